@@ -40,6 +40,7 @@ namespace rsai
 
             Eigen::Vector2d             projection_step () const;
             Eigen::Vector2d             shade_step () const;
+            gdal::polygon               object () const;
         protected:
             gdal::polygon m_object;
             Eigen::Vector2d   m_proj_step;
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <opencv2/opencv.hpp>
+#include <Eigen/Dense>
+#include "gdal_utils/shared_geometry.h"
+
+namespace rsai
+{
+    namespace building_models
+    {
+        // Everything roof_estimator and structure_estimator need to locate one feature
+        struct estimator_input
+        {
+            int             object_index        = -1;
+            cv::Mat         tile_gray;
+            Eigen::Matrix3d world_2_raster      = Eigen::Matrix3d::Identity ();
+            Eigen::Vector2d tile_top_left       = Eigen::Vector2d::Zero ();
+            // Normalized projection and shade steps
+            Eigen::Vector2d proj_world          = Eigen::Vector2d::Zero ();
+            Eigen::Vector2d shade_world         = Eigen::Vector2d::Zero ();
+            double          max_length          = 0.0;
+            gdal::polygon   roof;
+            gdal::polygons  segments;
+            bool            use_sam             = false;
+
+            float           roof_position_walk  = 0.0f;
+            int             roof_variants       = 0;
+            // Set by projection_and_shade_locator, roof_locator estimates roofs only
+            bool            estimate_structure  = false;
+            double          segmentize_step     = 0.0;
+            int             projection_step     = 0;
+            int             shade_variants      = 0;
+        };
+
+        // Self-contained binary file, the tile is stored raw and geometries as WKB
+        bool write_estimator_input ( const std::string &file_name, const estimator_input &input );
+        bool read_estimator_input ( const std::string &file_name, estimator_input &input );
+
+        // Directory of captured inputs, a file per feature
+        class estimator_capture
+        {
+        public:
+            bool            open    ( const std::string &directory );
+            void            close   ();
+
+            bool            enabled () const;
+            void            write   ( const estimator_input &input );
+
+        private:
+            std::atomic_bool m_enabled { false };
+            std::string     m_directory;
+            std::mutex      m_lock;
+        }; // class estimator_capture
+
+        // Process wide capture used by locators, it's off until opened
+        estimator_capture & estimator_captures ();
+    };
+};
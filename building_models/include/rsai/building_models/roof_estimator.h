@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include <memory>
 #include <opencv2/opencv.hpp>
 #include <Eigen/Dense>
 #include "eigen_utils/geometry.h"
@@ -12,20 +13,41 @@ namespace rsai
 {
     namespace building_models
     {
+        // Data shared by all candidates of one roof estimation
+        struct roof_frame
+        {
+            gdal::polygon   roof;
+            Eigen::Matrix3d world_2_raster;
+            Eigen::Vector2d tile_offset;
+        };
+
+        // A roof candidate is stored as a shift only, the aligned geometries are built on request
         struct roof_response
         {
-            gdal::polygon aligned_roof;
-            gdal::polygon aligned_roof_in_tile;
             Eigen::Vector2d shift_world;
             Eigen::Vector2d shift_on_tile;
             double value = -1e+300;
             double deviation = 0.0;
+            std::shared_ptr < const roof_frame > frame;
+
+            gdal::polygon aligned_roof () const;
+            gdal::polygon aligned_roof_in_tile () const;
 
             bool operator > ( const roof_response &rh ) const { return value > rh.value; }
         };
 
         using roof_responses = std::vector < roof_response >;
 
+        // Work done by the last estimation
+        struct roof_estimator_stats
+        {
+            size_t  candidates      = 0;
+            // Search region area, pixels
+            double  search_area     = 0.0;
+            // Peak size of the edges, heatmaps and segments' maps
+            size_t  scratch_bytes   = 0;
+        };
+
         class roof_estimator
         {
         public:
@@ -37,6 +59,7 @@ namespace rsai
                                           , const gdal::polygons &segments, const int roof_variants, const std::string dst_dir = "" );
 
             cv::Mat         heatmap () const;
+            const roof_estimator_stats & stats () const;
 
         private:
             gdal::bbox              m_search_bbox;
@@ -49,6 +72,7 @@ namespace rsai
             Eigen::Vector2d         m_shade_pixel;
             const double            m_max_length;
             const float             m_position_walk;
+            roof_estimator_stats    m_stats;
 
             static constexpr int response_calculation_step = 1;
             static constexpr int non_maxima_suppression_half_width = 3;
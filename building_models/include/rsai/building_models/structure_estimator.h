@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <map>
+#include <memory>
 #include "roof_estimator.h"
 #include "prismatic.h"
 
@@ -9,13 +10,27 @@ namespace rsai
 {
     namespace building_models
     {
+        // Data shared by all model candidates of one structure estimation
+        struct model_frame
+        {
+            prismatic       model;
+            Eigen::Matrix3d world_2_raster;
+            Eigen::Vector2d tile_tl_corner;
+        };
+
+        // A model candidate is stored as a length and a roof shift, the model geometry is generated on request
         struct model_response
         {
             int length = -1;
             double response = -1e+10;
-            prismatic model;
+            Eigen::Vector2d shift;
+            std::shared_ptr < const model_frame > frame;
+
+            model_response ( int l, double r, const Eigen::Vector2d &s, std::shared_ptr < const model_frame > f )
+                : length ( l ), response ( r ), shift ( s ), frame ( std::move ( f ) ) {}
 
-            model_response ( int l, double r, const prismatic &m ): length ( l ), response ( r ), model ( m ) {}
+            // Model on the tile raster
+            prismatic model () const;
 
             bool operator > ( const model_response &rh ) const { return response > rh.response; }
         };
@@ -42,6 +42,11 @@ Eigen::Vector2d rsai::building_models::abstract::shade_step () const
     return m_shade_step;
 }
 
+gdal::polygon rsai::building_models::abstract::object () const
+{
+    return m_object;
+}
+
 gdal::multipolygons rsai::building_models::precalculated::get ( const int length ) const
 {
     const int index = length - m_base_index;
@@ -0,0 +1,288 @@
+#include "rsai/building_models/estimator_capture.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <filesystem>
+
+#include "common/definitions.h"
+
+using namespace rsai::building_models;
+
+namespace
+{
+    const uint32_t capture_magic = 0x50414352; // "RCAP"
+    const uint32_t capture_version = 1;
+
+    template < class T >
+    void put ( std::string &payload, const T &value )
+    {
+        payload.append ( reinterpret_cast < const char * > ( &value ), sizeof ( T ) );
+    }
+
+    template < class T >
+    bool get ( const char * &data, const char * end, T &value )
+    {
+        if ( end - data < static_cast < std::ptrdiff_t > ( sizeof ( T ) ) )
+            return false;
+
+        std::memcpy ( &value, data, sizeof ( T ) );
+        data += sizeof ( T );
+        return true;
+    }
+
+    // Eigen's fixed size matrices are column major arrays of doubles
+    template < class Matrix >
+    void put_matrix ( std::string &payload, const Matrix &matrix )
+    {
+        payload.append ( reinterpret_cast < const char * > ( matrix.data () ), matrix.size () * sizeof ( double ) );
+    }
+
+    template < class Matrix >
+    bool get_matrix ( const char * &data, const char * end, Matrix &matrix )
+    {
+        const size_t size = matrix.size () * sizeof ( double );
+        if ( size_t ( end - data ) < size )
+            return false;
+
+        std::memcpy ( matrix.data (), data, size );
+        data += size;
+        return true;
+    }
+
+    bool put_polygon ( std::string &payload, const gdal::polygon &polygon )
+    {
+        if ( !polygon )
+        {
+            put ( payload, uint32_t ( 0 ) );
+            return true;
+        }
+
+        std::vector < unsigned char > wkb ( polygon->WkbSize () );
+        if ( polygon->exportToWkb ( wkbNDR, wkb.data () ) != OGRERR_NONE )
+            return false;
+
+        put ( payload, uint32_t ( wkb.size () ) );
+        payload.append ( reinterpret_cast < const char * > ( wkb.data () ), wkb.size () );
+        return true;
+    }
+
+    bool get_polygon ( const char * &data, const char * end, gdal::polygon &polygon )
+    {
+        uint32_t size = 0;
+        if ( !get ( data, end, size ) || size_t ( end - data ) < size )
+            return false;
+
+        polygon.reset ();
+        if ( size == 0 )
+            return true;
+
+        OGRGeometry * geometry = nullptr;
+        if ( OGRGeometryFactory::createFromWkb ( data, nullptr, &geometry, size ) != OGRERR_NONE )
+            return false;
+
+        data += size;
+
+        if ( wkbFlatten ( geometry->getGeometryType () ) != wkbPolygon )
+        {
+            OGRGeometryFactory::destroyGeometry ( geometry );
+            return false;
+        }
+
+        polygon = gdal::polygon ( geometry->toPolygon () );
+        return true;
+    }
+
+    bool encode ( const estimator_input &input, std::string &payload )
+    {
+        // Same tile type the decoder accepts
+        if ( input.tile_gray.type () != CV_8UC1 )
+            return false;
+
+        put ( payload, capture_magic );
+        put ( payload, capture_version );
+        put ( payload, int32_t ( input.object_index ) );
+
+        const cv::Mat tile = input.tile_gray.isContinuous () ? input.tile_gray : input.tile_gray.clone ();
+        put ( payload, int32_t ( tile.rows ) );
+        put ( payload, int32_t ( tile.cols ) );
+        put ( payload, int32_t ( tile.type () ) );
+        payload.append ( reinterpret_cast < const char * > ( tile.data ), tile.total () * tile.elemSize () );
+
+        put_matrix ( payload, input.world_2_raster );
+        put_matrix ( payload, input.tile_top_left );
+        put_matrix ( payload, input.proj_world );
+        put_matrix ( payload, input.shade_world );
+        put ( payload, input.max_length );
+
+        if ( !put_polygon ( payload, input.roof ) )
+            return false;
+
+        put ( payload, uint32_t ( input.segments.size () ) );
+        for ( const auto &segment : input.segments )
+            if ( !put_polygon ( payload, segment ) )
+                return false;
+
+        put ( payload, uint8_t ( input.use_sam ) );
+        put ( payload, input.roof_position_walk );
+        put ( payload, int32_t ( input.roof_variants ) );
+        put ( payload, uint8_t ( input.estimate_structure ) );
+        put ( payload, input.segmentize_step );
+        put ( payload, int32_t ( input.projection_step ) );
+        put ( payload, int32_t ( input.shade_variants ) );
+        return true;
+    }
+
+    bool decode ( const char * data, const char * end, estimator_input &input )
+    {
+        uint32_t magic = 0, version = 0;
+        if ( !get ( data, end, magic ) || !get ( data, end, version ) || magic != capture_magic || version != capture_version )
+            return false;
+
+        int32_t object_index = 0, rows = 0, cols = 0, type = 0;
+        if ( !get ( data, end, object_index ) || !get ( data, end, rows ) || !get ( data, end, cols ) || !get ( data, end, type )
+             || rows < 0 || cols < 0 )
+            return false;
+
+        // Header values are checked before allocating, estimators take a gray tile only
+        if ( type != CV_8UC1 )
+            return false;
+
+        const uint64_t tile_size = uint64_t ( rows ) * uint64_t ( cols );
+        if ( uint64_t ( end - data ) < tile_size )
+            return false;
+
+        input.object_index = object_index;
+        input.tile_gray.create ( rows, cols, type );
+
+        std::memcpy ( input.tile_gray.data, data, tile_size );
+        data += tile_size;
+
+        if ( !get_matrix ( data, end, input.world_2_raster ) || !get_matrix ( data, end, input.tile_top_left )
+             || !get_matrix ( data, end, input.proj_world ) || !get_matrix ( data, end, input.shade_world )
+             || !get ( data, end, input.max_length ) || !get_polygon ( data, end, input.roof ) )
+            return false;
+
+        uint32_t segments = 0;
+        if ( !get ( data, end, segments ) )
+            return false;
+
+        input.segments.clear ();
+        for ( uint32_t i = 0; i < segments; ++i )
+        {
+            gdal::polygon segment;
+            if ( !get_polygon ( data, end, segment ) )
+                return false;
+            input.segments.push_back ( segment );
+        }
+
+        uint8_t use_sam = 0, estimate_structure = 0;
+        int32_t roof_variants = 0, projection_step = 0, shade_variants = 0;
+        if ( !get ( data, end, use_sam ) || !get ( data, end, input.roof_position_walk ) || !get ( data, end, roof_variants )
+             || !get ( data, end, estimate_structure ) || !get ( data, end, input.segmentize_step )
+             || !get ( data, end, projection_step ) || !get ( data, end, shade_variants ) )
+            return false;
+
+        input.use_sam = use_sam != 0;
+        input.roof_variants = roof_variants;
+        input.estimate_structure = estimate_structure != 0;
+        input.projection_step = projection_step;
+        input.shade_variants = shade_variants;
+        return data == end;
+    }
+}; // namespace
+
+bool rsai::building_models::write_estimator_input ( const std::string &file_name, const estimator_input &input )
+{
+    std::string payload;
+    if ( !encode ( input, payload ) )
+    {
+        std::cerr << "Unable to encode estimator input of object " << input.object_index << std::endl;
+        return false;
+    }
+
+    // A partially written capture never replaces a complete one
+    const std::string temp_name = file_name + ".tmp";
+    {
+        std::ofstream out ( temp_name, std::ios::binary );
+        if ( !out || !out.write ( payload.data (), payload.size () ) )
+        {
+            std::cerr << "Unable to write estimator capture: " << temp_name << std::endl;
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename ( temp_name, file_name, error );
+    if ( error )
+    {
+        std::cerr << "Unable to write estimator capture: " << file_name << ", " << error.message () << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool rsai::building_models::read_estimator_input ( const std::string &file_name, estimator_input &input )
+{
+    std::ifstream in ( file_name, std::ios::binary );
+    if ( !in )
+    {
+        std::cerr << "Unable to read estimator capture: " << file_name << std::endl;
+        return false;
+    }
+
+    const std::string payload ( ( std::istreambuf_iterator < char > ( in ) ), std::istreambuf_iterator < char > () );
+    if ( !decode ( payload.data (), payload.data () + payload.size (), input ) )
+    {
+        std::cerr << "Malformed estimator capture: " << file_name << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool estimator_capture::open ( const std::string &directory )
+{
+    std::scoped_lock lock ( m_lock );
+
+    std::error_code error;
+    std::filesystem::create_directories ( directory, error );
+    if ( error )
+    {
+        std::cerr << "Unable to create captures directory: " << directory << ", " << error.message () << std::endl;
+        return false;
+    }
+
+    m_directory = directory;
+    m_enabled = true;
+    return true;
+}
+
+void estimator_capture::close ()
+{
+    std::scoped_lock lock ( m_lock );
+    m_enabled = false;
+}
+
+bool estimator_capture::enabled () const
+{
+    return m_enabled.load ( std::memory_order_relaxed );
+}
+
+void estimator_capture::write ( const estimator_input &input )
+{
+    if ( !enabled () )
+        return;
+
+    // Files are per object, so writing needs no serialization
+    write_estimator_input ( ( std::filesystem::path ( m_directory ) / ( std::to_string ( input.object_index ) + DEFAULT_CAPTURE_FILE_EXT ) ).string ()
+                          , input );
+}
+
+estimator_capture & rsai::building_models::estimator_captures ()
+{
+    static estimator_capture capture;
+    return capture;
+}
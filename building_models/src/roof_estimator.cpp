@@ -5,6 +5,8 @@
 #include "eigen_utils/geometry.h"
 #include "opencv_utils/gdal_bridges.h"
 #include "opencv_utils/geometry_renderer.h"
+#include "opencv_utils/artifact_writer.h"
+#include "threading_utils/trace.h"
 #include "differentiation/gauss_directed_derivative.h"
 #include "differentiation/convolution_mask.h"
 
@@ -15,6 +17,8 @@ rsai::building_models::roof_estimator::roof_estimator( const float position_walk
                                                        , const Eigen::Vector2d &shade_world, const double max_length, const cv::Mat &tile_gray, const cv::Mat &mask ):
     m_world_2_raster ( world_2_raster ), m_mask ( mask ), m_max_length ( max_length ), m_position_walk ( position_walk )
 {
+    RSAI_TRACE_SPAN ( "edge convolution" );
+
     const Eigen::Matrix2d transform     = world_2_raster.block < 2, 2 > ( 0, 0 );
     m_proj_pixel    = transform * proj_world;
     m_shade_pixel   = transform * shade_world;
@@ -31,6 +35,8 @@ rsai::building_models::roof_estimator::roof_estimator( const float position_walk
     cv::minMaxLoc(convolution, &minVal, &maxVal); //find minimum and maximum intensities
 
     convolution.convertTo(m_edges, CV_8U, 255.0/maxVal, 0);
+
+    m_stats.scratch_bytes = convolution.total () * convolution.elemSize () + m_edges.total () * m_edges.elemSize ();
 }
 
 rsai::building_models::roof_responses rsai::building_models::roof_estimator::operator () ( const gdal::polygon &roof, const Eigen::Vector2d &tile_offset
@@ -50,6 +56,8 @@ rsai::building_models::roof_responses rsai::building_models::roof_estimator::ope
         search_bbox = gdal::bbox ( m_search_region );
     }
 
+    RSAI_TRACE_BEGIN ( calc_span, "heatmap" );
+
     opencv::polygon_bounded_ops estimator ( m_edges, roof_local );
 
     cv::Mat heatmap = cv::Mat::zeros ( m_edges.size (), CV_32F );
@@ -71,10 +79,16 @@ rsai::building_models::roof_responses rsai::building_models::roof_estimator::ope
 
                 auto response = estimator.nonzero_weighted_sum ( x, y );
                 heatmap.at < float > ( y + start_y, x + start_x ) = response;
+                ++m_stats.candidates;
             }
         }
     }
 
+    RSAI_TRACE_END ( calc_span );
+
+    m_stats.search_area = search_region->get_Area ();
+    m_stats.scratch_bytes = std::max ( m_stats.scratch_bytes, m_edges.total () * m_edges.elemSize () + 2 * heatmap.total () * heatmap.elemSize () );
+
     auto responses = __heatmap_non_maxima_suppression ( heatmap, start_x, start_y );
     __fill_responses ( responses, roof, m_world_2_raster, tile_offset, roof_variants, distance_weight_mapping );
 
@@ -84,7 +98,7 @@ rsai::building_models::roof_responses rsai::building_models::roof_estimator::ope
 rsai::building_models::roof_responses rsai::building_models::roof_estimator::operator () ( const gdal::polygon &roof, const Eigen::Vector2d &tile_offset
                                                                                            , const gdal::polygons &segments, const int roof_variants, const std::string dst_dir )
 {
-    auto prepare_start = std::chrono::high_resolution_clock::now();
+    RSAI_TRACE_BEGIN ( prepare_span, "sam masks" );
 
     auto roof_local = gdal::operator * ( roof, m_world_2_raster );
     roof_local = gdal::operator +( roof_local, tile_offset );
@@ -144,15 +158,13 @@ rsai::building_models::roof_responses rsai::building_models::roof_estimator::ope
 
     //image.convertTo(image, CV_8U, 255.0/maxVal, 0);
 
-#   if defined ( RENDER_SAM_MASKS )    
-    cv::imwrite ( dst_dir + "segms.png", m_edges );
+#   if defined ( RENDER_SAM_MASKS )
+    opencv::artifacts ().write ( opencv::artifact_level::full, dst_dir + "segms.png", m_edges );
 #   endif
 
-    auto prepare_stop = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> prepare_elapsed = prepare_stop - prepare_start;
-    //std::cout << "prepare " << prepare_elapsed.count() << " s\n";
+    RSAI_TRACE_END ( prepare_span );
 
-    auto calc_start = std::chrono::high_resolution_clock::now();
+    RSAI_TRACE_BEGIN ( calc_span, "heatmap" );
 
     cv::Mat heatmap = cv::Mat::zeros ( m_edges.size (), CV_32F );
 
@@ -202,27 +214,35 @@ rsai::building_models::roof_responses rsai::building_models::roof_estimator::ope
                 const float edge_response = edge_estimator.sum_unsafe ( x, y );
 
                 heatmap.at < float > ( y + start_y, x + start_x ) = max_response + /*total_response +*/ edge_response;
+                ++m_stats.candidates;
             }
         }
     }
 
-    auto calc_stop = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> calc_elapsed = calc_stop - calc_start;
-    //std::cout << "calc " << calc_elapsed.count() << " s\n";
+    RSAI_TRACE_END ( calc_span );
+
+    size_t segment_maps_bytes = 0;
+    for ( const auto &segment_map : segment_maps )
+        segment_maps_bytes += segment_map.total () * segment_map.elemSize ();
 
-    auto post_proc_start = std::chrono::high_resolution_clock::now();
+    m_stats.search_area = search_region->get_Area ();
+    m_stats.scratch_bytes = std::max ( m_stats.scratch_bytes, m_edges.total () * m_edges.elemSize () + 2 * heatmap.total () * heatmap.elemSize ()
+                                                            + segment_maps_bytes );
 
-    cv::minMaxLoc(heatmap, &minVal, &maxVal);
-    cv::Mat heat_out;
-    heatmap.convertTo(heat_out, CV_8U, 255.0/maxVal, 0);
-    cv::imwrite ( dst_dir + "heats.png", heat_out );
+    RSAI_TRACE_BEGIN ( post_proc_span, "post processing" );
+
+    if ( opencv::artifacts ().enabled ( opencv::artifact_level::full ) )
+    {
+        cv::minMaxLoc(heatmap, &minVal, &maxVal);
+        cv::Mat heat_out;
+        heatmap.convertTo(heat_out, CV_8U, 255.0/maxVal, 0);
+        opencv::artifacts ().write ( opencv::artifact_level::full, dst_dir + "heats.png", heat_out );
+    }
 
     auto responses = __heatmap_non_maxima_suppression ( heatmap, start_x, start_y );
     __fill_responses ( responses, roof, m_world_2_raster, tile_offset, roof_variants, distance_weight_mapping );
 
-    auto post_proc_stop = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> post_proc_elapsed = post_proc_stop - post_proc_start;
-    //std::cout << "post proc " << post_proc_elapsed.count() << " s\n";
+    RSAI_TRACE_END ( post_proc_span );
 
     return std::move ( responses );
 }
@@ -232,6 +252,11 @@ cv::Mat rsai::building_models::roof_estimator::heatmap () const
     return m_heatmap;
 }
 
+const roof_estimator_stats & rsai::building_models::roof_estimator::stats () const
+{
+    return m_stats;
+}
+
 gdal::polygon rsai::building_models::roof_estimator::__create_search_region ( const float position_walk )
 {
     const Eigen::Matrix2d transform = m_world_2_raster.block < 2, 2 > ( 0, 0 );
@@ -248,6 +273,8 @@ gdal::polygon rsai::building_models::roof_estimator::__create_search_region ( co
 
 roof_responses rsai::building_models::roof_estimator::__heatmap_non_maxima_suppression ( cv::Mat heatmap, const double start_x, const double start_y )
 {
+    RSAI_TRACE_SPAN ( "nms" );
+
     roof_responses responses;
     responses.reserve ( 100 );
 
@@ -287,7 +314,7 @@ roof_responses rsai::building_models::roof_estimator::__heatmap_non_maxima_suppr
             {
                 const auto response = heatmap.at<float>(y, x);
                 m_heatmap.at<float>(y, x) = response;
-                responses.push_back ( { {}, {}, {}, { x - start_x, y - start_y }, response } );
+                responses.push_back ( { {}, { x - start_x, y - start_y }, response } );
             }
         }
     }
@@ -313,22 +340,37 @@ void rsai::building_models::roof_estimator::__fill_responses ( roof_responses &r
         responses.shrink_to_fit();
     }
 
+    // Candidates share the source roof, geometries are created only for the ones asked for
+    auto frame = std::make_shared < roof_frame > ( roof_frame { roof_geometry, world_2_raster, tile_offset } );
+
     for ( auto & response : responses )
     {
         const Eigen::Vector2i sh_pixel = response.shift_on_tile.cast < int > ();
-        const Eigen::Vector2d roof_shift = raster_2_world.block < 2, 2 > ( 0, 0 ) * response.shift_on_tile;
-        auto shifted_roof = gdal::operator + ( roof_geometry, roof_shift );
-
-        auto shifted_roof_raster = gdal::operator * ( shifted_roof, world_2_raster );
-        auto tiled_roof_raster = gdal::operator + ( shifted_roof_raster, tile_offset );
 
-        response.shift_world = roof_shift;
-        response.aligned_roof = shifted_roof;
-        response.aligned_roof_in_tile = tiled_roof_raster;
+        response.shift_world = raster_2_world.block < 2, 2 > ( 0, 0 ) * response.shift_on_tile;
         response.deviation = distance_weight_mapping [ { sh_pixel [0], sh_pixel [1] } ];
+        response.frame = frame;
     }
 }
 
+gdal::polygon rsai::building_models::roof_response::aligned_roof () const
+{
+    if ( !frame || !frame->roof )
+        return {};
+
+    return gdal::operator + ( frame->roof, shift_world );
+}
+
+gdal::polygon rsai::building_models::roof_response::aligned_roof_in_tile () const
+{
+    auto shifted_roof = aligned_roof ();
+    if ( !shifted_roof )
+        return {};
+
+    auto shifted_roof_raster = gdal::operator * ( shifted_roof, frame->world_2_raster );
+    return gdal::operator + ( shifted_roof_raster, frame->tile_offset );
+}
+
 bool rsai::building_models::roof_estimator::xy::operator < ( const xy &rh ) const
 {
     return y < rh.y || ( y == rh.y && x < rh.x );
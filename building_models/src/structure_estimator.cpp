@@ -4,6 +4,7 @@
 #include "opencv_utils/geometry_renderer.h"
 #include "differentiation/gauss_directed_derivative.h"
 #include "differentiation/convolution_mask.h"
+#include "threading_utils/trace.h"
 
 rsai::building_models::structure_estimator::structure_estimator ( prismatic model, const roof_responses &responses
                                                                 , const cv::Mat &tile_gray, const Eigen::Vector2d &tile_tl_corner
@@ -18,6 +19,8 @@ rsai::building_models::structure_estimator::structure_estimator ( prismatic mode
 rsai::building_models::structures rsai::building_models::structure_estimator::operator () ( const double max_length, const double projection_step
                                                                                                , const int roof_responses_max, const int shade_responses_max ) const
 {
+    RSAI_TRACE_SPAN ( "structure estimation" );
+
     //static std::atomic<int> model_counter(0);
     //++model_counter;
     //std::ofstream out ( "logs/" + std::to_string ( model_counter ) );
@@ -45,6 +48,8 @@ rsai::building_models::structures rsai::building_models::structure_estimator::op
         segment_maps [i] = image;
     }
 
+    auto frame = std::make_shared < model_frame > ( model_frame { m_model, m_world_2_raster, m_tile_tl_corner } );
+
     std::vector < double > memory_weights ( roof_responses_max );
     for ( int length = 1; length <= max_length; length += projection_step )
     {
@@ -75,13 +80,13 @@ rsai::building_models::structures rsai::building_models::structure_estimator::op
                 auto & roof_response = roof_map [roof_shift];
                 roof_response.shift_on_tile = roof_shift;
                 roof_response.shades.reserve ( max_length );
-                roof_response.shades.emplace_back ( length, estamate, local_model );
+                roof_response.shades.emplace_back ( length, estamate, roof_shift, frame );
                 roof_response.value = std::max ( roof_response.value, estamate  );
             }
             else
             {
                 auto & roof_response = roof_map [roof_shift];
-                roof_response.shades.emplace_back ( length, estamate, local_model );
+                roof_response.shades.emplace_back ( length, estamate, roof_shift, frame );
                 roof_response.value = std::max ( roof_response.value, estamate );
             }
         }
@@ -110,3 +115,15 @@ rsai::building_models::structures rsai::building_models::structure_estimator::op
 
     return std::move ( result );
 }
+
+rsai::building_models::prismatic rsai::building_models::model_response::model () const
+{
+    if ( !frame )
+        return {};
+
+    auto local_model = frame->model;
+    local_model.generate ( length );
+    local_model.transform_2_raster ( frame->world_2_raster, -frame->tile_tl_corner + shift );
+
+    return local_model;
+}
@@ -0,0 +1,370 @@
+#include <iostream>
+#include <string>
+
+#include <args-parser/all.hpp>
+
+#include "rsai/building_pipeline.h"
+#include "rsai/feature_profile.h"
+#include "rsai/building_models/estimator_capture.h"
+#include "threading_utils/trace.h"
+
+#include "common/definitions.h"
+#include "common/arguments.h"
+#include "common/promt_functions.hpp"
+#include "common/progress_functions.hpp"
+
+using namespace std;
+
+int main ( int argc, char * argv[] )
+{
+    try
+    {
+        Args::CmdLine cmd( argc, argv );
+
+        Args::Arg &input_vector_param = arguments::get_input_vector ();
+        input_vector_param.setDescription( input_vector_param.description() + SL( "Used to find raster inlier objects and locate them." ) );
+
+        Args::Arg & input_raster_param = arguments::get_input_raster ();
+        input_raster_param.setDescription( input_raster_param.description() + SL ( "Raster bounds are used as the primary region of interest, "
+                                           "raster is used to find actual buildings' roofs positions." ) );
+
+        Args::Arg &input_metadata_param = arguments::get_input_metadata();
+        input_metadata_param.setDescription( input_metadata_param.description() + SL( "Contains projection and shading vectors" ) );
+
+        Args::Arg & output_param = arguments::get_output ();
+        output_param.setDescription( output_param.description() + "Located objects are saved into the maps named '"
+                                     + DEFAULT_ROOF_LAYER_NAME + "', '" + DEFAULT_PROJECTION_LAYER_NAME + "' and '" + DEFAULT_SHADE_LAYER_NAME + "'." );
+
+        Args::Arg & driver_param = arguments::get_driver ();
+
+        Args::Arg & force_rewtire_param = arguments::get_force_rewtire ();
+
+        // Stages' params sharing the short names are long-only here
+        Args::Arg roi_param( SL( "roi" ), true, false );
+        roi_param.setDescription( SL( "Input single-layer vector map containing region-of-interest polygon (only the first one would be applied). "
+                                      "It's intersection with raster bound designates the final region to extract inliers and to update the map. " ) );
+
+        Args::Arg input_updating_map_param( SL( "input_updating" ), true, false );
+        input_updating_map_param.setDescription( SL( "Input vector map to be updated by the located roofs. If is not set - the map updating is skipped. " ) );
+
+        Args::Arg min_raster_obj_size_param( SL( "min_raster_obj_size" ), true, false );
+        min_raster_obj_size_param.setDescription( std::string( "Minimal object size on the source raster to be located. "
+                                                               "The default is " ) + DEFAULT_MIN_RASTER_OBJ_SIZE_VALUE + " m. " );
+        min_raster_obj_size_param.setDefaultValue ( DEFAULT_MIN_RASTER_OBJ_SIZE_VALUE );
+
+        Args::Arg segmentize_step_param( SL( "segmentize_step" ), true, false );
+        segmentize_step_param.setDescription( std::string ( "Step value to segmetize building model geometry (pixels). "
+                                                            "The default is " ) + DEFAULT_SEGMENTIZE_STEP_VALUE + " pixels. " );
+        segmentize_step_param.setDefaultValue ( DEFAULT_SEGMENTIZE_STEP_VALUE );
+
+        Args::Arg shade_variants_param( SL( "shade_varians" ), true, false );
+        shade_variants_param.setDescription( std::string( "Quantity of shade position variants to generate per each position variant. "
+                                                          "The default is " ) + DEFAULT_SHADE_VARIANTS_VALUE + " variants. ");
+        shade_variants_param.setDefaultValue ( DEFAULT_SHADE_VARIANTS_VALUE );
+
+        Args::Arg & crop_geometry_param = arguments::get_crop_by_raster ();
+
+        Args::Arg & semantic_filter_param = arguments::get_semantic_filter ();
+
+        Args::Arg & max_proj_param = arguments::get_max_projection_length ();
+
+        Args::Arg & mask_size_param = arguments::get_mask_size ();
+
+        Args::Arg & locator_param = arguments::get_pipeline_locator ();
+
+        Args::Arg & chunk_size_param = arguments::get_pipeline_chunk_size ();
+
+        Args::Arg & projection_step_param = arguments::get_projection_step ();
+
+        Args::Arg & roof_position_walk_param = arguments::get_roof_position_walk ();
+
+        Args::Arg & roof_variants_param = arguments::get_roof_varians();
+
+        Args::Arg & use_sam_param = arguments::get_use_sam ();
+
+        Args::Arg & segmentation_socket_param = arguments::get_segmentation_socket ();
+        segmentation_socket_param.setDescription( std::string( "Unix socket path of the persistent segmentation worker objects are segmented by. "
+                                                               "The default is " ) + DEFAULT_SEGMENTATION_SOCKET + ". " );
+
+        Args::Arg & segmentation_batch_param = arguments::get_segmentation_batch ();
+        segmentation_batch_param.setDescription( std::string( "Segmentation worker's batch, twice as many tiles are sent ahead. "
+                                                              "The default is " ) + DEFAULT_SEGMENTATION_BATCH_VALUE + ". " );
+
+        Args::Arg & min_first_pos_weight_param = arguments::get_min_first_pos_weight ();
+
+        Args::Arg & max_first_pos_deviation_param = arguments::get_max_first_pos_deviation ();
+
+        Args::Arg & iou_match_thresh_param = arguments::get_iou_match_thresh ();
+
+        Args::Arg & iou_min_thresh_param = arguments::get_iou_min_thresh ();
+
+        Args::Arg & save_update_diff_param = arguments::get_save_update_diff ();
+
+        Args::Arg & save_updated_map_param = arguments::get_save_updated_map ();
+
+        Args::Arg & save_intermediate_param = arguments::get_save_intermediate ();
+
+        Args::Arg & trace_param = arguments::get_trace ();
+
+        Args::Arg & profile_param = arguments::get_profile ();
+
+        Args::Arg & capture_param = arguments::get_capture ();
+
+        Args::Help help;
+        help.setAppDescription(
+            SL( "Utility to run inliers extraction, objects' bounds finding, automatic roofs or structures locating and map updating "
+                "in a single process. Objects pass the stages in chunks through bounded in-memory queues, so the stages run at once "
+                "and only the final maps are written. "
+                "World coordinate systems for all input datasets should match otherwise the utility will fail (no reprojection or conversion is performed)." ) );
+        help.setExecutable( argv[0] );
+
+        cmd.addArg ( input_vector_param );
+        cmd.addArg ( input_raster_param );
+        cmd.addArg ( input_metadata_param );
+        cmd.addArg ( input_updating_map_param );
+        cmd.addArg ( roi_param );
+        cmd.addArg ( output_param );
+        cmd.addArg ( driver_param );
+        cmd.addArg ( force_rewtire_param );
+        cmd.addArg ( crop_geometry_param );
+        cmd.addArg ( semantic_filter_param );
+        cmd.addArg ( min_raster_obj_size_param );
+        cmd.addArg ( mask_size_param );
+        cmd.addArg ( max_proj_param );
+        cmd.addArg ( locator_param );
+        cmd.addArg ( chunk_size_param );
+        cmd.addArg ( segmentize_step_param );
+        cmd.addArg ( projection_step_param );
+        cmd.addArg ( roof_position_walk_param );
+        cmd.addArg ( roof_variants_param );
+        cmd.addArg ( shade_variants_param );
+        cmd.addArg ( use_sam_param );
+        cmd.addArg ( segmentation_socket_param );
+        cmd.addArg ( segmentation_batch_param );
+        cmd.addArg ( min_first_pos_weight_param );
+        cmd.addArg ( max_first_pos_deviation_param );
+        cmd.addArg ( iou_match_thresh_param );
+        cmd.addArg ( iou_min_thresh_param );
+        cmd.addArg ( save_update_diff_param );
+        cmd.addArg ( save_updated_map_param );
+        cmd.addArg ( save_intermediate_param );
+        cmd.addArg ( trace_param );
+        cmd.addArg ( profile_param );
+        cmd.addArg ( capture_param );
+        cmd.addArg ( help );
+
+        cmd.parse();
+
+        // loading and validating datasets
+        gdal::open_vector_ro_helper iv_helper ( input_vector_param.value(), std::cerr );
+        auto ds_vector = iv_helper.validate ( true );
+
+        gdal::open_raster_ro_helper ir_helper ( input_raster_param.value(), std::cerr );
+        auto ds_raster = ir_helper.validate ( true );
+
+        gdal::open_vector_ro_helper im_helper ( input_metadata_param.value(), std::cerr );
+        auto ds_meta = im_helper.validate ( true );
+
+        gdal::open_vector_ro_helper roi_helper ( roi_param.value(), std::cerr );
+        auto ds_roi = roi_helper.validate ( false );
+
+        gdal::open_vector_ro_helper iu_helper ( input_updating_map_param.value(), std::cerr );
+        auto ds_updating = iu_helper.validate ( false );
+
+        gdal::create_vector_helper out_helper ( output_param.value(), driver_param.value(), std::cerr );
+        auto ds_out = out_helper.validate ( true );
+
+        if ( ds_vector == nullptr || ds_raster == nullptr || ds_meta == nullptr || ds_out == nullptr
+             || ds_roi == nullptr && !roi_param.value().empty ()
+             || ds_updating == nullptr && !input_updating_map_param.value().empty () )
+        {
+            std::cerr << "STOP: Input parameters verification failed" << std::endl;
+            return 1;
+        }
+
+        // getting and validaring SRSs
+        auto vec_srs = iv_helper.srs(),
+             rst_srs = ir_helper.srs(),
+             meta_srs = im_helper.srs(),
+             roi_srs = roi_helper.srs(),
+             updating_srs = iu_helper.srs();
+
+        // Verifying SRSs
+        if ( !vec_srs.verify ( std::cerr ) || !rst_srs.verify ( std::cerr ) || !meta_srs.verify ( std::cerr )
+             || ( ds_roi != nullptr ) && !roi_srs.verify ( std::cerr )
+             || ( ds_updating != nullptr ) && !updating_srs.verify ( std::cerr ) )
+        {
+            std::cerr << "STOP: Input datasets' SRS are not valid" << std::endl;
+            return 1;
+        }
+
+        // Verifying SRSs similarity
+        if ( !vec_srs->IsSame ( rst_srs.get() ) )
+        {
+            std::cerr << "STOP: source vector map's and raster image's SRSs are not same." << std::endl << std::endl;
+            std::cout << "Vector SRS: " << vec_srs.export_to_pretty_wkt() << std::endl << std::endl;
+            std::cout << "Raster SRS: " << rst_srs.export_to_pretty_wkt() << std::endl;
+            return 1;
+        }
+
+        if ( !vec_srs->IsSame ( meta_srs.get() ) )
+        {
+            std::cerr << "STOP: source vector map's and projectnios metadata SRSs are not same." << std::endl << std::endl;
+            std::cout << "Vector SRS: " << vec_srs.export_to_pretty_wkt() << std::endl << std::endl;
+            std::cout << "Metadata SRS: " << meta_srs.export_to_pretty_wkt() << std::endl;
+            return 1;
+        }
+
+        if ( ( ds_roi != nullptr ) && !vec_srs->IsSame ( roi_srs.get() ) )
+        {
+            std::cerr << "STOP: source vector map's and region of interest SRSs are not same." << std::endl << std::endl;
+            std::cout << "Vector SRS: " << vec_srs.export_to_pretty_wkt() << std::endl << std::endl;
+            std::cout << "ROI SRS: " << roi_srs.export_to_pretty_wkt() << std::endl;
+            return 1;
+        }
+
+        if ( ( ds_updating != nullptr ) && !vec_srs->IsSame ( updating_srs.get() ) )
+        {
+            std::cerr << "STOP: source vector map's and updating map's SRSs are not same." << std::endl << std::endl;
+            std::cout << "Vector SRS: " << vec_srs.export_to_pretty_wkt() << std::endl << std::endl;
+            std::cout << "Updating SRS: " << updating_srs.export_to_pretty_wkt() << std::endl;
+            return 1;
+        }
+
+        rsai::pipeline_options options;
+
+        value_helper < int > raster_size_helper    ( min_raster_obj_size_param.value() );
+        if ( !raster_size_helper.verify ( std::cerr, "STOP: Minimal object size on raster is incorrect" ) )
+            return 1;
+
+        value_helper < int > length_helper  ( max_proj_param.value() );
+        value_helper < int > mask_helper    ( mask_size_param.value() );
+        if ( !length_helper.verify ( std::cerr, "STOP: Maximum vectors length is incorrect" )
+             || !mask_helper.verify ( std::cerr, "STOP: Maximum mask size is incorrect" ) )
+            return 1;
+
+        // Building model segmentize step value
+        value_helper < double > segmentize_step_helper      ( segmentize_step_param.value() );
+        if ( !segmentize_step_helper.verify ( std::cerr,    "STOP: Building model segmentize step value is incorrect." ) )
+            return 1;
+
+        // Building model projection step value
+        value_helper < int > projection_step_helper         ( projection_step_param.value() );
+        if ( !projection_step_helper.verify ( std::cerr,    "STOP: Building model projection step value are incorrect." ) )
+            return 1;
+
+        // Building model roof position walk value
+        value_helper < double > roof_position_walk_helper   ( roof_position_walk_param.value() );
+        if ( !roof_position_walk_helper.verify ( std::cerr, "STOP: Building model roof position walk value is incorrect." ) )
+            return 1;
+
+        // Building model roof and shade varinats to generate
+        value_helper < int > roof_variants_helper           ( roof_variants_param.value() );
+        if ( !roof_variants_helper.verify ( std::cerr,      "STOP: Building model roof variants value is incorrect." ) )
+            return 1;
+
+        value_helper < int > segmentation_batch_helper      ( segmentation_batch_param.value() );
+        if ( !segmentation_batch_helper.verify ( std::cerr, "STOP: Segmentation batch value is incorrect." ) )
+            return 1;
+
+        value_helper < int > shade_variants_helper          ( shade_variants_param.value() );
+        if ( !shade_variants_helper.verify ( std::cerr,     "STOP: Building model shade variants value is incorrect." ) )
+            return 1;
+
+        value_helper < double > min_first_pos_weight_helper ( min_first_pos_weight_param.value() );
+        if ( !min_first_pos_weight_helper.verify ( std::cerr, "STOP: First position minimum weight value is incorrect." ) )
+            return 1;
+
+        value_helper < double > max_first_pos_deviation_helper ( max_first_pos_deviation_param.value() );
+        if ( !max_first_pos_deviation_helper.verify ( std::cerr, "STOP: First position minimum deviation value is incorrect." ) )
+            return 1;
+
+        value_helper < double > iou_match_thresh_helper      ( iou_match_thresh_param.value() );
+        if ( !iou_match_thresh_helper.verify ( std::cerr,    "STOP: IoU match threshold value is incorrect." ) )
+            return 1;
+
+        value_helper < double > iou_min_thresh_helper      ( iou_min_thresh_param.value() );
+        if ( !iou_min_thresh_helper.verify ( std::cerr,    "STOP: IoU min threshold value is incorrect." ) )
+            return 1;
+
+        value_helper < int > chunk_size_helper      ( chunk_size_param.value() );
+        if ( !chunk_size_helper.verify ( std::cerr,    "STOP: Chunk size value is incorrect." ) )
+            return 1;
+
+        if ( chunk_size_helper.value() < 1 )
+        {
+            std::cerr << "STOP: Chunk size has to be positive." << std::endl;
+            return 1;
+        }
+
+        options.locator = rsai::pipeline_locator_from_string ( locator_param.value() );
+        if ( options.locator == rsai::pipeline_locator::invalid )
+        {
+            std::cerr << "STOP: Pipeline locator '" << locator_param.value() << "' is invalid. Use --help param for correct values." << std::endl;
+            return 1;
+        }
+
+        options.chunk_size = chunk_size_helper.value();
+        options.crop_geometry = crop_geometry_param.isDefined ();
+        options.semantic_filter = semantic_filter_param.value();
+        options.min_raster_obj_size = raster_size_helper.value();
+        options.mask_size = mask_helper.value();
+        options.max_projection_length = length_helper.value();
+        options.segmentize_step = segmentize_step_helper.value();
+        options.projection_step = projection_step_helper.value();
+        options.roof_position_walk = roof_position_walk_helper.value();
+        options.roof_variants = roof_variants_helper.value();
+        options.shade_variants = shade_variants_helper.value();
+        options.min_first_pos_weight = min_first_pos_weight_helper.value();
+        options.max_first_pos_deviation = max_first_pos_deviation_helper.value();
+        options.use_sam = use_sam_param.isDefined();
+        options.segmentation.socket = segmentation_socket_param.value();
+        options.segmentation.batch = segmentation_batch_helper.value();
+        options.iou_match_thresh = iou_match_thresh_helper.value();
+        options.iou_min_thresh = iou_min_thresh_helper.value();
+        options.save_difference = save_update_diff_param.isDefined();
+        options.save_updated = save_updated_map_param.isDefined();
+        options.save_intermediate = save_intermediate_param.isDefined();
+        options.force_rewrite = force_rewtire_param.isDefined ();
+
+        if ( trace_param.isDefined () )
+            threading::tracer::instance ().enable ( true );
+
+        if ( profile_param.isDefined () && !rsai::feature_profiles ().open ( profile_param.value() ) )
+            return 1;
+
+        if ( capture_param.isDefined () && !rsai::building_models::estimator_captures ().open ( capture_param.value() ) )
+            return 1;
+
+        rsai::building_pipeline pipeline (
+                                            ds_vector
+                                          , ds_raster
+                                          , ds_roi
+                                          , ds_meta
+                                          , ds_updating
+                                          , ds_out
+                                          , options
+                                          , rewrite_layer_promt_func
+                                          , console_progress_layers
+                                         );
+
+        if ( trace_param.isDefined () )
+            threading::tracer::instance ().write_chrome_trace ( trace_param.value() );
+
+        rsai::feature_profiles ().close ();
+        rsai::building_models::estimator_captures ().close ();
+
+        if ( !pipeline.succeeded () )
+            return 1;
+    }
+    catch( const Args::HelpHasBeenPrintedException & )
+    {
+    }
+    catch( const Args::BaseException & x )
+    {
+        Args::outStream() << x.desc() << SL( "\n" );
+    }
+
+
+    return 0;
+}
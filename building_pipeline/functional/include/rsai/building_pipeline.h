@@ -0,0 +1,101 @@
+#pragma once
+
+#include <string>
+
+#include "common/definitions.h"
+#include "common/promt_functions.hpp"
+#include "common/progress_functions.hpp"
+#include "rsai/sam_segmentor.h"
+
+namespace rsai
+{
+    enum class pipeline_locator
+    {
+        invalid,
+        roofs,
+        structures
+    };
+
+    pipeline_locator pipeline_locator_from_string ( const std::string &locator );
+
+    // Stages' parameters, see the stages' utilities for their meaning
+    struct pipeline_options
+    {
+        // raster_inliers_extractor
+        bool                crop_geometry           = false;
+        std::string         semantic_filter;
+        int                 min_raster_obj_size     = 0;
+
+        // objects_bounds_finder
+        int                 mask_size               = 0;
+        int                 max_projection_length   = 0;
+
+        // roof_locator or projection_and_shade_locator
+        pipeline_locator    locator                 = pipeline_locator::roofs;
+        double              segmentize_step         = 0.0;
+        int                 projection_step         = 0;
+        double              roof_position_walk      = 0.0;
+        int                 roof_variants           = 0;
+        int                 shade_variants          = 0;
+        double              min_first_pos_weight    = 0.0;
+        double              max_first_pos_deviation = 0.0;
+        bool                use_sam                 = false;
+        segmentation_service segmentation;
+
+        // map_updater
+        double              iou_match_thresh        = 0.0;
+        double              iou_min_thresh          = 0.0;
+        bool                save_difference         = false;
+        bool                save_updated            = false;
+
+        // Source features per chunk passing the stages
+        int                 chunk_size              = std::stoi ( DEFAULT_PIPELINE_CHUNK_SIZE );
+
+        // Saves inliers and bounds to the output as well
+        bool                save_intermediate       = false;
+        bool                force_rewrite           = false;
+    };
+
+    // Runs the inliers extraction, bounds finding, locating and map updating stages in a single process. Source features
+    // are cut into chunks of memory datasets passing the stages through bounded queues, so the stages work on
+    // successive chunks at once and only the located layers, the update results and, if asked, the intermediate layers
+    // are written to the output. Locating runs in automatic mode. Map updating needs all the located roofs, so it runs
+    // after the other stages and is skipped if no updating map is given.
+    class building_pipeline
+    {
+    public:
+        template < class PromtFunc, class ProgressFunc >
+        building_pipeline (
+                            gdal::shared_dataset &ds_vector
+                            , gdal::shared_dataset &ds_raster
+                            , gdal::shared_dataset &ds_roi
+                            , gdal::shared_dataset &ds_meta
+                            , gdal::shared_dataset &ds_updating
+                            , gdal::shared_dataset &ds_out
+                            , const pipeline_options &options
+                            , const PromtFunc &promt_func = rewrite_layer_promt_dummy
+                            , const ProgressFunc &progress_func = progress_dummy
+                          );
+
+        bool succeeded () const;
+
+    private:
+        bool m_succeeded = false;
+
+        // Stage's memory dataset named after the output, so the stages' side files still go to the output directory
+        gdal::shared_dataset __stage_dataset ( gdal::shared_dataset &ds_out, const std::string &stage_name );
+        // Stage's memory dataset of the layer's next features, up to the chunk size
+        gdal::shared_dataset __chunk ( gdal::shared_dataset &ds_out, OGRLayer * layer, const int chunk_size, size_t &features );
+        // Another read-only handle of the raster
+        gdal::shared_dataset __raster_handle ( gdal::shared_dataset &ds_raster );
+        // Appends the layers' features, missing layers are created
+        bool __append ( gdal::shared_dataset &ds_from, gdal::shared_dataset &ds_to );
+        // Shifts the objects' ids
+        void __renumber ( gdal::shared_dataset &ds_objects, const int offset );
+
+        template < class PromtFunc >
+        bool __persist ( gdal::shared_dataset &ds_from, gdal::shared_dataset &ds_out, const bool force_rewrite, const PromtFunc &promt_func );
+    }; // class building_pipeline
+}; // namespace rsai
+
+#include "rsai/building_pipeline.hpp"
@@ -0,0 +1,325 @@
+#pragma once
+
+#include "rsai/building_pipeline.h"
+
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#include "common/definitions.h"
+#include "threading_utils/ordered_sink.h"
+#include "rsai/raster_inliers_extractor.h"
+#include "rsai/objects_bounds_finder.h"
+#include "rsai/roof_locator.h"
+#include "rsai/projection_and_shade_locator.h"
+#include "rsai/map_updater.h"
+
+template < class PromtFunc, class ProgressFunc >
+rsai::building_pipeline::building_pipeline (
+                                             gdal::shared_dataset &ds_vector
+                                             , gdal::shared_dataset &ds_raster
+                                             , gdal::shared_dataset &ds_roi
+                                             , gdal::shared_dataset &ds_meta
+                                             , gdal::shared_dataset &ds_updating
+                                             , gdal::shared_dataset &ds_out
+                                             , const pipeline_options &options
+                                             , const PromtFunc &promt_func
+                                             , const ProgressFunc &progress_func
+                                           )
+{
+    using clock = std::chrono::steady_clock;
+
+    auto stage_time = [] ( const clock::time_point &start )
+    {
+        return std::chrono::duration < double > ( clock::now () - start ).count ();
+    };
+
+    // Memory datasets are fresh, their layers are created without promting
+    auto ds_inliers = __stage_dataset ( ds_out, DEFAULT_INLIERS_LAYER_NAME );
+    auto ds_bounds = __stage_dataset ( ds_out, DEFAULT_BOUNDS_LAYER_NAME );
+    auto ds_located = __stage_dataset ( ds_out, DEFAULT_ROOF_LAYER_NAME );
+    if ( ds_inliers == nullptr || ds_bounds == nullptr || ds_located == nullptr )
+        return;
+
+    // Stages running at once read the raster through their own handles
+    auto ds_bounds_raster = __raster_handle ( ds_raster );
+    auto ds_locator_raster = __raster_handle ( ds_raster );
+    if ( ds_bounds_raster == nullptr || ds_locator_raster == nullptr )
+        return;
+
+    // A chunk of source features passes the stages in turn, every stage is a writer thread of a bounded
+    // ordered sink, so a stage works on a chunk while the previous one works on the next chunk
+    struct chunk
+    {
+        int                     layer = 0;
+        size_t                  features = 0;
+        gdal::shared_dataset    objects;
+        gdal::shared_dataset    inliers;
+        gdal::shared_dataset    bounds;
+        gdal::shared_dataset    located;
+    };
+
+    const size_t queue_size = DEFAULT_PIPELINE_QUEUE_CHUNKS;
+    std::atomic_bool failed ( false );
+    double inliers_time = 0.0, bounds_time = 0.0, locating_time = 0.0;
+
+    float features_count = 0;
+    for ( int i = 0; i < ds_vector->GetLayerCount (); ++i )
+        features_count += ds_vector->GetLayer ( i )->GetFeatureCount ();
+    features_count = std::max ( features_count, 1.0f );
+
+    size_t features_collected = 0;
+    threading::ordered_sink < chunk > collector ( [&] ( const int, chunk &a_chunk )
+    {
+        if ( failed )
+            return;
+
+        if ( !__append ( a_chunk.located, ds_located )
+             || ( options.save_intermediate && ( !__append ( a_chunk.inliers, ds_inliers ) || !__append ( a_chunk.bounds, ds_bounds ) ) ) )
+        {
+            failed = true;
+            return;
+        }
+
+        features_collected += a_chunk.features;
+        progress_func ( 1, 1, features_collected / features_count );
+    }, 0, queue_size );
+
+    threading::ordered_sink < chunk > locating ( [&] ( const int index, chunk &a_chunk )
+    {
+        a_chunk.located = __stage_dataset ( ds_out, DEFAULT_ROOF_LAYER_NAME );
+        if ( failed || a_chunk.located == nullptr )
+        {
+            failed = true;
+            collector.skip ( index );
+            return;
+        }
+
+        const auto start = clock::now ();
+        if ( options.locator == pipeline_locator::structures )
+        {
+            rsai::projection_and_shade_locator locator (
+                                                        a_chunk.bounds
+                                                      , ds_locator_raster
+                                                      , a_chunk.located
+                                                      , options.segmentize_step
+                                                      , options.projection_step
+                                                      , options.roof_position_walk
+                                                      , options.roof_variants
+                                                      , options.shade_variants
+                                                      , true
+                                                      , false
+                                                      , options.use_sam
+                                                      , options.segmentation
+                                                      , run_mode::automatic
+                                                      , interaction_mode::internal
+                                                      , rewrite_layer_promt_dummy
+                                                      , progress_layers_dummy
+                                                       );
+        }
+        else
+        {
+            rsai::roof_locator locator (
+                                        a_chunk.bounds
+                                      , ds_locator_raster
+                                      , a_chunk.located
+                                      , options.segmentize_step
+                                      , options.projection_step
+                                      , options.roof_position_walk
+                                      , options.roof_variants
+                                      , options.min_first_pos_weight
+                                      , options.max_first_pos_deviation
+                                      , true
+                                      , options.use_sam
+                                      , options.segmentation
+                                      , run_mode::automatic
+                                      , interaction_mode::internal
+                                      , rewrite_layer_promt_dummy
+                                      , progress_layers_dummy
+                                       );
+        }
+        locating_time += stage_time ( start );
+
+        collector.push ( index, std::move ( a_chunk ) );
+    }, 0, queue_size );
+
+    // Bounds finder numbers objects within its input, chunks continue the numbering of the previous ones
+    int bounds_layer = 0;
+    int bounds_offset = 0;
+    threading::ordered_sink < chunk > bounds ( [&] ( const int index, chunk &a_chunk )
+    {
+        a_chunk.bounds = __stage_dataset ( ds_out, DEFAULT_BOUNDS_LAYER_NAME );
+        if ( failed || a_chunk.bounds == nullptr )
+        {
+            failed = true;
+            locating.skip ( index );
+            return;
+        }
+
+        const auto start = clock::now ();
+        rsai::objects_bounds_finder bounds_finder (
+                                                    a_chunk.inliers
+                                                  , ds_bounds_raster
+                                                  , ds_meta
+                                                  , a_chunk.bounds
+                                                  , options.mask_size
+                                                  , options.max_projection_length
+                                                  , true
+                                                  , rewrite_layer_promt_dummy
+                                                  , progress_layers_dummy
+                                                  );
+        bounds_time += stage_time ( start );
+
+        if ( a_chunk.layer != bounds_layer )
+        {
+            bounds_layer = a_chunk.layer;
+            bounds_offset = 0;
+        }
+
+        __renumber ( a_chunk.bounds, bounds_offset );
+        for ( int i = 0; i < a_chunk.inliers->GetLayerCount (); ++i )
+            bounds_offset += a_chunk.inliers->GetLayer ( i )->GetFeatureCount ();
+
+        // Inliers are not needed anymore
+        if ( !options.save_intermediate )
+            a_chunk.inliers = gdal::shared_dataset ();
+
+        locating.push ( index, std::move ( a_chunk ) );
+    }, 0, queue_size );
+
+    threading::ordered_sink < chunk > inliers ( [&] ( const int index, chunk &a_chunk )
+    {
+        a_chunk.inliers = __stage_dataset ( ds_out, DEFAULT_INLIERS_LAYER_NAME );
+        if ( failed || a_chunk.inliers == nullptr )
+        {
+            failed = true;
+            bounds.skip ( index );
+            return;
+        }
+
+        const auto start = clock::now ();
+        rsai::raster_inliers_extractor extractor (
+                                                    a_chunk.objects
+                                                  , ds_raster
+                                                  , a_chunk.inliers
+                                                  , ds_roi
+                                                  , true
+                                                  , options.crop_geometry
+                                                  , options.semantic_filter
+                                                  , options.min_raster_obj_size
+                                                  , rewrite_layer_promt_dummy
+                                                  , progress_layers_dummy
+                                                 );
+        inliers_time += stage_time ( start );
+
+        a_chunk.objects = gdal::shared_dataset ();
+        bounds.push ( index, std::move ( a_chunk ) );
+    }, 0, queue_size );
+
+    auto start = clock::now ();
+
+    // Source features are cut into chunks in the source order, the bounded sinks hold the reading back
+    int chunks = 0;
+    for ( int i = 0; i < ds_vector->GetLayerCount () && !failed; ++i )
+    {
+        auto layer = ds_vector->GetLayer ( i );
+        layer->ResetReading ();
+
+        bool layer_read = false;
+        while ( !layer_read && !failed )
+        {
+            chunk a_chunk;
+            a_chunk.layer = i;
+            a_chunk.objects = __chunk ( ds_out, layer, options.chunk_size, a_chunk.features );
+            if ( a_chunk.objects == nullptr )
+            {
+                failed = true;
+                break;
+            }
+
+            layer_read = a_chunk.features < size_t ( options.chunk_size );
+            if ( a_chunk.features > 0 )
+                inliers.push ( chunks++, std::move ( a_chunk ) );
+        }
+    }
+
+    inliers.finish ();
+    bounds.finish ();
+    locating.finish ();
+    collector.finish ();
+
+    progress_func ( 1, 1, 1.0f, true );
+
+    std::cout << "Inliers extracted in " << inliers_time << " s, bounds found in " << bounds_time
+              << " s, objects located in " << locating_time << " s, " << chunks << " chunks overlapped in "
+              << stage_time ( start ) << " s\n";
+
+    if ( failed )
+    {
+        std::cerr << "Stop: Pipeline stages failed" << std::endl;
+        return;
+    }
+
+    if ( options.save_intermediate && ( !__persist ( ds_inliers, ds_out, options.force_rewrite, promt_func )
+                                        || !__persist ( ds_bounds, ds_out, options.force_rewrite, promt_func ) ) )
+        return;
+
+    ds_inliers = gdal::shared_dataset ();
+    ds_bounds = gdal::shared_dataset ();
+
+    if ( !__persist ( ds_located, ds_out, options.force_rewrite, promt_func ) )
+        return;
+
+    if ( ds_updating != nullptr )
+    {
+        // Only the roofs update the map
+        auto ds_detected = __stage_dataset ( ds_out, DEFAULT_UPDATED_LAYER_NAME );
+        auto roof_layer = ds_located->GetLayerByName ( DEFAULT_ROOF_LAYER_NAME );
+        if ( ds_detected == nullptr || roof_layer == nullptr || ds_detected->CopyLayer ( roof_layer, DEFAULT_ROOF_LAYER_NAME ) == nullptr )
+        {
+            std::cerr << "Stop: Failed to pass located roofs to map updating" << std::endl;
+            return;
+        }
+
+        ds_located = gdal::shared_dataset ();
+
+        start = clock::now ();
+        rsai::map_updater updater (
+                                     ds_detected
+                                   , ds_updating
+                                   , ds_roi
+                                   , ds_out
+                                   , options.iou_match_thresh
+                                   , options.iou_min_thresh
+                                   , options.save_difference
+                                   , options.save_updated
+                                   , promt_func
+                                   , progress_func
+                                  );
+        std::cout << "Map updated in " << stage_time ( start ) << " s\n";
+    }
+
+    m_succeeded = true;
+}
+
+template < class PromtFunc >
+bool rsai::building_pipeline::__persist ( gdal::shared_dataset &ds_from, gdal::shared_dataset &ds_out, const bool force_rewrite, const PromtFunc &promt_func )
+{
+    for ( int i = 0; i < ds_from->GetLayerCount (); ++i )
+    {
+        auto layer = ds_from->GetLayer ( i );
+        const std::string layer_name = layer->GetName ();
+
+        if ( !promt_func ( ds_out, layer_name, force_rewrite ) )
+            continue;
+
+        if ( ds_out->CopyLayer ( layer, layer_name.c_str () ) == nullptr )
+        {
+            std::cerr << "Stop: Failed to save layer " << layer_name << " to " << ds_out->GetDescription () << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,132 @@
+#include "rsai/building_pipeline.h"
+
+#include <map>
+#include <iostream>
+
+#include "common/definitions.h"
+#include "gdal_utils/all_helpers.h"
+
+using namespace rsai;
+
+pipeline_locator rsai::pipeline_locator_from_string ( const std::string &locator )
+{
+    static std::map < std::string, pipeline_locator > locator_mapping = { { "roofs", pipeline_locator::roofs }, { "structures", pipeline_locator::structures } };
+    return locator_mapping [locator];
+}
+
+bool building_pipeline::succeeded () const
+{
+    return m_succeeded;
+}
+
+gdal::shared_dataset building_pipeline::__stage_dataset ( gdal::shared_dataset &ds_out, const std::string &stage_name )
+{
+    auto ds_stage = gdal::create_dataset ( "Memory", ds_out->GetDescription () );
+    if ( ds_stage == nullptr )
+        std::cerr << "Stop: Failed to create memory dataset for " << stage_name << std::endl;
+
+    return ds_stage;
+}
+
+gdal::shared_dataset building_pipeline::__chunk ( gdal::shared_dataset &ds_out, OGRLayer * layer, const int chunk_size, size_t &features )
+{
+    features = 0;
+
+    auto ds_chunk = __stage_dataset ( ds_out, layer->GetName () );
+    if ( ds_chunk == nullptr )
+        return ds_chunk;
+
+    auto defn = layer->GetLayerDefn ();
+    auto chunk_layer = ds_chunk->CreateLayer ( layer->GetName (), layer->GetSpatialRef (), defn->GetGeomType () );
+    if ( chunk_layer == nullptr )
+    {
+        std::cerr << "Stop: Failed to create chunk layer " << layer->GetName () << std::endl;
+        return {};
+    }
+
+    for ( int i = 0; i < defn->GetFieldCount (); ++i )
+        chunk_layer->CreateField ( defn->GetFieldDefn ( i ) );
+
+    while ( features < size_t ( chunk_size ) )
+    {
+        gdal::shared_feature feature = layer->GetNextFeature ();
+        if ( !feature )
+            break;
+
+        gdal::shared_feature chunk_feature ( chunk_layer->GetLayerDefn () );
+        chunk_feature->SetFrom ( feature.get (), TRUE );
+        if ( chunk_layer->CreateFeature ( chunk_feature.get () ) != OGRERR_NONE )
+        {
+            std::cerr << "Stop: Failed to create feature in chunk layer " << layer->GetName () << std::endl;
+            return {};
+        }
+
+        ++features;
+    }
+
+    return ds_chunk;
+}
+
+gdal::shared_dataset building_pipeline::__raster_handle ( gdal::shared_dataset &ds_raster )
+{
+    gdal::open_raster_ro_helper raster_helper ( ds_raster->GetDescription (), std::cerr );
+    return raster_helper.validate ( true );
+}
+
+bool building_pipeline::__append ( gdal::shared_dataset &ds_from, gdal::shared_dataset &ds_to )
+{
+    for ( int i = 0; i < ds_from->GetLayerCount (); ++i )
+    {
+        auto layer = ds_from->GetLayer ( i );
+        auto defn = layer->GetLayerDefn ();
+
+        auto to_layer = ds_to->GetLayerByName ( layer->GetName () );
+        if ( to_layer == nullptr )
+        {
+            to_layer = ds_to->CreateLayer ( layer->GetName (), layer->GetSpatialRef (), defn->GetGeomType () );
+            if ( to_layer == nullptr )
+            {
+                std::cerr << "Stop: Failed to create layer " << layer->GetName () << std::endl;
+                return false;
+            }
+
+            for ( int j = 0; j < defn->GetFieldCount (); ++j )
+                to_layer->CreateField ( defn->GetFieldDefn ( j ) );
+        }
+
+        layer->ResetReading ();
+        while ( gdal::shared_feature feature = layer->GetNextFeature () )
+        {
+            gdal::shared_feature to_feature ( to_layer->GetLayerDefn () );
+            to_feature->SetFrom ( feature.get (), TRUE );
+            if ( to_layer->CreateFeature ( to_feature.get () ) != OGRERR_NONE )
+            {
+                std::cerr << "Stop: Failed to create feature in layer " << to_layer->GetName () << std::endl;
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+void building_pipeline::__renumber ( gdal::shared_dataset &ds_objects, const int offset )
+{
+    if ( offset == 0 )
+        return;
+
+    for ( int i = 0; i < ds_objects->GetLayerCount (); ++i )
+    {
+        auto layer = ds_objects->GetLayer ( i );
+        const int id_index = layer->GetLayerDefn ()->GetFieldIndex ( DEFAULT_OBJECT_ID_FIELD_NAME );
+        if ( id_index < 0 )
+            continue;
+
+        layer->ResetReading ();
+        while ( gdal::shared_feature feature = layer->GetNextFeature () )
+        {
+            feature->SetField ( id_index, feature->GetFieldAsInteger ( id_index ) + offset );
+            layer->SetFeature ( feature.get () );
+        }
+    }
+}
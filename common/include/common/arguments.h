@@ -19,6 +19,7 @@ public:
     static Args::Arg & get_driver ();
 
     static Args::Arg & get_force_rewtire ();
+    static Args::Arg & get_resume ();
 
     static Args::Arg & get_region_of_interest ();
     static Args::Arg & get_crop_by_raster ();
@@ -37,6 +38,36 @@ public:
     static Args::Arg & get_roof_varians ();
     static Args::Arg & get_shade_varians ();
     static Args::Arg & get_use_sam ();
+    static Args::Arg & get_artifacts ();
+    static Args::Arg & get_artifacts_archive ();
+    static Args::Arg & get_trace ();
+    static Args::Arg & get_profile ();
+    static Args::Arg & get_profile_top ();
+    static Args::Arg & get_capture ();
+    static Args::Arg & get_replay_repeat ();
+    static Args::Arg & get_replay_checksums ();
+    static Args::Arg & get_replay_reference ();
+
+    static Args::Arg & get_segmentation_socket ();
+    static Args::Arg & get_segmentation_batch ();
+    static Args::Arg & get_segments_directory ();
+
+    static Args::Arg & get_shards_count ();
+    static Args::Arg & get_shard_processes ();
+    static Args::Arg & get_shard_halo ();
+    static Args::Arg & get_shard_command ();
+    static Args::Arg & get_shard_updating ();
+
+    static Args::Arg & get_pipeline_locator ();
+    static Args::Arg & get_pipeline_chunk_size ();
+    static Args::Arg & get_save_intermediate ();
+
+    static Args::Arg & get_second_raster ();
+    static Args::Arg & get_background_raster ();
+    static Args::Arg & get_projection_window ();
+    static Args::Arg & get_source_band ();
+    static Args::Arg & get_composite_color ();
+    static Args::Arg & get_pixel_size ();
 
     static Args::Arg & get_tile_buffer_size ();
     static Args::Arg & get_min_first_pos_weight ();
@@ -48,9 +79,14 @@ public:
     static Args::Arg & get_markup_validation ();
     static Args::Arg & get_markup_overlap ();
     static Args::Arg & get_markup_format ();
+    static Args::Arg & get_markup_mode ();
+    static Args::Arg & get_markup_image_format ();
+    static Args::Arg & get_markup_image_quality ();
+    static Args::Arg & get_shard_size ();
 
     static Args::Arg & get_iou_match_thresh ();
     static Args::Arg & get_iou_min_thresh ();
+    static Args::Arg & get_iou_thresholds ();
     static Args::Arg & get_save_update_diff ();
     static Args::Arg & get_save_updated_map ();
 };
@@ -114,6 +114,16 @@ Args::Arg & arguments_t < Dummy >::get_force_rewtire ()
     return force_rewtire_param;
 }
 
+template < class Dummy >
+Args::Arg & arguments_t < Dummy >::get_resume ()
+{
+    static Args::Arg resume_param( SL( "resume" ), false, false );
+    resume_param.setDescription( std::string( "Continues an interrupted run. Features completed in the output '" ) + DEFAULT_JOURNAL_FILE_EXT
+                                 + "' journals are skipped and output layers are rebuilt from the journals. " );
+
+    return resume_param;
+}
+
 template < class Dummy >
 Args::Arg & arguments_t < Dummy >::get_region_of_interest ()
 {
@@ -283,6 +293,251 @@ Args::Arg & arguments_t < Dummy >::get_use_sam ()
     return use_sam_param;
 }
 
+template < class Dummy >
+Args::Arg & arguments_t < Dummy >::get_artifacts ()
+{
+    static Args::Arg artifacts_param( SL( "artifacts" ), true, false );
+    artifacts_param.setDescription( std::string( "Debug images level: 'off' - no debug images, 'summary' - objects' tiles and heat maps, "
+                                                 "'full' - estimators' intermediate images as well. Images are encoded and written in background. "
+                                                 "The default is '" ) + DEFAULT_ARTIFACTS_LEVEL + "'. " );
+    artifacts_param.setDefaultValue ( DEFAULT_ARTIFACTS_LEVEL );
+    return artifacts_param;
+}
+
+template < class Dummy >
+Args::Arg & arguments_t < Dummy >::get_artifacts_archive ()
+{
+    static Args::Arg artifacts_archive_param( SL( "artifacts_archive" ), false, false );
+    artifacts_archive_param.setDescription( std::string( "If defined debug images are packed into a single '" ) + DEFAULT_ARTIFACTS_ARCHIVE_PREFIX
+                                            + "' tar archive with an index in the output directory instead of separate files. " );
+    return artifacts_archive_param;
+}
+
+template < class Dummy >
+Args::Arg & arguments_t < Dummy >::get_trace ()
+{
+    static Args::Arg trace_param( SL( "trace" ), true, false );
+    trace_param.setDescription( SL( "Chrome trace file (JSON) to save the hot path spans of the run to, it is opened by chrome://tracing or Perfetto. "
+                                    "Requires the utilities configured with -DRSAI_TRACING=ON. " ) );
+    return trace_param;
+}
+
+template < class Dummy >
+Args::Arg & arguments_t < Dummy >::get_profile ()
+{
+    static Args::Arg profile_param( SL( "profile" ), true, false );
+    profile_param.setDescription( SL( "JSONL file of the per-feature performance records: object id, tile size, contour length, search region area, "
+                                      "segments, candidates evaluated, stages' durations and peak scratch memory. " ) );
+    return profile_param;
+}
+
+template < class Dummy >
+Args::Arg & arguments_t < Dummy >::get_profile_top ()
+{
+    static Args::Arg profile_top_param( SL( "top" ), true, false );
+    profile_top_param.setDescription( std::string( "Quantity of the slowest objects to list. "
+                                                   "The default is " ) + DEFAULT_PROFILE_TOP_VALUE + ". " );
+    profile_top_param.setDefaultValue ( DEFAULT_PROFILE_TOP_VALUE );
+    return profile_top_param;
+}
+
+template < class Dummy >
+Args::Arg & arguments_t < Dummy >::get_capture ()
+{
+    static Args::Arg capture_param( SL( "capture" ), true, false );
+    capture_param.setDescription( SL( "Directory to capture the estimators' inputs of every feature to, a self-contained file per feature. "
+                                      "Captures are replayed by estimator_replay. " ) );
+    return capture_param;
+}
+
+template < class Dummy >
+Args::Arg & arguments_t < Dummy >::get_replay_repeat ()
+{
+    static Args::Arg replay_repeat_param( SL( "repeat" ), true, false );
+    replay_repeat_param.setDescription( std::string( "Quantity of runs of the estimators per capture, the fastest run is reported. "
+                                                     "The default is " ) + DEFAULT_REPLAY_REPEAT_VALUE + ". " );
+    replay_repeat_param.setDefaultValue ( DEFAULT_REPLAY_REPEAT_VALUE );
+    return replay_repeat_param;
+}
+
+template < class Dummy >
+Args::Arg & arguments_t < Dummy >::get_replay_checksums ()
+{
+    static Args::Arg replay_checksums_param( SL( "checksums" ), true, false );
+    replay_checksums_param.setDescription( SL( "File to save the estimators' outputs checksums to, to be used as a reference later. " ) );
+    return replay_checksums_param;
+}
+
+template < class Dummy >
+Args::Arg & arguments_t < Dummy >::get_replay_reference ()
+{
+    static Args::Arg replay_reference_param( SL( "reference" ), true, false );
+    replay_reference_param.setDescription( SL( "Reference checksums file to compare the estimators' outputs with. " ) );
+    return replay_reference_param;
+}
+
+template < class Dummy >
+Args::Arg & arguments_t < Dummy >::get_segmentation_socket ()
+{
+    static Args::Arg segmentation_socket_param( SL( "socket" ), true, false );
+    segmentation_socket_param.setDescription( std::string( "Unix socket path of the persistent segmentation worker. "
+                                                        "The default is " ) + DEFAULT_SEGMENTATION_SOCKET + ". " );
+    segmentation_socket_param.setDefaultValue ( DEFAULT_SEGMENTATION_SOCKET );
+    return segmentation_socket_param;
+}
+
+template < class Dummy >
+Args::Arg & arguments_t < Dummy >::get_segmentation_batch ()
+{
+    static Args::Arg segmentation_batch_param( SL( "batch" ), true, false );
+    segmentation_batch_param.setDescription( std::string( "Maximum number of pipelined tiles segmented together. "
+                                                        "The default is " ) + DEFAULT_SEGMENTATION_BATCH_VALUE + ". " );
+    segmentation_batch_param.setDefaultValue ( DEFAULT_SEGMENTATION_BATCH_VALUE );
+    return segmentation_batch_param;
+}
+
+template < class Dummy >
+Args::Arg & arguments_t < Dummy >::get_segments_directory ()
+{
+    static Args::Arg segments_directory_param( SL( "segments_dir" ), true, true );
+    segments_directory_param.setDescription( std::string( "Directory of segments files, e.g. output/" ) + DEFAULT_SEGMENTS_DIRECTORY + ". " );
+    return segments_directory_param;
+}
+
+template < class Dummy >
+Args::Arg & arguments_t < Dummy >::get_shards_count ()
+{
+    static Args::Arg shards_count_param( SL( "shards" ), true, false );
+    shards_count_param.setDescription( std::string( "Number of spatial shards the input vector map is split into. "
+                                                    "The default is " ) + DEFAULT_SHARDS_COUNT_VALUE + ". " );
+    shards_count_param.setDefaultValue ( DEFAULT_SHARDS_COUNT_VALUE );
+    return shards_count_param;
+}
+
+template < class Dummy >
+Args::Arg & arguments_t < Dummy >::get_shard_processes ()
+{
+    static Args::Arg shard_processes_param( SL( "processes" ), true, false );
+    shard_processes_param.setDescription( std::string( "Maximum number of shard processes run at once. "
+                                                       "The default is " ) + DEFAULT_SHARD_PROCESSES_VALUE + ". " );
+    shard_processes_param.setDefaultValue ( DEFAULT_SHARD_PROCESSES_VALUE );
+    return shard_processes_param;
+}
+
+template < class Dummy >
+Args::Arg & arguments_t < Dummy >::get_shard_halo ()
+{
+    static Args::Arg shard_halo_param( SL( "halo" ), true, false );
+    shard_halo_param.setDescription( std::string( "Margin around a shard in the input map's units, features within it are processed by "
+                                                  "both neighbouring shards. The default is " ) + DEFAULT_SHARD_HALO_VALUE + ". " );
+    shard_halo_param.setDefaultValue ( DEFAULT_SHARD_HALO_VALUE );
+    return shard_halo_param;
+}
+
+template < class Dummy >
+Args::Arg & arguments_t < Dummy >::get_shard_command ()
+{
+    static Args::Arg shard_command_param( SL( "command" ), true, true );
+    shard_command_param.setDescription( std::string( "Utility command line run for every shard, {input}, {updating}, {output} and {shard} are "
+                                                     "replaced by the shard's input and updating vector maps, output directory and index, e.g. "
+                                                     "\"projection_and_shade_locator -r raster.tif -v {input} -o {output} -f\" or "
+                                                     "\"map_updater -v {input} -u {updating} -i roi.shp -o {output} --save_updated -f\". "
+                                                     "Other maps of the command are passed whole. " ) );
+    return shard_command_param;
+}
+
+template < class Dummy >
+Args::Arg & arguments_t < Dummy >::get_shard_updating ()
+{
+    static Args::Arg shard_updating_param( SL( 'u' ), SL( "input_updating" ), true, false );
+    shard_updating_param.setDescription( SL( "Vector map to be updated, it is clipped by the same shards as the input one and passed "
+                                             "to the command as {updating}, e.g. for map_updater. " ) );
+    return shard_updating_param;
+}
+
+template < class Dummy >
+Args::Arg & arguments_t < Dummy >::get_pipeline_locator ()
+{
+    static Args::Arg pipeline_locator_param( SL( "locator" ), true, false );
+    pipeline_locator_param.setDescription( std::string( "Pipeline's locating stage: 'roofs' - roof positions only, 'structures' - roofs, projections and shades. "
+                                                        "The default is '" ) + DEFAULT_PIPELINE_LOCATOR + "'. " );
+    pipeline_locator_param.setDefaultValue ( DEFAULT_PIPELINE_LOCATOR );
+    return pipeline_locator_param;
+}
+
+template < class Dummy >
+Args::Arg & arguments_t < Dummy >::get_pipeline_chunk_size ()
+{
+    static Args::Arg pipeline_chunk_size_param( SL( "chunk_size" ), true, false );
+    pipeline_chunk_size_param.setDescription( std::string( "Source objects per chunk passing the pipeline's stages, the stages work on successive chunks at once. "
+                                                            "The default is " ) + DEFAULT_PIPELINE_CHUNK_SIZE + ". " );
+    pipeline_chunk_size_param.setDefaultValue ( DEFAULT_PIPELINE_CHUNK_SIZE );
+    return pipeline_chunk_size_param;
+}
+
+template < class Dummy >
+Args::Arg & arguments_t < Dummy >::get_save_intermediate ()
+{
+    static Args::Arg save_intermediate_param( SL( "save_intermediate" ), false, false );
+    save_intermediate_param.setDescription( std::string( "If defined the pipeline's intermediate '" ) + DEFAULT_INLIERS_LAYER_NAME + "' and '"
+                                            + DEFAULT_BOUNDS_LAYER_NAME + "' maps are saved to the output as well. " );
+    return save_intermediate_param;
+}
+
+template < class Dummy >
+Args::Arg & arguments_t < Dummy >::get_second_raster ()
+{
+    static Args::Arg second_raster_param( SL( "second_raster" ), true, true );
+    second_raster_param.setDescription( SL( "Second input raster in GDAL-supported format. " ) );
+    return second_raster_param;
+}
+
+template < class Dummy >
+Args::Arg & arguments_t < Dummy >::get_background_raster ()
+{
+    static Args::Arg background_raster_param( SL( "background" ), true, false );
+    background_raster_param.setDescription( SL( "Background raster in GDAL-supported format. " ) );
+    return background_raster_param;
+}
+
+template < class Dummy >
+Args::Arg & arguments_t < Dummy >::get_projection_window ()
+{
+    static Args::Arg projection_window_param( SL( "projwin" ), true, true );
+    projection_window_param.setDescription( SL( "Region in world coordinates in format 'ulx,uly,lrx,lry'. " ) );
+    return projection_window_param;
+}
+
+template < class Dummy >
+Args::Arg & arguments_t < Dummy >::get_source_band ()
+{
+    static Args::Arg source_band_param( SL( "band" ), true, false );
+    source_band_param.setDescription( std::string( "Source rasters' band to compose. "
+                                                "The default is " ) + DEFAULT_COMPOSER_SOURCE_BAND + ". " );
+    source_band_param.setDefaultValue ( DEFAULT_COMPOSER_SOURCE_BAND );
+    return source_band_param;
+}
+
+template < class Dummy >
+Args::Arg & arguments_t < Dummy >::get_composite_color ()
+{
+    static Args::Arg composite_color_param( SL( "color" ), true, false );
+    composite_color_param.setDescription( std::string( "Output color channel of the first raster: blue, green or red. "
+                                                    "The default is " ) + DEFAULT_COMPOSER_COLOR + ". " );
+    composite_color_param.setDefaultValue ( DEFAULT_COMPOSER_COLOR );
+    return composite_color_param;
+}
+
+template < class Dummy >
+Args::Arg & arguments_t < Dummy >::get_pixel_size ()
+{
+    static Args::Arg pixel_size_param( SL( "pixel_size" ), true, false );
+    pixel_size_param.setDescription( std::string( "Output pixel size in world units. "
+                                               "The default is " ) + DEFAULT_COMPOSER_PIXEL_SIZE + ". " );
+    pixel_size_param.setDefaultValue ( DEFAULT_COMPOSER_PIXEL_SIZE );
+    return pixel_size_param;
+}
+
 template < class Dummy >
 Args::Arg & arguments_t < Dummy >::get_min_first_pos_weight ()
 {
@@ -364,13 +619,58 @@ template < class Dummy >
 Args::Arg & arguments_t < Dummy >::get_markup_format ()
 {
     static Args::Arg markup_format_param( SL( "format" ), true, false );
-    markup_format_param.setDescription( std::string( "A target format to save markup. "
+    markup_format_param.setDescription( std::string( "A target format to save markup: yolo (an image and a labels file per tile) "
+                                                        "or yolo_shards (tar shards with per-shard indices). "
                                                         "The default value is " ) + DEFAULT_MARKUP_FORMAT + ". " );
     markup_format_param.setDefaultValue ( DEFAULT_MARKUP_FORMAT );
 
     return markup_format_param;
 }
 
+template < class Dummy >
+Args::Arg & arguments_t < Dummy >::get_markup_mode ()
+{
+    static Args::Arg markup_mode_param( SL ( 'm' ), SL( "mode" ), true, false );
+    markup_mode_param.setDescription( std::string( "Markup writing mode: " ) + DEFAULT_MARKUP_REPLACE_MODE + " (the output is cleared), "
+                                                    + DEFAULT_MARKUP_APPEND_MODE + " or " + DEFAULT_MARKUP_UPDATE_MODE + " (tiles already written are skipped, "
+                                                    "so an interrupted markup is completed). The default value is " + DEFAULT_MARKUP_APPEND_MODE + ". " );
+    markup_mode_param.setDefaultValue ( DEFAULT_MARKUP_APPEND_MODE );
+
+    return markup_mode_param;
+}
+
+template < class Dummy >
+Args::Arg & arguments_t < Dummy >::get_markup_image_format ()
+{
+    static Args::Arg markup_image_format_param( SL( "image_format" ), true, false );
+    markup_image_format_param.setDescription( std::string( "Markup tiles' image format: .jpg, .png or .webp. "
+                                                           "The default value is " ) + DEFAULT_MARKUP_IMAGE_FORMAT + ". " );
+    markup_image_format_param.setDefaultValue ( DEFAULT_MARKUP_IMAGE_FORMAT );
+
+    return markup_image_format_param;
+}
+
+template < class Dummy >
+Args::Arg & arguments_t < Dummy >::get_markup_image_quality ()
+{
+    static Args::Arg markup_image_quality_param( SL( "image_quality" ), true, false );
+    markup_image_quality_param.setDescription( std::string( "Markup tiles' image quality [0..100], png maps it to the compression level. "
+                                                            "The default value is " ) + std::to_string ( DEFAULT_MARKUP_IMAGE_QUALITY ) + ". " );
+    markup_image_quality_param.setDefaultValue ( std::to_string ( DEFAULT_MARKUP_IMAGE_QUALITY ) );
+
+    return markup_image_quality_param;
+}
+
+template < class Dummy >
+Args::Arg & arguments_t < Dummy >::get_shard_size ()
+{
+    static Args::Arg shard_size_param( SL( "shard_size" ), true, false );
+    shard_size_param.setDescription( std::string( "Packs markup samples into tar shards of the given size (MB) with per-shard indices "
+                                                  "instead of separate files, e.g. " ) + DEFAULT_MARKUP_SHARD_SIZE_MB + ". " );
+
+    return shard_size_param;
+}
+
 template < class Dummy >
 Args::Arg & arguments_t < Dummy >::get_iou_match_thresh ()
 {
@@ -393,6 +693,17 @@ Args::Arg & arguments_t < Dummy >::get_iou_min_thresh ()
     return iou_min_thresh_param;
 }
 
+template < class Dummy >
+Args::Arg & arguments_t < Dummy >::get_iou_thresholds ()
+{
+    static Args::Arg iou_thresholds_param( SL( "iou_thresholds" ), true, false );
+    iou_thresholds_param.setDescription( std::string ( "A comma-separated list of IoU thresholds to estimate precision, recall and F1 "
+                                                        "with one-to-one objects assignment. The default is " ) + DEFAULT_IOU_THRESHOLDS_VALUE + ". " );
+    iou_thresholds_param.setDefaultValue ( DEFAULT_IOU_THRESHOLDS_VALUE );
+
+    return iou_thresholds_param;
+}
+
 template < class Dummy >
 Args::Arg & arguments_t < Dummy >::get_save_update_diff ()
 {
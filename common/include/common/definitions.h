@@ -23,7 +23,13 @@
 #define DEFAULT_STRUCTURE_SUBDIRECTORY      "structures"
 #define DEFAULT_SEGMENT_FILE_EXT            ".jpg"
 #define DEFAULT_SEGMENT_WKT_FILE_EXT        ".wkt"
+#define DEFAULT_SEGMENT_STORE_FILE_EXT      ".segs"
 #define DEFAULT_OBJECT_WKT_FILE_PREFIX      "obj_"
+#define DEFAULT_REVIEW_STORE_FILE_EXT       ".review"
+#define DEFAULT_JOURNAL_FILE_EXT            ".journal"
+#define DEFAULT_CAPTURE_FILE_EXT            ".capture"
+#define DEFAULT_SHARDS_DIRECTORY            "shards"
+#define DEFAULT_SHARD_DIRECTORY_PREFIX      "shard_"
 
 /// Default output features names and values
 #define DEFAULT_PROJ_STEP_X_FIELD_NAME      "proj_x"
@@ -44,8 +50,24 @@
 #define DEFAULT_SHADE_VARIANTS_VALUE        "5"
 #define DEFAULT_RECONSTRUCTION_MODE         "auto"
 #define DEFAULT_INTERACTION_MODE            "internal"
+#define DEFAULT_PIPELINE_LOCATOR            "roofs"
+#define DEFAULT_PIPELINE_CHUNK_SIZE         "1000"
+#define DEFAULT_PIPELINE_QUEUE_CHUNKS       2
 #define DEFAULT_SEG_ANY_TILE_BUFFER_VALUE   "200"
 #define DEFAULT_SEG_ANY_EDGES_WIDTH_VALUE   "5"
+#define DEFAULT_SEGMENTATION_SOCKET         "/tmp/open_rsai_segmentation.sock"
+#define DEFAULT_SEGMENTATION_BATCH_VALUE    "8"
+#define DEFAULT_SEGMENTATION_IN_FLIGHT      32
+#define DEFAULT_SEGMENTATION_TILE_SIZE      512
+#define DEFAULT_SEGMENTATION_TILE_MARGIN    100
+#define DEFAULT_SHARDS_COUNT_VALUE          "4"
+#define DEFAULT_SHARD_PROCESSES_VALUE       "4"
+#define DEFAULT_SHARD_HALO_VALUE            "50.0"
+#define DEFAULT_PROFILE_TOP_VALUE           "20"
+#define DEFAULT_REPLAY_REPEAT_VALUE         "3"
+#define DEFAULT_COMPOSER_SOURCE_BAND        "2"
+#define DEFAULT_COMPOSER_COLOR              "blue"
+#define DEFAULT_COMPOSER_PIXEL_SIZE         "0.4"
 #define DEFAULT_MIN_FIRST_POS_WEIGHT        "150"
 #define DEFAULT_MAX_FIRST_POS_DEVIATION     "1.5"
 #define DEFAULT_MARKUP_BALANCE              "0.5"
@@ -56,6 +78,21 @@
 #define DEFAULT_MARKUP_FORMAT               "yolo"
 #define DEFAULT_MARKUP_APPEND_MODE          "append"
 #define DEFAULT_MARKUP_REPLACE_MODE         "replace"
+#define DEFAULT_MARKUP_UPDATE_MODE          "update"
+#define DEFAULT_MARKUP_IMAGE_FORMAT         ".jpg"
+#define DEFAULT_MARKUP_IMAGE_QUALITY        95
+#define DEFAULT_MARKUP_SHARD_SIZE           ( size_t ( 256 ) << 20 )
+#define DEFAULT_MARKUP_SHARD_SIZE_MB        "256"
+#define DEFAULT_REVIEW_WINDOW               16
+#define DEFAULT_FRAME_CACHE_SIZE            16
+#define DEFAULT_FRAME_CACHE_THREADS         2
+#define DEFAULT_ARTIFACTS_LEVEL             "full"
+#define DEFAULT_ARTIFACTS_ARCHIVE_PREFIX    "artifacts"
+#define DEFAULT_ARTIFACTS_THREADS           2
+#define DEFAULT_ARTIFACTS_PENDING           64
+#define DEFAULT_JOURNAL_SYNC_RECORDS        64
+#define DEFAULT_JOURNAL_SYNC_INTERVAL       2000
+#define DEFAULT_TRACE_BUFFER_EVENTS         65536
 
 #define DEFAULT_OBJECT_ID_FIELD_NAME        "FID"
 #define DEFAULT_OBJECT_HEIGHT_FIELD_NAME    "height"
@@ -68,6 +105,7 @@
 #define MAXIMUM_MARKUP_VALIDATION           0.5
 #define DEFAULT_IOU_MATCH_THRESH_VALUE      "0.9"
 #define DEFAULT_IOU_MIN_THRESH_VALUE        "0.02"
+#define DEFAULT_IOU_THRESHOLDS_VALUE        "0.5,0.75"
 #define DEFAULT_OUTDATED_LAYER_NAME         "outdated"
 #define DEFAULT_UPCOMMING_LAYER_NAME        "upcomming"
 #define DEFAULT_UPDATED_LAYER_NAME          "updated"
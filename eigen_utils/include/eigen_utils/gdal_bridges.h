@@ -30,6 +30,9 @@ namespace eigen
         void    __set_geo_bounds ();
     };
 
+    // Curve points as contiguous 2xN coordinates matrix
+    Eigen::Matrix2Xd to_matrix ( const OGRSimpleCurve * curve );
+
     template < class Type >
     Eigen::Vector2 < Type > cast ( const gdal::point & pt )
     {
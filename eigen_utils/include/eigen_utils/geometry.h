@@ -87,6 +87,17 @@ namespace gdal
     polygon      bbox_and_projections_2_polygon ( const OGRPolygon *polygon, const std::list < Eigen::Vector2d > &shifts, const Eigen::Vector2d &raster_sizes
                                                    , const Eigen::Matrix3d &raster_2_world, const double buffer_size, const bool save_projections = false );
 
+    // Vectorized bounds of contiguous 2xN coordinates
+    bbox         points_bbox ( const Eigen::Matrix2Xd &points );
+
+    // Buffered raster bbox covering the ring shifted by each of the shifts ( columns )
+    bbox         shifted_raster_bbox ( const Eigen::Matrix2Xd &ring, const Eigen::Matrix2Xd &shifts
+                                       , const Eigen::Matrix3d &world_2_raster, const double buffer_size );
+
+    polygon      bbox_and_projections_2_polygon ( const Eigen::Matrix2Xd &ring, const Eigen::Matrix2Xd &shifts, const Eigen::Vector2d &raster_sizes
+                                                   , const Eigen::Matrix3d &raster_2_world, const Eigen::Matrix3d &world_2_raster
+                                                   , const double buffer_size );
+
 }; // namespace gdal
 
 template < class Out >
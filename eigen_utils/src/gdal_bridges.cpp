@@ -80,3 +80,15 @@ void eigen::gdal_dataset_bridge::__set_geo_bounds ()
                      , geo_br [0], geo_br [1];
     }
 }
+
+Eigen::Matrix2Xd eigen::to_matrix ( const OGRSimpleCurve * curve )
+{
+    if ( curve == nullptr )
+        return {};
+
+    Eigen::Matrix2Xd result ( 2, curve->getNumPoints () );
+    if ( result.cols () > 0 )
+        curve->getPoints ( result.data (), sizeof ( double ) * 2, result.data () + 1, sizeof ( double ) * 2 );
+
+    return result;
+}
@@ -520,3 +520,58 @@ polygon gdal::bbox_and_projections_2_polygon ( const OGRPolygon *polygon, const
 
     return result;
 }
+
+bbox gdal::points_bbox ( const Eigen::Matrix2Xd &points )
+{
+    if ( points.cols () == 0 )
+        return {};
+
+    return bbox ( points.rowwise ().minCoeff (), points.rowwise ().maxCoeff () );
+}
+
+bbox gdal::shifted_raster_bbox ( const Eigen::Matrix2Xd &ring, const Eigen::Matrix2Xd &shifts
+                                 , const Eigen::Matrix3d &world_2_raster, const double buffer_size )
+{
+    // Union of the shifted rings' bboxes is the ring's bbox extended by the shifts' bbox
+    const auto ring_bbox = points_bbox ( ring );
+    const auto shifts_bbox = points_bbox ( shifts );
+
+    const Eigen::Vector2d tl = ring_bbox.top_left () + shifts_bbox.top_left ();
+    const Eigen::Vector2d br = ring_bbox.bottom_right () + shifts_bbox.bottom_right ();
+
+    Eigen::Matrix < double, 3, 4 > corners;
+    corners << tl.x (), br.x (), br.x (), tl.x (),
+               tl.y (), tl.y (), br.y (), br.y (),
+               1.0,     1.0,     1.0,     1.0;
+
+    const Eigen::Matrix < double, 3, 4 > raster_corners = world_2_raster * corners;
+
+    auto covering_raster = points_bbox ( raster_corners.topRows < 2 > () );
+    covering_raster.bufferize( { buffer_size, buffer_size } );
+
+    return covering_raster;
+}
+
+polygon gdal::bbox_and_projections_2_polygon ( const Eigen::Matrix2Xd &ring, const Eigen::Matrix2Xd &shifts, const Eigen::Vector2d &raster_sizes
+                                               , const Eigen::Matrix3d &raster_2_world, const Eigen::Matrix3d &world_2_raster
+                                               , const double buffer_size )
+{
+    if ( ring.cols () == 0 )
+        return {};
+
+    const auto covering_raster = shifted_raster_bbox ( ring, shifts, world_2_raster, buffer_size );
+
+    const auto &tl = covering_raster.top_left();
+    const auto &br = covering_raster.bottom_right();
+
+    if ( tl.x() < 0.0 || tl.y () < 0.0 )
+        return {};
+
+    if ( br.x () > raster_sizes [0] || br.y () > raster_sizes [1] )
+        return {};
+
+    gdal::polygon result ( new polygon::element_type );
+    result << covering_raster.transform( raster_2_world );
+
+    return result;
+}
@@ -0,0 +1,144 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+#include <args-parser/all.hpp>
+
+#include "common/definitions.h"
+#include "common/arguments.h"
+#include "common/string_utils.h"
+#include "rsai/estimator_replay.h"
+
+using namespace std;
+
+int main ( int argc, char * argv[] )
+{
+    try
+    {
+        Args::CmdLine cmd( argc, argv );
+
+        Args::Arg & capture_param = arguments::get_capture ();
+        capture_param.setDescription( SL( "Directory of the estimators' inputs captured by a locator's --capture option. " ) );
+
+        Args::Arg & replay_repeat_param = arguments::get_replay_repeat ();
+
+        Args::Arg & replay_checksums_param = arguments::get_replay_checksums ();
+
+        Args::Arg & replay_reference_param = arguments::get_replay_reference ();
+
+        Args::Help help;
+        help.setAppDescription(
+            std::string ( "Utility to benchmark roof and structure estimators on captured features' inputs without the GDAL pipeline. "
+                          "Every capture is run the given number of times, the fastest run and the outputs' checksum are reported. "
+                          "With a reference checksums file the utility fails on any changed output, so it serves as a regression suite. " ) );
+        help.setExecutable( argv[0] );
+
+        cmd.addArg ( capture_param );
+        cmd.addArg ( replay_repeat_param );
+        cmd.addArg ( replay_checksums_param );
+        cmd.addArg ( replay_reference_param );
+        cmd.addArg ( help );
+
+        cmd.parse();
+
+        if ( !capture_param.isDefined () )
+        {
+            std::cerr << "STOP: Captures directory is required" << std::endl;
+            return 1;
+        }
+
+        value_helper < int > replay_repeat_helper       ( replay_repeat_param.value() );
+        if ( !replay_repeat_helper.verify ( std::cerr,  "STOP: Repeat value is incorrect." ) )
+            return 1;
+
+        if ( replay_repeat_helper.value() < 1 )
+        {
+            std::cerr << "STOP: Repeat value must be positive" << std::endl;
+            return 1;
+        }
+
+        std::map < int, uint64_t > reference;
+        if ( replay_reference_param.isDefined () && !rsai::read_checksums ( replay_reference_param.value(), reference ) )
+            return 1;
+
+        const auto files = rsai::capture_files ( capture_param.value() );
+        if ( files.empty () )
+        {
+            std::cerr << "STOP: No captures found in " << capture_param.value() << std::endl;
+            return 1;
+        }
+
+        std::cout << "Replaying " << files.size () << " captures " << replay_repeat_helper.value() << " times...\n";
+        std::cout << std::setw ( 10 ) << "id" << std::setw ( 12 ) << "tile" << std::setw ( 12 ) << "roof_ms"
+                  << std::setw ( 14 ) << "structure_ms" << std::setw ( 11 ) << "responses" << std::setw ( 12 ) << "structures"
+                  << std::setw ( 18 ) << "checksum" << "  status\n";
+
+        std::vector < rsai::replay_result > results;
+        double roof_total = 0.0, structure_total = 0.0;
+        int failed = 0, mismatched = 0, unstable = 0;
+        for ( const auto &file : files )
+        {
+            rsai::building_models::estimator_input input;
+            if ( !rsai::building_models::read_estimator_input ( file, input ) )
+            {
+                ++failed;
+                continue;
+            }
+
+            const auto result = rsai::replay_estimators ( input, replay_repeat_helper.value() );
+            results.push_back ( result );
+            roof_total += result.roof_ms;
+            structure_total += result.structure_ms;
+
+            std::string status = "ok";
+            if ( !result.deterministic )
+            {
+                status = "UNSTABLE";
+                ++unstable;
+            }
+            else if ( replay_reference_param.isDefined () )
+            {
+                auto expected = reference.find ( result.object_index );
+                if ( expected == reference.end () )
+                    status = "new";
+                else if ( expected->second != result.checksum )
+                {
+                    status = "MISMATCH";
+                    ++mismatched;
+                }
+            }
+
+            std::cout << std::setw ( 10 ) << result.object_index
+                      << std::setw ( 12 ) << ( std::to_string ( result.tile_width ) + "x" + std::to_string ( result.tile_height ) )
+                      << std::fixed << std::setprecision ( 2 )
+                      << std::setw ( 12 ) << result.roof_ms << std::setw ( 14 ) << result.structure_ms
+                      << std::setw ( 11 ) << result.responses << std::setw ( 12 ) << result.structures
+                      << std::setw ( 18 ) << std::hex << result.checksum << std::dec << "  " << status << '\n';
+        }
+
+        std::cout << "Total: roofs " << roof_total << " ms, structures " << structure_total << " ms over "
+                  << results.size () << " captures\n";
+
+        if ( replay_checksums_param.isDefined () && !rsai::write_checksums ( replay_checksums_param.value(), results ) )
+            return 1;
+
+        if ( failed > 0 || mismatched > 0 || unstable > 0 )
+        {
+            std::cerr << "STOP: " << failed << " unreadable, " << mismatched << " mismatched and "
+                      << unstable << " unstable captures" << std::endl;
+            return 1;
+        }
+
+        std::cout << "done\n";
+    }
+    catch( const Args::HelpHasBeenPrintedException & )
+    {
+    }
+    catch( const Args::BaseException & x )
+    {
+        Args::outStream() << x.desc() << SL( "\n" );
+    }
+
+
+    return 0;
+}
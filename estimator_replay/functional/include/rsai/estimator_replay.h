@@ -0,0 +1,37 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "rsai/building_models/estimator_capture.h"
+
+namespace rsai
+{
+    struct replay_result
+    {
+        int         object_index        = -1;
+        int         tile_width          = 0;
+        int         tile_height         = 0;
+        // The fastest run's durations, ms
+        double      roof_ms             = 0.0;
+        double      structure_ms        = 0.0;
+        size_t      responses           = 0;
+        size_t      structures          = 0;
+        // Outputs' checksum, equal for every run of a deterministic estimator
+        uint64_t    checksum            = 0;
+        bool        deterministic       = true;
+    };
+
+    // Captures' files of the directory in name order
+    std::vector < std::string > capture_files ( const std::string &directory );
+
+    // Runs the captured estimators the given number of times
+    replay_result replay_estimators ( const building_models::estimator_input &input, const int repeat );
+
+    // Text file of "object_index checksum" lines
+    bool write_checksums ( const std::string &file_name, const std::vector < replay_result > &results );
+    bool read_checksums ( const std::string &file_name, std::map < int, uint64_t > &checksums );
+
+}; // namespace rsai
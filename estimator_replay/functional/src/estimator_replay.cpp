@@ -0,0 +1,191 @@
+#include "rsai/estimator_replay.h"
+
+#include <cmath>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+
+#include "common/definitions.h"
+#include "rsai/building_models/prismatic.h"
+#include "rsai/building_models/roof_estimator.h"
+#include "rsai/building_models/structure_estimator.h"
+
+using namespace rsai;
+using namespace rsai::building_models;
+
+namespace
+{
+    // FNV-1a over the outputs, values are rounded to 1e-6 so that a reordered floating point sum
+    // of an optimized estimator still matches while any change of the located positions does not
+    class output_hash
+    {
+    public:
+        void add ( const double value )
+        {
+            int64_t quantized = 0;
+            if ( std::isfinite ( value ) && std::fabs ( value ) < 1e+12 )
+                quantized = std::llround ( value * 1e+6 );
+            else
+                std::memcpy ( &quantized, &value, sizeof ( value ) );
+
+            add_bytes ( &quantized, sizeof ( quantized ) );
+        }
+
+        void add ( const Eigen::Vector2d &value )
+        {
+            add ( value.x () );
+            add ( value.y () );
+        }
+
+        void add_bytes ( const void * data, const size_t size )
+        {
+            auto bytes = static_cast < const unsigned char * > ( data );
+            for ( size_t i = 0; i < size; ++i )
+            {
+                m_hash ^= bytes [i];
+                m_hash *= 1099511628211ull;
+            }
+        }
+
+        uint64_t value () const { return m_hash; }
+
+    private:
+        uint64_t m_hash = 14695981039346656037ull;
+    };
+
+    void add_response ( output_hash &hash, const roof_response &response )
+    {
+        hash.add ( response.shift_world );
+        hash.add ( response.shift_on_tile );
+        hash.add ( response.value );
+        hash.add ( response.deviation );
+    }
+
+    double elapsed_ms ( const std::chrono::steady_clock::time_point &start )
+    {
+        return std::chrono::duration < double, std::milli > ( std::chrono::steady_clock::now () - start ).count ();
+    }
+}; // namespace
+
+std::vector < std::string > rsai::capture_files ( const std::string &directory )
+{
+    std::vector < std::string > files;
+
+    std::error_code error;
+    for ( const auto &entry : std::filesystem::directory_iterator ( directory, error ) )
+        if ( entry.is_regular_file () && entry.path ().extension () == DEFAULT_CAPTURE_FILE_EXT )
+            files.push_back ( entry.path ().string () );
+
+    if ( error )
+        std::cerr << "Unable to list captures directory: " << directory << ", " << error.message () << std::endl;
+
+    std::sort ( files.begin (), files.end () );
+    return files;
+}
+
+replay_result rsai::replay_estimators ( const estimator_input &input, const int repeat )
+{
+    replay_result result;
+    result.object_index = input.object_index;
+    result.tile_width = input.tile_gray.cols;
+    result.tile_height = input.tile_gray.rows;
+
+    for ( int run = 0; run < std::max ( 1, repeat ); ++run )
+    {
+        output_hash hash;
+
+        // Estimators' construction is timed as well, the edges convolution happens there
+        auto start = std::chrono::steady_clock::now ();
+        roof_estimator a_roof_estimator ( input.roof_position_walk, input.world_2_raster, input.proj_world, input.shade_world
+                                          , input.max_length, input.tile_gray );
+
+        auto responses = ( input.use_sam ) ? a_roof_estimator ( input.roof, -input.tile_top_left, input.segments, input.roof_variants )
+                                           : a_roof_estimator ( input.roof, -input.tile_top_left, input.roof_variants );
+        const double roof_ms = elapsed_ms ( start );
+
+        for ( const auto &response : responses )
+            add_response ( hash, response );
+
+        double structure_ms = 0.0;
+        size_t structures_count = 0;
+        if ( input.estimate_structure )
+        {
+            start = std::chrono::steady_clock::now ();
+            prismatic model ( input.roof->getExteriorRing (), input.proj_world, input.shade_world );
+            structure_estimator a_structure_estimator ( model, responses, input.tile_gray, input.tile_top_left, input.world_2_raster
+                                                        , input.segmentize_step, input.segments );
+            auto position_estimates = a_structure_estimator ( input.max_length, input.projection_step, input.roof_variants, input.shade_variants );
+            structure_ms = elapsed_ms ( start );
+
+            structures_count = position_estimates.size ();
+            for ( const auto &estimate : position_estimates )
+            {
+                add_response ( hash, estimate );
+                for ( const auto &shade : estimate.shades )
+                {
+                    hash.add ( shade.length );
+                    hash.add ( shade.response );
+                    hash.add ( shade.shift );
+                }
+            }
+        }
+
+        if ( run == 0 )
+        {
+            result.roof_ms = roof_ms;
+            result.structure_ms = structure_ms;
+            result.responses = responses.size ();
+            result.structures = structures_count;
+            result.checksum = hash.value ();
+        }
+        else
+        {
+            result.roof_ms = std::min ( result.roof_ms, roof_ms );
+            result.structure_ms = std::min ( result.structure_ms, structure_ms );
+            result.deterministic = result.deterministic && result.checksum == hash.value ();
+        }
+    }
+
+    return result;
+}
+
+bool rsai::write_checksums ( const std::string &file_name, const std::vector < replay_result > &results )
+{
+    std::ofstream out ( file_name );
+    if ( !out )
+    {
+        std::cerr << "Unable to write checksums file: " << file_name << std::endl;
+        return false;
+    }
+
+    for ( const auto &result : results )
+        out << result.object_index << ' ' << std::hex << result.checksum << std::dec << '\n';
+
+    return bool ( out );
+}
+
+bool rsai::read_checksums ( const std::string &file_name, std::map < int, uint64_t > &checksums )
+{
+    std::ifstream in ( file_name );
+    if ( !in )
+    {
+        std::cerr << "Unable to read checksums file: " << file_name << std::endl;
+        return false;
+    }
+
+    int object_index = 0;
+    uint64_t checksum = 0;
+    while ( in >> std::dec >> object_index >> std::hex >> checksum )
+        checksums [object_index] = checksum;
+
+    if ( !in.eof () )
+    {
+        std::cerr << "Malformed checksums file: " << file_name << std::endl;
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <functional>
+
+#include "common/definitions.h"
+#include "gdal_utils/shared_geometry.h"
+
+namespace gdal
+{
+    // Completed feature: source object id, selected variant and its compact result
+    struct journal_record
+    {
+        int         object_index    = 0;
+        // Selected variant's indices, empty for a feature completed without a result, e.g. rejected
+        std::vector < int > variants;
+        double      value           = 0.0;
+        // Result geometries in the order defined by the writer, null entries are kept
+        geometries  items;
+    };
+
+    // Append-only per-feature completion journal of a long run. Records are framed by a size and a checksum, so
+    // a torn tail left by a crash is dropped on load. Appends are buffered and synced to disk in batches.
+    class feature_journal
+    {
+    public:
+        // Previous records are loaded on resume, the journal is started anew otherwise
+        feature_journal ( const std::string &file_name, const bool resume
+                          , const size_t sync_records = DEFAULT_JOURNAL_SYNC_RECORDS
+                          , const int sync_interval_ms = DEFAULT_JOURNAL_SYNC_INTERVAL );
+        ~feature_journal ();
+
+        feature_journal ( const feature_journal & ) = delete;
+        feature_journal & operator = ( const feature_journal & ) = delete;
+
+        bool        is_open     () const;
+
+        // Thread safe, a later record of the same object replaces the former one
+        bool        append      ( const journal_record &record );
+        // Writes buffered records and flushes them to the disk
+        bool        sync        ();
+
+        bool        contains    ( const int object_index ) const;
+        // Completed objects count including the loaded ones
+        size_t      size        () const;
+        // Objects loaded from the previous run
+        size_t      resumed     () const;
+
+        // Calls the function for the latest record of each object in objects' id order
+        bool        replay      ( const std::function < void ( const journal_record & ) > &func );
+
+    private:
+        const std::string           m_file_name;
+        const size_t                m_sync_records;
+        const std::chrono::milliseconds m_sync_interval;
+
+        int                         m_descriptor    = -1;
+        uint64_t                    m_file_size     = 0;
+        size_t                      m_resumed       = 0;
+
+        // Latest record's offset of each completed object
+        std::map < int, uint64_t >  m_offsets;
+
+        std::string                 m_buffer;
+        size_t                      m_buffered      = 0;
+        std::chrono::steady_clock::time_point m_synced;
+
+        mutable std::mutex          m_lock;
+
+        bool        __load      ();
+        bool        __sync      ();
+    }; // class feature_journal
+
+}; // namespace gdal
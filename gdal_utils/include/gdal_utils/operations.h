@@ -1,19 +1,85 @@
 #pragma once
 
 #include "gdal_utils/shared_geometry.h"
+#include <map>
+#include <mutex>
+#include <thread>
 #include <cpl_conv.h>
+#include <ogr_geometry.h>
 
 namespace gdal
 {
-    template < class GeometryType1, class GeometryType2 >
-    double iou ( const std::shared_ptr < GeometryType1 > &geom1, const std::shared_ptr < GeometryType2 > &geom2 );
+    // GEOS prepared geometry for repeated spatial predicates against a single geometry
+    class prepared_geometry
+    {
+    public:
+        prepared_geometry () = default;
+        explicit prepared_geometry ( const OGRGeometry * geom );
+
+        bool                    valid       () const;
+        const OGREnvelope &     envelope    () const;
+
+        bool                    intersects  ( const OGRGeometry * other ) const;
+        bool                    contains    ( const OGRGeometry * other ) const;
+
+    private:
+        std::shared_ptr < OGRPreparedGeometry > m_prepared;
+        OGREnvelope             m_envelope;
+    }; // class prepared_geometry
+
+    // A prepared geometry is bound to the GEOS context of its creating thread and isn't safe for
+    // concurrent queries, so every querying thread gets its own copy prepared on the first use
+    class thread_prepared_geometry
+    {
+    public:
+        explicit thread_prepared_geometry ( const OGRGeometry * geom );
+
+        const prepared_geometry & local () const;
+
+    private:
+        const OGRGeometry *     m_geometry;
+        mutable std::mutex      m_lock;
+        mutable std::map < std::thread::id, prepared_geometry > m_prepared;
+    }; // class thread_prepared_geometry
+
+    // Geometry prepared once for a series of IoU calculations: validity, envelope and area
+    // are evaluated on construction, invalid geometry is replaced by its valid copy
+    class iou_operand
+    {
+    public:
+        explicit iou_operand ( const OGRGeometry * geom, const bool prepare = false );
+
+        const OGRGeometry *     geometry    () const;
+        const OGREnvelope &     envelope    () const;
+        double                  area        () const;
+        bool                    empty       () const;
+        bool                    prepared    () const;
+
+        // Envelope rejection followed by the prepared geometry predicate when available
+        bool                    intersects  ( const iou_operand &other ) const;
+
+    private:
+        const OGRGeometry *     m_geometry = nullptr;
+        gdal::geometry          m_valid;
+        OGREnvelope             m_envelope;
+        double                  m_area = 0.0;
+        prepared_geometry       m_prepared;
+    }; // class iou_operand
+
+    double iou ( const OGRGeometry * geom1, const OGRGeometry * geom2 );
+    double iou ( const iou_operand &geom1, const iou_operand &geom2 );
+
+    // One geometry against many candidates, the geometry is validated and prepared only once
+    std::vector < double > iou ( const iou_operand &geom, const std::vector < iou_operand > &candidates );
+    std::vector < double > iou ( const OGRGeometry * geom, const std::vector < const OGRGeometry * > &candidates );
 
     template < class GeometryType1, class GeometryType2 >
-    double iou ( GeometryType1 * geom1, GeometryType2 * geom2 );
+    double iou ( const std::shared_ptr < GeometryType1 > &geom1, const std::shared_ptr < GeometryType2 > &geom2 );
 
+    static double get_area ( const OGRGeometry * geom );
     static double get_area ( const gdal::geometry &geom );
 
-    static double get_area ( const gdal::geometry &geom )
+    static double get_area ( const OGRGeometry * geom )
     {
         if (geom != nullptr)
         {
@@ -29,54 +95,14 @@ namespace gdal
         return 0.0;
     }
 
-    template < class GeometryType1, class GeometryType2 >
-    double iou ( GeometryType1 * geom1, GeometryType2 * geom2 )
+    static double get_area ( const gdal::geometry &geom )
     {
-        CPLSetErrorHandler(CPLQuietErrorHandler);
-
-        if (geom1 == nullptr || geom2 == nullptr)
-        {
-            return 0.0;
-        }
-
-        if ( !geom1->IsValid() )
-            geom1 = geom1->MakeValid();
-
-        if ( !geom2->IsValid() )
-            geom2 = geom2->MakeValid();
-
-        gdal::geometry intersection_geom ( geom1->Intersection ( geom2 ) );
-        gdal::geometry union_geom ( geom1->Union ( geom2 ) );
-
-        if (intersection_geom == nullptr || union_geom == nullptr)
-        {
-            return 0.0;
-        }
-
-        if ( !intersection_geom->IsValid() )
-            intersection_geom = gdal::geometry ( intersection_geom->MakeValid() );
-
-        if ( !union_geom->IsValid() )
-            union_geom = gdal::geometry ( union_geom->MakeValid() );
-
-        const double intersectionArea = get_area ( intersection_geom );
-        const double unionArea = get_area ( union_geom );
-
-        if (unionArea == 0.0)
-        {
-            return 0.0;
-        }
-
-        const double iou = intersectionArea / unionArea;
-
-        CPLSetErrorHandler(CPLDefaultErrorHandler);
-
-        return iou;
+        return get_area ( geom.get () );
     }
 
     template < class GeometryType1, class GeometryType2 >
     double iou ( const std::shared_ptr < GeometryType1 > &geom1, const std::shared_ptr < GeometryType2 > &geom2 )
     {
-        return iou ( geom1.get(), geom2.get () );
+        return iou ( static_cast < const OGRGeometry * > ( geom1.get() ), static_cast < const OGRGeometry * > ( geom2.get () ) );
     }
 }
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <gdal_priv.h>
+#include "gdal_utils/shared_dataset.h"
+
+namespace gdal
+{
+    // North-up pixel grid in world coordinates
+    class raster_grid
+    {
+    public:
+        raster_grid () = default;
+        raster_grid ( const double origin_x, const double origin_y, const double pixel_x, const double pixel_y, const int width, const int height );
+
+        // Grid of the raster's pixels inside the projection window ( gdal_translate -projwin ulx uly lrx lry )
+        static raster_grid  from_projwin ( const shared_dataset &ds, const double ulx, const double uly, const double lrx, const double lry );
+        // Grid of the window with the given pixel sizes ( gdal_rasterize -te xmin ymin xmax ymax -tr x y )
+        static raster_grid  from_extent ( const OGREnvelope &extent, const double pixel_x, const double pixel_y );
+
+        bool                valid () const;
+        int                 width () const;
+        int                 height () const;
+        void                geo_transform ( double * transform ) const;
+        // Rows [row_from, row_to) as a separate grid
+        raster_grid         rows ( const int row_from, const int row_to ) const;
+        OGREnvelope         envelope () const;
+
+        // Reads the band's pixels covering the grid by the nearest neighbour, pixels outside the source are left intact.
+        // Buffer holds width () * height () pixels of the type
+        bool                read ( GDALRasterBand *band, GDALDataType type, void *buffer ) const;
+
+    private:
+        double  m_origin_x  = 0.0;
+        double  m_origin_y  = 0.0;
+        double  m_pixel_x   = 0.0;
+        double  m_pixel_y   = 0.0;
+        int     m_width     = 0;
+        int     m_height    = 0;
+    }; // class raster_grid
+
+    // Tiled compressed GeoTIFF of the grid, written aside and renamed by commit ()
+    class tiled_raster_writer
+    {
+    public:
+        tiled_raster_writer ( const std::string &file_name, const raster_grid &grid, const int bands, const GDALDataType type
+                              , const std::string &photometric, const OGRSpatialReference *srs );
+        ~tiled_raster_writer ();
+
+        bool                valid () const;
+        int                 block_height () const;
+
+        // Band sequential buffer of the rows [row_from, row_to)
+        bool                write ( const int row_from, const int row_to, const void *buffer );
+        bool                commit ();
+
+    private:
+        const std::string   m_file_name;
+        const std::string   m_temp_name;
+        const raster_grid   m_grid;
+        const int           m_bands;
+        const GDALDataType  m_type;
+        shared_dataset      m_ds;
+        bool                m_committed = false;
+    }; // class tiled_raster_writer
+
+}; // namespace gdal
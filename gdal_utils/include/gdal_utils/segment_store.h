@@ -0,0 +1,87 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "gdal_utils/shared_geometry.h"
+
+namespace gdal
+{
+    // Binary segments file: a header, a table of segments' bboxes, a table of rings and a flat array of x, y pairs.
+    // Segments are valid polygons, multipolygons are stored as separate segments.
+    class segments_file
+    {
+    public:
+        struct segment
+        {
+            double      min_x;
+            double      min_y;
+            double      max_x;
+            double      max_y;
+            uint64_t    first_ring;
+            uint64_t    rings_count;
+        };
+
+        struct ring
+        {
+            uint64_t    first_point;
+            uint64_t    points_count;
+        };
+
+        // File is memory mapped read only, all the accessors return pointers into the mapping
+        explicit segments_file ( const std::string &file_name );
+        ~segments_file ();
+
+        bool                    is_open () const;
+        size_t                  size () const;
+
+        const segment &         operator [] ( const size_t index ) const;
+        const ring *            rings ( const segment &a_segment ) const;
+        // Interleaved x, y pairs of the ring
+        const double *          points ( const ring &a_ring ) const;
+
+        // Segments which bboxes intersect the region, in the stored order
+        std::vector < size_t >  search ( const OGREnvelope &region ) const;
+
+        polygon                 to_polygon ( const size_t index ) const;
+        // Segments within the filter's envelope clipped by the filter, all of them without a filter
+        geometries              read ( polygon spatial_filter = {} ) const;
+
+    private:
+        struct header
+        {
+            uint32_t    magic;
+            uint32_t    version;
+            uint64_t    segments_count;
+            uint64_t    rings_count;
+            uint64_t    points_count;
+        };
+
+        const std::string   m_file_name;
+        void *              m_data      = nullptr;
+        size_t              m_data_size = 0;
+
+        const header *      m_header    = nullptr;
+        const segment *     m_segments  = nullptr;
+        const ring *        m_rings     = nullptr;
+        const double *      m_points    = nullptr;
+
+        segments_file ( const segments_file &src ) = delete;
+        segments_file & operator = ( const segments_file &src ) = delete;
+
+        bool __map ();
+        void __unmap ();
+
+        friend bool to_segments_file ( const std::string &file_name, const std::vector < const OGRGeometry * > &geometry_list );
+    }; // class segments_file
+
+    bool        to_segments_file ( const std::string &file_name, const std::vector < const OGRGeometry * > &geometry_list );
+    bool        to_segments_file ( const std::string &file_name, const geometries &geometry_list );
+    bool        to_segments_file ( const std::string &file_name, const polygons &geometry_list );
+
+    geometries  from_segments_file ( const std::string &file_name, polygon spatial_filter = {} );
+
+    // Converts a WKT segments file, one geometry per line
+    bool        wkt_to_segments_file ( const std::string &wkt_file_name, const std::string &segments_file_name );
+
+}; // namespace gdal
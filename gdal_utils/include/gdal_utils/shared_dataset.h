@@ -94,9 +94,11 @@ namespace gdal
         \param[in] height           Количество строк / вертикальный размер (только для растров)
         \param[in] bands            Количество каналов / цветовых плоскостей (только для растров)
         \param[in] type             Тип точки растра (только для растров)
+        \param[in] options          Список опций создания
         \return действительный указатель GDALDataset в виде shared_dataset в случае успеха / shared_dataset ( nullptr ) - в случае неудачи
     */
-    shared_dataset create_dataset ( const std::string &driver_name, const std::string & file_name, int width = 0, int height = 0, int bands = 0, GDALDataType type = GDT_Unknown );
+    shared_dataset create_dataset ( const std::string &driver_name, const std::string & file_name, int width = 0, int height = 0, int bands = 0, GDALDataType type = GDT_Unknown
+                                    , char ** options = nullptr );
 
     using shared_datasets = std::vector < shared_dataset >;
 
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+#include <cpl_quad_tree.h>
+#include <ogr_core.h>
+
+namespace gdal
+{
+    // Envelope keyed quad tree over GDAL's CPLQuadTree. Bounds should cover all the inserted items.
+    // Items are stored by value and never move, concurrent search () calls are safe while no insertion is performed.
+    template < class Item >
+    class spatial_index
+    {
+    public:
+        spatial_index ( const OGREnvelope &bounds );
+        ~spatial_index ();
+
+        Item &                      insert ( const OGREnvelope &envelope, Item item );
+        std::vector < Item * >      search ( const OGREnvelope &region ) const;
+
+        size_t                      size () const;
+        bool                        empty () const;
+
+        const OGREnvelope &         bounds () const;
+
+    private:
+        struct node
+        {
+            OGREnvelope envelope;
+            Item        item;
+        };
+
+        OGREnvelope         m_bounds;
+        std::deque < node > m_nodes;
+        CPLQuadTree *       m_tree = nullptr;
+
+        spatial_index ( const spatial_index &src )  = delete;
+        spatial_index ( spatial_index &&src )       = delete;
+
+        static CPLRectObj   __to_rect ( const OGREnvelope &envelope );
+    }; // class spatial_index
+
+}; // namespace gdal
+
+#include "gdal_utils/spatial_index.hpp"
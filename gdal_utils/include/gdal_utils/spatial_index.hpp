@@ -0,0 +1,86 @@
+#pragma once
+
+#include "gdal_utils/spatial_index.h"
+
+#include <cpl_conv.h>
+
+template < class Item >
+gdal::spatial_index < Item >::spatial_index ( const OGREnvelope &bounds )
+    : m_bounds ( bounds )
+{
+    const CPLRectObj rect = __to_rect ( bounds );
+    m_tree = CPLQuadTreeCreate ( &rect, nullptr );
+}
+
+template < class Item >
+gdal::spatial_index < Item >::~spatial_index ()
+{
+    if ( m_tree )
+        CPLQuadTreeDestroy ( m_tree );
+}
+
+template < class Item >
+Item & gdal::spatial_index < Item >::insert ( const OGREnvelope &envelope, Item item )
+{
+    m_nodes.push_back ( { envelope, std::move ( item ) } );
+    auto &new_node = m_nodes.back ();
+
+    const CPLRectObj rect = __to_rect ( envelope );
+    CPLQuadTreeInsertWithBounds ( m_tree, &new_node, &rect );
+
+    return new_node.item;
+}
+
+template < class Item >
+std::vector < Item * > gdal::spatial_index < Item >::search ( const OGREnvelope &region ) const
+{
+    std::vector < Item * > result;
+
+    const CPLRectObj rect = __to_rect ( region );
+
+    int found_count = 0;
+    void ** found = CPLQuadTreeSearch ( m_tree, &rect, &found_count );
+
+    result.reserve ( found_count );
+    for ( int i = 0; i < found_count; ++i )
+    {
+        auto found_node = static_cast < node * > ( found [i] );
+
+        // Quad tree nodes are coarser than items' envelopes
+        if ( found_node->envelope.Intersects ( region ) )
+            result.push_back ( &found_node->item );
+    }
+
+    CPLFree ( found );
+
+    return result;
+}
+
+template < class Item >
+size_t gdal::spatial_index < Item >::size () const
+{
+    return m_nodes.size ();
+}
+
+template < class Item >
+bool gdal::spatial_index < Item >::empty () const
+{
+    return m_nodes.empty ();
+}
+
+template < class Item >
+const OGREnvelope & gdal::spatial_index < Item >::bounds () const
+{
+    return m_bounds;
+}
+
+template < class Item >
+CPLRectObj gdal::spatial_index < Item >::__to_rect ( const OGREnvelope &envelope )
+{
+    CPLRectObj rect;
+    rect.minx = envelope.MinX;
+    rect.miny = envelope.MinY;
+    rect.maxx = envelope.MaxX;
+    rect.maxy = envelope.MaxY;
+    return rect;
+}
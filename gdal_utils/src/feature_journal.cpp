@@ -0,0 +1,323 @@
+#include "gdal_utils/feature_journal.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace gdal;
+
+namespace
+{
+    const uint32_t journal_record_magic = 0x4E524A52; // "RJRN"
+
+    struct record_header
+    {
+        uint32_t    magic;
+        uint32_t    size;
+        uint32_t    checksum;
+    };
+
+    // FNV-1a, enough to catch a partially written record
+    uint32_t checksum ( const char * data, const size_t size )
+    {
+        uint32_t hash = 2166136261u;
+        for ( size_t i = 0; i < size; ++i )
+        {
+            hash ^= static_cast < unsigned char > ( data [i] );
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    template < class T >
+    void put ( std::string &payload, const T &value )
+    {
+        payload.append ( reinterpret_cast < const char * > ( &value ), sizeof ( T ) );
+    }
+
+    template < class T >
+    bool get ( const char * &data, const char * end, T &value )
+    {
+        if ( end - data < static_cast < std::ptrdiff_t > ( sizeof ( T ) ) )
+            return false;
+
+        std::memcpy ( &value, data, sizeof ( T ) );
+        data += sizeof ( T );
+        return true;
+    }
+
+    bool encode ( const journal_record &record, std::string &payload )
+    {
+        put ( payload, int32_t ( record.object_index ) );
+        put ( payload, uint32_t ( record.variants.size () ) );
+        for ( const auto variant : record.variants )
+            put ( payload, int32_t ( variant ) );
+        put ( payload, record.value );
+        put ( payload, uint32_t ( record.items.size () ) );
+
+        for ( const auto &item : record.items )
+        {
+            if ( !item )
+            {
+                put ( payload, uint32_t ( 0 ) );
+                continue;
+            }
+
+            std::vector < unsigned char > wkb ( item->WkbSize () );
+            if ( item->exportToWkb ( wkbNDR, wkb.data () ) != OGRERR_NONE )
+                return false;
+
+            put ( payload, uint32_t ( wkb.size () ) );
+            payload.append ( reinterpret_cast < const char * > ( wkb.data () ), wkb.size () );
+        }
+
+        return true;
+    }
+
+    bool decode ( const char * data, const char * end, journal_record &record, const bool with_items = true )
+    {
+        int32_t object_index = 0;
+        uint32_t count = 0;
+        if ( !get ( data, end, object_index ) || !get ( data, end, count ) )
+            return false;
+
+        record.object_index = object_index;
+        record.variants.clear ();
+        for ( uint32_t i = 0; i < count; ++i )
+        {
+            int32_t variant = 0;
+            if ( !get ( data, end, variant ) )
+                return false;
+            record.variants.push_back ( variant );
+        }
+
+        if ( !get ( data, end, record.value ) || !get ( data, end, count ) )
+            return false;
+
+        record.items.clear ();
+
+        if ( !with_items )
+            return true;
+
+        for ( uint32_t i = 0; i < count; ++i )
+        {
+            uint32_t size = 0;
+            if ( !get ( data, end, size ) || end - data < size )
+                return false;
+
+            if ( size == 0 )
+            {
+                record.items.push_back ( nullptr );
+                continue;
+            }
+
+            OGRGeometry * item = nullptr;
+            if ( OGRGeometryFactory::createFromWkb ( data, nullptr, &item, size ) != OGRERR_NONE )
+                return false;
+
+            record.items.push_back ( geometry ( item ) );
+            data += size;
+        }
+
+        return true;
+    }
+}
+
+feature_journal::feature_journal ( const std::string &file_name, const bool resume, const size_t sync_records, const int sync_interval_ms )
+    : m_file_name ( file_name ), m_sync_records ( std::max < size_t > ( 1, sync_records ) ), m_sync_interval ( sync_interval_ms )
+    , m_synced ( std::chrono::steady_clock::now () )
+{
+    if ( resume && !__load () )
+        return;
+
+    const int flags = O_WRONLY | O_CREAT | ( resume ? O_APPEND : O_TRUNC );
+    m_descriptor = open ( m_file_name.c_str (), flags, 0644 );
+    if ( m_descriptor < 0 )
+    {
+        std::cerr << "Unable to open journal file: " << m_file_name << std::endl;
+        return;
+    }
+}
+
+feature_journal::~feature_journal ()
+{
+    if ( m_descriptor >= 0 )
+    {
+        sync ();
+        close ( m_descriptor );
+    }
+}
+
+bool feature_journal::is_open () const
+{
+    return m_descriptor >= 0;
+}
+
+bool feature_journal::append ( const journal_record &record )
+{
+    std::string payload;
+    if ( !encode ( record, payload ) )
+    {
+        std::cerr << "Failed to encode journal record of object " << record.object_index << std::endl;
+        return false;
+    }
+
+    const record_header header { journal_record_magic, uint32_t ( payload.size () ), checksum ( payload.data (), payload.size () ) };
+
+    std::scoped_lock lock ( m_lock );
+    if ( m_descriptor < 0 )
+        return false;
+
+    m_offsets [record.object_index] = m_file_size + m_buffer.size ();
+
+    put ( m_buffer, header );
+    m_buffer.append ( payload );
+    ++m_buffered;
+
+    // Syncing in batches, a crash loses the unsynced tail only
+    if ( m_buffered >= m_sync_records || std::chrono::steady_clock::now () - m_synced >= m_sync_interval )
+        return __sync ();
+
+    return true;
+}
+
+bool feature_journal::sync ()
+{
+    std::scoped_lock lock ( m_lock );
+    return __sync ();
+}
+
+bool feature_journal::contains ( const int object_index ) const
+{
+    std::scoped_lock lock ( m_lock );
+    return m_offsets.find ( object_index ) != m_offsets.end ();
+}
+
+size_t feature_journal::size () const
+{
+    std::scoped_lock lock ( m_lock );
+    return m_offsets.size ();
+}
+
+size_t feature_journal::resumed () const
+{
+    return m_resumed;
+}
+
+bool feature_journal::replay ( const std::function < void ( const journal_record & ) > &func )
+{
+    std::scoped_lock lock ( m_lock );
+    if ( !__sync () )
+        return false;
+
+    std::ifstream in ( m_file_name, std::ios::binary );
+    if ( !in )
+    {
+        std::cerr << "Unable to read journal file: " << m_file_name << std::endl;
+        return false;
+    }
+
+    std::string payload;
+    for ( const auto &offset : m_offsets )
+    {
+        record_header header;
+        in.seekg ( offset.second );
+        in.read ( reinterpret_cast < char * > ( &header ), sizeof ( header ) );
+
+        payload.resize ( header.size );
+        in.read ( payload.data (), payload.size () );
+
+        journal_record record;
+        if ( !in || !decode ( payload.data (), payload.data () + payload.size (), record ) )
+        {
+            std::cerr << "Damaged journal record of object " << offset.first << " in " << m_file_name << std::endl;
+            return false;
+        }
+
+        func ( record );
+    }
+
+    return true;
+}
+
+bool feature_journal::__load ()
+{
+    if ( !std::filesystem::exists ( m_file_name ) )
+        return true;
+
+    std::ifstream in ( m_file_name, std::ios::binary );
+    if ( !in )
+    {
+        std::cerr << "Unable to read journal file: " << m_file_name << std::endl;
+        return false;
+    }
+
+    const uint64_t file_size = std::filesystem::file_size ( m_file_name );
+
+    std::string payload;
+    uint64_t offset = 0;
+    while ( true )
+    {
+        record_header header;
+        if ( !in.read ( reinterpret_cast < char * > ( &header ), sizeof ( header ) ) || header.magic != journal_record_magic
+                || header.size > file_size - offset - sizeof ( header ) )
+            break;
+
+        payload.resize ( header.size );
+        if ( !in.read ( payload.data (), payload.size () ) || checksum ( payload.data (), payload.size () ) != header.checksum )
+            break;
+
+        journal_record record;
+        if ( !decode ( payload.data (), payload.data () + payload.size (), record, false ) )
+            break;
+
+        m_offsets [record.object_index] = offset;
+        offset += sizeof ( header ) + header.size;
+    }
+
+    // A record torn by a crash is dropped, appends continue from the last complete one
+    if ( offset != file_size )
+    {
+        std::cerr << "Journal " << m_file_name << " has a damaged tail, " << file_size - offset << " bytes dropped" << std::endl;
+        std::filesystem::resize_file ( m_file_name, offset );
+    }
+
+    m_file_size = offset;
+    m_resumed = m_offsets.size ();
+
+    return true;
+}
+
+bool feature_journal::__sync ()
+{
+    if ( m_descriptor < 0 )
+        return false;
+
+    size_t written = 0;
+    while ( written < m_buffer.size () )
+    {
+        const auto result = write ( m_descriptor, m_buffer.data () + written, m_buffer.size () - written );
+        if ( result < 0 )
+        {
+            std::cerr << "Failed to write journal file: " << m_file_name << std::endl;
+            return false;
+        }
+        written += result;
+    }
+
+    m_file_size += m_buffer.size ();
+    m_buffer.clear ();
+    m_buffered = 0;
+    m_synced = std::chrono::steady_clock::now ();
+
+    if ( fdatasync ( m_descriptor ) != 0 )
+    {
+        std::cerr << "Failed to sync journal file: " << m_file_name << std::endl;
+        return false;
+    }
+
+    return true;
+}
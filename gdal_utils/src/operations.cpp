@@ -0,0 +1,197 @@
+#include "gdal_utils/operations.h"
+
+#include <cpl_error.h>
+
+using namespace gdal;
+
+namespace
+{
+    // GDAL error handlers stack is thread local, so quiet mode doesn't affect other threads
+    struct quiet_errors
+    {
+        quiet_errors  () { CPLPushErrorHandler ( CPLQuietErrorHandler ); }
+        ~quiet_errors () { CPLPopErrorHandler (); }
+    };
+
+    bool envelopes_intersect ( const OGRGeometry * geom1, const OGRGeometry * geom2 )
+    {
+        OGREnvelope envelope1, envelope2;
+        geom1->getEnvelope ( &envelope1 );
+        geom2->getEnvelope ( &envelope2 );
+        return envelope1.Intersects ( envelope2 );
+    }
+}
+
+gdal::prepared_geometry::prepared_geometry ( const OGRGeometry * geom )
+{
+    if ( geom == nullptr || geom->IsEmpty () )
+        return;
+
+    geom->getEnvelope ( &m_envelope );
+    m_prepared = std::shared_ptr < OGRPreparedGeometry > ( OGRCreatePreparedGeometry ( geom ), OGRDestroyPreparedGeometry );
+}
+
+bool gdal::prepared_geometry::valid () const
+{
+    return m_prepared != nullptr;
+}
+
+const OGREnvelope & gdal::prepared_geometry::envelope () const
+{
+    return m_envelope;
+}
+
+bool gdal::prepared_geometry::intersects ( const OGRGeometry * other ) const
+{
+    return m_prepared && other && OGRPreparedGeometryIntersects ( m_prepared.get (), other );
+}
+
+bool gdal::prepared_geometry::contains ( const OGRGeometry * other ) const
+{
+    return m_prepared && other && OGRPreparedGeometryContains ( m_prepared.get (), other );
+}
+
+gdal::thread_prepared_geometry::thread_prepared_geometry ( const OGRGeometry * geom )
+    : m_geometry ( geom )
+{
+}
+
+const gdal::prepared_geometry & gdal::thread_prepared_geometry::local () const
+{
+    const auto id = std::this_thread::get_id ();
+
+    std::scoped_lock lock ( m_lock );
+    auto found = m_prepared.find ( id );
+    if ( found == m_prepared.end () )
+        found = m_prepared.emplace ( id, prepared_geometry ( m_geometry ) ).first;
+
+    // Map nodes are stable, the reference outlives the lock
+    return found->second;
+}
+
+gdal::iou_operand::iou_operand ( const OGRGeometry * geom, const bool prepare )
+{
+    if ( geom == nullptr || geom->IsEmpty () )
+        return;
+
+    quiet_errors quiet;
+
+    m_geometry = geom;
+    if ( !geom->IsValid () )
+    {
+        m_valid = gdal::geometry ( geom->MakeValid () );
+        m_geometry = m_valid.get ();
+
+        if ( m_geometry == nullptr )
+            return;
+    }
+
+    m_geometry->getEnvelope ( &m_envelope );
+    m_area = get_area ( m_geometry );
+
+    if ( prepare )
+        m_prepared = prepared_geometry ( m_geometry );
+}
+
+const OGRGeometry * gdal::iou_operand::geometry () const
+{
+    return m_geometry;
+}
+
+const OGREnvelope & gdal::iou_operand::envelope () const
+{
+    return m_envelope;
+}
+
+double gdal::iou_operand::area () const
+{
+    return m_area;
+}
+
+bool gdal::iou_operand::empty () const
+{
+    return m_geometry == nullptr || m_area <= 0.0;
+}
+
+bool gdal::iou_operand::prepared () const
+{
+    return m_prepared.valid ();
+}
+
+bool gdal::iou_operand::intersects ( const iou_operand &other ) const
+{
+    if ( empty () || other.empty () || !m_envelope.Intersects ( other.m_envelope ) )
+        return false;
+
+    if ( m_prepared.valid () )
+        return m_prepared.intersects ( other.m_geometry );
+
+    if ( other.m_prepared.valid () )
+        return other.m_prepared.intersects ( m_geometry );
+
+    return true;
+}
+
+double gdal::iou ( const iou_operand &geom1, const iou_operand &geom2 )
+{
+    if ( !geom1.intersects ( geom2 ) )
+        return 0.0;
+
+    quiet_errors quiet;
+
+    // Union is not required: |A U B| = |A| + |B| - |A ^ B|
+    gdal::geometry intersection_geom ( geom1.geometry ()->Intersection ( geom2.geometry () ) );
+    if ( intersection_geom == nullptr )
+        return 0.0;
+
+    const double intersection_area = get_area ( intersection_geom );
+    const double union_area = geom1.area () + geom2.area () - intersection_area;
+
+    if ( union_area <= 0.0 )
+        return 0.0;
+
+    return intersection_area / union_area;
+}
+
+double gdal::iou ( const OGRGeometry * geom1, const OGRGeometry * geom2 )
+{
+    if ( geom1 == nullptr || geom2 == nullptr )
+        return 0.0;
+
+    // Rejecting distant objects before the validity checks
+    if ( !envelopes_intersect ( geom1, geom2 ) )
+        return 0.0;
+
+    return iou ( iou_operand ( geom1 ), iou_operand ( geom2 ) );
+}
+
+std::vector < double > gdal::iou ( const iou_operand &geom, const std::vector < iou_operand > &candidates )
+{
+    std::vector < double > result;
+    result.reserve ( candidates.size () );
+
+    for ( const auto &candidate : candidates )
+        result.push_back ( iou ( geom, candidate ) );
+
+    return result;
+}
+
+std::vector < double > gdal::iou ( const OGRGeometry * geom, const std::vector < const OGRGeometry * > &candidates )
+{
+    std::vector < double > result ( candidates.size (), 0.0 );
+
+    const iou_operand prepared_geom ( geom, candidates.size () > 1 );
+    if ( prepared_geom.empty () )
+        return result;
+
+    for ( size_t i = 0; i < candidates.size (); ++i )
+    {
+        const auto candidate = candidates [i];
+        if ( candidate == nullptr || !envelopes_intersect ( prepared_geom.geometry (), candidate ) )
+            continue;
+
+        result [i] = iou ( prepared_geom, iou_operand ( candidate ) );
+    }
+
+    return result;
+}
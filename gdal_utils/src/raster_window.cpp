@@ -0,0 +1,224 @@
+#include "gdal_utils/raster_window.h"
+
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+#include <filesystem>
+#include "gdal_utils/shared_options.h"
+
+using namespace gdal;
+
+namespace
+{
+    const int default_block_size = 256;
+}
+
+raster_grid::raster_grid ( const double origin_x, const double origin_y, const double pixel_x, const double pixel_y, const int width, const int height )
+    : m_origin_x ( origin_x ), m_origin_y ( origin_y ), m_pixel_x ( pixel_x ), m_pixel_y ( pixel_y ), m_width ( width ), m_height ( height )
+{
+}
+
+raster_grid raster_grid::from_projwin ( const shared_dataset &ds, const double ulx, const double uly, const double lrx, const double lry )
+{
+    double transform [6];
+    if ( !ds || ds->GetGeoTransform ( transform ) != CE_None || transform [2] != 0.0 || transform [4] != 0.0 )
+        return {};
+
+    // Snapping the window to the source pixels like gdal_translate does
+    const int x_from = std::floor ( ( ulx - transform [0] ) / transform [1] + 0.001 );
+    const int y_from = std::floor ( ( uly - transform [3] ) / transform [5] + 0.001 );
+    const int x_to = std::ceil ( ( lrx - transform [0] ) / transform [1] - 0.001 );
+    const int y_to = std::ceil ( ( lry - transform [3] ) / transform [5] - 0.001 );
+
+    return { transform [0] + x_from * transform [1], transform [3] + y_from * transform [5], transform [1], transform [5]
+           , x_to - x_from, y_to - y_from };
+}
+
+raster_grid raster_grid::from_extent ( const OGREnvelope &extent, const double pixel_x, const double pixel_y )
+{
+    if ( pixel_x <= 0.0 || pixel_y <= 0.0 )
+        return {};
+
+    const int width = std::ceil ( ( extent.MaxX - extent.MinX ) / pixel_x - 0.001 );
+    const int height = std::ceil ( ( extent.MaxY - extent.MinY ) / pixel_y - 0.001 );
+
+    return { extent.MinX, extent.MaxY, pixel_x, -pixel_y, width, height };
+}
+
+bool raster_grid::valid () const
+{
+    return m_width > 0 && m_height > 0 && m_pixel_x != 0.0 && m_pixel_y != 0.0;
+}
+
+int raster_grid::width () const
+{
+    return m_width;
+}
+
+int raster_grid::height () const
+{
+    return m_height;
+}
+
+void raster_grid::geo_transform ( double * transform ) const
+{
+    transform [0] = m_origin_x;
+    transform [1] = m_pixel_x;
+    transform [2] = 0.0;
+    transform [3] = m_origin_y;
+    transform [4] = 0.0;
+    transform [5] = m_pixel_y;
+}
+
+raster_grid raster_grid::rows ( const int row_from, const int row_to ) const
+{
+    return { m_origin_x, m_origin_y + row_from * m_pixel_y, m_pixel_x, m_pixel_y, m_width, row_to - row_from };
+}
+
+OGREnvelope raster_grid::envelope () const
+{
+    OGREnvelope envelope;
+    envelope.MinX = std::min ( m_origin_x, m_origin_x + m_width * m_pixel_x );
+    envelope.MaxX = std::max ( m_origin_x, m_origin_x + m_width * m_pixel_x );
+    envelope.MinY = std::min ( m_origin_y, m_origin_y + m_height * m_pixel_y );
+    envelope.MaxY = std::max ( m_origin_y, m_origin_y + m_height * m_pixel_y );
+    return envelope;
+}
+
+bool raster_grid::read ( GDALRasterBand *band, GDALDataType type, void *buffer ) const
+{
+    auto * ds = band->GetDataset ();
+
+    double transform [6];
+    if ( ds == nullptr || ds->GetGeoTransform ( transform ) != CE_None || transform [2] != 0.0 || transform [4] != 0.0 )
+        return false;
+
+    // Grid's pixels in the source pixel coordinates
+    const double x_origin = ( m_origin_x - transform [0] ) / transform [1];
+    const double y_origin = ( m_origin_y - transform [3] ) / transform [5];
+    const double x_scale = m_pixel_x / transform [1];
+    const double y_scale = m_pixel_y / transform [5];
+
+    if ( x_scale <= 0.0 || y_scale <= 0.0 )
+        return false;
+
+    const int source_width = band->GetXSize ();
+    const int source_height = band->GetYSize ();
+
+    // Grid's pixels fully inside the source
+    const int col_from = std::max ( 0, int ( std::ceil ( -x_origin / x_scale ) ) );
+    const int col_to = std::min ( m_width, int ( std::floor ( ( source_width - x_origin ) / x_scale ) ) );
+    const int row_from = std::max ( 0, int ( std::ceil ( -y_origin / y_scale ) ) );
+    const int row_to = std::min ( m_height, int ( std::floor ( ( source_height - y_origin ) / y_scale ) ) );
+
+    if ( col_from >= col_to || row_from >= row_to )
+        return true;
+
+    const double x_from = x_origin + col_from * x_scale, x_to = x_origin + col_to * x_scale;
+    const double y_from = y_origin + row_from * y_scale, y_to = y_origin + row_to * y_scale;
+
+    GDALRasterIOExtraArg extra_arg;
+    INIT_RASTERIO_EXTRA_ARG ( extra_arg );
+    extra_arg.eResampleAlg = GRIORA_NearestNeighbour;
+    extra_arg.bFloatingPointWindowValidity = TRUE;
+    extra_arg.dfXOff = x_from;
+    extra_arg.dfYOff = y_from;
+    extra_arg.dfXSize = x_to - x_from;
+    extra_arg.dfYSize = y_to - y_from;
+
+    const int x_off = std::floor ( x_from ), y_off = std::floor ( y_from );
+    const int x_size = std::min ( source_width, int ( std::ceil ( x_to ) ) ) - x_off;
+    const int y_size = std::min ( source_height, int ( std::ceil ( y_to ) ) ) - y_off;
+
+    const int pixel_size = GDALGetDataTypeSizeBytes ( type );
+    auto * target = static_cast < GByte * > ( buffer ) + ( GSpacing ( row_from ) * m_width + col_from ) * pixel_size;
+
+    return band->RasterIO ( GF_Read, x_off, y_off, x_size, y_size, target, col_to - col_from, row_to - row_from, type
+                          , pixel_size, GSpacing ( m_width ) * pixel_size, &extra_arg ) == CE_None;
+}
+
+tiled_raster_writer::tiled_raster_writer ( const std::string &file_name, const raster_grid &grid, const int bands, const GDALDataType type
+                                           , const std::string &photometric, const OGRSpatialReference *srs )
+    : m_file_name ( file_name ), m_temp_name ( file_name + ".part" ), m_grid ( grid ), m_bands ( bands ), m_type ( type )
+{
+    if ( !grid.valid () )
+        return;
+
+    const auto directory = std::filesystem::path ( file_name ).parent_path ();
+    std::error_code error;
+    if ( !directory.empty () )
+        std::filesystem::create_directories ( directory, error );
+
+    const std::string block_size = std::to_string ( default_block_size );
+
+    shared_options options;
+    options.set ( "TILED", "YES" );
+    options.set ( "BLOCKXSIZE", block_size );
+    options.set ( "BLOCKYSIZE", block_size );
+    options.set ( "COMPRESS", "DEFLATE" );
+    options.set ( "BIGTIFF", "IF_SAFER" );
+    if ( !photometric.empty () )
+        options.set ( "PHOTOMETRIC", photometric );
+    if ( bands == 4 )
+        options.set ( "ALPHA", "YES" );
+
+    m_ds = create_dataset ( "GTiff", m_temp_name, grid.width (), grid.height (), bands, type, options.get () );
+    if ( !m_ds )
+        return;
+
+    double transform [6];
+    grid.geo_transform ( transform );
+    m_ds->SetGeoTransform ( transform );
+
+    if ( srs != nullptr )
+    {
+        char * wkt = nullptr;
+        if ( srs->exportToWkt ( &wkt ) == OGRERR_NONE )
+            m_ds->SetProjection ( wkt );
+        CPLFree ( wkt );
+    }
+}
+
+tiled_raster_writer::~tiled_raster_writer ()
+{
+    // Not committed output is dropped
+    if ( !m_committed && m_ds )
+    {
+        m_ds.reset ();
+        std::remove ( m_temp_name.c_str () );
+    }
+}
+
+bool tiled_raster_writer::valid () const
+{
+    return m_ds != nullptr;
+}
+
+int tiled_raster_writer::block_height () const
+{
+    return default_block_size;
+}
+
+bool tiled_raster_writer::write ( const int row_from, const int row_to, const void *buffer )
+{
+    const int rows = row_to - row_from;
+    const GSpacing pixel_size = GDALGetDataTypeSizeBytes ( m_type );
+
+    return m_ds->RasterIO ( GF_Write, 0, row_from, m_grid.width (), rows, const_cast < void * > ( buffer ), m_grid.width (), rows, m_type
+                          , m_bands, nullptr, pixel_size, pixel_size * m_grid.width (), pixel_size * m_grid.width () * rows, nullptr ) == CE_None;
+}
+
+bool tiled_raster_writer::commit ()
+{
+    if ( !m_ds )
+        return false;
+
+    m_ds->FlushCache ();
+    m_ds.reset ();
+
+    m_committed = std::rename ( m_temp_name.c_str (), m_file_name.c_str () ) == 0;
+    if ( !m_committed )
+        std::remove ( m_temp_name.c_str () );
+
+    return m_committed;
+}
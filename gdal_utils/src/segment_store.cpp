@@ -0,0 +1,367 @@
+#include "gdal_utils/segment_store.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cpl_error.h>
+
+using namespace gdal;
+
+namespace
+{
+    const uint32_t segments_file_magic   = 0x47455352; // "RSEG"
+    const uint32_t segments_file_version = 1;
+
+    struct quiet_errors
+    {
+        quiet_errors  () { CPLPushErrorHandler ( CPLQuietErrorHandler ); }
+        ~quiet_errors () { CPLPopErrorHandler (); }
+    };
+
+    bool envelopes_intersect ( const OGREnvelope &lh, const segments_file::segment &rh )
+    {
+        return !( rh.max_x < lh.MinX || rh.min_x > lh.MaxX || rh.max_y < lh.MinY || rh.min_y > lh.MaxY );
+    }
+
+    // Valid polygons of a geometry, multipolygons and collections are split
+    void collect_polygons ( const OGRGeometry * geometry, std::vector < polygon > &polygons )
+    {
+        if ( geometry == nullptr || geometry->IsEmpty () )
+            return;
+
+        const auto type = wkbFlatten ( geometry->getGeometryType () );
+        if ( type == wkbPolygon )
+        {
+            if ( geometry->IsValid () )
+                polygons.push_back ( polygon ( geometry->clone ()->toPolygon () ) );
+            else
+            {
+                gdal::geometry valid ( geometry->MakeValid () );
+                if ( valid && wkbFlatten ( valid->getGeometryType () ) == wkbPolygon )
+                    polygons.push_back ( polygon ( valid->clone ()->toPolygon () ) );
+                else
+                    collect_polygons ( valid.get (), polygons );
+            }
+        }
+        else if ( type == wkbMultiPolygon || type == wkbGeometryCollection )
+        {
+            for ( const auto * part : geometry->toGeometryCollection () )
+                collect_polygons ( part, polygons );
+        }
+    }
+}
+
+segments_file::segments_file ( const std::string &file_name )
+    : m_file_name ( file_name )
+{
+    if ( !__map () )
+        __unmap ();
+}
+
+segments_file::~segments_file ()
+{
+    __unmap ();
+}
+
+bool segments_file::is_open () const
+{
+    return m_header != nullptr;
+}
+
+size_t segments_file::size () const
+{
+    return m_header ? m_header->segments_count : 0;
+}
+
+const segments_file::segment & segments_file::operator [] ( const size_t index ) const
+{
+    return m_segments [index];
+}
+
+const segments_file::ring * segments_file::rings ( const segment &a_segment ) const
+{
+    return m_rings + a_segment.first_ring;
+}
+
+const double * segments_file::points ( const ring &a_ring ) const
+{
+    return m_points + 2 * a_ring.first_point;
+}
+
+std::vector < size_t > segments_file::search ( const OGREnvelope &region ) const
+{
+    std::vector < size_t > found;
+    for ( size_t i = 0; i < size (); ++i )
+    {
+        if ( envelopes_intersect ( region, m_segments [i] ) )
+            found.push_back ( i );
+    }
+    return found;
+}
+
+polygon segments_file::to_polygon ( const size_t index ) const
+{
+    const auto &a_segment = m_segments [index];
+    const ring * segment_rings = rings ( a_segment );
+
+    auto result = instance < polygon > ();
+    for ( uint64_t i = 0; i < a_segment.rings_count; ++i )
+    {
+        auto * a_ring = new OGRLinearRing;
+        a_ring->setPoints ( segment_rings [i].points_count, reinterpret_cast < const OGRRawPoint * > ( points ( segment_rings [i] ) ) );
+        result->addRingDirectly ( a_ring );
+    }
+    return result;
+}
+
+geometries segments_file::read ( polygon spatial_filter ) const
+{
+    geometries result;
+
+    if ( !spatial_filter )
+    {
+        for ( size_t i = 0; i < size (); ++i )
+            result.push_back ( to_polygon ( i ) );
+        return result;
+    }
+
+    quiet_errors quiet;
+
+    OGREnvelope region;
+    spatial_filter->getEnvelope ( &region );
+
+    for ( auto index : search ( region ) )
+    {
+        gdal::geometry clipped ( to_polygon ( index )->Intersection ( spatial_filter.get () ) );
+        if ( clipped && !clipped->IsEmpty () )
+            result.push_back ( clipped );
+    }
+
+    return result;
+}
+
+bool segments_file::__map ()
+{
+    const int descriptor = open ( m_file_name.c_str (), O_RDONLY );
+    if ( descriptor < 0 )
+    {
+        std::cerr << "Unable to open segments file: " << m_file_name << std::endl;
+        return false;
+    }
+
+    struct stat file_stat;
+    if ( fstat ( descriptor, &file_stat ) != 0 || file_stat.st_size < sizeof ( header ) )
+    {
+        std::cerr << "Segments file is truncated: " << m_file_name << std::endl;
+        close ( descriptor );
+        return false;
+    }
+
+    m_data_size = file_stat.st_size;
+    m_data = mmap ( nullptr, m_data_size, PROT_READ, MAP_PRIVATE, descriptor, 0 );
+    close ( descriptor );
+
+    if ( m_data == MAP_FAILED )
+    {
+        m_data = nullptr;
+        std::cerr << "Unable to map segments file: " << m_file_name << std::endl;
+        return false;
+    }
+
+    const auto * bytes = static_cast < const char * > ( m_data );
+    const auto * file_header = reinterpret_cast < const header * > ( bytes );
+
+    if ( file_header->magic != segments_file_magic || file_header->version != segments_file_version )
+    {
+        std::cerr << "Unknown segments file format: " << m_file_name << std::endl;
+        return false;
+    }
+
+    // Counts are bounded by the mapping first, so the size sum can't overflow
+    const size_t tables_size = m_data_size - sizeof ( header );
+    if (    file_header->segments_count > tables_size / sizeof ( segment )
+         || file_header->rings_count > tables_size / sizeof ( ring )
+         || file_header->points_count > tables_size / ( 2 * sizeof ( double ) ) )
+    {
+        std::cerr << "Segments file is truncated: " << m_file_name << std::endl;
+        return false;
+    }
+
+    const size_t expected_size = sizeof ( header )
+                               + file_header->segments_count * sizeof ( segment )
+                               + file_header->rings_count * sizeof ( ring )
+                               + file_header->points_count * 2 * sizeof ( double );
+    if ( expected_size != m_data_size )
+    {
+        std::cerr << "Segments file is truncated: " << m_file_name << std::endl;
+        return false;
+    }
+
+    const auto * file_segments = reinterpret_cast < const segment * > ( bytes + sizeof ( header ) );
+    const auto * file_rings = reinterpret_cast < const ring * > ( file_segments + file_header->segments_count );
+
+    // Accessors trust the tables, so every range is checked once here
+    for ( uint64_t i = 0; i < file_header->segments_count; ++i )
+    {
+        const auto &a_segment = file_segments [i];
+        if ( a_segment.first_ring > file_header->rings_count || a_segment.rings_count > file_header->rings_count - a_segment.first_ring )
+        {
+            std::cerr << "Segments file is corrupt, segment " << i << " rings are out of bounds: " << m_file_name << std::endl;
+            return false;
+        }
+    }
+
+    for ( uint64_t i = 0; i < file_header->rings_count; ++i )
+    {
+        const auto &a_ring = file_rings [i];
+        if ( a_ring.first_point > file_header->points_count || a_ring.points_count > file_header->points_count - a_ring.first_point )
+        {
+            std::cerr << "Segments file is corrupt, ring " << i << " points are out of bounds: " << m_file_name << std::endl;
+            return false;
+        }
+    }
+
+    m_segments = file_segments;
+    m_rings = file_rings;
+    m_points = reinterpret_cast < const double * > ( m_rings + file_header->rings_count );
+    m_header = file_header;
+
+    return true;
+}
+
+void segments_file::__unmap ()
+{
+    if ( m_data )
+        munmap ( m_data, m_data_size );
+
+    m_data = nullptr;
+    m_data_size = 0;
+    m_header = nullptr;
+    m_segments = nullptr;
+    m_rings = nullptr;
+    m_points = nullptr;
+}
+
+bool gdal::to_segments_file ( const std::string &file_name, const std::vector < const OGRGeometry * > &geometry_list )
+{
+    using header = segments_file::header;
+    using segment = segments_file::segment;
+    using ring = segments_file::ring;
+
+    std::vector < polygon > polygons;
+    {
+        quiet_errors quiet;
+        for ( const auto * geometry : geometry_list )
+            collect_polygons ( geometry, polygons );
+    }
+
+    std::vector < segment > segments;
+    std::vector < ring > rings;
+    std::vector < OGRRawPoint > points;
+    segments.reserve ( polygons.size () );
+
+    for ( const auto &a_polygon : polygons )
+    {
+        OGREnvelope envelope;
+        a_polygon->getEnvelope ( &envelope );
+
+        segments.push_back ( { envelope.MinX, envelope.MinY, envelope.MaxX, envelope.MaxY, rings.size (), 0 } );
+
+        for ( const auto * a_ring : a_polygon.get () )
+        {
+            const int count = a_ring->getNumPoints ();
+            rings.push_back ( { points.size (), uint64_t ( count ) } );
+
+            points.resize ( points.size () + count );
+            a_ring->getPoints ( points.data () + points.size () - count );
+            ++segments.back ().rings_count;
+        }
+    }
+
+    header file_header { segments_file_magic, segments_file_version, segments.size (), rings.size (), points.size () };
+
+    // Written aside and renamed, so mapped readers never see a partial file
+    const std::string temp_name = file_name + ".tmp";
+    {
+        std::ofstream out ( temp_name, std::ios::binary | std::ios::trunc );
+        if ( !out.is_open () )
+            return false;
+
+        out.write ( reinterpret_cast < const char * > ( &file_header ), sizeof ( file_header ) );
+        out.write ( reinterpret_cast < const char * > ( segments.data () ), segments.size () * sizeof ( segment ) );
+        out.write ( reinterpret_cast < const char * > ( rings.data () ), rings.size () * sizeof ( ring ) );
+        out.write ( reinterpret_cast < const char * > ( points.data () ), points.size () * sizeof ( OGRRawPoint ) );
+
+        if ( !out.good () )
+        {
+            out.close ();
+            std::remove ( temp_name.c_str () );
+            return false;
+        }
+    }
+
+    return std::rename ( temp_name.c_str (), file_name.c_str () ) == 0;
+}
+
+bool gdal::to_segments_file ( const std::string &file_name, const geometries &geometry_list )
+{
+    std::vector < const OGRGeometry * > raw;
+    raw.reserve ( geometry_list.size () );
+    for ( const auto &geometry : geometry_list )
+        raw.push_back ( geometry.get () );
+    return to_segments_file ( file_name, raw );
+}
+
+bool gdal::to_segments_file ( const std::string &file_name, const polygons &geometry_list )
+{
+    std::vector < const OGRGeometry * > raw;
+    raw.reserve ( geometry_list.size () );
+    for ( const auto &geometry : geometry_list )
+        raw.push_back ( geometry.get () );
+    return to_segments_file ( file_name, raw );
+}
+
+geometries gdal::from_segments_file ( const std::string &file_name, polygon spatial_filter )
+{
+    segments_file file ( file_name );
+    if ( !file.is_open () )
+        return {};
+    return file.read ( spatial_filter );
+}
+
+bool gdal::wkt_to_segments_file ( const std::string &wkt_file_name, const std::string &segments_file_name )
+{
+    std::ifstream file_stream ( wkt_file_name );
+    if ( !file_stream.is_open () )
+    {
+        std::cerr << "Unable to open WKT file: " << wkt_file_name << std::endl;
+        return false;
+    }
+
+    quiet_errors quiet;
+
+    geometries geometry_list;
+    std::string wkt_string;
+    while ( std::getline ( file_stream, wkt_string ) )
+    {
+        if ( wkt_string.empty () )
+            continue;
+
+        OGRGeometry * a_geometry = nullptr;
+        const char * wkt = wkt_string.c_str ();
+
+        if ( OGRGeometryFactory::createFromWkt ( &wkt, nullptr, &a_geometry ) != OGRERR_NONE )
+        {
+            std::cerr << "Error parsing WKT: " << wkt_string << std::endl;
+            continue;
+        }
+
+        geometry_list.push_back ( gdal::geometry ( a_geometry ) );
+    }
+
+    return to_segments_file ( segments_file_name, geometry_list );
+}
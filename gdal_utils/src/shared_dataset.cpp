@@ -90,7 +90,8 @@ gdal::shared_dataset gdal::open_subdataset ( const std::string & file_name, int
 	return gdal::open_dataset ( subds_name, mode, allowed_drivers, open_options, sibling_files );
 }
 
-gdal::shared_dataset gdal::create_dataset ( const std::string &driver_name, const std::string & file_name, int width, int height, int bands, GDALDataType type )
+gdal::shared_dataset gdal::create_dataset ( const std::string &driver_name, const std::string & file_name, int width, int height, int bands, GDALDataType type
+                                            , char ** options )
 {
     gdal_initer::all ();
 
@@ -98,7 +99,7 @@ gdal::shared_dataset gdal::create_dataset ( const std::string &driver_name, cons
     if ( driver == nullptr )
         return shared_dataset ();
 
-    return reinterpret_cast < GDALDataset * > ( driver->Create ( file_name.c_str (), width, height, bands, type, nullptr ) );
+    return reinterpret_cast < GDALDataset * > ( driver->Create ( file_name.c_str (), width, height, bands, type, options ) );
 }
 
 bool gdal::operator ! ( const shared_datasets &datasets )
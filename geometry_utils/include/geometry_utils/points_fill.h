@@ -1,12 +1,11 @@
 #pragma once
 
-#include <boost/geometry.hpp>
-#include <boost/geometry/geometries/polygon.hpp>
-#include <boost/geometry/geometries/point_xy.hpp>
 #include <gdal_utils/shared_geometry.h>
 
 namespace geometry
 {
+    // Prompt points for an object: positives are inside the polygon, negatives are around it. Both keep
+    // a distance from the polygon's boundary and from each other of the same kind ( Poisson-disk sampling ).
     class point_fill
     {
     public:
@@ -16,11 +15,13 @@ namespace geometry
             gdal::multipoint negative;
         }; // struct markup
 
-        point_fill ( const OGRPolygon * polygon );
-        point_fill ( gdal::polygon polygon );
+        // Negative seed means a non-deterministic sampling
+        point_fill ( const OGRPolygon * polygon, const int seed = -1 );
+        point_fill ( gdal::polygon polygon, const int seed = -1 );
 
         markup operator () () const;
     private:
         gdal::polygon m_polygon;
+        const int     m_seed;
     };
 }
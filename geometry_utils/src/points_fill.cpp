@@ -1,134 +1,363 @@
 #include "geometry_utils/points_fill.h"
 
+#include <cmath>
 #include <random>
+#include <vector>
+#include <algorithm>
 #include "eigen_utils/geometry.h"
 
-typedef boost::geometry::model::d2::point_xy<double> point_t;
-typedef boost::geometry::model::polygon<point_t> polygon_t;
+namespace
+{
+    struct xy
+    {
+        double x;
+        double y;
+    };
 
-typedef std::pair<point_t, unsigned> value_t;
-typedef boost::geometry::index::rtree<value_t, boost::geometry::index::quadratic<16>> rtree_t;
+    double squared_distance ( const xy &a, const xy &b )
+    {
+        return ( a.x - b.x ) * ( a.x - b.x ) + ( a.y - b.y ) * ( a.y - b.y );
+    }
 
-bool check_min_distance(const boost::geometry::index::rtree<value_t, boost::geometry::index::quadratic<16>>& rtree, const point_t& point, double min_distance)
-{
-    std::vector<value_t> result;
-    rtree.query(boost::geometry::index::nearest(point, 1), std::back_inserter(result));
+    double squared_distance ( const xy &p, const xy &a, const xy &b )
+    {
+        const double dx = b.x - a.x, dy = b.y - a.y;
+        const double length = dx * dx + dy * dy;
+        const double t = ( length > 0 ) ? std::clamp ( ( ( p.x - a.x ) * dx + ( p.y - a.y ) * dy ) / length, 0.0, 1.0 ) : 0.0;
+        return squared_distance ( p, { a.x + t * dx, a.y + t * dy } );
+    }
 
-    if (result.empty())
-        return true;
+    struct extent
+    {
+        xy min;
+        xy max;
 
-    return boost::geometry::distance(result[0].first, point) >= min_distance;
-}
+        bool contains ( const xy &p ) const
+        {
+            return p.x >= min.x && p.x <= max.x && p.y >= min.y && p.y <= max.y;
+        }
+    };
 
-polygon_t ogr_2_boost_polygon (gdal::polygon polygon)
-{
-    polygon_t boost_polygon;
+    // Inside/outside and boundary distance lookup over a background grid of the clearance size.
+    // Boundary is split to pieces not longer than the cell, every piece is registered in cells of its
+    // envelope, so all the pieces closer than the clearance to a point are in the point's 3x3 cells.
+    // Cells without pieces are entirely inside or outside and classified by row scanlines.
+    class boundary_field
+    {
+    public:
+        enum class state : uint8_t
+        {
+            outside,
+            inside,
+            boundary
+        };
+
+        boundary_field ( const std::vector < std::vector < xy > > &rings, const extent &area, const double clearance )
+            : m_area ( area ), m_cell ( clearance )
+        {
+            m_width = std::max ( 1, int ( std::ceil ( ( area.max.x - area.min.x ) / m_cell ) ) );
+            m_height = std::max ( 1, int ( std::ceil ( ( area.max.y - area.min.y ) / m_cell ) ) );
+
+            m_pieces.resize ( m_width * m_height );
+            m_rows.resize ( m_height );
+            m_states.assign ( m_width * m_height, state::outside );
 
-    OGRLinearRing* exteriorRing = polygon->getExteriorRing();
+            for ( const auto & ring : rings )
+            {
+                for ( size_t i = 0; i + 1 < ring.size (); ++i )
+                    __add_edge ( ring [i], ring [i + 1] );
+            }
+
+            // Even-odd scanline through the row's center classifies cells without boundary pieces
+            std::vector < double > crossings;
+            for ( int row = 0; row < m_height; ++row )
+            {
+                const double y = m_area.min.y + ( row + 0.5 ) * m_cell;
+
+                crossings.clear ();
+                for ( const auto edge : m_rows [row] )
+                {
+                    const auto & a = m_edges [edge].first, & b = m_edges [edge].second;
+                    if ( ( a.y > y ) != ( b.y > y ) )
+                        crossings.push_back ( a.x + ( y - a.y ) * ( b.x - a.x ) / ( b.y - a.y ) );
+                }
+                std::sort ( crossings.begin (), crossings.end () );
+
+                size_t passed = 0;
+                for ( int column = 0; column < m_width; ++column )
+                {
+                    const double x = m_area.min.x + ( column + 0.5 ) * m_cell;
+                    while ( passed < crossings.size () && crossings [passed] < x )
+                        ++passed;
+
+                    auto & cell_state = m_states [row * m_width + column];
+                    if ( !m_pieces [row * m_width + column].empty () )
+                        cell_state = state::boundary;
+                    else if ( passed % 2 )
+                        cell_state = state::inside;
+                }
+            }
+        }
 
-    for(int i = 0; i < exteriorRing->getNumPoints(); i++)
-        boost::geometry::append(boost_polygon, point_t (exteriorRing->getX(i), exteriorRing->getY(i)));
+        int  width  () const { return m_width; }
+        int  height () const { return m_height; }
+        double cell () const { return m_cell; }
+
+        state cell_state ( const int column, const int row ) const
+        {
+            return m_states [row * m_width + column];
+        }
+
+        xy cell_origin ( const int column, const int row ) const
+        {
+            return { m_area.min.x + column * m_cell, m_area.min.y + row * m_cell };
+        }
+
+        bool inside ( const xy &p ) const
+        {
+            int column, row;
+            if ( !__cell ( p, column, row ) )
+                return false;
+
+            const auto cell_state = m_states [row * m_width + column];
+            if ( cell_state != state::boundary )
+                return cell_state == state::inside;
+
+            // Exact even-odd test by the edges crossing the point's row
+            bool result = false;
+            for ( const auto edge : m_rows [row] )
+            {
+                const auto & a = m_edges [edge].first, & b = m_edges [edge].second;
+                if ( ( a.y > p.y ) != ( b.y > p.y ) && p.x < a.x + ( p.y - a.y ) * ( b.x - a.x ) / ( b.y - a.y ) )
+                    result = !result;
+            }
+
+            return result;
+        }
+
+        // Boundary is not closer than the clearance
+        bool clear ( const xy &p ) const
+        {
+            int column, row;
+            if ( !__cell ( p, column, row ) )
+                return true;
+
+            const double clearance = m_cell * m_cell;
+            for ( int y = std::max ( row - 1, 0 ); y <= std::min ( row + 1, m_height - 1 ); ++y )
+                for ( int x = std::max ( column - 1, 0 ); x <= std::min ( column + 1, m_width - 1 ); ++x )
+                    for ( const auto & piece : m_pieces [y * m_width + x] )
+                        if ( squared_distance ( p, piece.first, piece.second ) < clearance )
+                            return false;
+
+            return true;
+        }
+
+    private:
+        const extent    m_area;
+        const double    m_cell;
+        int             m_width;
+        int             m_height;
+
+        std::vector < std::pair < xy, xy > >                    m_edges;
+        std::vector < std::vector < int > >                     m_rows;
+        std::vector < std::vector < std::pair < xy, xy > > >    m_pieces;
+        std::vector < state >                                   m_states;
+
+        bool __cell ( const xy &p, int &column, int &row ) const
+        {
+            column = int ( std::floor ( ( p.x - m_area.min.x ) / m_cell ) );
+            row = int ( std::floor ( ( p.y - m_area.min.y ) / m_cell ) );
+            return column >= 0 && row >= 0 && column < m_width && row < m_height;
+        }
 
-    for(int i = 0; i < polygon->getNumInteriorRings(); i++)
+        int __clamp_row ( const double y ) const
+        {
+            return std::clamp ( int ( std::floor ( ( y - m_area.min.y ) / m_cell ) ), 0, m_height - 1 );
+        }
+
+        int __clamp_column ( const double x ) const
+        {
+            return std::clamp ( int ( std::floor ( ( x - m_area.min.x ) / m_cell ) ), 0, m_width - 1 );
+        }
+
+        void __add_edge ( const xy &a, const xy &b )
+        {
+            const int edge = m_edges.size ();
+            m_edges.push_back ( { a, b } );
+
+            for ( int row = __clamp_row ( std::min ( a.y, b.y ) ); row <= __clamp_row ( std::max ( a.y, b.y ) ); ++row )
+                m_rows [row].push_back ( edge );
+
+            const int pieces = std::max ( 1, int ( std::ceil ( std::sqrt ( squared_distance ( a, b ) ) / m_cell ) ) );
+            for ( int i = 0; i < pieces; ++i )
+            {
+                const double t0 = double ( i ) / pieces, t1 = double ( i + 1 ) / pieces;
+                const xy from { a.x + t0 * ( b.x - a.x ), a.y + t0 * ( b.y - a.y ) };
+                const xy to { a.x + t1 * ( b.x - a.x ), a.y + t1 * ( b.y - a.y ) };
+
+                for ( int row = __clamp_row ( std::min ( from.y, to.y ) ); row <= __clamp_row ( std::max ( from.y, to.y ) ); ++row )
+                    for ( int column = __clamp_column ( std::min ( from.x, to.x ) ); column <= __clamp_column ( std::max ( from.x, to.x ) ); ++column )
+                        m_pieces [row * m_width + column].push_back ( { from, to } );
+            }
+        }
+    }; // class boundary_field
+
+    // Bridson's Poisson-disk sampling of a possibly disconnected region. The region's components are
+    // seeded by a pass over the boundary field cells which may contain region points.
+    template < class Valid >
+    std::vector < xy > poisson_disk ( const boundary_field &field, const boundary_field::state region_state, const extent &area,
+                                      const double radius, const Valid &valid, std::mt19937 &engine )
     {
-        OGRLinearRing* interiorRing = polygon->getInteriorRing(i);
-        boost::geometry::model::ring<point_t> boostInteriorRing;
+        const int attempts = 30;
+        const double cell = radius / std::sqrt ( 2.0 );
+        const int width = std::max ( 1, int ( std::ceil ( ( area.max.x - area.min.x ) / cell ) ) );
+        const int height = std::max ( 1, int ( std::ceil ( ( area.max.y - area.min.y ) / cell ) ) );
 
-        for(int j = 0; j < interiorRing->getNumPoints(); j++)
-            boost::geometry::append(boostInteriorRing, point_t(interiorRing->getX(j), interiorRing->getY(j)));
+        std::vector < int > grid ( width * height, -1 );
+        std::vector < xy > points;
+        std::vector < int > active;
 
-        boost_polygon.inners().push_back(boostInteriorRing);
-    }
+        auto grid_cell = [&] ( const xy &p, int &column, int &row )
+        {
+            column = std::clamp ( int ( ( p.x - area.min.x ) / cell ), 0, width - 1 );
+            row = std::clamp ( int ( ( p.y - area.min.y ) / cell ), 0, height - 1 );
+        };
+
+        auto spaced = [&] ( const xy &p )
+        {
+            int column, row;
+            grid_cell ( p, column, row );
+            for ( int y = std::max ( row - 2, 0 ); y <= std::min ( row + 2, height - 1 ); ++y )
+                for ( int x = std::max ( column - 2, 0 ); x <= std::min ( column + 2, width - 1 ); ++x )
+                {
+                    const int id = grid [y * width + x];
+                    if ( id >= 0 && squared_distance ( points [id], p ) < radius * radius )
+                        return false;
+                }
+            return true;
+        };
+
+        auto accept = [&] ( const xy &p )
+        {
+            if ( !area.contains ( p ) || !spaced ( p ) || !valid ( p ) )
+                return false;
+
+            int column, row;
+            grid_cell ( p, column, row );
+            grid [row * width + column] = points.size ();
+            active.push_back ( points.size () );
+            points.push_back ( p );
+            return true;
+        };
+
+        std::uniform_real_distribution < double > unit ( 0.0, 1.0 );
+
+        for ( int row = 0; row < field.height (); ++row )
+        {
+            for ( int column = 0; column < field.width (); ++column )
+            {
+                const auto cell_state = field.cell_state ( column, row );
+                if ( cell_state != region_state && cell_state != boundary_field::state::boundary )
+                    continue;
+
+                // Pure cells are seeded by the center, boundary ones by random attempts
+                const xy origin = field.cell_origin ( column, row );
+                bool seeded = false;
+                if ( cell_state == region_state )
+                    seeded = accept ( { origin.x + field.cell () / 2, origin.y + field.cell () / 2 } );
+                else
+                    for ( int i = 0; i < attempts && !seeded; ++i )
+                        seeded = accept ( { origin.x + unit ( engine ) * field.cell (), origin.y + unit ( engine ) * field.cell () } );
+
+                while ( !active.empty () )
+                {
+                    const int index = std::uniform_int_distribution < int > ( 0, active.size () - 1 ) ( engine );
+                    const xy center = points [active [index]];
+
+                    bool found = false;
+                    for ( int i = 0; i < attempts && !found; ++i )
+                    {
+                        const double angle = 2.0 * M_PI * unit ( engine );
+                        const double distance = radius * std::sqrt ( 1.0 + 3.0 * unit ( engine ) );
+                        found = accept ( { center.x + distance * std::cos ( angle ), center.y + distance * std::sin ( angle ) } );
+                    }
+
+                    if ( !found )
+                    {
+                        active [index] = active.back ();
+                        active.pop_back ();
+                    }
+                }
+            }
+        }
 
-    return boost_polygon;
+        return points;
+    }
 }
 
-geometry::point_fill::point_fill ( const OGRPolygon * polygon )
-    : m_polygon ( polygon->clone () )
+geometry::point_fill::point_fill ( const OGRPolygon * polygon, const int seed )
+    : m_polygon ( polygon->clone () ), m_seed ( seed )
 {
 
 }
 
-geometry::point_fill::point_fill ( gdal::polygon polygon )
-    : m_polygon ( polygon )
+geometry::point_fill::point_fill ( gdal::polygon polygon, const int seed )
+    : m_polygon ( polygon ), m_seed ( seed )
 {
 }
 
 geometry::point_fill::markup geometry::point_fill::operator () () const
 {
     // Define your parameters for point sampling and distance calculation
-    double step_size = 1.0;
     double min_negative_distance = 30.0;
     double min_internal_distance = 15.0;
     double min_external_distance = 7.0;
     double bbox_enlarge_value = 50;
 
-    gdal::polygon ogr_poly ( m_polygon->clone () );
-    gdal::bbox poly_bbox ( ogr_poly );
+    gdal::bbox poly_bbox ( m_polygon );
     poly_bbox.bufferize ( { bbox_enlarge_value, bbox_enlarge_value } );
-    ogr_poly->segmentize ( step_size );
 
-    auto poly = ogr_2_boost_polygon ( ogr_poly );
+    const extent area { { poly_bbox.top_left().x (), poly_bbox.top_left().y () },
+                        { poly_bbox.bottom_right().x (), poly_bbox.bottom_right().y () } };
 
-    point_t center;
-    boost::geometry::centroid ( poly, center );
+    std::vector < std::vector < xy > > rings;
+    auto add_ring = [&rings] ( const OGRLinearRing * ring )
+    {
+        std::vector < xy > points;
+        for ( int i = 0; i < ring->getNumPoints(); ++i )
+            points.push_back ( { ring->getX(i), ring->getY(i) } );
+        rings.push_back ( std::move ( points ) );
+    };
 
-    rtree_t internal;
-    rtree_t external;
-    rtree_t negative;
+    add_ring ( m_polygon->getExteriorRing() );
+    for ( int i = 0; i < m_polygon->getNumInteriorRings(); ++i )
+        add_ring ( m_polygon->getInteriorRing(i) );
 
-    // prefill rtree with polygon
-    for ( auto const& point: boost::geometry::exterior_ring (poly) )
-        external.insert ( std::make_pair ( point, 0 ) );
+    boundary_field field ( rings, area, min_external_distance );
+
+    std::mt19937 eng ( ( m_seed < 0 ) ? std::random_device () () : m_seed );
+
+    auto positives = poisson_disk ( field, boundary_field::state::inside, area, min_internal_distance,
+                                    [&field] ( const xy &p ) { return field.inside ( p ) && field.clear ( p ); }, eng );
+    auto negatives = poisson_disk ( field, boundary_field::state::outside, area, min_negative_distance,
+                                    [&field] ( const xy &p ) { return !field.inside ( p ) && field.clear ( p ); }, eng );
 
     markup result;
     result.positive = gdal::instance < gdal::multipoint > ();
     result.negative = gdal::instance < gdal::multipoint > ();
 
-    std::random_device rd;
-    std::mt19937 eng(rd());
-
-    const int bbox_square = ( poly_bbox.bottom_right().x () - poly_bbox.top_left().x () )
-            * ( poly_bbox.bottom_right().y () - poly_bbox.top_left().y () );
-    const int samples_count = bbox_square / 10;
-    std::uniform_int_distribution<> dx (poly_bbox.top_left().x (), poly_bbox.bottom_right().x ());
-    std::uniform_int_distribution<> dy (poly_bbox.top_left().y (), poly_bbox.bottom_right().y ());
-
-    //for (double y = poly_bbox.top_left().y (); y <= poly_bbox.bottom_right().y (); y += step_size)
-    for ( int i = 0; i < samples_count; ++i )
-    {
-        //for (double x = poly_bbox.top_left().x (); x <= poly_bbox.bottom_right().x (); x += step_size)
-        {
-            const double x = dx ( eng );
-            const double y = dy ( eng );
-
-            point_t point{x, y};
-            if (boost::geometry::within(point, poly) && check_min_distance(internal, point, min_internal_distance)
-                    && check_min_distance(external, point, min_external_distance) )
-            {
-                auto ogr_point = new OGRPoint ( x, y );
-
-                result.positive->addGeometryDirectly( ogr_point );
-                internal.insert(std::make_pair(point, 0));
-            }
+    for ( const auto & point : positives )
+        result.positive->addGeometryDirectly( new OGRPoint ( point.x, point.y ) );
 
-            if (!boost::geometry::within(point, poly) && check_min_distance(negative, point, min_negative_distance)
-                    && check_min_distance(external, point, min_external_distance) )
-            {
-                auto ogr_point = new OGRPoint ( x, y );
-
-                result.negative->addGeometryDirectly( ogr_point );
-                negative.insert(std::make_pair(point, 0));
-            }
-        }
-    }
+    for ( const auto & point : negatives )
+        result.negative->addGeometryDirectly( new OGRPoint ( point.x, point.y ) );
 
     if ( result.positive->getNumGeometries() == 0 )
     {
-        auto ogr_center = new OGRPoint ( center.x (), center.y () );
-        result.positive->addGeometryDirectly( ogr_center );
+        OGRPoint center;
+        m_polygon->Centroid ( &center );
+        result.positive->addGeometryDirectly( center.clone () );
     }
 
     return std::move ( result );
 }
-
@@ -85,7 +85,7 @@ int main ( int argc, char * argv[] )
         if ( !iou_match_thresh_helper.verify ( std::cerr,    "STOP: IoU match threshold value is incorrect." ) )
             return 1;
 
-        value_helper < double > iou_min_thresh_helper      ( iou_match_thresh_param.value() );
+        value_helper < double > iou_min_thresh_helper      ( iou_min_thresh_param.value() );
         if ( !iou_min_thresh_helper.verify ( std::cerr,    "STOP: IoU min threshold value is incorrect." ) )
             return 1;
 
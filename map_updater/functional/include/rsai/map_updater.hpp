@@ -2,6 +2,7 @@
 
 #include "rsai/map_updater.h"
 
+#include <unordered_map>
 #include <ogrsf_frmts.h>
 
 #include "gdal_utils/all_helpers.h"
@@ -14,89 +15,30 @@
 
 #include "common/definitions.h"
 
-struct features_with_iou
+// Collisions of a feature with the features of the opposite map
+struct match_summary
 {
-    gdal::shared_feature feature;
+    int collisions = 0;
     double iou = 0;
 
-    bool operator > ( const features_with_iou &rh ) { return iou > rh.iou; }
-};
-
-std::list < gdal::shared_feature > get_difference ( gdal::ogr_layer * verified, gdal::ogr_layer * base, OGRGeometry * update_region, const double iou_match_thresh, const double iou_min_thresh )
-{
-    verified->SetSpatialFilter ( update_region );
-    verified->ResetReading ();
+    // Object is almost the same - the only one reasonable collision with high IoU
+    bool is_matched ( const double iou_match_thresh ) const { return collisions == 1 && iou > iou_match_thresh; }
 
-    std::list < gdal::shared_feature > result;
-
-    threading::layer_iterator a_layer_iterator ( verified );
-    auto layer_result = a_layer_iterator ( [&] ( gdal::shared_feature feature, const int current_feature_id )
-    {
-        OGRGeometry *geometry = feature->GetGeometryRef ();
-
-        base->SetSpatialFilter ( geometry );
-        base->ResetReading();
-
-        std::vector < features_with_iou > collisions;
-        while ( gdal::shared_feature older_feature = base->GetNextFeature() )
-        {
-            auto iou_value = gdal::iou ( geometry, older_feature->GetGeometryRef() );
-;
-            if ( iou_value > iou_min_thresh )
-                collisions.push_back ( { older_feature, iou_value } );
-        }
-
-        // Object is almost the same
-        if ( collisions.size() > 0 )
-        {
-
-            if ( collisions.front().iou > iou_match_thresh && collisions.size() == 1 )
-                return;
-            else
-                result.push_back ( feature );
-        }
-        else
-            result.push_back ( feature );
-
-    }, 0, 1, console_progress_layers, 1 );
-
-    return std::move ( result );
-}
+    void add ( const double iou_value ) { if ( collisions++ == 0 ) iou = iou_value; }
+};
 
-std::list < gdal::shared_feature > get_matching ( gdal::ogr_layer * verified, gdal::ogr_layer * base, const double iou_match_thresh, const double iou_min_thresh )
+static bool write_feature ( OGRLayer * layer, const gdal::shared_feature &feature, const std::string &layer_name )
 {
-    verified->SetSpatialFilter ( nullptr );
-    verified->ResetReading ();
-
-    std::list < gdal::shared_feature > result;
+    if ( layer == nullptr )
+        return true;
 
-    threading::layer_iterator a_layer_iterator ( verified );
-    auto layer_result = a_layer_iterator ( [&] ( gdal::shared_feature feature, const int current_feature_id )
+    if( layer->CreateFeature( feature.get () ) != OGRERR_NONE )
     {
-        OGRGeometry *geometry = feature->GetGeometryRef ();
-
-        base->SetSpatialFilter ( geometry );
-        base->ResetReading();
-
-        std::vector < features_with_iou > collisions;
-        while ( gdal::shared_feature older_feature = base->GetNextFeature() )
-        {
-            auto iou_value = gdal::iou ( geometry, older_feature->GetGeometryRef() );
-;
-            if ( iou_value > iou_min_thresh )
-                collisions.push_back ( { older_feature, iou_value } );
-        }
-
-        // Object is almost the same
-        if ( collisions.size() > 0 )
-        {
-            if ( collisions.front().iou > iou_match_thresh && collisions.size() == 1 )
-                result.push_back ( feature );
-        }
-
-    }, 0, 1, console_progress_layers, 1 );
+        std::cerr << "Stop: Failed to create feature in layer " << layer_name << std::endl;
+        return false;
+    }
 
-    return std::move ( result );
+    return true;
 }
 
 template < class PromtFunc, class ProgressFunc >
@@ -123,72 +65,106 @@ rsai::map_updater::map_updater (
         auto new_layer = ds_vector->GetLayer ( i );
         auto updating_layer = ds_updating->GetLayer ( i );
 
-        std::cout << "Finding new objects...\n";
-        auto upcomming = get_difference ( new_layer, updating_layer, roi.get(), iou_match_thresh, iou_min_thresh );
-
-        std::cout << "Finding outdated objects...\n";
-        auto outdated = get_difference ( updating_layer, new_layer, roi.get(), iou_match_thresh, iou_min_thresh );
-
-        std::cout << "Finding remaining objects...\n";
-        auto retained = get_matching ( updating_layer, new_layer, iou_match_thresh, iou_min_thresh );
+        // Creating output layers before matching to stream the results directly
+        gdal::create_vector_helper layers_helper ( ds_out, std::cerr );
 
-        std::cout << "Retained " << retained.size () << " objects, deleted " << outdated.size() << " created " << upcomming.size () << '\n';
+        OGRLayer * outdated_layer = nullptr;
+        OGRLayer * upcomming_layer = nullptr;
+        OGRLayer * updated_layer = nullptr;
 
         if ( save_difference )
         {
-            gdal::create_vector_helper layers_helper ( ds_out, std::cerr );
-            auto outdated_layer = layers_helper.create_layer ( DEFAULT_OUTDATED_LAYER_NAME, updating_layer->GetGeomType (), updating_layer->GetSpatialRef()
-                                                               , true, promt_func );
+            outdated_layer = layers_helper.create_layer ( DEFAULT_OUTDATED_LAYER_NAME, updating_layer->GetGeomType (), updating_layer->GetSpatialRef()
+                                                          , true, promt_func );
             if ( !outdated_layer )
                 continue;
 
-            for ( auto feature : outdated )
-            {
-                if( outdated_layer->CreateFeature( feature.get () ) != OGRERR_NONE )
-                {
-                    std::cerr << "Stop: Failed to create feature in layer " << DEFAULT_OUTDATED_LAYER_NAME << std::endl;
-                    return;
-                }
-            }
-
-            auto upcomming_layer = layers_helper.create_layer ( DEFAULT_UPCOMMING_LAYER_NAME, updating_layer->GetGeomType (), updating_layer->GetSpatialRef()
-                                                               , true, promt_func );
+            upcomming_layer = layers_helper.create_layer ( DEFAULT_UPCOMMING_LAYER_NAME, updating_layer->GetGeomType (), updating_layer->GetSpatialRef()
+                                                           , true, promt_func );
             if ( !upcomming_layer )
                 continue;
-
-            for ( auto feature : upcomming )
-            {
-                if( upcomming_layer->CreateFeature( feature.get () ) != OGRERR_NONE )
-                {
-                    std::cerr << "Stop: Failed to create feature in layer " << DEFAULT_UPCOMMING_LAYER_NAME << std::endl;
-                    return;
-                }
-            }
         }
 
         if ( save_updated )
         {
-            gdal::create_vector_helper layers_helper ( ds_out, std::cerr );
-            auto updated_layer = layers_helper.create_layer ( DEFAULT_UPDATED_LAYER_NAME, updating_layer->GetGeomType (), updating_layer->GetSpatialRef()
-                                                              , true, promt_func );
+            updated_layer = layers_helper.create_layer ( DEFAULT_UPDATED_LAYER_NAME, updating_layer->GetGeomType (), updating_layer->GetSpatialRef()
+                                                         , true, promt_func );
+            if ( !updated_layer )
+                continue;
+        }
+
+        // Newer features' collisions collected while matching the updating map, keyed by FID
+        std::unordered_map < GIntBig, match_summary > new_matches;
+
+        int retained = 0, outdated = 0, upcomming = 0;
+        bool written = true;
+
+        std::cout << "Matching objects...\n";
+
+        // Single matching pass: every candidate pair's IoU is calculated once
+        updating_layer->SetSpatialFilter ( nullptr );
+        updating_layer->ResetReading ();
+
+        threading::layer_iterator a_layer_iterator ( updating_layer );
+        auto layer_result = a_layer_iterator ( [&] ( gdal::shared_feature feature, const int current_feature_id )
+        {
+            if ( !written )
+                return;
+
+            OGRGeometry *geometry = feature->GetGeometryRef ();
+
+            new_layer->SetSpatialFilter ( geometry );
+            new_layer->ResetReading();
 
-            for ( auto feature : upcomming )
+            match_summary old_match;
+            while ( gdal::shared_feature newer_feature = new_layer->GetNextFeature() )
             {
-                if( updated_layer->CreateFeature( feature.get () ) != OGRERR_NONE )
+                auto iou_value = gdal::iou ( geometry, newer_feature->GetGeometryRef() );
+
+                if ( iou_value > iou_min_thresh )
                 {
-                    std::cerr << "Stop: Failed to create feature in layer " << DEFAULT_UPDATED_LAYER_NAME << std::endl;
-                    return;
+                    old_match.add ( iou_value );
+                    new_matches [newer_feature->GetFID ()].add ( iou_value );
                 }
             }
 
-            for ( auto feature : retained )
+            if ( old_match.is_matched ( iou_match_thresh ) )
             {
-                if( updated_layer->CreateFeature( feature.get () ) != OGRERR_NONE )
-                {
-                    std::cerr << "Stop: Failed to create feature in layer " << DEFAULT_UPDATED_LAYER_NAME << std::endl;
-                    return;
-                }
+                ++retained;
+                written &= write_feature ( updated_layer, feature, DEFAULT_UPDATED_LAYER_NAME );
+            }
+            else if ( roi == nullptr || ( geometry != nullptr && roi->Intersects ( geometry ) ) )
+            {
+                ++outdated;
+                written &= write_feature ( outdated_layer, feature, DEFAULT_OUTDATED_LAYER_NAME );
             }
+
+        }, 0, 1, progress_func, 1 );
+
+        if ( !written )
+            return;
+
+        // Newer objects within the region are classified by the collected collisions, no IoU recalculation
+        std::cout << "Collecting new objects...\n";
+
+        new_layer->SetSpatialFilter ( roi.get () );
+        new_layer->ResetReading ();
+
+        while ( gdal::shared_feature feature = new_layer->GetNextFeature() )
+        {
+            const auto match = new_matches.find ( feature->GetFID () );
+            if ( match != new_matches.end () && match->second.is_matched ( iou_match_thresh ) )
+                continue;
+
+            ++upcomming;
+
+            if ( !write_feature ( upcomming_layer, feature, DEFAULT_UPCOMMING_LAYER_NAME )
+                 || !write_feature ( updated_layer, feature, DEFAULT_UPDATED_LAYER_NAME ) )
+                return;
         }
+
+        new_layer->SetSpatialFilter ( nullptr );
+
+        std::cout << "Retained " << retained << " objects, deleted " << outdated << " created " << upcomming << '\n';
     }
 }
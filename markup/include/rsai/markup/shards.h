@@ -0,0 +1,106 @@
+#pragma once
+
+#include <set>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <fstream>
+#include <cstdint>
+
+#include "common/string_utils.h"
+#include "common/definitions.h"
+
+namespace rsai
+{
+
+    namespace markup
+    {
+        // Sample part, e.g. an encoded image or an annotation, stored as <key><extension>
+        struct shard_member
+        {
+            std::string extension;
+            std::string data;
+        };
+
+        struct shard_sample
+        {
+            std::string                     key;
+            std::vector < shard_member >    members;
+
+            const shard_member *    find ( const std::string &extension ) const;
+        };
+
+        // Writes samples to tar (ustar) shards <prefix>-NNNNN.tar of about target_size bytes. Members of a sample
+        // are stored contiguously in one shard. Every shard has a text index <prefix>-NNNNN.idx of
+        // "key<TAB>extension<TAB>data offset<TAB>data size" lines. Both are written as .part files and renamed
+        // when the shard is completed, so the index presence marks a complete shard. Numbering continues
+        // after already existing shards of the prefix.
+        class shard_writer
+        {
+        public:
+            shard_writer ( const std::string &directory, const std::string &prefix, const size_t target_size = DEFAULT_MARKUP_SHARD_SIZE );
+            ~shard_writer ();
+
+            shard_writer ( const shard_writer & ) = delete;
+            shard_writer & operator = ( const shard_writer & ) = delete;
+
+            // Thread-safe, samples are stored in calls order
+            bool        write   ( const shard_sample &sample );
+            // Stores a file as a single member sample keyed by the file path relative to the shards' directory
+            // without extension, e.g. variants/roofs/12_tile
+            bool        write_file ( const std::string &file_name, const std::vector < unsigned char > &data );
+            bool        close   ();
+
+            int         shards  () const;
+
+        private:
+            const std::string   m_directory;
+            const std::string   m_prefix;
+            const size_t        m_target_size;
+
+            int                 m_next_shard = 0;
+            int                 m_shards = 0;
+            std::string         m_shard_name;
+            std::ofstream       m_tar;
+            std::ofstream       m_index;
+            uint64_t            m_size = 0;
+            bool                m_failed = false;
+
+            mutable std::mutex  m_lock;
+
+            bool                __open  ();
+            bool                __close ();
+        }; // class shard_writer
+
+        // Streams samples of completed shards sequentially, in shards and index order
+        class shard_reader
+        {
+        public:
+            shard_reader ( const std::string &directory, const std::string &prefix );
+
+            bool                    next    ( shard_sample &sample );
+            size_t                  size    () const;
+            std::set < std::string > keys   () const;
+
+            // Completed shards of the prefix without extension, in numbering order
+            static strings          shards  ( const std::string &directory, const std::string &prefix );
+
+        private:
+            struct entry
+            {
+                std::string key;
+                std::string extension;
+                uint64_t    offset;
+                uint64_t    size;
+            };
+
+            const strings           m_shards;
+            std::vector < std::vector < entry > > m_entries;
+            size_t                  m_shard = 0;
+            size_t                  m_entry = 0;
+            std::ifstream           m_tar;
+        }; // class shard_reader
+
+    } // namespace markup
+
+} // namespace rsai
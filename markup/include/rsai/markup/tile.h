@@ -7,6 +7,10 @@
 #include "eigen_utils/geometry.h"
 #include "common/definitions.h"
 #include "opencv_utils/raster_roi.h"
+#include "gdal_utils/spatial_index.h"
+
+#include <memory>
+#include <thread>
 
 namespace rsai
 {
@@ -21,11 +25,17 @@ namespace rsai
 
             bool                populate ( gdal::shared_dataset vector, const strings &layers );
             bool                populate ( gdal::ogr_layer * layer );
+            // Adds geometries given in raster coordinates to the layer's population
+            bool                populate ( const std::string &layer_name, const gdal::geometries &raster_geometries );
 
             gdal::polygon       world_border () const;
             gdal::bbox          world_bbox () const;
+            const gdal::bbox &  raster_bbox () const;
 
             cv::Mat             image () const;
+            // Reading by another extractor, e.g. over a thread's own raster handle
+            cv::Mat             image ( const opencv::dataset_roi_extractor &extractor ) const;
+            gdal::shared_dataset raster () const;
             cv::Mat             render ();
 
             bool                populated () const;
@@ -37,6 +47,7 @@ namespace rsai
             const std::map < std::string, gdal::geometries > &  population () const;
 
         private:
+            gdal::shared_dataset                        m_raster;
             opencv::dataset_roi_extractor               m_extractor;
             mutable gdal::bbox                          m_bbox;
             std::map < std::string, gdal::geometries >  m_population;
@@ -60,6 +71,30 @@ namespace rsai
 
         }; // class tile_generator
 
+        // Bulk alternative to tile::populate: every layer is read once, transformed to raster coordinates
+        // and indexed, then tiles collect their population from the index in parallel
+        class tile_populator
+        {
+        public:
+            tile_populator ( gdal::shared_dataset vector, const strings &layers, gdal::shared_dataset raster );
+
+            // Tiles of other rasters are populated from the vector layers directly. Returns populated tiles count.
+            int operator () ( tiles &tls, const int threads = std::thread::hardware_concurrency () ) const;
+
+        private:
+            struct layer_index
+            {
+                std::string                                         name;
+                gdal::geometries                                    geometries;
+                std::unique_ptr < gdal::spatial_index < size_t > >  index;
+            };
+
+            gdal::shared_dataset        m_vector;
+            gdal::shared_dataset        m_raster;
+            const strings               m_layer_names;
+            std::vector < layer_index > m_layers;
+        }; // class tile_populator
+
         class tile_balancer
         {
         public:
@@ -19,6 +19,8 @@ namespace rsai
         tile_saver ( const std::string &path, gdal::shared_dataset raster );
 
         gdal::bbox operator () ( gdal::shared_feature feature, const int tile_buffer_size = 0 );
+        // Encodes the tile to the buffer instead of a file
+        gdal::bbox operator () ( gdal::shared_feature feature, std::vector < uchar > &encoded, const int tile_buffer_size = 0 );
 
         gdal::bbox get_bbox ( gdal::shared_feature feature, const int tile_buffer_size = 0 ) const;
 
@@ -4,6 +4,8 @@
 #include "rsai/markup/tile.h"
 
 #include <memory>
+#include <thread>
+#include <functional>
 #include "common/progress_functions.hpp"
 
 namespace rsai
@@ -17,49 +19,104 @@ namespace rsai
         update
     };
 
+    // Parses DEFAULT_MARKUP_*_MODE values, write_mode::invalid otherwise
+    write_mode write_mode_from_string ( const std::string &mode );
+
     namespace markup
     {
         enum class markup_type
         {
             invalid,
             yolo,
+            yolo_shards,
             coco
         };
 
+        // Parses --format values, markup_type::invalid otherwise
+        markup_type markup_type_from_string ( const std::string &type );
+
         enum class markup_part
         {
             train,
             valid
         };
 
+        // Image encoding parameters, quality is in [0,100] for jpg/webp and mapped to compression level for png
+        struct image_codec
+        {
+            std::string extension = DEFAULT_MARKUP_IMAGE_FORMAT;
+            int         quality   = DEFAULT_MARKUP_IMAGE_QUALITY;
+
+            std::vector < int > params () const;
+        };
+
         class writer;
         using writer_ptr = std::shared_ptr < writer >;
 
         class writer
         {
         public:
-            writer ( const strings &classes );
+            writer ( const strings &classes, const image_codec &codec = {}, const int threads = std::thread::hardware_concurrency () );
             virtual bool save ( const tiles &tls, const std::string &path, const markup_part part, write_mode mode = write_mode::append, bool show_progress = true ) const = 0;
 
-            static writer_ptr get_writer ( const markup_type type, const strings &classes );
+            static writer_ptr get_writer ( const markup_type type, const strings &classes, const image_codec &codec = {},
+                                           const int threads = std::thread::hardware_concurrency (),
+                                           const size_t shard_size = DEFAULT_MARKUP_SHARD_SIZE );
 
         protected:
             std::map < std::string, int > m_classes;
+            const image_codec             m_codec;
+            const int                     m_threads;
         };
 
         class yolo_writer
                 : public writer
         {
         public:
-            yolo_writer ( const strings &classes );
+            yolo_writer ( const strings &classes, const image_codec &codec = {}, const int threads = std::thread::hardware_concurrency () );
+            // Tiles are read and encoded by a worker pool, the index file is appended strictly in tiles order
+            // by a single writer. Under write_mode::update tiles already listed in the index are skipped,
+            // so an interrupted dataset is completed by the repeated call.
             virtual bool save ( const tiles &tls, const std::string &path, const markup_part part, write_mode mode = write_mode::append, bool show_progress = true ) const override;
 
-        private:
+        protected:
+            struct encoded_tile
+            {
+                std::string         name;
+                std::vector < uchar > image;
+                std::string         markup;
+            };
+
+            // Called by pool workers for every encoded tile
+            using tile_store  = std::function < bool ( encoded_tile & ) >;
+            // Called by a single writer in tiles order for every stored tile
+            using tile_commit = std::function < void ( encoded_tile & ) >;
+
+            bool        __encode_tiles ( const std::vector < const tile * > &tls, const tile_store &store,
+                                         const tile_commit &commit, bool show_progress ) const;
+            bool        __encode_tile ( const tile &a_tile, const cv::Mat &image, encoded_tile &encoded ) const;
+            static std::string __tile_name ( const tile &a_tile );
+
             std::string __geometry_to_yolo(OGRGeometry *geometry, int tile_width, int tile_height, int class_id) const;
             std::string __geometries_to_yolo(const gdal::geometries& geometries, int tile_width, int tile_height, int class_id) const;
             bool        __write_class_names ( const std::string &path ) const;
             bool        __write_data_file   ( const std::string &path ) const;
         };
+
+        // Same samples as yolo_writer, packed into tar shards <path>/<part>-NNNNN.tar with per-shard
+        // indices ( see shard_writer ) instead of a file pair per tile. Shards are read back by shard_reader.
+        class yolo_shards_writer
+                : public yolo_writer
+        {
+        public:
+            yolo_shards_writer ( const strings &classes, const image_codec &codec = {}, const int threads = std::thread::hardware_concurrency (),
+                                 const size_t shard_size = DEFAULT_MARKUP_SHARD_SIZE );
+            // Under write_mode::update samples already stored in completed shards are skipped
+            virtual bool save ( const tiles &tls, const std::string &path, const markup_part part, write_mode mode = write_mode::append, bool show_progress = true ) const override;
+
+        private:
+            const size_t m_shard_size;
+        };
     } // namespace markup
 
 } // namespace rsai
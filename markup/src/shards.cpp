@@ -0,0 +1,345 @@
+#include "rsai/markup/shards.h"
+
+#include <ctime>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+
+using namespace rsai::markup;
+
+namespace
+{
+    const size_t tar_block = 512;
+    const std::string tar_ext = ".tar";
+    const std::string index_ext = ".idx";
+    const std::string part_ext = ".part";
+
+    void put_octal ( char * field, const size_t width, const uint64_t value )
+    {
+        std::ostringstream stream;
+        stream << std::oct << std::setw ( width - 1 ) << std::setfill ( '0' ) << value;
+        std::memcpy ( field, stream.str ().c_str (), width - 1 );
+        field [width - 1] = '\0';
+    }
+
+    // ustar header of a regular file
+    std::vector < char > tar_header ( const std::string &name, const uint64_t size )
+    {
+        std::vector < char > header ( tar_block, '\0' );
+
+        std::memcpy ( header.data (), name.c_str (), name.size () );
+        put_octal ( &header [100], 8, 0644 );
+        put_octal ( &header [108], 8, 0 );
+        put_octal ( &header [116], 8, 0 );
+        put_octal ( &header [124], 12, size );
+        put_octal ( &header [136], 12, std::time ( nullptr ) );
+        header [156] = '0';
+        std::memcpy ( &header [257], "ustar", 6 );
+        std::memcpy ( &header [263], "00", 2 );
+
+        // Checksum is calculated with the checksum field filled by spaces
+        std::memset ( &header [148], ' ', 8 );
+        unsigned int checksum = 0;
+        for ( const auto byte : header )
+            checksum += static_cast < unsigned char > ( byte );
+
+        put_octal ( &header [148], 7, checksum );
+        header [155] = ' ';
+
+        return header;
+    }
+
+    uint64_t tar_padding ( const uint64_t size )
+    {
+        return ( tar_block - size % tar_block ) % tar_block;
+    }
+
+    std::string shard_name ( const std::string &prefix, const int index )
+    {
+        std::ostringstream stream;
+        stream << prefix << "-" << std::setw ( 5 ) << std::setfill ( '0' ) << index;
+        return stream.str ();
+    }
+
+    // Number of a shard file name <prefix>-NNNNN<ext>, -1 if the name doesn't match
+    int shard_number ( const std::string &file_name, const std::string &prefix, const std::string &ext )
+    {
+        if ( file_name.size () <= prefix.size () + 1 + ext.size ()
+             || file_name.compare ( 0, prefix.size () + 1, prefix + "-" ) != 0
+             || file_name.compare ( file_name.size () - ext.size (), ext.size (), ext ) != 0 )
+            return -1;
+
+        const auto number = file_name.substr ( prefix.size () + 1, file_name.size () - prefix.size () - 1 - ext.size () );
+        if ( number.empty () || !std::all_of ( number.begin (), number.end (), ::isdigit ) )
+            return -1;
+
+        return std::stoi ( number );
+    }
+}
+
+const shard_member * rsai::markup::shard_sample::find ( const std::string &extension ) const
+{
+    for ( const auto & member : members )
+        if ( member.extension == extension )
+            return &member;
+
+    return nullptr;
+}
+
+rsai::markup::shard_writer::shard_writer ( const std::string &directory, const std::string &prefix, const size_t target_size )
+    : m_directory ( directory ), m_prefix ( prefix ), m_target_size ( target_size )
+{
+    std::error_code error;
+    std::filesystem::create_directories ( m_directory, error );
+
+    for ( const auto & entry : std::filesystem::directory_iterator ( m_directory, error ) )
+    {
+        const int number = shard_number ( entry.path ().filename ().string (), m_prefix, index_ext );
+        m_next_shard = std::max ( m_next_shard, number + 1 );
+    }
+}
+
+rsai::markup::shard_writer::~shard_writer ()
+{
+    close ();
+}
+
+bool rsai::markup::shard_writer::write ( const shard_sample &sample )
+{
+    std::scoped_lock lock ( m_lock );
+
+    if ( m_failed )
+        return false;
+
+    uint64_t sample_size = 0;
+    for ( const auto & member : sample.members )
+    {
+        const auto name = sample.key + member.extension;
+        if ( name.size () >= 100 )
+        {
+            std::cerr << "Sample member name is too long for a shard: " << name << std::endl;
+            return false;
+        }
+        sample_size += tar_block + member.data.size () + tar_padding ( member.data.size () );
+    }
+
+    // A sample is never split, so a shard exceeds the target by at most one sample
+    if ( m_tar.is_open () && m_size > 0 && m_size + sample_size > m_target_size && !__close () )
+        return false;
+
+    if ( !m_tar.is_open () && !__open () )
+        return false;
+
+    static const char zeros [tar_block] = {};
+    for ( const auto & member : sample.members )
+    {
+        const auto header = tar_header ( sample.key + member.extension, member.data.size () );
+        m_tar.write ( header.data (), header.size () );
+        m_tar.write ( member.data.data (), member.data.size () );
+        m_tar.write ( zeros, tar_padding ( member.data.size () ) );
+
+        m_index << sample.key << '\t' << member.extension << '\t' << m_size + tar_block << '\t' << member.data.size () << '\n';
+        m_size += tar_block + member.data.size () + tar_padding ( member.data.size () );
+    }
+
+    if ( m_tar.fail () || m_index.fail () )
+    {
+        std::cerr << "Failed to write the shard: " << m_shard_name << tar_ext << std::endl;
+        m_failed = true;
+        return false;
+    }
+
+    return true;
+}
+
+bool rsai::markup::shard_writer::write_file ( const std::string &file_name, const std::vector < unsigned char > &data )
+{
+    const auto path = std::filesystem::path ( file_name ).lexically_normal ();
+
+    // Same named files of different directories must not collide, files outside the root keep their full path
+    auto relative = path.lexically_relative ( std::filesystem::path ( m_directory ).lexically_normal () );
+    if ( relative.empty () || *relative.begin () == ".." )
+        relative = path.relative_path ();
+
+    const auto key = ( relative.parent_path () / relative.stem () ).generic_string ();
+    return write ( { key, { { path.extension ().string (), std::string ( data.begin (), data.end () ) } } } );
+}
+
+bool rsai::markup::shard_writer::close ()
+{
+    std::scoped_lock lock ( m_lock );
+
+    if ( !m_tar.is_open () )
+        return !m_failed;
+
+    return __close ();
+}
+
+int rsai::markup::shard_writer::shards () const
+{
+    std::scoped_lock lock ( m_lock );
+    return m_shards;
+}
+
+bool rsai::markup::shard_writer::__open ()
+{
+    m_shard_name = m_directory + "/" + shard_name ( m_prefix, m_next_shard++ );
+    m_size = 0;
+
+    m_tar.open ( m_shard_name + tar_ext + part_ext, std::ios_base::binary | std::ios_base::trunc );
+    m_index.open ( m_shard_name + index_ext + part_ext, std::ios_base::trunc );
+
+    if ( !m_tar.is_open () || !m_index.is_open () )
+    {
+        std::cerr << "Failed to open the file for writing: " << m_shard_name << tar_ext << std::endl;
+        m_tar.close ();
+        m_index.close ();
+        m_failed = true;
+        return false;
+    }
+
+    return true;
+}
+
+bool rsai::markup::shard_writer::__close ()
+{
+    // Archive end is marked by two zero blocks
+    static const char zeros [tar_block * 2] = {};
+    m_tar.write ( zeros, sizeof ( zeros ) );
+
+    m_tar.close ();
+    m_index.close ();
+
+    const bool written = !m_tar.fail () && !m_index.fail ();
+
+    // The tar goes first, the index rename marks the shard complete
+    std::error_code error;
+    if ( written )
+        std::filesystem::rename ( m_shard_name + tar_ext + part_ext, m_shard_name + tar_ext, error );
+    if ( written && !error )
+        std::filesystem::rename ( m_shard_name + index_ext + part_ext, m_shard_name + index_ext, error );
+
+    if ( !written || error )
+    {
+        std::cerr << "Failed to complete the shard: " << m_shard_name << tar_ext << std::endl;
+        m_failed = true;
+        return false;
+    }
+
+    ++m_shards;
+    return true;
+}
+
+rsai::markup::shard_reader::shard_reader ( const std::string &directory, const std::string &prefix )
+    : m_shards ( shards ( directory, prefix ) )
+{
+    for ( const auto & shard : m_shards )
+    {
+        std::vector < entry > entries;
+
+        std::ifstream index ( shard + index_ext );
+        std::string line;
+        while ( std::getline ( index, line ) )
+        {
+            std::istringstream stream ( line );
+            entry an_entry;
+            std::string offset, size;
+            if ( std::getline ( stream, an_entry.key, '\t' ) && std::getline ( stream, an_entry.extension, '\t' )
+                 && std::getline ( stream, offset, '\t' ) && std::getline ( stream, size ) )
+            {
+                an_entry.offset = std::stoull ( offset );
+                an_entry.size = std::stoull ( size );
+                entries.push_back ( std::move ( an_entry ) );
+            }
+        }
+
+        m_entries.push_back ( std::move ( entries ) );
+    }
+}
+
+bool rsai::markup::shard_reader::next ( shard_sample &sample )
+{
+    while ( m_shard < m_shards.size () && m_entry >= m_entries [m_shard].size () )
+    {
+        m_tar.close ();
+        m_entry = 0;
+        ++m_shard;
+    }
+
+    if ( m_shard >= m_shards.size () )
+        return false;
+
+    if ( !m_tar.is_open () )
+    {
+        m_tar.open ( m_shards [m_shard] + tar_ext, std::ios_base::binary );
+        if ( !m_tar.is_open () )
+        {
+            std::cerr << "Failed to open the shard: " << m_shards [m_shard] << tar_ext << std::endl;
+            return false;
+        }
+    }
+
+    const auto & entries = m_entries [m_shard];
+
+    sample.key = entries [m_entry].key;
+    sample.members.clear ();
+
+    // Members of a sample are contiguous, so reading is sequential within a shard
+    for ( ; m_entry < entries.size () && entries [m_entry].key == sample.key; ++m_entry )
+    {
+        const auto & an_entry = entries [m_entry];
+        shard_member member { an_entry.extension, std::string ( an_entry.size, '\0' ) };
+
+        m_tar.seekg ( an_entry.offset );
+        m_tar.read ( member.data.data (), an_entry.size );
+        if ( m_tar.fail () )
+        {
+            std::cerr << "Failed to read the shard: " << m_shards [m_shard] << tar_ext << std::endl;
+            return false;
+        }
+
+        sample.members.push_back ( std::move ( member ) );
+    }
+
+    return true;
+}
+
+size_t rsai::markup::shard_reader::size () const
+{
+    return keys ().size ();
+}
+
+std::set < std::string > rsai::markup::shard_reader::keys () const
+{
+    std::set < std::string > result;
+    for ( const auto & entries : m_entries )
+        for ( const auto & an_entry : entries )
+            result.insert ( an_entry.key );
+
+    return result;
+}
+
+strings rsai::markup::shard_reader::shards ( const std::string &directory, const std::string &prefix )
+{
+    std::vector < std::pair < int, std::string > > numbered;
+
+    std::error_code error;
+    for ( const auto & entry : std::filesystem::directory_iterator ( directory, error ) )
+    {
+        const int number = shard_number ( entry.path ().filename ().string (), prefix, index_ext );
+        if ( number >= 0 )
+            numbered.push_back ( { number, directory + "/" + shard_name ( prefix, number ) } );
+    }
+
+    std::sort ( numbered.begin (), numbered.end () );
+
+    strings result;
+    for ( const auto & shard : numbered )
+        result.push_back ( shard.second );
+
+    return result;
+}
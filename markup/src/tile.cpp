@@ -4,12 +4,16 @@
 #include <random>
 #include "rsai/building_models/building_renderer.h"
 #include "eigen_utils/gdal_bridges.h"
+#include "threading_utils/thread_pool.h"
+
+#include <atomic>
+#include <iostream>
 
 using namespace rsai::markup;
 using namespace gdal;
 
 rsai::markup::tile::tile ( gdal::shared_dataset raster, const gdal::bbox &bbox, int index, const std::string &source_name )
-    : m_extractor ( raster ), m_bbox ( bbox ), m_index ( index ), m_source_name ( source_name )
+    : m_raster ( raster ), m_extractor ( raster ), m_bbox ( bbox ), m_index ( index ), m_source_name ( source_name )
 {
 }
 
@@ -53,11 +57,38 @@ bool rsai::markup::tile::populate ( gdal::ogr_layer * layer )
     return added_population;
 }
 
+bool rsai::markup::tile::populate ( const std::string &layer_name, const gdal::geometries &raster_geometries )
+{
+    auto & layer_population = m_population [layer_name];
+    int start_population = layer_population.size();
+    for ( const auto & raster_geometry : raster_geometries )
+    {
+        auto tile_geometry = raster_geometry + -m_bbox.top_left();
+        if ( !tile_geometry )
+            continue;
+
+        layer_population.push_back ( tile_geometry );
+    }
+
+    bool added_population = layer_population.size() - start_population;
+    return added_population;
+}
+
 cv::Mat rsai::markup::tile::image () const
 {
     return m_extractor.roi ( m_bbox );
 }
 
+cv::Mat rsai::markup::tile::image ( const opencv::dataset_roi_extractor &extractor ) const
+{
+    return extractor.roi ( m_bbox );
+}
+
+gdal::shared_dataset rsai::markup::tile::raster () const
+{
+    return m_raster;
+}
+
 cv::Mat rsai::markup::tile::render ()
 {
     auto tile_image = image ();
@@ -108,6 +139,11 @@ gdal::bbox rsai::markup::tile::world_bbox () const
     return gdal::bbox ( world_border () );
 }
 
+const gdal::bbox & rsai::markup::tile::raster_bbox () const
+{
+    return m_bbox;
+}
+
 int rsai::markup::tile::index () const
 {
     return m_index;
@@ -168,6 +204,122 @@ tiles rsai::markup::tile_generator::operator () ( const Eigen::Vector2i &tile_si
     return result;
 }
 
+rsai::markup::tile_populator::tile_populator ( gdal::shared_dataset vector, const strings &layers, gdal::shared_dataset raster )
+    : m_vector ( vector ), m_raster ( raster ), m_layer_names ( layers )
+{
+    eigen::gdal_dataset_bridge raster_eigen ( raster );
+    const Eigen::Matrix3d raster_2_world = raster_eigen.transform ();
+    const Eigen::Matrix3d world_2_raster = raster_2_world.inverse ();
+
+    const Eigen::Vector2d raster_size ( raster->GetRasterXSize(), raster->GetRasterYSize() );
+    const auto raster_border = gdal::bbox ( Eigen::Vector2d ( 0, 0 ), raster_size ).transform ( raster_2_world );
+
+    for ( const auto & layer_name : layers )
+    {
+        auto layer = vector->GetLayerByName ( layer_name.c_str() );
+        if ( layer == nullptr )
+        {
+            std::cerr << "Layer " << layer_name << " is not found" << std::endl;
+            continue;
+        }
+
+        layer_index a_layer;
+        a_layer.name = layer->GetName();
+
+        layer->SetSpatialFilter ( raster_border.get () );
+        layer->ResetReading ();
+
+        // Index bounds have to cover all the features, including ones partially outside the raster
+        OGREnvelope bounds;
+        bounds.Merge ( 0, 0 );
+        bounds.Merge ( raster_size.x (), raster_size.y () );
+
+        std::vector < OGREnvelope > envelopes;
+        while ( gdal::shared_feature feature = layer->GetNextFeature() )
+        {
+            auto raster_geometry = feature->GetGeometryRef() * world_2_raster;
+            if ( !raster_geometry )
+                continue;
+
+            OGREnvelope envelope;
+            raster_geometry->getEnvelope ( &envelope );
+            bounds.Merge ( envelope );
+
+            envelopes.push_back ( envelope );
+            a_layer.geometries.push_back ( raster_geometry );
+        }
+
+        layer->SetSpatialFilter ( nullptr );
+
+        a_layer.index.reset ( new gdal::spatial_index < size_t > ( bounds ) );
+        for ( size_t i = 0; i < envelopes.size (); ++i )
+            a_layer.index->insert ( envelopes [i], i );
+
+        m_layers.push_back ( std::move ( a_layer ) );
+    }
+}
+
+int rsai::markup::tile_populator::operator () ( tiles &tls, const int threads ) const
+{
+    std::vector < tile * > indexed;
+    indexed.reserve ( tls.size () );
+
+    for ( auto & a_tile : tls )
+    {
+        if ( a_tile.raster ().get () == m_raster.get () )
+            indexed.push_back ( &a_tile );
+        else
+            a_tile.populate ( m_vector, m_layer_names );
+    }
+
+    std::atomic_int next_tile = 0;
+    auto worker = [&] ()
+    {
+        for ( int i = next_tile++; i < indexed.size (); i = next_tile++ )
+        {
+            auto & a_tile = *indexed [i];
+
+            // Same envelope and exact intersection test as OGR's spatial filter does
+            const auto tile_border = a_tile.raster_bbox ().to_polygon ();
+            OGREnvelope tile_envelope;
+            tile_border->getEnvelope ( &tile_envelope );
+
+            for ( const auto & a_layer : m_layers )
+            {
+                auto found = a_layer.index->search ( tile_envelope );
+
+                // Keeping the layer reading order
+                std::vector < size_t > ids;
+                ids.reserve ( found.size () );
+                for ( const auto * id : found )
+                    ids.push_back ( *id );
+                std::sort ( ids.begin (), ids.end () );
+
+                gdal::geometries population;
+                population.reserve ( ids.size () );
+                for ( const auto id : ids )
+                {
+                    const auto & raster_geometry = a_layer.geometries [id];
+                    if ( raster_geometry->Intersects ( tile_border.get () ) )
+                        population.push_back ( raster_geometry );
+                }
+
+                a_tile.populate ( a_layer.name, population );
+            }
+        }
+    };
+
+    {
+        threading::worker_pool pool ( worker, std::max ( 1, std::min < int > ( threads, indexed.size () ) ) );
+    }
+
+    int populated = 0;
+    for ( const auto & a_tile : tls )
+        populated += a_tile.populated ();
+
+    return populated;
+}
+
 rsai::markup::tile_balancer::tile_balancer ( const tiles &tls )
     : m_tiles ( tls )
 {
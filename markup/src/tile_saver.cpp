@@ -35,6 +35,20 @@ gdal::bbox rsai::tile_saver::operator () ( gdal::shared_feature feature, const i
     return raster_box;
 }
 
+gdal::bbox rsai::tile_saver::operator () ( gdal::shared_feature feature, std::vector < uchar > &encoded, const int tile_buffer_size )
+{
+    auto raster_box = get_bbox ( feature, tile_buffer_size );
+
+    encoded.clear ();
+    if ( !raster_box.empty() )
+    {
+        auto tile = m_ds_tile_extractor.roi ( raster_box );
+        cv::imencode ( DEFAULT_SEGMENT_FILE_EXT, tile, encoded );
+    }
+
+    return raster_box;
+}
+
 gdal::bbox rsai::tile_saver::get_bbox ( gdal::shared_feature feature, const int tile_buffer_size ) const
 {
     if ( feature == nullptr || m_raster == nullptr )
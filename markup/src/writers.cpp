@@ -1,33 +1,83 @@
 #include "rsai/markup/writers.h"
 
 #include <filesystem>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <set>
+#include "threading_utils/thread_pool.h"
+#include "threading_utils/ordered_sink.h"
+#include "rsai/markup/shards.h"
 
 using namespace rsai::markup;
 
 std::map < markup_part, std::string > markup_part_folder_names = { { markup_part::train, "train" }, { markup_part::valid, "valid" } };
 
-rsai::markup::writer::writer ( const strings &classes )
+rsai::write_mode rsai::write_mode_from_string ( const std::string &mode )
+{
+    if ( mode == DEFAULT_MARKUP_REPLACE_MODE )
+        return write_mode::replace;
+    if ( mode == DEFAULT_MARKUP_APPEND_MODE )
+        return write_mode::append;
+    if ( mode == DEFAULT_MARKUP_UPDATE_MODE )
+        return write_mode::update;
+
+    return write_mode::invalid;
+}
+
+markup_type rsai::markup::markup_type_from_string ( const std::string &type )
+{
+    if ( type == "yolo" )
+        return markup_type::yolo;
+    if ( type == "yolo_shards" )
+        return markup_type::yolo_shards;
+
+    return markup_type::invalid;
+}
+
+std::vector < int > rsai::markup::image_codec::params () const
+{
+    auto ext = extension;
+    std::transform ( ext.begin (), ext.end (), ext.begin (), ::tolower );
+
+    const int clamped = std::clamp ( quality, 0, 100 );
+    if ( ext == ".jpg" || ext == ".jpeg" )
+        return { cv::IMWRITE_JPEG_QUALITY, clamped };
+    if ( ext == ".webp" )
+        return { cv::IMWRITE_WEBP_QUALITY, std::max ( clamped, 1 ) };
+    if ( ext == ".png" )
+        return { cv::IMWRITE_PNG_COMPRESSION, ( 100 - clamped ) * 9 / 100 };
+
+    return {};
+}
+
+rsai::markup::writer::writer ( const strings &classes, const image_codec &codec, const int threads )
+    : m_codec ( codec ), m_threads ( std::max ( threads, 1 ) )
 {
     for ( int i = 0; i < classes.size(); ++i )
         m_classes [classes [i]] = i;
 }
 
-writer_ptr rsai::markup::writer::get_writer ( const markup_type type, const strings &classes )
+writer_ptr rsai::markup::writer::get_writer ( const markup_type type, const strings &classes, const image_codec &codec, const int threads,
+                                              const size_t shard_size )
 {
     if ( type == markup_type::yolo )
-        return writer_ptr ( new yolo_writer ( classes ) );
+        return writer_ptr ( new yolo_writer ( classes, codec, threads ) );
+
+    if ( type == markup_type::yolo_shards )
+        return writer_ptr ( new yolo_shards_writer ( classes, codec, threads, shard_size ) );
 
     return {};
 }
 
-rsai::markup::yolo_writer::yolo_writer ( const strings &classes )
-    : writer ( classes )
+rsai::markup::yolo_writer::yolo_writer ( const strings &classes, const image_codec &codec, const int threads )
+    : writer ( classes, codec, threads )
 {
 }
 
 bool rsai::markup::yolo_writer::save ( const tiles &tls, const std::string &path, const markup_part part, write_mode mode, bool show_progress ) const
 {
-    const std::string images_ext = ".jpg";
+    const std::string images_ext = m_codec.extension;
     const std::string markup_ext = ".txt";
 
     //const auto dataset_name = std::filesystem::path ( path ).filename().string();
@@ -48,60 +98,221 @@ bool rsai::markup::yolo_writer::save ( const tiles &tls, const std::string &path
         std::filesystem::create_directories( backup_path );
 
     const auto index_path = path + "/" + markup_dir + markup_ext;
-    std::ofstream index_file ( index_path, ( mode == write_mode::append ) ? std::ios_base::app : std::ios_base::trunc );
+
+    // Index lines are written after tile files, so the index is a commit log of completed tiles
+    std::set < std::string > completed;
+    if ( mode == write_mode::update )
+    {
+        std::ifstream existing ( index_path );
+        std::string line;
+        while ( std::getline ( existing, line ) )
+            if ( !line.empty () )
+                completed.insert ( line );
+    }
+
+    const bool keep_index = mode == write_mode::append || mode == write_mode::update;
+    std::ofstream index_file ( index_path, keep_index ? std::ios_base::app : std::ios_base::trunc );
     if (!index_file.is_open())
     {
         std::cerr << "Failed to open the file for writing: " << index_path << std::endl;
         return false;
     }
 
-    int tile_index = 0;
+    std::vector < const tile * > pending;
+    pending.reserve ( tls.size () );
     for ( auto & tile : tls )
     {
-        const auto image_file_name = tile.source() + "_" + std::to_string ( tile.index() ) + images_ext;
-        const auto image_path = tiles_path + image_file_name;
-        const auto markup_path = tiles_path + tile.source() + "_" + std::to_string ( tile.index() ) + markup_ext;
-        auto image = tile.image();
-        cv::imwrite ( image_path, image );
-
-        auto & tile_population = tile.population();
+        const auto image_relative_path = dataset_name + "/" + markup_dir + "/" + __tile_name ( tile ) + images_ext;
+        if ( !completed.count ( image_relative_path ) )
+            pending.push_back ( &tile );
+    }
 
-        std::ofstream file(markup_path);
-        if (!file.is_open())
+    const bool result = __encode_tiles ( pending, [&] ( encoded_tile &encoded )
         {
-            std::cerr << "Failed to open the file for writing: " << markup_path << std::endl;
-            return false;
-        }
-
-        for ( auto &class_population : tile_population )
+            const auto image_path = tiles_path + encoded.name + images_ext;
+            const auto markup_path = tiles_path + encoded.name + markup_ext;
+
+            std::ofstream image_file ( image_path, std::ios_base::binary | std::ios_base::trunc );
+            if ( !image_file.is_open () )
+            {
+                std::cerr << "Failed to open the file for writing: " << image_path << std::endl;
+                return false;
+            }
+            image_file.write ( reinterpret_cast < const char * > ( encoded.image.data () ), encoded.image.size () );
+            image_file.close ();
+
+            std::ofstream file(markup_path);
+            if (!file.is_open())
+            {
+                std::cerr << "Failed to open the file for writing: " << markup_path << std::endl;
+                return false;
+            }
+            file << encoded.markup;
+            file.close();
+
+            // Only the name goes further to the index writer
+            encoded.image = {};
+            encoded.markup = {};
+
+            return !image_file.fail () && !file.fail ();
+        },
+        [&] ( encoded_tile &encoded )
         {
-            auto class_name = class_population.first;
-            auto class_index = ( m_classes.find( class_name ) )->second;
+            index_file << dataset_name << "/" << markup_dir << "/" << encoded.name << images_ext << '\n';
+            index_file.flush ();
+        }, show_progress );
 
-            auto yolo_markup = __geometries_to_yolo ( class_population.second, image.cols, image.rows, class_index );
-            file << yolo_markup;
-        }
+    index_file.close ();
 
-        const auto image_relative_path = dataset_name + "/" + markup_dir + "/" + image_file_name;
-        index_file << image_relative_path << '\n';
+    if ( !result )
+        return false;
 
-        tile_index++;
+    if ( !__write_class_names ( path ) )
+        return false;
 
-        file.close();
+    return __write_data_file ( path );
+}
 
-        if ( show_progress )
-            console_progress ( float ( tile_index ) / tls.size() );
-    }
+bool rsai::markup::yolo_writer::__encode_tiles ( const std::vector < const tile * > &tls, const tile_store &store,
+                                                 const tile_commit &commit, bool show_progress ) const
+{
+    const int total = tls.size ();
+    int committed = 0;
+    std::atomic_bool failed = false;
 
-    index_file.close ();
+    {
+        threading::ordered_sink < encoded_tile > sink ( [&] ( const int, encoded_tile &encoded )
+            {
+                commit ( encoded );
+
+                ++committed;
+                if ( show_progress )
+                    console_progress ( float ( committed ) / total );
+            }, 0, m_threads * 4 );
+
+        std::atomic_int next_tile = 0;
+        std::mutex fallback_lock;
+
+        auto worker = [&] ()
+        {
+            // Every thread reads tiles through its own handles of the source rasters,
+            // a source which can't be reopened is read through the tile's shared handle
+            std::map < GDALDataset *, gdal::shared_dataset > handles;
+
+            for ( int i = next_tile++; i < total; i = next_tile++ )
+            {
+                const auto & a_tile = *tls [i];
+                const auto source = a_tile.raster ();
+
+                auto handle = handles.find ( source.get () );
+                if ( handle == handles.end () )
+                    handle = handles.emplace ( source.get (), gdal::open_dataset ( source->GetDescription (), GDAL_OF_RASTER | GDAL_OF_READONLY ) ).first;
+
+                cv::Mat image;
+                if ( handle->second )
+                    image = a_tile.image ( opencv::dataset_roi_extractor ( handle->second ) );
+                else
+                {
+                    std::scoped_lock lock ( fallback_lock );
+                    image = a_tile.image ();
+                }
+
+                encoded_tile encoded;
+                if ( __encode_tile ( a_tile, image, encoded ) && store ( encoded ) )
+                    sink.push ( i, std::move ( encoded ) );
+                else
+                {
+                    failed = true;
+                    sink.skip ( i );
+                }
+            }
+        };
+
+        threading::worker_pool pool ( worker, std::min ( m_threads, std::max ( total, 1 ) ) );
+    }
 
     if ( show_progress )
         console_progress ( 1.f, true );
 
-    if ( !__write_class_names ( path ) )
+    return !failed;
+}
+
+bool rsai::markup::yolo_writer::__encode_tile ( const tile &a_tile, const cv::Mat &image, encoded_tile &encoded ) const
+{
+    encoded.name = __tile_name ( a_tile );
+
+    if ( image.empty () )
+    {
+        std::cerr << "Failed to read the tile: " << encoded.name << std::endl;
         return false;
+    }
 
-    return __write_data_file ( path );
+    if ( !cv::imencode ( m_codec.extension, image, encoded.image, m_codec.params () ) )
+    {
+        std::cerr << "Failed to encode the tile: " << encoded.name << std::endl;
+        return false;
+    }
+
+    for ( auto &class_population : a_tile.population() )
+    {
+        auto class_name = class_population.first;
+        auto class_index = ( m_classes.find( class_name ) )->second;
+
+        encoded.markup += __geometries_to_yolo ( class_population.second, image.cols, image.rows, class_index );
+    }
+
+    return true;
+}
+
+std::string rsai::markup::yolo_writer::__tile_name ( const tile &a_tile )
+{
+    return a_tile.source() + "_" + std::to_string ( a_tile.index() );
+}
+
+rsai::markup::yolo_shards_writer::yolo_shards_writer ( const strings &classes, const image_codec &codec, const int threads, const size_t shard_size )
+    : yolo_writer ( classes, codec, threads ), m_shard_size ( shard_size )
+{
+}
+
+bool rsai::markup::yolo_shards_writer::save ( const tiles &tls, const std::string &path, const markup_part part, write_mode mode, bool show_progress ) const
+{
+    const std::string markup_ext = ".txt";
+    const auto shards_prefix = markup_part_folder_names [part];
+
+    if ( mode == write_mode::replace )
+        std::filesystem::remove_all ( path );
+
+    if ( !std::filesystem::exists ( path ) )
+        std::filesystem::create_directories( path );
+
+    std::set < std::string > completed;
+    if ( mode == write_mode::update )
+        completed = shard_reader ( path, shards_prefix ).keys ();
+
+    std::vector < const tile * > pending;
+    pending.reserve ( tls.size () );
+    for ( auto & tile : tls )
+        if ( !completed.count ( __tile_name ( tile ) ) )
+            pending.push_back ( &tile );
+
+    shard_writer shards ( path, shards_prefix, m_shard_size );
+    bool stored = true;
+
+    const bool result = __encode_tiles ( pending, [] ( encoded_tile & ) { return true; },
+        [&] ( encoded_tile &encoded )
+        {
+            shard_sample sample { encoded.name,
+                                  { { m_codec.extension, std::string ( encoded.image.begin (), encoded.image.end () ) },
+                                    { markup_ext, std::move ( encoded.markup ) } } };
+            stored &= shards.write ( sample );
+        }, show_progress );
+
+    stored &= shards.close ();
+
+    if ( !result || !stored )
+        return false;
+
+    return __write_class_names ( path );
 }
 
 std::string rsai::markup::yolo_writer::__geometry_to_yolo ( OGRGeometry *geometry, int tile_width, int tile_height, int class_id ) const
@@ -0,0 +1,243 @@
+#include <iostream>
+#include <string>
+#include <filesystem>
+
+#include <args-parser/all.hpp>
+
+#include "common/definitions.h"
+#include "common/arguments.h"
+#include "common/string_utils.h"
+#include "gdal_utils/all_helpers.h"
+#include "rsai/markup/tile.h"
+#include "rsai/markup/writers.h"
+
+using namespace std;
+using namespace rsai::markup;
+
+int main ( int argc, char * argv[] )
+{
+    try
+    {
+        Args::CmdLine cmd( argc, argv );
+
+        Args::Arg & input_raster_param = arguments::get_input_raster ();
+        input_raster_param.setDescription( input_raster_param.description() + SL ( "A list of comma separated rasters to cut markup tiles from. " ) );
+
+        Args::Arg & input_vector_param = arguments::get_input_vector ();
+        input_vector_param.setDescription( input_vector_param.description() + SL ( "A list of comma separated vector maps with classes' layers. " ) );
+
+        Args::Arg & output_param = arguments::get_output ();
+        output_param.setDescription( output_param.description() + SL ( "The markup directory with train and valid parts. " ) );
+
+        Args::Arg & denied_param = arguments::get_input_denied_regions ();
+        denied_param.setDescription( denied_param.description() + SL ( "Tiles intersecting denied polygons are skipped. " ) );
+
+        Args::Arg & tile_sizes_param = arguments::get_markup_tile_sizes ();
+
+        Args::Arg & classes_param = arguments::get_markup_classes ();
+
+        Args::Arg & balance_param = arguments::get_markup_balance ();
+
+        Args::Arg & validation_param = arguments::get_markup_validation ();
+
+        Args::Arg & overlap_param = arguments::get_markup_overlap ();
+
+        Args::Arg & format_param = arguments::get_markup_format ();
+
+        Args::Arg & mode_param = arguments::get_markup_mode ();
+
+        Args::Arg & image_format_param = arguments::get_markup_image_format ();
+
+        Args::Arg & image_quality_param = arguments::get_markup_image_quality ();
+
+        Args::Arg & shard_size_param = arguments::get_shard_size ();
+        shard_size_param.setDescription( shard_size_param.description() + SL ( "Used with the yolo_shards format. " ) );
+
+        Args::Help help;
+        help.setAppDescription(
+            SL( "Utility to create a detection markup from rasters and vector maps. Rasters are cut into tiles, "
+                "tiles are populated with classes' objects, balanced and split to train and valid parts. "
+                "Tiles' images are encoded in parallel with the given image format and quality." ) );
+        help.setExecutable( argv[0] );
+
+        cmd.addArg ( input_raster_param );
+        cmd.addArg ( input_vector_param );
+        cmd.addArg ( output_param );
+        cmd.addArg ( denied_param );
+        cmd.addArg ( tile_sizes_param );
+        cmd.addArg ( classes_param );
+        cmd.addArg ( balance_param );
+        cmd.addArg ( validation_param );
+        cmd.addArg ( overlap_param );
+        cmd.addArg ( format_param );
+        cmd.addArg ( mode_param );
+        cmd.addArg ( image_format_param );
+        cmd.addArg ( image_quality_param );
+        cmd.addArg ( shard_size_param );
+        cmd.addArg ( help );
+
+        cmd.parse();
+
+        // validating markup parameters
+        array_helper < int > tile_sizes_helper ( tile_sizes_param.value(), std::string ( DEFAULT_DELIMITERS ) + "x" );
+        if ( !tile_sizes_helper.verify ( std::cerr, "STOP: Tile sizes are incorrect." ) )
+            return 1;
+
+        const auto tile_sizes_array = tile_sizes_helper.value();
+        if ( tile_sizes_array.size () != 2 || tile_sizes_array [0] <= 0 || tile_sizes_array [1] <= 0 )
+        {
+            std::cerr << "STOP: Tile sizes have to be two positive values." << std::endl;
+            return 1;
+        }
+
+        const Eigen::Vector2i tile_sizes ( tile_sizes_array [0], tile_sizes_array [1] );
+
+        value_helper < double > balance_helper      ( balance_param.value() );
+        value_helper < double > validation_helper   ( validation_param.value() );
+        value_helper < double > overlap_helper      ( overlap_param.value() );
+        value_helper < int >    quality_helper      ( image_quality_param.value() );
+
+        if (    !balance_helper.verify      ( std::cerr, "STOP: Balance value is incorrect." )
+             || !validation_helper.verify   ( std::cerr, "STOP: Validation value is incorrect." )
+             || !overlap_helper.verify      ( std::cerr, "STOP: Overlap value is incorrect." )
+             || !quality_helper.verify      ( std::cerr, "STOP: Image quality is incorrect." ) )
+            return 1;
+
+        if ( balance_helper.value() <= 0.0 || balance_helper.value() > 1.0 )
+        {
+            std::cerr << "STOP: Balance has to be in (0..1]." << std::endl;
+            return 1;
+        }
+
+        if ( validation_helper.value() < 0.0 || validation_helper.value() > MAXIMUM_MARKUP_VALIDATION )
+        {
+            std::cerr << "STOP: Validation has to be in [0.." << MAXIMUM_MARKUP_VALIDATION << "]." << std::endl;
+            return 1;
+        }
+
+        if ( overlap_helper.value() < 0.0 || overlap_helper.value() >= 1.0 )
+        {
+            std::cerr << "STOP: Overlap has to be in [0..1)." << std::endl;
+            return 1;
+        }
+
+        const auto type = markup_type_from_string ( format_param.value() );
+        if ( type == markup_type::invalid )
+        {
+            std::cerr << "STOP: Markup format " << format_param.value() << " is not supported." << std::endl;
+            return 1;
+        }
+
+        const auto mode = rsai::write_mode_from_string ( mode_param.value() );
+        if ( mode == rsai::write_mode::invalid )
+        {
+            std::cerr << "STOP: Markup mode " << mode_param.value() << " is not supported." << std::endl;
+            return 1;
+        }
+
+        const image_codec codec { image_format_param.value(), quality_helper.value() };
+        if ( codec.params ().empty () )
+        {
+            std::cerr << "STOP: Image format " << codec.extension << " is not supported." << std::endl;
+            return 1;
+        }
+
+        size_t shard_size = DEFAULT_MARKUP_SHARD_SIZE;
+        if ( shard_size_param.isDefined () )
+        {
+            value_helper < int > shard_size_helper  ( shard_size_param.value() );
+
+            if ( !shard_size_helper.verify ( std::cerr, "STOP: Shard size is incorrect." ) )
+                return 1;
+
+            if ( shard_size_helper.value() <= 0 )
+            {
+                std::cerr << "STOP: Shard size has to be positive." << std::endl;
+                return 1;
+            }
+
+            shard_size = size_t ( shard_size_helper.value() ) << 20;
+        }
+
+        const auto classes = split ( classes_param.value(), DEFAULT_DELIMITERS [0] );
+
+        // loading and validating datasets
+        gdal::shared_dataset ds_denied;
+        if ( denied_param.isDefined () )
+        {
+            gdal::open_vector_ro_helper denied_helper ( denied_param.value(), std::cerr );
+            ds_denied = denied_helper.validate ( true );
+            if ( ds_denied == nullptr )
+            {
+                std::cerr << "STOP: Denied regions verification failed" << std::endl;
+                return 1;
+            }
+        }
+
+        std::vector < gdal::shared_dataset > ds_vectors;
+        for ( auto vector_name : split ( input_vector_param.value(), DEFAULT_DELIMITERS [0] ) )
+        {
+            trim ( vector_name );
+            gdal::open_vector_ro_helper iv_helper ( vector_name, std::cerr );
+            auto ds_vector = iv_helper.validate ( true );
+            if ( ds_vector == nullptr )
+            {
+                std::cerr << "STOP: Input vector " << vector_name << " verification failed" << std::endl;
+                return 1;
+            }
+            ds_vectors.push_back ( ds_vector );
+        }
+
+        // Tiles of every raster are populated by a vector index built for this raster
+        tiles all_tiles;
+        for ( auto raster_name : split ( input_raster_param.value(), DEFAULT_DELIMITERS [0] ) )
+        {
+            trim ( raster_name );
+            gdal::open_raster_ro_helper ir_helper ( raster_name, std::cerr );
+            auto ds_raster = ir_helper.validate ( true );
+            if ( ds_raster == nullptr )
+            {
+                std::cerr << "STOP: Input raster " << raster_name << " verification failed" << std::endl;
+                return 1;
+            }
+
+            const auto source_name = std::filesystem::path ( raster_name ).stem ().string ();
+            auto raster_tiles = tile_generator ( ds_raster, source_name, ds_denied ) ( tile_sizes, overlap_helper.value() );
+
+            int populated = 0;
+            for ( auto ds_vector : ds_vectors )
+                populated = tile_populator ( ds_vector, classes, ds_raster ) ( raster_tiles );
+
+            std::cout << "Raster " << source_name << ": " << raster_tiles.size () << " tiles, " << populated << " populated" << std::endl;
+            all_tiles.splice ( all_tiles.end (), raster_tiles );
+        }
+
+        const auto balanced = tile_balancer ( all_tiles ) ( balance_helper.value() );
+        const tile_splitter splitter ( balanced, validation_helper.value() );
+
+        auto markup_writer = writer::get_writer ( type, classes, codec, std::thread::hardware_concurrency (), shard_size );
+
+        // Replacing clears the whole output, so the validation part is appended after the training one
+        const auto valid_mode = ( mode == rsai::write_mode::replace ) ? rsai::write_mode::append : mode;
+
+        std::cout << "Saving " << balanced.size () << " tiles to " << output_param.value() << std::endl;
+        if (    !markup_writer->save ( splitter.train (), output_param.value(), markup_part::train, mode )
+             || !markup_writer->save ( splitter.validation (), output_param.value(), markup_part::valid, valid_mode ) )
+        {
+            std::cerr << "STOP: Markup saving failed" << std::endl;
+            return 1;
+        }
+
+        std::cout << "done\n";
+    }
+    catch( const Args::HelpHasBeenPrintedException & )
+    {
+    }
+    catch( const Args::BaseException & x )
+    {
+        Args::outStream() << x.desc() << SL( "\n" );
+    }
+
+
+    return 0;
+}
@@ -39,6 +39,8 @@ int main ( int argc, char * argv[] )
 
         Args::Arg & force_rewtire_param = arguments::get_force_rewtire ();
 
+        Args::Arg & resume_param = arguments::get_resume ();
+
         Args::Arg & segmentize_step_param = arguments::get_segmentize_step ();
 
         Args::Arg & projection_step_param = arguments::get_projection_step ();
@@ -75,6 +77,7 @@ int main ( int argc, char * argv[] )
         cmd.addArg ( projection_step_param );
         cmd.addArg ( height_factor_param );
         cmd.addArg ( force_rewtire_param );
+        cmd.addArg ( resume_param );
         cmd.addArg ( run_mode_param );
         cmd.addArg ( interaction_mode_param );
         cmd.addArg ( roof_position_walk_param );
@@ -226,6 +229,7 @@ int main ( int argc, char * argv[] )
                                               , shade_variants
                                               , height_factor
                                               , force_rewtire_param.isDefined ()
+                                              , resume_param.isDefined ()
                                               , use_sam_param.isDefined()
                                               , run_mode
                                               , interaction_mode
@@ -25,6 +25,7 @@ namespace rsai
                                         , const int shade_variants
                                         , const double height_factor
                                         , const bool force_rewrite
+                                        , const bool resume
                                         , const bool use_sam = false
                                         , run_mode mode = run_mode::automatic
                                         , interaction_mode interaction = interaction_mode::internal
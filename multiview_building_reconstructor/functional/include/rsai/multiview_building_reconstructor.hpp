@@ -13,6 +13,7 @@
 #include "eigen_utils/math.hpp"
 #include "gdal_utils/shared_options.h"
 #include "gdal_utils/shared_feature.h"
+#include "gdal_utils/feature_journal.h"
 #include "opencv_utils/raster_roi.h"
 #include "opencv_utils/gdal_bridges.h"
 #include "opencv_utils/geometry_renderer.h"
@@ -48,6 +49,7 @@ rsai::multiview_building_reconstructor::multiview_building_reconstructor (
                                                                    , const int shade_variants
                                                                    , const double height_factor
                                                                    , const bool force_rewrite
+                                                                   , const bool resume
                                                                    , const bool use_sam
                                                                    , run_mode a_run_mode
                                                                    , interaction_mode an_interaction_mode
@@ -112,6 +114,65 @@ rsai::multiview_building_reconstructor::multiview_building_reconstructor (
 
         std::vector < std::pair < tiles_info, rsai::building_models::structure_responses > > structure_list;
 
+        // Features completed in internal mode are journaled, a resumed run skips them
+        std::unique_ptr < gdal::feature_journal > journal;
+        if ( an_interaction_mode == interaction_mode::internal )
+        {
+            journal.reset ( new gdal::feature_journal ( std::string ( ds_first_out->GetDescription() ) + "/" + leading_layer->GetName () + DEFAULT_JOURNAL_FILE_EXT, resume ) );
+            if ( !journal->is_open () )
+                continue;
+
+            if ( journal->resumed () > 0 )
+                std::cout << "Resuming after " << journal->resumed () << " completed features\n";
+        }
+
+        // Automatic choice between the two best structures by their responses and lengths
+        auto automatic_choice = [max_structure_length] ( const gdal::polygons &roofs, const rsai::building_models::structure_responses &structures )
+        {
+            if ( structures.size () < 2 )
+                return 0;
+
+            int linear_size = 0;
+            for ( int i = 0; i < structures [0].projections_and_shades.size(); ++i )
+            {
+                if ( roofs [i] )
+                {
+                    linear_size = static_cast < int > ( std::sqrt ( roofs [i]->get_Area() ) );
+                    break;
+                }
+            }
+
+            auto response_diff = std::abs ( structures [1].response - structures [0].response ) / linear_size;
+            response_diff = response_diff < 1.0 ? 1.0 : response_diff;
+            const auto distance_diff = std::abs ( structures [1].length - structures [0].length ) / float ( max_structure_length );
+
+            return ( distance_diff / response_diff < 0.15 ) ? 1 : 0;
+        };
+
+        // Journal items are proj and shade pairs of each dataset in world coordinates, null where the roof is missing
+        auto journal_structure = [&journal] ( const int object_index, const gdal::polygons &roofs, const rsai::building_models::structure_responses &structures
+                                            , const std::vector < Eigen::Matrix3d > &raster_2_worlds, const int structure_index )
+        {
+            gdal::journal_record record { object_index, { structure_index }, double ( structures [structure_index].length ) };
+
+            const auto & geometry_list = structures [structure_index].projections_and_shades;
+            for ( int i = 0; i < geometry_list.size(); ++i )
+            {
+                if ( roofs [i] )
+                {
+                    record.items.push_back ( gdal::operator * ( geometry_list [i][1], raster_2_worlds [i] ) );
+                    record.items.push_back ( gdal::operator * ( geometry_list [i][2], raster_2_worlds [i] ) );
+                }
+                else
+                {
+                    record.items.push_back ( nullptr );
+                    record.items.push_back ( nullptr );
+                }
+            }
+
+            journal->append ( record );
+        };
+
         threading::layer_iterator a_layer_iterator ( leading_layer );
         layers_result &= a_layer_iterator ( [&] ( gdal::shared_feature feature, const int current_feature_id )
         {
@@ -122,6 +183,9 @@ rsai::multiview_building_reconstructor::multiview_building_reconstructor (
                 const int object_index = feature->GetFieldAsInteger ( id_field_name.c_str() );
                 const std::string object_index_str = std::to_string ( object_index );
 
+                if ( journal && journal->contains ( object_index ) )
+                    return;
+
                 //std::cout << "for ID = " << object_index_str << "\n";
 
                 gdal::polygons roofs;
@@ -255,6 +319,14 @@ rsai::multiview_building_reconstructor::multiview_building_reconstructor (
 
                 if ( an_interaction_mode == interaction_mode::external )
                     saver.write ( object_index_str, roofs, structures, tiles, tile_shifts, raster_2_worlds, structure_save_dirs );
+                else if ( a_run_mode == run_mode::automatic )
+                {
+                    // Automatic choice needs no review, the feature is completed right away
+                    if ( structures.size () == 0 )
+                        journal->append ( { object_index } );
+                    else
+                        journal_structure ( object_index, roofs, structures, raster_2_worlds, automatic_choice ( roofs, structures ) );
+                }
                 else
                 {
                     static std::mutex mutex;
@@ -283,16 +355,6 @@ rsai::multiview_building_reconstructor::multiview_building_reconstructor (
 
             std::map < int, int > choice_index_hist;
 
-            struct map_item
-            {
-                int object_index = 0;
-                int length = -1;
-                std::map < int, gdal::multipolygon > projes;
-                std::map < int, gdal::multipolygon > shades;
-            };
-
-            std::vector < map_item > map_items ( structure_list.size () );
-
             int key = 0;
             for ( int j = 0; j < structure_list.size (); )
             {
@@ -307,6 +369,7 @@ rsai::multiview_building_reconstructor::multiview_building_reconstructor (
                 if ( structures.size() == 0 )
                 {
                     std::cout << "Skipped feature " << obj_id << " with no structure variants\n";
+                    journal->append ( { std::stoi ( obj_id ) } );
                 }
                 else
                 {
@@ -396,36 +459,9 @@ rsai::multiview_building_reconstructor::multiview_building_reconstructor (
                         }
 
                         if ( a_run_mode == run_mode::automatic )
-                        {
-                            auto response_diff = std::abs ( structures [1].response - structures [0].response ) / linear_size;
-                            response_diff = response_diff < 1.0 ? 1.0 : response_diff;
-                            const auto distance_diff = std::abs ( structures [1].length - structures [0].length ) / float ( max_structure_length );
+                            current_structure_index = automatic_choice ( roofs, structures );
 
-                            if ( distance_diff / response_diff < 0.15 )
-                            {
-                                current_structure_index = 1;
-                            }
-                            else
-                                current_structure_index = 0;
-                        }
-
-                        auto geometry_list = structures [current_structure_index].projections_and_shades;
-                        for ( int i = 0; i < geometry_list.size(); ++i )
-                        {
-                            auto structure = geometry_list [i];
-
-                            if ( roofs [i] )
-                            {
-                                auto proj_world     = gdal::operator * ( structure [1], raster_2_worlds [i] );
-                                auto shade_world    = gdal::operator * ( structure [2], raster_2_worlds [i] );
-
-                                auto & item = map_items [j];
-                                item.object_index = std::stoi ( obj_id );
-                                item.projes [i] = proj_world;
-                                item.shades [i] = shade_world;
-                                item.length = structures [current_structure_index].length;
-                            }
-                        }
+                        journal_structure ( std::stoi ( obj_id ), roofs, structures, raster_2_worlds, current_structure_index );
 
                         if ( a_run_mode != run_mode::automatic )
                         {
@@ -458,7 +494,14 @@ rsai::multiview_building_reconstructor::multiview_building_reconstructor (
 //                        choice_time.flush ();
 
                         ++choice_index_hist [-1];
+
+                        if ( key == 27 )
+                            journal->append ( { std::stoi ( obj_id ) } );
                     }
+
+                    // Operator's decisions are expensive to repeat
+                    if ( a_run_mode != run_mode::automatic )
+                        journal->sync ();
                 }
 
                 if (key == 8)
@@ -487,13 +530,13 @@ rsai::multiview_building_reconstructor::multiview_building_reconstructor (
 
                 // Creating output roof, proj and shade layers
                 gdal::create_vector_helper layers_helper ( ds_outs [ds_index], std::cerr );
-                auto proj_layer = layers_helper.create_layer ( DEFAULT_PROJECTION_LAYER_NAME, wkbMultiPolygon, bounds_layer->GetSpatialRef(), force_rewrite, promt_func );
+                auto proj_layer = layers_helper.create_layer ( DEFAULT_PROJECTION_LAYER_NAME, wkbMultiPolygon, bounds_layer->GetSpatialRef(), force_rewrite || resume, promt_func );
                 if ( !proj_layer )
                     return;
 
                 proj_layer << gdal::field_definition ( DEFAULT_OBJECT_ID_FIELD_NAME, OFTInteger );
 
-                auto shade_layer = layers_helper.create_layer ( DEFAULT_SHADE_LAYER_NAME, wkbMultiPolygon, bounds_layer->GetSpatialRef(), force_rewrite, promt_func );
+                auto shade_layer = layers_helper.create_layer ( DEFAULT_SHADE_LAYER_NAME, wkbMultiPolygon, bounds_layer->GetSpatialRef(), force_rewrite || resume, promt_func );
                 if ( !shade_layer )
                     return;
 
@@ -510,33 +553,34 @@ rsai::multiview_building_reconstructor::multiview_building_reconstructor (
             }
 
             std::cout << "Saving results...";
-            for ( const auto &item : map_items )
+
+            // Output layers hold the decisions of this and the interrupted runs
+            journal->replay ( [&] ( const gdal::journal_record &record )
             {
-                for ( auto proj_pair : item.projes )
+                for ( int ds_index = 0; ds_index < ds_vectors.size () && 2 * ds_index + 1 < record.items.size (); ++ds_index )
                 {
-                    const int layer_index = proj_pair.first;
-                    const auto &shade_iter = item.shades.find ( layer_index );
-                    if ( shade_iter == item.shades.end () )
-                    {
-                        std::cerr << "Warning: shade for object " << item.object_index << "is not found\n";
+                    const auto & proj_world = record.items [2 * ds_index];
+                    const auto & shade_world = record.items [2 * ds_index + 1];
+                    if ( !proj_world || !shade_world )
                         continue;
-                    }
 
-                    gdal::shared_feature proj_feature ( proj_layer_iters [layer_index].layer()->GetLayerDefn() );
-                    proj_feature->SetGeometry ( proj_pair.second.get () );
-                    proj_feature->SetField ( DEFAULT_OBJECT_ID_FIELD_NAME, item.object_index );
+                    auto & proj_layer_iter = proj_layer_iters [ds_index];
+                    gdal::shared_feature proj_feature ( proj_layer_iter.layer()->GetLayerDefn() );
+                    proj_feature->SetGeometry ( proj_world.get () );
+                    proj_feature->SetField ( DEFAULT_OBJECT_ID_FIELD_NAME, record.object_index );
                     if ( height_factor > 0.0 )
-                        proj_feature->SetField ( DEFAULT_OBJECT_HEIGHT_FIELD_NAME, item.length * height_factor );
-                    proj_layer_iters [layer_index].set_feature( proj_feature );
+                        proj_feature->SetField ( DEFAULT_OBJECT_HEIGHT_FIELD_NAME, record.value * height_factor );
+                    proj_layer_iter.set_feature( proj_feature );
 
-                    gdal::shared_feature shade_feature ( shade_layer_iters [layer_index].layer()->GetLayerDefn() );
-                    shade_feature->SetGeometry ( shade_iter->second.get () );
-                    shade_feature->SetField ( DEFAULT_OBJECT_ID_FIELD_NAME, item.object_index );
+                    auto & shade_layer_iter = shade_layer_iters [ds_index];
+                    gdal::shared_feature shade_feature ( shade_layer_iter.layer()->GetLayerDefn() );
+                    shade_feature->SetGeometry ( shade_world.get () );
+                    shade_feature->SetField ( DEFAULT_OBJECT_ID_FIELD_NAME, record.object_index );
                     if ( height_factor > 0.0 )
-                        shade_feature->SetField ( DEFAULT_OBJECT_HEIGHT_FIELD_NAME, item.length * height_factor );
-                    shade_layer_iters [layer_index].set_feature( shade_feature );
+                        shade_feature->SetField ( DEFAULT_OBJECT_HEIGHT_FIELD_NAME, record.value * height_factor );
+                    shade_layer_iter.set_feature( shade_feature );
                 }
-            }
+            } );
 
             std::cout << "done\n";
         }
@@ -2,6 +2,7 @@
 
 #include "rsai/objects_bounds_finder.h"
 
+#include <atomic>
 #include <ogrsf_frmts.h>
 
 #include "common/definitions.h"
@@ -11,6 +12,8 @@
 #include "eigen_utils/geometry.h"
 #include "gdal_utils/shared_options.h"
 #include "gdal_utils/shared_feature.h"
+#include "threading_utils/gdal_iterators.h"
+#include "threading_utils/ordered_sink.h"
 
 template < class PromtFunc, class ProgressFunc >
 rsai::objects_bounds_finder::objects_bounds_finder (
@@ -112,9 +115,13 @@ rsai::objects_bounds_finder::objects_bounds_finder (
     const Eigen::Vector2d shade_max  = shade_step * max_projection_length;
 
     // Source object together with projecting and shading
-    std::list < Eigen::Vector2d > shifts = { { 0, 0 }, proj_max, shade_max };
+    Eigen::Matrix2Xd shifts ( 2, 3 );
+    shifts << Eigen::Vector2d::Zero (), proj_max, shade_max;
+
+    const Eigen::Vector2d raster_sizes ( ds_raster->GetRasterXSize () - 1, ds_raster->GetRasterYSize () - 1 );
 
     const int layers = ds_vector->GetLayerCount ();
+    const int threads_count = std::max ( 1u, std::thread::hardware_concurrency () );
 
     for( int i = 0; i < layers; ++i )
     {
@@ -134,53 +141,64 @@ rsai::objects_bounds_finder::objects_bounds_finder (
                   << gdal::field_definition ( DEFAULT_SHADE_STEP_Y_FIELD_NAME,  OFTReal )
                   << gdal::field_definition ( DEFAULT_VECTOR_MAX_LENGTH_NAME,   OFTInteger );
 
-        // Creating feature with fixed fields' values
-        gdal::shared_feature new_feature ( out_layer->GetLayerDefn() );
-        new_feature->SetField ( DEFAULT_OBJECT_ID_FIELD_NAME,    0 );
-        new_feature->SetField ( DEFAULT_PROJ_STEP_X_FIELD_NAME,  proj_vector [0] );
-        new_feature->SetField ( DEFAULT_PROJ_STEP_Y_FIELD_NAME,  proj_vector [1] );
-        new_feature->SetField ( DEFAULT_SHADE_STEP_X_FIELD_NAME, shade_vector [0] );
-        new_feature->SetField ( DEFAULT_SHADE_STEP_Y_FIELD_NAME, shade_vector [1] );
-        new_feature->SetField ( DEFAULT_VECTOR_MAX_LENGTH_NAME,  max_projection_length );
-
-        const float features_count = layer->GetFeatureCount ();
-        int features_processed = 0;
-
-        for ( const auto& feature: *layer )
+        // Features are written in the source order behind the workers
+        std::atomic_bool written ( true );
+        threading::ordered_sink < gdal::shared_feature > out_sink ( [&] ( const int, gdal::shared_feature &new_feature )
         {
-            progress_func ( i + 1, layers, ++features_processed / features_count );
+            if ( written && out_layer->CreateFeature( new_feature.get () ) != OGRERR_NONE )
+            {
+                std::cerr << "Stop: Failed to create feature." << std::endl;
+                written = false;
+            }
+        }, 1, threads_count * 4 );
 
+        threading::layer_iterator a_layer_iterator ( layer );
+        a_layer_iterator ( [&] ( gdal::shared_feature feature, const int current_feature_id )
+        {
             const OGRGeometry *geometry = feature->GetGeometryRef ();
-            if ( geometry != nullptr
-                    && wkbFlatten ( geometry->getGeometryType()) == wkbPolygon )
+            if ( !written || geometry == nullptr
+                    || wkbFlatten ( geometry->getGeometryType()) != wkbPolygon
+                    || geometry->toPolygon()->getExteriorRing () == nullptr )
             {
-                auto polygon = geometry->toPolygon();
+                out_sink.skip ( current_feature_id );
+                return;
+            }
 
-                gdal::polygon simplified_geometry ( new polygon::element_type );
-                simplified_geometry->addRing ( const_cast < OGRLinearRing * > ( polygon->getExteriorRing () ) );
+            auto exterior_ring = geometry->toPolygon()->getExteriorRing ();
 
-                // calculating bbox for RasterIO
-                auto bbox_geometry = gdal::bbox_and_projections_2_polygon ( simplified_geometry.get (), shifts
-                                                                            , { ds_raster->GetRasterXSize () - 1, ds_raster->GetRasterYSize () - 1 }
-                                                                            , raster_2_world, mask_size );
-                if ( bbox_geometry == nullptr )
-                    continue;
+            // calculating bbox for RasterIO from the contiguous ring coordinates
+            auto bbox_geometry = gdal::bbox_and_projections_2_polygon ( eigen::to_matrix ( exterior_ring ), shifts, raster_sizes
+                                                                        , raster_2_world, world_2_raster, mask_size );
+            if ( bbox_geometry == nullptr )
+            {
+                out_sink.skip ( current_feature_id );
+                return;
+            }
 
-                // Saving bbox together with polygon
-                bbox_geometry << simplified_geometry;
-                bbox_geometry->closeRings ();
+            gdal::polygon simplified_geometry ( new polygon::element_type );
+            simplified_geometry->addRing ( const_cast < OGRLinearRing * > ( exterior_ring ) );
 
-                new_feature->SetGeometry ( bbox_geometry.get () );
-                new_feature->SetField ( DEFAULT_OBJECT_ID_FIELD_NAME, features_processed );
+            // Saving bbox together with polygon
+            bbox_geometry << simplified_geometry;
+            bbox_geometry->closeRings ();
 
-                if( out_layer->CreateFeature( new_feature.get () ) != OGRERR_NONE )
-                {
-                    std::cerr << "Stop: Failed to create feature." << std::endl;
-                    return;
-                }
-            }
-        }
-        progress_func ( i + 1, layers, 1.0f, true );
+            // Creating feature with fixed fields' values
+            gdal::shared_feature new_feature ( out_layer->GetLayerDefn() );
+            new_feature->SetField ( DEFAULT_OBJECT_ID_FIELD_NAME,    current_feature_id );
+            new_feature->SetField ( DEFAULT_PROJ_STEP_X_FIELD_NAME,  proj_vector [0] );
+            new_feature->SetField ( DEFAULT_PROJ_STEP_Y_FIELD_NAME,  proj_vector [1] );
+            new_feature->SetField ( DEFAULT_SHADE_STEP_X_FIELD_NAME, shade_vector [0] );
+            new_feature->SetField ( DEFAULT_SHADE_STEP_Y_FIELD_NAME, shade_vector [1] );
+            new_feature->SetField ( DEFAULT_VECTOR_MAX_LENGTH_NAME,  max_projection_length );
+            new_feature->SetGeometry ( bbox_geometry.get () );
+
+            out_sink.push ( current_feature_id, new_feature );
+
+        }, i, layers, progress_func, threads_count );
+
+        out_sink.finish ();
+
+        if ( !written )
+            return;
     }
 }
-
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+#include <opencv2/opencv.hpp>
+
+#include "common/definitions.h"
+
+namespace opencv
+{
+    enum class artifact_level
+    {
+        off,
+        summary,
+        full
+    };
+
+    bool artifact_level_from_string ( const std::string &name, artifact_level &level );
+
+    // Debug images encoded and stored by a bounded pool of background threads. Images above the configured level
+    // are dropped by the caller's enabled () check before any work is done, the disabled writer has no threads.
+    class artifact_writer
+    {
+    public:
+        // Receives an image's file name and its encoded bytes instead of the file system, calls are serialized
+        using archive_sink = std::function < bool ( const std::string &, const std::vector < uchar > & ) >;
+
+        artifact_writer ( const artifact_level level = artifact_level::off, const int threads = DEFAULT_ARTIFACTS_THREADS
+                          , const size_t max_pending = DEFAULT_ARTIFACTS_PENDING );
+        ~artifact_writer ();
+
+        artifact_writer ( const artifact_writer & ) = delete;
+        artifact_writer & operator = ( const artifact_writer & ) = delete;
+
+        // Waits for queued images before switching
+        void            configure   ( const artifact_level level, archive_sink sink = {} );
+
+        bool            enabled     ( const artifact_level level ) const;
+
+        // Queues the image, blocks while the queue is full. The image is shared, not copied, so it must not be
+        // modified after the call. Format is chosen by the file name's extension.
+        void            write       ( const artifact_level level, const std::string &file_name, const cv::Mat &image );
+
+        // Waits for queued images
+        void            flush       ();
+
+        size_t          failed      () const;
+
+    private:
+        struct job
+        {
+            std::string file_name;
+            cv::Mat     image;
+        };
+
+        std::atomic < artifact_level >  m_level;
+        const int                       m_threads;
+        const size_t                    m_max_pending;
+
+        archive_sink                    m_sink;
+        std::mutex                      m_sink_lock;
+
+        std::deque < job >              m_jobs;
+        size_t                          m_busy = 0;
+        bool                            m_stop = false;
+        std::atomic < size_t >          m_failed { 0 };
+        mutable std::mutex              m_lock;
+        std::condition_variable         m_wake;
+        std::condition_variable         m_done;
+        std::vector < std::thread >     m_workers;
+
+        void            __work  ();
+        bool            __store ( const job &a_job );
+        void            __stop  ();
+    }; // class artifact_writer
+
+    // Process wide writer used by estimators and locators, it's off until configured
+    artifact_writer & artifacts ();
+
+}; // namespace opencv
@@ -15,6 +15,7 @@ namespace opencv
         dataset_roi_extractor( dataset_roi_extractor && src);
         dataset_roi_extractor(gdal::shared_dataset dataset);
         cv::Mat         roi     (gdal::bbox &bbox) const;
+        void            clip    (gdal::bbox &bbox) const;
         gdal::bbox      raster_bbox    (gdal::polygon roi);
 
         Eigen::Matrix3d raster_2_world () const;
@@ -0,0 +1,159 @@
+#include "opencv_utils/artifact_writer.h"
+
+#include <map>
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+
+using namespace opencv;
+
+bool opencv::artifact_level_from_string ( const std::string &name, artifact_level &level )
+{
+    static const std::map < std::string, artifact_level > levels = { { "off", artifact_level::off }
+                                                                   , { "summary", artifact_level::summary }
+                                                                   , { "full", artifact_level::full } };
+
+    auto found = levels.find ( name );
+    if ( found == levels.end () )
+        return false;
+
+    level = found->second;
+    return true;
+}
+
+artifact_writer::artifact_writer ( const artifact_level level, const int threads, const size_t max_pending )
+    : m_level ( artifact_level::off ), m_threads ( std::max ( 1, threads ) ), m_max_pending ( std::max < size_t > ( 1, max_pending ) )
+{
+    configure ( level );
+}
+
+artifact_writer::~artifact_writer ()
+{
+    flush ();
+    __stop ();
+}
+
+void artifact_writer::configure ( const artifact_level level, archive_sink sink )
+{
+    flush ();
+
+    {
+        std::scoped_lock lock ( m_sink_lock );
+        m_sink = std::move ( sink );
+    }
+
+    m_level = level;
+
+    // Threads are started on the first enabling only
+    std::scoped_lock lock ( m_lock );
+    if ( level != artifact_level::off && m_workers.empty () )
+    {
+        m_stop = false;
+        for ( int i = 0; i < m_threads; ++i )
+            m_workers.emplace_back ( &artifact_writer::__work, this );
+    }
+}
+
+bool artifact_writer::enabled ( const artifact_level level ) const
+{
+    return level != artifact_level::off && level <= m_level.load ();
+}
+
+void artifact_writer::write ( const artifact_level level, const std::string &file_name, const cv::Mat &image )
+{
+    if ( !enabled ( level ) || image.empty () )
+        return;
+
+    std::unique_lock lock ( m_lock );
+    m_done.wait ( lock, [this] { return m_jobs.size () < m_max_pending; } );
+
+    m_jobs.push_back ( { file_name, image } );
+    m_wake.notify_one ();
+}
+
+void artifact_writer::flush ()
+{
+    std::unique_lock lock ( m_lock );
+    m_done.wait ( lock, [this] { return m_jobs.empty () && m_busy == 0; } );
+}
+
+size_t artifact_writer::failed () const
+{
+    return m_failed;
+}
+
+void artifact_writer::__work ()
+{
+    std::unique_lock lock ( m_lock );
+    while ( true )
+    {
+        m_wake.wait ( lock, [this] { return m_stop || !m_jobs.empty (); } );
+
+        if ( m_jobs.empty () )
+            return;
+
+        job a_job = std::move ( m_jobs.front () );
+        m_jobs.pop_front ();
+        ++m_busy;
+        m_done.notify_all ();
+
+        lock.unlock ();
+        const bool stored = __store ( a_job );
+        lock.lock ();
+
+        if ( !stored )
+            ++m_failed;
+
+        --m_busy;
+        m_done.notify_all ();
+    }
+}
+
+bool artifact_writer::__store ( const job &a_job )
+{
+    const auto extension = std::filesystem::path ( a_job.file_name ).extension ().string ();
+
+    std::vector < uchar > encoded;
+    if ( !cv::imencode ( extension.empty () ? ".png" : extension, a_job.image, encoded ) )
+    {
+        std::cerr << "Failed to encode debug image " << a_job.file_name << std::endl;
+        return false;
+    }
+
+    {
+        std::scoped_lock lock ( m_sink_lock );
+        if ( m_sink )
+            return m_sink ( a_job.file_name, encoded );
+    }
+
+    std::ofstream out ( a_job.file_name, std::ios::binary | std::ios::trunc );
+    out.write ( reinterpret_cast < const char * > ( encoded.data () ), encoded.size () );
+
+    if ( !out.good () )
+    {
+        std::cerr << "Failed to write debug image " << a_job.file_name << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+void artifact_writer::__stop ()
+{
+    {
+        std::scoped_lock lock ( m_lock );
+        m_stop = true;
+    }
+    m_wake.notify_all ();
+
+    for ( auto & worker : m_workers )
+        worker.join ();
+
+    m_workers.clear ();
+}
+
+artifact_writer & opencv::artifacts ()
+{
+    static artifact_writer writer;
+    return writer;
+}
@@ -31,7 +31,7 @@ gdal::bbox dataset_roi_extractor::raster_bbox (gdal::polygon roi)
     return gdal::bbox ( raster_bounds );
 }
 
-cv::Mat dataset_roi_extractor::roi (gdal::bbox &bbox) const
+void dataset_roi_extractor::clip (gdal::bbox &bbox) const
 {
     int topLeftX = bbox.top_left().x();
     int topLeftY = bbox.top_left().y();
@@ -47,6 +47,16 @@ cv::Mat dataset_roi_extractor::roi (gdal::bbox &bbox) const
     bottomRightY = bottomRightY >= raster_height ? raster_height - 1 : bottomRightY;
 
     bbox.set ( {topLeftX, topLeftY}, {bottomRightX, bottomRightY} );
+}
+
+cv::Mat dataset_roi_extractor::roi (gdal::bbox &bbox) const
+{
+    clip ( bbox );
+
+    const int topLeftX = bbox.top_left().x();
+    const int topLeftY = bbox.top_left().y();
+    const int bottomRightX = bbox.bottom_right().x();
+    const int bottomRightY = bbox.bottom_right().y();
 
     const int width = bottomRightX - topLeftX;
     const int height = bottomRightY - topLeftY;
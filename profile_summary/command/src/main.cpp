@@ -0,0 +1,63 @@
+#include <iostream>
+#include <string>
+
+#include <args-parser/all.hpp>
+
+#include "common/definitions.h"
+#include "common/arguments.h"
+#include "common/string_utils.h"
+#include "rsai/profile_summary.h"
+
+using namespace std;
+
+int main ( int argc, char * argv[] )
+{
+    try
+    {
+        Args::CmdLine cmd( argc, argv );
+
+        Args::Arg profile_param( SL( "profile" ), true, true );
+        profile_param.setDescription( SL( "Per-feature performance records JSONL file written by a locator's --profile option. " ) );
+
+        Args::Arg & profile_top_param = arguments::get_profile_top ();
+
+        Args::Help help;
+        help.setAppDescription(
+            std::string ( "Utility to summarize locators' per-feature performance records. Prints percentiles of the total and "
+                          "stages' durations, the slowest objects with their characteristics and correlation of the duration "
+                          "with tile size, contour length, search region area, segments, candidates and scratch memory. " ) );
+        help.setExecutable( argv[0] );
+
+        cmd.addArg ( profile_param );
+        cmd.addArg ( profile_top_param );
+        cmd.addArg ( help );
+
+        cmd.parse();
+
+        value_helper < int > profile_top_helper         ( profile_top_param.value() );
+        if ( !profile_top_helper.verify ( std::cerr,    "STOP: Top objects quantity value is incorrect." ) )
+            return 1;
+
+        if ( profile_top_helper.value() < 0 )
+        {
+            std::cerr << "STOP: Top objects quantity must not be negative" << std::endl;
+            return 1;
+        }
+
+        std::vector < rsai::profile_record > records;
+        if ( !rsai::read_profiles ( profile_param.value(), records ) )
+            return 1;
+
+        rsai::summarize_profiles ( records, profile_top_helper.value(), std::cout );
+    }
+    catch( const Args::HelpHasBeenPrintedException & )
+    {
+    }
+    catch( const Args::BaseException & x )
+    {
+        Args::outStream() << x.desc() << SL( "\n" );
+    }
+
+
+    return 0;
+}
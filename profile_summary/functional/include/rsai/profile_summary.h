@@ -0,0 +1,20 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include <ostream>
+
+namespace rsai
+{
+    // Numeric fields of a feature's performance record by their names
+    using profile_record = std::map < std::string, double >;
+
+    // Reads a locator's --profile JSONL file, malformed lines are skipped with a warning
+    bool read_profiles ( const std::string &file_name, std::vector < profile_record > &records );
+
+    // Percentiles of total and stages' durations, the slowest objects with their characteristics
+    // and correlation of the total duration with every characteristic
+    void summarize_profiles ( const std::vector < profile_record > &records, const size_t top, std::ostream &out );
+
+}; // namespace rsai
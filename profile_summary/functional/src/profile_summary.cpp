@@ -0,0 +1,205 @@
+#include "rsai/profile_summary.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+
+using namespace rsai;
+
+namespace
+{
+    const char * const total_field = "total_ms";
+    const char * const stage_suffix = "_ms";
+
+    // Object characteristics the duration is correlated with
+    const std::vector < std::string > characteristics = { "tile_area", "contour_length", "search_area", "segments",
+                                                          "candidates", "variants", "scratch_bytes" };
+
+    // Records are flat objects of "name":number pairs written by profile_writer
+    bool __parse_record ( const std::string &line, profile_record &record )
+    {
+        size_t pos = line.find ( '{' );
+        if ( pos == std::string::npos )
+            return false;
+
+        while ( true )
+        {
+            const size_t name_begin = line.find ( '"', pos );
+            if ( name_begin == std::string::npos )
+                break;
+
+            const size_t name_end = line.find ( '"', name_begin + 1 );
+            const size_t colon = line.find ( ':', name_end );
+            if ( name_end == std::string::npos || colon == std::string::npos )
+                return false;
+
+            const char * value_begin = line.c_str () + colon + 1;
+            char * value_end = nullptr;
+            const double value = std::strtod ( value_begin, &value_end );
+            if ( value_end == value_begin )
+                return false;
+
+            record [line.substr ( name_begin + 1, name_end - name_begin - 1 )] = value;
+            pos = value_end - line.c_str ();
+        }
+
+        auto width = record.find ( "tile_width" );
+        auto height = record.find ( "tile_height" );
+        if ( width != record.end () && height != record.end () )
+            record ["tile_area"] = width->second * height->second;
+
+        return record.count ( total_field ) > 0;
+    }
+
+    double __percentile ( const std::vector < double > &sorted, const double percent )
+    {
+        const size_t index = std::min < size_t > ( sorted.size () - 1, std::ceil ( percent / 100.0 * sorted.size () ) - 1 );
+        return sorted [index];
+    }
+
+    // Pearson correlation over records having both fields, NaN if undefined
+    double __correlation ( const std::vector < profile_record > &records, const std::string &x_name, const std::string &y_name )
+    {
+        double sum_x = 0, sum_y = 0, sum_xx = 0, sum_yy = 0, sum_xy = 0;
+        size_t count = 0;
+        for ( const auto &record : records )
+        {
+            auto x = record.find ( x_name );
+            auto y = record.find ( y_name );
+            if ( x == record.end () || y == record.end () )
+                continue;
+
+            sum_x += x->second;
+            sum_y += y->second;
+            sum_xx += x->second * x->second;
+            sum_yy += y->second * y->second;
+            sum_xy += x->second * y->second;
+            ++count;
+        }
+
+        const double covariance = count * sum_xy - sum_x * sum_y;
+        const double deviation = std::sqrt ( count * sum_xx - sum_x * sum_x ) * std::sqrt ( count * sum_yy - sum_y * sum_y );
+        if ( count < 2 || deviation <= 0.0 )
+            return std::nan ( "" );
+
+        return covariance / deviation;
+    }
+
+    double __field ( const profile_record &record, const std::string &name )
+    {
+        auto it = record.find ( name );
+        return it != record.end () ? it->second : 0.0;
+    }
+}; // namespace
+
+bool rsai::read_profiles ( const std::string &file_name, std::vector < profile_record > &records )
+{
+    std::ifstream in ( file_name );
+    if ( !in )
+    {
+        std::cerr << "Unable to read profiles file: " << file_name << std::endl;
+        return false;
+    }
+
+    std::string line;
+    size_t line_number = 0;
+    while ( std::getline ( in, line ) )
+    {
+        ++line_number;
+        if ( line.find_first_not_of ( " \t\r" ) == std::string::npos )
+            continue;
+
+        profile_record record;
+        if ( __parse_record ( line, record ) )
+            records.push_back ( std::move ( record ) );
+        else
+            std::cerr << "Skipping malformed profile record at line " << line_number << std::endl;
+    }
+
+    return true;
+}
+
+void rsai::summarize_profiles ( const std::vector < profile_record > &records, const size_t top, std::ostream &out )
+{
+    out << "Profiles: " << records.size () << '\n';
+    if ( records.empty () )
+        return;
+
+    // Total is printed first, then the stages in name order
+    std::vector < std::string > durations = { total_field };
+    for ( const auto &record : records )
+        for ( const auto &field : record )
+        {
+            const auto &name = field.first;
+            if ( name.size () > 3 && name.compare ( name.size () - 3, 3, stage_suffix ) == 0
+                 && std::find ( durations.begin (), durations.end (), name ) == durations.end () )
+                durations.push_back ( name );
+        }
+
+    out << std::fixed << std::setprecision ( 2 );
+
+    out << '\n' << std::left << std::setw ( 28 ) << "duration, ms" << std::right
+        << std::setw ( 8 ) << "count" << std::setw ( 12 ) << "p50" << std::setw ( 12 ) << "p90"
+        << std::setw ( 12 ) << "p99" << std::setw ( 12 ) << "max" << std::setw ( 14 ) << "sum" << '\n';
+
+    for ( const auto &name : durations )
+    {
+        std::vector < double > values;
+        for ( const auto &record : records )
+        {
+            auto it = record.find ( name );
+            if ( it != record.end () )
+                values.push_back ( it->second );
+        }
+        std::sort ( values.begin (), values.end () );
+
+        double sum = 0.0;
+        for ( auto value : values )
+            sum += value;
+
+        out << std::left << std::setw ( 28 ) << name << std::right
+            << std::setw ( 8 ) << values.size () << std::setw ( 12 ) << __percentile ( values, 50 )
+            << std::setw ( 12 ) << __percentile ( values, 90 ) << std::setw ( 12 ) << __percentile ( values, 99 )
+            << std::setw ( 12 ) << values.back () << std::setw ( 14 ) << sum << '\n';
+    }
+
+    std::vector < const profile_record * > slowest;
+    for ( const auto &record : records )
+        slowest.push_back ( &record );
+
+    const size_t listed = std::min ( top, slowest.size () );
+    std::partial_sort ( slowest.begin (), slowest.begin () + listed, slowest.end (),
+                        [] ( auto a, auto b ) { return __field ( *a, total_field ) > __field ( *b, total_field ); } );
+
+    out << "\nSlowest " << listed << " objects:\n";
+    out << std::setw ( 10 ) << "id" << std::setw ( 12 ) << "total_ms";
+    for ( const auto &name : characteristics )
+        out << std::setw ( 16 ) << name;
+    out << '\n';
+
+    for ( size_t i = 0; i < listed; ++i )
+    {
+        const auto &record = *slowest [i];
+        out << std::setw ( 10 ) << std::setprecision ( 0 ) << __field ( record, "id" )
+            << std::setw ( 12 ) << std::setprecision ( 2 ) << __field ( record, total_field );
+        for ( const auto &name : characteristics )
+            out << std::setw ( 16 ) << __field ( record, name );
+        out << '\n';
+    }
+
+    out << "\nCorrelation of total_ms with:\n";
+    for ( const auto &name : characteristics )
+    {
+        const double correlation = __correlation ( records, name, total_field );
+        out << "    " << std::left << std::setw ( 20 ) << name << std::right;
+        if ( std::isnan ( correlation ) )
+            out << "n/a\n";
+        else
+            out << std::setprecision ( 3 ) << correlation << '\n';
+    }
+
+    out << std::defaultfloat;
+}
@@ -2,6 +2,7 @@
 
 #include <string>
 #include <opencv2/opencv.hpp>
+#include "opencv_utils/artifact_writer.h"
 #include "rsai/building_models/structure_estimator.h"
 #include "rsai/building_models/roof_estimator.h"
 #include "rsai/building_models/multiview_estimator.h"
@@ -23,7 +24,10 @@ namespace rsai
                      , const std::vector < Eigen::Matrix3d > &raster_2_worlds, const std::vector < std::string > &save_dirs );
 
     private:
-        std::string m_target_dir;        
+        std::string m_target_dir;
+        // Variants are the external review input, so images are always written, in background
+        opencv::artifact_writer m_images;
+
         bool __write_wkt ( const std::string &file_name, const OGRGeometry * geom ) const;
     }; // class buiding_variants_saver
 }; // namespace rsai
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <fstream>
+
+namespace rsai
+{
+    // Characteristics and compute time of one located feature
+    class feature_profile
+    {
+    public:
+        feature_profile ( const int object_index );
+
+        // Ends the stage started by the previous lap or the profile's creation
+        void            lap             ( const char * stage );
+        double          total_ms        () const;
+
+        int             object_index    = 0;
+        int             tile_width      = 0;
+        int             tile_height     = 0;
+        // Object's contour length, world units
+        double          contour_length  = 0.0;
+        // Roof search region area, pixels
+        double          search_area     = 0.0;
+        int             segments        = 0;
+        size_t          candidates      = 0;
+        size_t          variants        = 0;
+        size_t          scratch_bytes   = 0;
+
+        // Stages' names and durations, ms
+        std::vector < std::pair < const char *, double > > stages;
+
+    private:
+        std::chrono::steady_clock::time_point m_start;
+        std::chrono::steady_clock::time_point m_lap;
+    }; // class feature_profile
+
+    // JSONL file of the features' profiles, a record per line. Writes are serialized.
+    class profile_writer
+    {
+    public:
+        bool            open    ( const std::string &file_name );
+        void            close   ();
+
+        bool            enabled () const;
+        void            write   ( const feature_profile &profile );
+
+    private:
+        std::atomic_bool m_enabled { false };
+        std::ofstream   m_out;
+        std::mutex      m_lock;
+    }; // class profile_writer
+
+    // Process wide profiles writer used by locators, it's off until opened
+    profile_writer & feature_profiles ();
+
+}; // namespace rsai
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <map>
+#include <list>
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+#include <opencv2/opencv.hpp>
+
+#include "common/definitions.h"
+#include "threading_utils/thread_pool.h"
+
+namespace rsai
+{
+    // Reviewed variant of an item: roof and shade candidates' indices and view toggles
+    struct frame_key
+    {
+        int  roof   = 0;
+        int  shade  = 0;
+        bool markup = false;
+        bool model  = true;
+
+        bool operator <  ( const frame_key &rh ) const;
+        bool operator == ( const frame_key &rh ) const;
+    };
+
+    // Frames rendered ahead by background threads. A reviewer asks for the shown frame and hints the frames
+    // reachable by the next keypress, so navigation is mostly a lookup. Doesn't depend on a display.
+    template < class Key >
+    class frame_cache
+    {
+    public:
+        using render_func = std::function < cv::Mat ( const Key & ) >;
+
+        frame_cache ( const size_t capacity = DEFAULT_FRAME_CACHE_SIZE, const int threads = DEFAULT_FRAME_CACHE_THREADS );
+        ~frame_cache ();
+
+        frame_cache ( const frame_cache & ) = delete;
+        frame_cache & operator = ( const frame_cache & ) = delete;
+
+        // Starts a new reviewed item, frames and requests of the previous one are dropped
+        void        reset       ( render_func render );
+
+        // Cached frame, rendered by the calling thread if missing
+        cv::Mat     get         ( const Key &key );
+        // Replaces pending requests, frames are rendered in the given order
+        void        prefetch    ( const std::vector < Key > &keys );
+
+        bool        contains    ( const Key &key ) const;
+        size_t      size        () const;
+
+    private:
+        const size_t                m_capacity;
+
+        render_func                 m_render;
+        uint64_t                    m_generation = 0;
+        std::map < Key, cv::Mat >   m_frames;
+        std::list < Key >           m_recent;
+        std::deque < Key >          m_pending;
+        bool                        m_stop = false;
+
+        mutable std::mutex          m_lock;
+        std::condition_variable     m_wake;
+        std::unique_ptr < threading::worker_pool > m_workers;
+
+        void                        __work  ();
+        void                        __store ( const Key &key, cv::Mat frame );
+    }; // class frame_cache
+
+} // namespace rsai
+
+#include "rsai/frame_cache.hpp"
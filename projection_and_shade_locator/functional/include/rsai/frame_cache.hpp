@@ -0,0 +1,154 @@
+#pragma once
+
+#include "rsai/frame_cache.h"
+
+#include <tuple>
+#include <algorithm>
+
+inline bool rsai::frame_key::operator < ( const frame_key &rh ) const
+{
+    return std::tie ( roof, shade, markup, model ) < std::tie ( rh.roof, rh.shade, rh.markup, rh.model );
+}
+
+inline bool rsai::frame_key::operator == ( const frame_key &rh ) const
+{
+    return std::tie ( roof, shade, markup, model ) == std::tie ( rh.roof, rh.shade, rh.markup, rh.model );
+}
+
+template < class Key >
+rsai::frame_cache < Key >::frame_cache ( const size_t capacity, const int threads )
+    : m_capacity ( std::max < size_t > ( 1, capacity ) )
+{
+    m_workers.reset ( new threading::worker_pool ( [this] () { __work (); }, std::max ( 1, threads ) ) );
+}
+
+template < class Key >
+rsai::frame_cache < Key >::~frame_cache ()
+{
+    {
+        std::scoped_lock lock ( m_lock );
+        m_stop = true;
+    }
+    m_wake.notify_all ();
+
+    // Pool destruction joins workers
+    m_workers.reset ();
+}
+
+template < class Key >
+void rsai::frame_cache < Key >::reset ( render_func render )
+{
+    std::scoped_lock lock ( m_lock );
+
+    m_render = std::move ( render );
+    ++m_generation;
+    m_frames.clear ();
+    m_recent.clear ();
+    m_pending.clear ();
+}
+
+template < class Key >
+cv::Mat rsai::frame_cache < Key >::get ( const Key &key )
+{
+    render_func render;
+    uint64_t generation = 0;
+    {
+        std::scoped_lock lock ( m_lock );
+
+        auto found = m_frames.find ( key );
+        if ( found != m_frames.end () )
+        {
+            m_recent.remove ( key );
+            m_recent.push_front ( key );
+            return found->second;
+        }
+
+        render = m_render;
+        generation = m_generation;
+    }
+
+    if ( !render )
+        return {};
+
+    auto frame = render ( key );
+
+    std::scoped_lock lock ( m_lock );
+    if ( generation == m_generation )
+        __store ( key, frame );
+
+    return frame;
+}
+
+template < class Key >
+void rsai::frame_cache < Key >::prefetch ( const std::vector < Key > &keys )
+{
+    {
+        std::scoped_lock lock ( m_lock );
+
+        m_pending.clear ();
+        for ( const auto &key : keys )
+            if ( m_frames.find ( key ) == m_frames.end () )
+                m_pending.push_back ( key );
+    }
+    m_wake.notify_all ();
+}
+
+template < class Key >
+bool rsai::frame_cache < Key >::contains ( const Key &key ) const
+{
+    std::scoped_lock lock ( m_lock );
+    return m_frames.find ( key ) != m_frames.end ();
+}
+
+template < class Key >
+size_t rsai::frame_cache < Key >::size () const
+{
+    std::scoped_lock lock ( m_lock );
+    return m_frames.size ();
+}
+
+template < class Key >
+void rsai::frame_cache < Key >::__work ()
+{
+    std::unique_lock lock ( m_lock );
+    while ( true )
+    {
+        m_wake.wait ( lock, [this] { return m_stop || ( !m_pending.empty () && m_render ); } );
+
+        if ( m_stop )
+            return;
+
+        const Key key = m_pending.front ();
+        m_pending.pop_front ();
+
+        if ( m_frames.find ( key ) != m_frames.end () )
+            continue;
+
+        auto render = m_render;
+        const auto generation = m_generation;
+
+        lock.unlock ();
+        auto frame = render ( key );
+        lock.lock ();
+
+        // Frames of a previous item are dropped
+        if ( generation == m_generation )
+            __store ( key, frame );
+    }
+}
+
+template < class Key >
+void rsai::frame_cache < Key >::__store ( const Key &key, cv::Mat frame )
+{
+    if ( m_frames.find ( key ) == m_frames.end () )
+        m_recent.push_front ( key );
+
+    m_frames [key] = frame;
+
+    // Least recently used frames go first
+    while ( m_frames.size () > m_capacity && !m_recent.empty () )
+    {
+        m_frames.erase ( m_recent.back () );
+        m_recent.pop_back ();
+    }
+}
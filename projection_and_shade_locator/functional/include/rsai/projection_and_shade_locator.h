@@ -5,6 +5,7 @@
 
 #include "common/promt_functions.hpp"
 #include "common/progress_functions.hpp"
+#include "rsai/sam_segmentor.h"
 
 namespace rsai
 {
@@ -40,7 +41,9 @@ namespace rsai
                                         , const int roof_variants
                                         , const int shade_variants
                                         , const bool force_rewrite
+                                        , const bool resume
                                         , const bool use_sam = false
+                                        , const segmentation_service &segmentation = {}
                                         , run_mode mode = run_mode::automatic
                                         , interaction_mode interaction = interaction_mode::internal
                                         , const PromtFunc &promt_func = rewrite_layer_promt_dummy
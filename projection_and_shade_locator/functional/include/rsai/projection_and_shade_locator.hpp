@@ -4,6 +4,7 @@
 
 #include <ogrsf_frmts.h>
 #include <cstdint>
+#include <optional>
 
 #include "common/definitions.h"
 #include "gdal_utils/all_helpers.h"
@@ -13,17 +14,26 @@
 #include "eigen_utils/math.hpp"
 #include "gdal_utils/shared_options.h"
 #include "gdal_utils/shared_feature.h"
+#include "gdal_utils/segment_store.h"
+#include "gdal_utils/feature_journal.h"
 #include "opencv_utils/raster_roi.h"
 #include "opencv_utils/gdal_bridges.h"
 #include "opencv_utils/geometry_renderer.h"
+#include "opencv_utils/artifact_writer.h"
 #include "threading_utils/gdal_iterators.h"
+#include "threading_utils/ordered_sink.h"
+#include "threading_utils/trace.h"
 #include "rsai/building_models/prismatic.h"
 #include "rsai/building_models/roof_estimator.h"
 #include "rsai/building_models/structure_estimator.h"
+#include "rsai/building_models/estimator_capture.h"
 #include "differentiation/convolution_mask.h"
 #include "differentiation/gauss_directed_derivative.h"
 #include "differentiation/edge_detection.h"
 #include "rsai/building_variants_saver.h"
+#include "rsai/review_store.h"
+#include "rsai/feature_profile.h"
+#include "rsai/frame_cache.h"
 #include "rsai/building_models/building_renderer.h"
 #include "rsai/sam_segmentor.h"
 
@@ -43,15 +53,6 @@ struct model_details
     bool operator > ( const model_details &rh ) const { return estimate > rh.estimate; }
 };
 
-struct tile_info
-{
-    cv::Mat tile;
-    cv::Mat tile_marked;
-    Eigen::Vector2d top_left;
-    std::string index;
-    gdal::polygon original_object;
-};
-
 template < class PromtFunc, class ProgressFunc >
 rsai::projection_and_shade_locator::projection_and_shade_locator (
                                                                      gdal::shared_dataset &ds_vector
@@ -63,7 +64,9 @@ rsai::projection_and_shade_locator::projection_and_shade_locator (
                                                                    , const int roof_variants
                                                                    , const int shade_variants
                                                                    , const bool force_rewrite
+                                                                   , const bool resume
                                                                    , const bool use_sam
+                                                                   , const segmentation_service &segmentation
                                                                    , run_mode a_run_mode
                                                                    , interaction_mode an_interaction_mode
                                                                    , const PromtFunc &promt_func
@@ -78,7 +81,7 @@ rsai::projection_and_shade_locator::projection_and_shade_locator (
     Eigen::Matrix3d world_2_raster = raster_2_world.inverse ();
 
     const std::string dst_dir = std::string ( ds_out->GetDescription() ) + "/" + DEFAULT_SEGMENTS_DIRECTORY + "/";
-    sam_segmentor segmentor ( ds_raster, ds_vector, dst_dir );
+    sam_segmentor segmentor ( ds_raster, ds_vector, dst_dir, segmentation );
     //if ( use_sam )
     {
         std::cout << "Creating Segment anything objects' boundaries...\n";
@@ -96,20 +99,25 @@ rsai::projection_and_shade_locator::projection_and_shade_locator (
     {
         auto layer = ds_vector->GetLayer ( i );
 
-        // Creating output roof, proj and shade layers
+        // Creating output roof, proj and shade layers, a resumed run rebuilds them from the journal
         gdal::create_vector_helper layers_helper ( ds_out, std::cerr );
-        auto roof_layer = layers_helper.create_layer ( DEFAULT_ROOF_LAYER_NAME, wkbMultiPolygon, layer->GetSpatialRef(), force_rewrite, promt_func );
+        auto roof_layer = layers_helper.create_layer ( DEFAULT_ROOF_LAYER_NAME, wkbMultiPolygon, layer->GetSpatialRef(), force_rewrite || resume, promt_func );
         if ( !roof_layer )
             continue;
 
-        auto proj_layer = layers_helper.create_layer ( DEFAULT_PROJECTION_LAYER_NAME, wkbMultiPolygon, layer->GetSpatialRef(), force_rewrite, promt_func );
+        auto proj_layer = layers_helper.create_layer ( DEFAULT_PROJECTION_LAYER_NAME, wkbMultiPolygon, layer->GetSpatialRef(), force_rewrite || resume, promt_func );
         if ( !proj_layer )
             continue;
 
-        auto shade_layer = layers_helper.create_layer ( DEFAULT_SHADE_LAYER_NAME, wkbMultiPolygon, layer->GetSpatialRef(), force_rewrite, promt_func );
+        auto shade_layer = layers_helper.create_layer ( DEFAULT_SHADE_LAYER_NAME, wkbMultiPolygon, layer->GetSpatialRef(), force_rewrite || resume, promt_func );
         if ( !shade_layer )
             continue;
 
+        // Objects' ids tie the results to the source features, e.g. for merging shards
+        roof_layer << gdal::field_definition ( DEFAULT_OBJECT_ID_FIELD_NAME, OFTInteger );
+        proj_layer << gdal::field_definition ( DEFAULT_OBJECT_ID_FIELD_NAME, OFTInteger );
+        shade_layer << gdal::field_definition ( DEFAULT_OBJECT_ID_FIELD_NAME, OFTInteger );
+
         const float features_count = layer->GetFeatureCount ();
         std::atomic_int features_processed ( 0 );
 
@@ -123,10 +131,78 @@ rsai::projection_and_shade_locator::projection_and_shade_locator (
 
         opencv::dataset_roi_extractor ds_tile_extractor ( ds_raster );
         rsai::building_variants_saver saver ( std::string ( ds_out->GetDescription() ) + "/" + DEFAULT_VARIANTS_DIRECTORY );
-        std::vector < std::pair < tile_info, rsai::building_models::structures > > positions_list;
 
-        threading::layer_iterator a_layer_iterator ( layer );
-        layers_result &= a_layer_iterator ( [&] ( gdal::shared_feature feature, const int current_feature_id )
+        // Candidates for internal review are spilled to a memory mapped file instead of being kept in RAM
+        std::unique_ptr < rsai::review_store < rsai::building_models::structures > > positions_store;
+
+        struct map_item
+        {
+            int object_index = 0;
+            gdal::multipolygon roof;
+            gdal::multipolygon proj;
+            gdal::multipolygon shade;
+        };
+
+        // Roof, proj and shade geometries of a selected model, the journal records keep the same order
+        auto write_item = [&] ( const int object_index, const gdal::geometries &items )
+        {
+            gdal::shared_feature roof_feature ( roof_layer->GetLayerDefn() );
+            roof_feature->SetGeometry ( items [0].get () );
+            roof_feature->SetField ( id_field_name.c_str(), object_index );
+            roof_layer_iter.set_feature( roof_feature );
+
+            gdal::shared_feature proj_feature ( proj_layer->GetLayerDefn() );
+            proj_feature->SetGeometry ( items [1].get () );
+            proj_feature->SetField ( id_field_name.c_str(), object_index );
+            proj_layer_iter.set_feature( proj_feature );
+
+            gdal::shared_feature shade_feature ( shade_layer->GetLayerDefn() );
+            shade_feature->SetGeometry ( items [2].get () );
+            shade_feature->SetField ( id_field_name.c_str(), object_index );
+            shade_layer_iter.set_feature( shade_feature );
+        };
+
+        // Features completed in internal mode are journaled, a resumed run skips them
+        std::unique_ptr < gdal::feature_journal > journal;
+        if ( an_interaction_mode == interaction_mode::internal )
+        {
+            journal.reset ( new gdal::feature_journal ( std::string ( ds_out->GetDescription() ) + "/" + layer->GetName () + DEFAULT_JOURNAL_FILE_EXT, resume ) );
+            if ( !journal->is_open () )
+                continue;
+
+            if ( journal->resumed () > 0 )
+                std::cout << "Resuming after " << journal->resumed () << " completed features\n";
+        }
+
+        auto journal_item = [&journal] ( const int object_index, std::vector < int > variants, const map_item &item )
+        {
+            journal->append ( { object_index, std::move ( variants ), 0.0, { item.roof, item.proj, item.shade } } );
+        };
+
+        // Automatic mode streams the selected models straight to the output layers in the source order,
+        // tiles and estimates are dropped by workers
+        const bool streaming = an_interaction_mode == interaction_mode::internal && a_run_mode == run_mode::automatic;
+        std::unique_ptr < threading::ordered_sink < map_item > > out_sink;
+        if ( streaming )
+        {
+            // Results of the interrupted run go first
+            journal->replay ( [&] ( const gdal::journal_record &record )
+            {
+                if ( !record.variants.empty () )
+                    write_item ( record.object_index, record.items );
+            } );
+
+            out_sink.reset ( new threading::ordered_sink < map_item > ( [&] ( const int, map_item &item )
+            {
+                RSAI_TRACE_SPAN ( "write" );
+                write_item ( item.object_index, { item.roof, item.proj, item.shade } );
+            }, 1, std::max ( 1u, std::thread::hardware_concurrency () ) * 4 ) );
+        }
+        else if ( an_interaction_mode == interaction_mode::internal )
+            positions_store.reset ( new rsai::review_store < rsai::building_models::structures > (
+                                        std::string ( ds_out->GetDescription() ) + "/" + layer->GetName () + DEFAULT_REVIEW_STORE_FILE_EXT ) );
+
+        auto locate = [&] ( gdal::shared_feature feature, const int current_feature_id ) -> std::optional < map_item >
         {
             const OGRGeometry *geometry = feature->GetGeometryRef ();
             if ( geometry != nullptr
@@ -135,23 +211,33 @@ rsai::projection_and_shade_locator::projection_and_shade_locator (
                 const int object_index = feature->GetFieldAsInteger ( id_field_name.c_str() );
                 const std::string object_index_str = std::to_string ( object_index );
 
+                RSAI_TRACE_FEATURE ( object_index );
+                RSAI_TRACE_SPAN ( "locate" );
+                rsai::feature_profile profile ( object_index );
+
+                if ( journal && journal->contains ( object_index ) )
+                    return {};
+
                 auto polygon = geometry->toPolygon();
 
                 if ( polygon == nullptr )
-                    return;
+                    return {};
 
                 // Getting bbox and polygon
                 auto bounds_ring = polygon->getExteriorRing ();
                 auto object = polygon->getInteriorRing ( 0 );
 
                 if ( bounds_ring == nullptr || object == nullptr )
-                    return;
+                    return {};
 
                 // Extracting a desired object's tile from source raster
                 auto tile_bounds = instance < gdal::polygon > ();
                 tile_bounds->addRingDirectly ( bounds_ring->clone () );
+                RSAI_TRACE_BEGIN ( tile_span, "tile read" );
                 auto tile_bbox  = ds_tile_extractor.raster_bbox ( tile_bounds );
                 auto tile       = ds_tile_extractor.roi ( tile_bbox );
+                RSAI_TRACE_END ( tile_span );
+                profile.lap ( "tile_read" );
 
                 // Loading objects' edges maps
                 //cv::Mat edges = cv::Mat::ones( tile.size (), CV_8U );
@@ -161,15 +247,18 @@ rsai::projection_and_shade_locator::projection_and_shade_locator (
                 {
                     //edges = cv::imread ( dst_dir + object_index_str + "_edges.jpg" );
 
-                    cv::imwrite ( dst_dir + object_index_str + "_tile.jpg", tile );
+                    opencv::artifacts ().write ( opencv::artifact_level::summary, dst_dir + object_index_str + "_tile.jpg", tile );
 
-                    segments = to_polygon ( gdal::from_wkt_file ( dst_dir + DEFAULT_OBJECT_WKT_FILE_PREFIX + object_index_str + ".wkt" ) );
+                    RSAI_TRACE_SPAN ( "sam load" );
+                    segments = to_polygon ( gdal::from_segments_file ( dst_dir + DEFAULT_OBJECT_WKT_FILE_PREFIX + object_index_str + DEFAULT_SEGMENT_STORE_FILE_EXT ) );
 
 //                    if ( tile.size () != edges.size () )
 //                        std::cerr << "Stop: Image tile and edges size missmatch! "
 //                                  << "Tile: " << tile.size () << " edges: " << edges.size () << '\n';
                 }
 
+                profile.lap ( "prepare" );
+
                 // Projecting and shading vectors
                 cv::Mat tile_gray;
                 cv::cvtColor ( tile, tile_gray, cv::COLOR_BGR2GRAY );
@@ -197,50 +286,117 @@ rsai::projection_and_shade_locator::projection_and_shade_locator (
                 auto roof = instance < gdal::polygon > ();
                 roof->addRingDirectly ( object->clone() );
 
+                if ( building_models::estimator_captures ().enabled () )
+                {
+                    building_models::estimator_input input;
+                    input.object_index = object_index;
+                    input.tile_gray = tile_gray;
+                    input.world_2_raster = world_2_raster;
+                    input.tile_top_left = tile_bbox.top_left ();
+                    input.proj_world = proj_world;
+                    input.shade_world = shade_world;
+                    input.max_length = max_length;
+                    input.roof = roof;
+                    input.segments = segments;
+                    input.use_sam = use_sam;
+                    input.roof_position_walk = roof_position_walk;
+                    input.roof_variants = roof_variants;
+                    input.estimate_structure = true;
+                    input.segmentize_step = segmentize_step;
+                    input.projection_step = projection_step;
+                    input.shade_variants = shade_variants;
+                    building_models::estimator_captures ().write ( input );
+                }
+
                 // Estimating roof position
                 rsai::building_models::roof_estimator roof_estimator ( roof_position_walk, world_2_raster, proj_world, shade_world, max_length, tile_gray );
 
                 auto responses = ( use_sam ) ? roof_estimator ( roof, -tile_bbox.top_left(), segments, roof_variants, dst_dir + object_index_str + "_" )
                                              : roof_estimator ( roof, -tile_bbox.top_left(), roof_variants );
+                profile.lap ( "roof_estimation" );
 
-                cv::imwrite ( dst_dir + object_index_str + "_heat.jpg", roof_estimator.heatmap() );
+                opencv::artifacts ().write ( opencv::artifact_level::summary, dst_dir + object_index_str + "_heat.jpg", roof_estimator.heatmap() );
 
                 // Estimating building's structure
                 rsai::building_models::structure_estimator structure_estimator ( model, responses, tile_gray, tile_bbox.top_left(), world_2_raster, segmentize_step, segments );
                 auto position_estimates = structure_estimator ( max_length, projection_step, roof_variants, shade_variants );
+                profile.lap ( "structure_estimation" );
+
+                if ( rsai::feature_profiles ().enabled () )
+                {
+                    const auto & estimator_stats = roof_estimator.stats ();
+                    profile.tile_width = tile.cols;
+                    profile.tile_height = tile.rows;
+                    profile.contour_length = object->get_Length ();
+                    profile.search_area = estimator_stats.search_area;
+                    profile.segments = segments.size ();
+                    profile.candidates = estimator_stats.candidates;
+                    profile.variants = position_estimates.size ();
+                    profile.scratch_bytes = estimator_stats.scratch_bytes;
+                    rsai::feature_profiles ().write ( profile );
+                }
 
                 if ( an_interaction_mode == interaction_mode::external )
                     saver.write ( object_index_str, position_estimates, tile, tile_bbox.top_left(), raster_2_world );
 
+                if ( streaming )
                 {
-                    static std::mutex mutex;
-                    std::lock_guard < std::mutex > lock ( mutex );
+                    if ( position_estimates.size() == 0 || position_estimates [0].shades.size() == 0 )
+                    {
+                        std::cout << "Skipped feature " << object_index_str << " with no positions\n";
+                        journal->append ( { object_index } );
+                        return {};
+                    }
+
+                    // Same choice as the automatic review does
+                    auto & shades = position_estimates [0].shades;
+                    const int shade_index = std::min < size_t > ( 1, shades.size() - 1 );
+                    auto local_model = shades [shade_index].model ();
+                    local_model.transform_2_world ( raster_2_world, tile_bbox.top_left() );
 
-                    positions_list.push_back ( { { tile, tile, tile_bbox.top_left(), object_index_str }, std::move ( position_estimates ) } );
+                    map_item item { object_index, local_model.roof (), local_model.projection(), local_model.shade () };
+                    journal_item ( object_index, { 0, shade_index }, item );
+
+                    return item;
                 }
+
+                if ( positions_store )
+                    positions_store->push ( { tile, tile, tile_bbox.top_left(), object_index_str }, position_estimates );
             }
+
+            return {};
+        };
+
+        threading::layer_iterator a_layer_iterator ( layer );
+        layers_result &= a_layer_iterator ( [&] ( gdal::shared_feature feature, const int current_feature_id )
+        {
+            auto item = locate ( feature, current_feature_id );
+
+            // Every feature id has to reach the bounded sink
+            if ( out_sink && item )
+                out_sink->push ( current_feature_id, std::move ( *item ) );
+            else if ( out_sink )
+                out_sink->skip ( current_feature_id );
         } , i, layers, progress_func );
 
-        if ( an_interaction_mode == interaction_mode::internal )
+        if ( streaming )
+            out_sink->finish ();
+        else if ( an_interaction_mode == interaction_mode::internal )
         {
 
             std::cout << "Result reviewing...\n";
 
-            struct map_item
-            {
-                gdal::multipolygon roof;
-                gdal::multipolygon proj;
-                gdal::multipolygon shade;
-            };
+            if ( !positions_store->seal () )
+                continue;
 
-            std::vector < map_item > map_items ( positions_list.size () );
+            rsai::frame_cache < rsai::frame_key > frames;
 
             int key = 0;
 
-            gdal::shared_feature new_feature ( roof_layer_iter.layer()->GetLayerDefn() );
-            for ( int j = 0; j < positions_list.size (); )
+            for ( int j = 0; j < positions_store->size (); )
             {
-                auto &positions_data = positions_list [j];
+                auto positions_item = positions_store->get ( j );
+                auto &positions_data = *positions_item;
                 const auto &tile_tl = positions_data.first.top_left;
                 auto &positions = positions_data.second;
                 auto obj_id = positions_data.first.index;
@@ -248,6 +404,7 @@ rsai::projection_and_shade_locator::projection_and_shade_locator (
                 if ( positions.size() == 0 )
                 {
                     std::cout << "Skipped feature " << obj_id << " with no positions\n";
+                    journal->append ( { std::stoi ( obj_id ) } );
                 }
                 else
                 {
@@ -258,18 +415,13 @@ rsai::projection_and_shade_locator::projection_and_shade_locator (
                     int current_shade_index = 0;
                     cv::namedWindow("Image", cv::WINDOW_AUTOSIZE);
 
-                    while (true && a_run_mode != run_mode::automatic )
+                    frames.reset ( [positions_item] ( const rsai::frame_key &view )
                     {
+                        auto tile = positions_item->first.tile.clone ();
 
-                        std::cout << "Reveiwing " << obj_id << " with positions count " << positions.size() << "\n";
-                        std::cout.flush();
-
-
-                        auto tile = positions_data.first.tile.clone ();
-
-                        if ( draw_model )
+                        if ( view.model )
                         {
-                            auto & local_model = positions[current_roof_index].shades [current_shade_index].model;
+                            auto local_model = positions_item->second [view.roof].shades [view.shade].model ();
                             auto model_geometries = local_model.get();
 
                             building_renderer renderer ( tile );
@@ -281,6 +433,31 @@ rsai::projection_and_shade_locator::projection_and_shade_locator (
                             tile = renderer.get ();
                         }
 
+                        return tile;
+                    } );
+
+                    // A variant exists only if its roof has the shade index
+                    auto has_view = [&positions] ( const int roof, const int shade )
+                    {
+                        return roof >= 0 && roof < positions.size () && shade >= 0 && shade < positions [roof].shades.size ();
+                    };
+
+                    while (true && a_run_mode != run_mode::automatic )
+                    {
+
+                        std::cout << "Reveiwing " << obj_id << " with positions count " << positions.size() << "\n";
+                        std::cout.flush();
+
+                        auto tile = frames.get ( { current_roof_index, current_shade_index, false, draw_model } );
+
+                        // Frames reachable by the next keypress are rendered while the operator looks at this one
+                        std::vector < rsai::frame_key > next_views;
+                        for ( const auto & step : { std::make_pair ( 1, 0 ), std::make_pair ( 0, 1 ), std::make_pair ( -1, 0 ), std::make_pair ( 0, -1 ) } )
+                            if ( has_view ( current_roof_index + step.first, current_shade_index + step.second ) )
+                                next_views.push_back ( { current_roof_index + step.first, current_shade_index + step.second, false, draw_model } );
+                        next_views.push_back ( { current_roof_index, current_shade_index, false, !draw_model } );
+                        frames.prefetch ( next_views );
+
                         cv::imshow("Image", tile);
                         key = cv::waitKey(0);
 
@@ -320,17 +497,18 @@ rsai::projection_and_shade_locator::projection_and_shade_locator (
                             current_shade_index = 1;
                         }
 
-                        auto & local_model = positions[current_roof_index].shades [current_shade_index].model;
+                        auto local_model = positions[current_roof_index].shades [current_shade_index].model ();
                         local_model.transform_2_world ( raster_2_world, tile_tl );
 
-                        auto & item = map_items [j];
-                        item.roof = local_model.roof ();
-                        item.proj = local_model.projection();
-                        item.shade = local_model.shade ();
-
-                        //map_items.push_back ( { local_model.roof (), local_model.projection(), local_model.shade () } );
-
+                        journal_item ( std::stoi ( obj_id ), { current_roof_index, current_shade_index }
+                                     , { std::stoi ( obj_id ), local_model.roof (), local_model.projection(), local_model.shade () } );
                     }
+                    else if ( key == 27 )
+                        journal->append ( { std::stoi ( obj_id ) } );
+
+                    // Operator's decisions are expensive to repeat
+                    if ( a_run_mode != run_mode::automatic )
+                        journal->sync ();
                 }
 
                 if (key == 8)
@@ -344,21 +522,12 @@ rsai::projection_and_shade_locator::projection_and_shade_locator (
             progress_func ( i + 1, layers, 1.0f, true );
             std::cout << "Saving results...";
 
-
-            for ( const auto &item : map_items )
+            // Output layers hold the decisions of this and the interrupted runs
+            journal->replay ( [&] ( const gdal::journal_record &record )
             {
-                if ( item.roof != nullptr )
-                {
-                    new_feature->SetGeometry ( item.roof.get () );
-                    roof_layer_iter.set_feature( new_feature );
-
-                    new_feature->SetGeometry ( item.proj.get () );
-                    proj_layer_iter.set_feature( new_feature );
-
-                    new_feature->SetGeometry ( item.shade.get () );
-                    shade_layer_iter.set_feature( new_feature );
-                }
-            }
+                if ( !record.variants.empty () )
+                    write_item ( record.object_index, record.items );
+            } );
         }
 
         std::cout << "done\n";
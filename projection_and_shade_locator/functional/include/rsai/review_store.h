@@ -0,0 +1,121 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include <string_view>
+#include <condition_variable>
+#include <Eigen/Dense>
+#include <opencv2/opencv.hpp>
+
+#include "common/definitions.h"
+#include "gdal_utils/shared_geometry.h"
+#include "rsai/building_models/roof_estimator.h"
+#include "rsai/building_models/structure_estimator.h"
+
+namespace rsai
+{
+    struct tile_info
+    {
+        cv::Mat tile;
+        cv::Mat tile_marked;
+        Eigen::Vector2d top_left;
+        std::string index;
+        gdal::polygon original_object;
+    };
+
+    // Append-only file of binary records. Records are written by workers and read through a read only
+    // memory mapping after sealing. The file is a scratch one and is removed on destruction.
+    class review_file
+    {
+    public:
+        explicit review_file ( const std::string &file_name );
+        ~review_file ();
+
+        review_file ( const review_file & ) = delete;
+        review_file & operator = ( const review_file & ) = delete;
+
+        bool                is_open () const;
+
+        // Thread-safe, records are numbered in calls order
+        bool                append  ( const std::string &record );
+        // Stops writing and maps the file
+        bool                seal    ();
+
+        size_t              size    () const;
+        // Valid after sealing, the view points into the mapping
+        std::string_view    record  ( const size_t index ) const;
+
+    private:
+        struct entry
+        {
+            uint64_t offset;
+            uint64_t size;
+        };
+
+        const std::string       m_file_name;
+        std::ofstream           m_out;
+        std::vector < entry >   m_entries;
+        uint64_t                m_size = 0;
+        bool                    m_failed = false;
+        mutable std::mutex      m_lock;
+
+        void *                  m_data = nullptr;
+        size_t                  m_data_size = 0;
+
+        void                    __unmap ();
+    }; // class review_file
+
+    // Compact candidates records: shifts, scores and lengths, geometries are stored once per frame as WKB,
+    // tiles are PNG compressed
+    bool encode_review_item ( std::string &record, const tile_info &info, const building_models::roof_responses &candidates );
+    bool encode_review_item ( std::string &record, const tile_info &info, const building_models::structures &candidates );
+    bool decode_review_item ( std::string_view record, tile_info &info, building_models::roof_responses &candidates );
+    bool decode_review_item ( std::string_view record, tile_info &info, building_models::structures &candidates );
+
+    // Review items spilled to a review_file. Items within the window around the last requested index are kept
+    // decoded, the ones ahead are decoded by a background thread, so stepping back and forth doesn't wait for decoding.
+    template < class Candidates >
+    class review_store
+    {
+    public:
+        using item = std::pair < tile_info, Candidates >;
+
+        review_store ( const std::string &file_name, const int window = DEFAULT_REVIEW_WINDOW );
+        ~review_store ();
+
+        review_store ( const review_store & ) = delete;
+        review_store & operator = ( const review_store & ) = delete;
+
+        // Thread-safe, encoding is done by the calling thread
+        bool                        push    ( const tile_info &info, const Candidates &candidates );
+        // Finishes pushing and starts prefetching from the first item
+        bool                        seal    ();
+
+        size_t                      size    () const;
+        std::shared_ptr < item >    get     ( const int index );
+
+    private:
+        review_file                 m_file;
+        const int                   m_window;
+
+        std::map < int, std::shared_ptr < item > > m_items;
+        int                         m_current = 0;
+        bool                        m_stop = false;
+        std::mutex                  m_lock;
+        std::condition_variable     m_wake;
+        std::thread                 m_prefetcher;
+
+        std::shared_ptr < item >    __decode    ( const int index ) const;
+        void                        __prefetch  ();
+        void                        __evict     ();
+    }; // class review_store
+
+} // namespace rsai
+
+#include "rsai/review_store.hpp"
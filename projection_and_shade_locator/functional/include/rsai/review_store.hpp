@@ -0,0 +1,138 @@
+#pragma once
+
+#include "rsai/review_store.h"
+
+#include <iostream>
+
+template < class Candidates >
+rsai::review_store < Candidates >::review_store ( const std::string &file_name, const int window )
+    : m_file ( file_name ), m_window ( std::max ( 1, window ) )
+{
+
+}
+
+template < class Candidates >
+rsai::review_store < Candidates >::~review_store ()
+{
+    {
+        std::scoped_lock lock ( m_lock );
+        m_stop = true;
+    }
+    m_wake.notify_all ();
+
+    if ( m_prefetcher.joinable () )
+        m_prefetcher.join ();
+}
+
+template < class Candidates >
+bool rsai::review_store < Candidates >::push ( const tile_info &info, const Candidates &candidates )
+{
+    std::string record;
+    if ( !encode_review_item ( record, info, candidates ) )
+    {
+        std::cerr << "Stop: Failed to encode review item " << info.index << std::endl;
+        return false;
+    }
+
+    return m_file.append ( record );
+}
+
+template < class Candidates >
+bool rsai::review_store < Candidates >::seal ()
+{
+    if ( !m_file.seal () )
+        return false;
+
+    m_prefetcher = std::thread ( &review_store::__prefetch, this );
+    return true;
+}
+
+template < class Candidates >
+size_t rsai::review_store < Candidates >::size () const
+{
+    return m_file.size ();
+}
+
+template < class Candidates >
+std::shared_ptr < typename rsai::review_store < Candidates >::item > rsai::review_store < Candidates >::get ( const int index )
+{
+    {
+        std::scoped_lock lock ( m_lock );
+        m_current = index;
+        __evict ();
+
+        auto found = m_items.find ( index );
+        if ( found != m_items.end () )
+        {
+            m_wake.notify_all ();
+            return found->second;
+        }
+    }
+
+    // Not prefetched yet, the reviewer waits for this item only
+    auto decoded = __decode ( index );
+
+    std::scoped_lock lock ( m_lock );
+    auto inserted = m_items.emplace ( index, decoded ).first->second;
+    m_wake.notify_all ();
+
+    return inserted;
+}
+
+template < class Candidates >
+std::shared_ptr < typename rsai::review_store < Candidates >::item > rsai::review_store < Candidates >::__decode ( const int index ) const
+{
+    auto decoded = std::make_shared < item > ();
+    if ( !decode_review_item ( m_file.record ( index ), decoded->first, decoded->second ) )
+        std::cerr << "Stop: Failed to decode review item #" << index << std::endl;
+
+    return decoded;
+}
+
+template < class Candidates >
+void rsai::review_store < Candidates >::__prefetch ()
+{
+    const int count = static_cast < int > ( m_file.size () );
+
+    std::unique_lock lock ( m_lock );
+    while ( !m_stop )
+    {
+        // Items ahead go first, the ones behind are kept for stepping back
+        int missing = -1;
+        for ( int distance = 0; distance <= m_window && missing < 0; ++distance )
+        {
+            const int ahead = m_current + distance,
+                      behind = m_current - distance;
+
+            if ( ahead < count && m_items.find ( ahead ) == m_items.end () )
+                missing = ahead;
+            else if ( behind >= 0 && distance <= m_window / 2 && m_items.find ( behind ) == m_items.end () )
+                missing = behind;
+        }
+
+        if ( missing < 0 )
+        {
+            m_wake.wait ( lock );
+            continue;
+        }
+
+        lock.unlock ();
+        auto decoded = __decode ( missing );
+        lock.lock ();
+
+        if ( missing >= m_current - m_window && missing <= m_current + m_window )
+            m_items.emplace ( missing, std::move ( decoded ) );
+    }
+}
+
+template < class Candidates >
+void rsai::review_store < Candidates >::__evict ()
+{
+    for ( auto it = m_items.begin (); it != m_items.end (); )
+    {
+        if ( it->first < m_current - m_window || it->first > m_current + m_window )
+            it = m_items.erase ( it );
+        else
+            ++it;
+    }
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <vector>
+#include <Eigen/Dense>
+#include "eigen_utils/geometry.h"
+
+namespace rsai
+{
+    // Plans segmentation tiles before any raster read. Every object's bbox extended by the margin must fit into a tile.
+    // Segmented pixel area is minimized by a greedy set cover over fixed size candidate tiles anchored at the objects'
+    // corners, each chosen tile is shrunk to the objects it covers. Objects larger than a tile get own tiles fitted to them,
+    // the segmentation worker gets such tiles downscaled to its maximum side.
+    class sam_coverage_planner
+    {
+    public:
+        sam_coverage_planner ( const Eigen::Vector2d &raster_size, const Eigen::Vector2d &tile_size, const double margin );
+
+        // Result does not depend on objects' order
+        std::vector < gdal::bbox > operator () ( const std::vector < gdal::bbox > &objects ) const;
+
+    private:
+        Eigen::Vector2d m_raster_size;
+        Eigen::Vector2d m_tile_size;
+        double          m_margin;
+
+        gdal::bbox      __fit ( const Eigen::Vector2d &top_left ) const;
+    }; // class sam_coverage_planner
+};
@@ -1,27 +1,43 @@
 #pragma once
 
 #include <string>
+#include <algorithm>
 #include <mutex>
+#include <deque>
+#include <atomic>
+#include <memory>
 #include <opencv2/opencv.hpp>
 #include <Eigen/Dense>
 #include "gdal_utils/shared_feature.h"
 #include "gdal_utils/shared_dataset.h"
 #include "gdal_utils/shared_geometry.h"
 #include "eigen_utils/geometry.h"
+#include "gdal_utils/spatial_index.h"
+#include "gdal_utils/segment_store.h"
+#include "opencv_utils/raster_roi.h"
+#include "rsai/segmentation/client.h"
+#include "common/definitions.h"
 
 namespace rsai
 {
     class sam_tile
     {
     public:
-        sam_tile ( gdal::shared_dataset raster, const std::string &path, const int index, const Eigen::Vector2d &pos, const Eigen::Vector2d &size );
+        sam_tile ( const opencv::dataset_roi_extractor &extractor, const std::string &path, const int index, const Eigen::Vector2d &pos, const Eigen::Vector2d &size );
 
         gdal::bbox  bbox () const;
+        int         index () const;
         bool        verify ( const gdal::bbox &tile_bbox ) const;
         double      distance ( const gdal::bbox &tile_bbox ) const;
         //cv::Mat   segments ( const gdal::bbox &tile_bbox );
         gdal::polygons segments ( const gdal::bbox &tile_bbox );
 
+        cv::Mat     image ( const opencv::dataset_roi_extractor &extractor ) const;
+        bool        save ( const opencv::dataset_roi_extractor &extractor ) const;
+        void        set_segments ( const segmentation::contours &contours );
+        // Converts the script's WKT output into a mapped binary store
+        bool        load ();
+
     private:
         const int               m_index;
         Eigen::Vector2d         m_pos;
@@ -29,6 +45,10 @@ namespace rsai
         Eigen::Vector2d         m_center;
         const std::string       m_file_name;
         const std::string       m_segs_name;
+        const std::string       m_store_name;
+        gdal::geometries        m_segments;
+        bool                    m_segmented = false;
+        std::unique_ptr < gdal::segments_file > m_store;
     };
 
     class sam_tiles
@@ -37,22 +57,47 @@ namespace rsai
         sam_tiles ( gdal::shared_dataset raster, const std::string &path );
         sam_tiles ( gdal::shared_dataset raster, const std::string &path, gdal::geometry coverage, const Eigen::Vector2d tile_size, const Eigen::Vector2d tile_step );
 
-        bool verify_or_add ( const gdal::bbox &tile_bbox );
+        // Tiles are planned and added before any segments' lookup
+        void add ( const gdal::bbox &tile_bbox );
         //cv::Mat segments ( const gdal::bbox &tile_bbox );
         gdal::polygons segments ( const gdal::bbox &tile_bbox );
 
+        // Tiles' images for the segmentation script
+        bool save ();
+        // Script's segments of all the tiles
+        bool load ();
+        // Streaming tiles to the persistent segmentation worker
+        bool segment ( segmentation::client &client, const int in_flight );
+
     private:
-        std::vector < sam_tile >    m_tiles;
         gdal::shared_dataset        m_raster;
+        opencv::dataset_roi_extractor m_extractor;
         const std::string           m_path;
         int                         m_index;
-        std::mutex                  m_lock;
+
+        // Tiles never move, the index keeps their bboxes for lookups
+        std::deque < sam_tile >     m_tiles;
+        gdal::spatial_index < sam_tile * > m_tiles_index;
+
+        sam_tile *  __find ( const gdal::bbox &tile_bbox ) const;
+        void        __add ( sam_tile &&tile );
+    };
+
+    // Persistent segmentation worker the segmentor connects to
+    struct segmentation_service
+    {
+        std::string socket      = DEFAULT_SEGMENTATION_SOCKET;
+        // Worker's batch, twice as many tiles are kept in flight so the next batch is ready when one is done
+        int         batch       = std::stoi ( DEFAULT_SEGMENTATION_BATCH_VALUE );
+
+        int         in_flight   () const { return std::max ( DEFAULT_SEGMENTATION_IN_FLIGHT, 2 * batch ); }
     };
 
     class sam_segmentor
     {
     public:
-        sam_segmentor ( gdal::shared_dataset raster, gdal::shared_dataset objects_vector, const std::string & );
+        sam_segmentor ( gdal::shared_dataset raster, gdal::shared_dataset objects_vector, const std::string &
+                        , const segmentation_service &service = {} );
         ~sam_segmentor ();
 
         template < class ProgressFunc >
@@ -62,6 +107,7 @@ namespace rsai
         gdal::shared_dataset    m_raster;
         gdal::shared_dataset    m_objects_vector;
         const std::string       m_store_dir;
+        const segmentation_service m_service;
     };
 }
 
@@ -1,9 +1,11 @@
 #pragma once
 
 #include "rsai/sam_segmentor.h"
+#include "rsai/sam_coverage_planner.h"
 
 #include <atomic>
 #include <mutex>
+#include <deque>
 #include "common/definitions.h"
 #include "threading_utils/gdal_iterators.h"
 #include "rsai/markup/tile_saver.h"
@@ -67,10 +69,9 @@ bool rsai::sam_segmentor::operator () ( const ProgressFunc &progress_func )
 
     sam_tiles tiles ( m_raster, m_store_dir, coverage, { 800, 800 }, { 600, 600 } );*/
 
-    sam_tiles tiles ( m_raster, m_store_dir );
-
-    //std::cout << "Verifying region coverage...\n";
-    const bool verified = iterator ( [&] ( gdal::shared_feature feature, const int current_feature_id )
+    //std::cout << "Planning region coverage...\n";
+    std::vector < gdal::bbox > objects_bboxes;
+    const bool collected = iterator ( [&] ( gdal::shared_feature feature, const int current_feature_id )
     {
         const OGRGeometry *geometry = feature->GetGeometryRef ();
         if ( geometry != nullptr
@@ -78,29 +79,48 @@ bool rsai::sam_segmentor::operator () ( const ProgressFunc &progress_func )
         {
             auto object_raster_bbox = a_tile_saver.get_bbox( feature );
 
-            if ( tiles.verify_or_add ( object_raster_bbox ) )
-            {
-                std::scoped_lock lock_guard ( lock );
-                //std::cout << "\rCreated a tile for feature " << current_feature_id << " with bbox " << object_raster_bbox << '\n';
-                //std::cout.flush ();
-            }
-
+            std::scoped_lock lock_guard ( lock );
+            objects_bboxes.push_back ( object_raster_bbox );
         }
     }
     , progress_func, 1 );
 
-    if ( !verified )
+    if ( !collected )
         return false;
 
-    const std::string segment_script = "python3 ./scripts/sam_binary_segments.py";
-    const std::string weights_file = "./weights/sam_vit_h_4b8939.pth";
-    const std::string command = segment_script + " " + weights_file + " "
-                                + m_store_dir + " " + DEFAULT_SEG_ANY_EDGES_WIDTH_VALUE;
+    // Tiles are planned over all the objects at once, so the set does not depend on features' order
+    const Eigen::Vector2d raster_size ( m_raster->GetRasterXSize (), m_raster->GetRasterYSize () );
+    sam_coverage_planner planner ( raster_size, Eigen::Vector2d::Constant ( DEFAULT_SEGMENTATION_TILE_SIZE ), DEFAULT_SEGMENTATION_TILE_MARGIN );
 
-    const int result = system(command.c_str());
+    sam_tiles tiles ( m_raster, m_store_dir );
+    for ( const auto &tile_bbox : planner ( objects_bboxes ) )
+        tiles.add ( tile_bbox );
 
-    if ( result != 0 )
-        return false;
+    // Persistent worker keeps the model loaded and exchanges tiles via socket, the script is a fallback
+    segmentation::client service ( m_service.socket, m_service.in_flight () );
+    if ( service.connected () )
+    {
+        if ( !tiles.segment ( service, m_service.in_flight () ) )
+            return false;
+    }
+    else
+    {
+        if ( !tiles.save () )
+            return false;
+
+        const std::string segment_script = "python3 ./scripts/sam_binary_segments.py";
+        const std::string weights_file = "./weights/sam_vit_h_4b8939.pth";
+        const std::string command = segment_script + " " + weights_file + " "
+                                    + m_store_dir + " " + DEFAULT_SEG_ANY_EDGES_WIDTH_VALUE;
+
+        const int result = system(command.c_str());
+
+        if ( result != 0 )
+            return false;
+
+        if ( !tiles.load () )
+            return false;
+    }
 
     //std::cout << "Created objectwise segments...\n";
     const bool segmented = iterator ( [&] ( gdal::shared_feature feature, const int current_feature_id )
@@ -116,11 +136,11 @@ bool rsai::sam_segmentor::operator () ( const ProgressFunc &progress_func )
             //std::cout << "\robject " << object_index_str;
             auto object_raster_bbox = a_tile_saver.get_bbox( feature );
             auto segments = tiles.segments ( object_raster_bbox );
-            gdal::to_wkt_file ( m_store_dir + DEFAULT_OBJECT_WKT_FILE_PREFIX + object_index_str + DEFAULT_SEGMENT_WKT_FILE_EXT, segments );
+            gdal::to_segments_file ( m_store_dir + DEFAULT_OBJECT_WKT_FILE_PREFIX + object_index_str + DEFAULT_SEGMENT_STORE_FILE_EXT, segments );
 
         }
     }
     , progress_func, 1 );
 
-    return result == 0 && segmented;
+    return segmented;
 }
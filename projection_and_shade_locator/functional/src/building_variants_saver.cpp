@@ -15,7 +15,7 @@ const std::string shade_wkt_file_ext = ".shade";
 const std::string image_file_ext = ".jpg";
 
 rsai::building_variants_saver::building_variants_saver ( const std::string &target_dir )
-    : m_target_dir ( target_dir )
+    : m_target_dir ( target_dir ), m_images ( opencv::artifact_level::summary )
 {
     if (!std::filesystem::exists(target_dir) && !target_dir.empty())
         std::filesystem::create_directories(target_dir);
@@ -30,7 +30,7 @@ bool rsai::building_variants_saver::write ( const std::string id, const building
         std::filesystem::create_directories(sample_target);
 
     // Saving source tile without vectors
-    cv::imwrite ( sample_target + source_tile_name + image_file_ext, tile );
+    m_images.write ( opencv::artifact_level::summary, sample_target + source_tile_name + image_file_ext, tile );
 
     for ( int position_index = 0; position_index < positions.size (); ++position_index )
     {
@@ -43,13 +43,13 @@ bool rsai::building_variants_saver::write ( const std::string id, const building
         // Save the roof image for the first choice
         if ( position.shades.size() > 0 )
         {
-            const auto roof = position.shades [0].model.roof();
+            const auto roof = position.shades [0].model ().roof();
 
             building_renderer roof_renderer ( tile );
             roof_renderer.render_roof ( roof );
 
             const auto roof_image_name = sample_target + std::to_string ( position_index ) + image_file_ext;
-            roof_renderer.save ( roof_image_name );
+            m_images.write ( opencv::artifact_level::summary, roof_image_name, roof_renderer.get () );
         }
 
         // Save roofs, projes and shades to choose final model
@@ -59,7 +59,7 @@ bool rsai::building_variants_saver::write ( const std::string id, const building
 
             const auto &variant = position.shades [shade_index];
 
-            auto model = variant.model;
+            auto model = variant.model ();
 
             building_renderer renderer ( tile );
 
@@ -67,7 +67,7 @@ bool rsai::building_variants_saver::write ( const std::string id, const building
             renderer.render_projection ( model.projection() );
             renderer.render_shade ( model.shade() );
 
-            renderer.save ( projection_position_target + image_file_ext );
+            m_images.write ( opencv::artifact_level::summary, projection_position_target + image_file_ext, renderer.get () );
 
             model.transform_2_world ( raster_2_world, tile_top_left );
             auto roof = model.roof();
@@ -92,19 +92,19 @@ bool rsai::building_variants_saver::write ( const std::string id, gdal::polygon
         std::filesystem::create_directories(sample_target);
 
     // Saving source tile without vectors
-    cv::imwrite ( sample_target + source_tile_name + image_file_ext, tile );
+    m_images.write ( opencv::artifact_level::summary, sample_target + source_tile_name + image_file_ext, tile );
 
     for ( int position_index = 0; position_index < positions.size (); ++position_index )
     {
         const auto & position = positions [position_index];
 
         building_renderer roof_renderer ( tile );
-        roof_renderer.render_roof ( position.aligned_roof_in_tile );
+        roof_renderer.render_roof ( position.aligned_roof_in_tile () );
 
         const auto roof_image_name = sample_target + std::to_string ( position_index ) + image_file_ext;
-        roof_renderer.save ( roof_image_name );
+        m_images.write ( opencv::artifact_level::summary, roof_image_name, roof_renderer.get () );
 
-        __write_wkt ( sample_target + std::to_string ( position_index ) + roof_wkt_file_ext, position.aligned_roof.get() );
+        __write_wkt ( sample_target + std::to_string ( position_index ) + roof_wkt_file_ext, position.aligned_roof ().get() );
     }
 
     return true;
@@ -155,7 +155,7 @@ bool rsai::building_variants_saver::write ( const std::string id, std::vector <
                     }
 
                     const auto roof_image_name = sample_targets [i] + std::to_string ( l ) + image_file_ext;
-                    renderer.save ( roof_image_name );
+                    m_images.write ( opencv::artifact_level::summary, roof_image_name, renderer.get () );
                 }
             }
         }
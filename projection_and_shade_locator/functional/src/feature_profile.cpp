@@ -0,0 +1,84 @@
+#include "rsai/feature_profile.h"
+
+#include <sstream>
+#include <iostream>
+
+using namespace rsai;
+
+feature_profile::feature_profile ( const int object_index )
+    : object_index ( object_index ), m_start ( std::chrono::steady_clock::now () ), m_lap ( m_start )
+{
+}
+
+void feature_profile::lap ( const char * stage )
+{
+    const auto now = std::chrono::steady_clock::now ();
+    stages.emplace_back ( stage, std::chrono::duration < double, std::milli > ( now - m_lap ).count () );
+    m_lap = now;
+}
+
+double feature_profile::total_ms () const
+{
+    return std::chrono::duration < double, std::milli > ( m_lap - m_start ).count ();
+}
+
+bool profile_writer::open ( const std::string &file_name )
+{
+    std::scoped_lock lock ( m_lock );
+
+    m_out.open ( file_name );
+    if ( !m_out )
+    {
+        std::cerr << "Unable to write profiles file: " << file_name << std::endl;
+        return false;
+    }
+
+    m_enabled = true;
+    return true;
+}
+
+void profile_writer::close ()
+{
+    std::scoped_lock lock ( m_lock );
+
+    m_enabled = false;
+    if ( m_out.is_open () )
+        m_out.close ();
+}
+
+bool profile_writer::enabled () const
+{
+    return m_enabled.load ( std::memory_order_relaxed );
+}
+
+void profile_writer::write ( const feature_profile &profile )
+{
+    if ( !enabled () )
+        return;
+
+    // Formatting outside of the lock
+    std::ostringstream line;
+    line << "{\"id\":" << profile.object_index
+         << ",\"tile_width\":" << profile.tile_width
+         << ",\"tile_height\":" << profile.tile_height
+         << ",\"contour_length\":" << profile.contour_length
+         << ",\"search_area\":" << profile.search_area
+         << ",\"segments\":" << profile.segments
+         << ",\"candidates\":" << profile.candidates
+         << ",\"variants\":" << profile.variants
+         << ",\"scratch_bytes\":" << profile.scratch_bytes;
+
+    for ( const auto &stage : profile.stages )
+        line << ",\"" << stage.first << "_ms\":" << stage.second;
+
+    line << ",\"total_ms\":" << profile.total_ms () << "}\n";
+
+    std::scoped_lock lock ( m_lock );
+    m_out << line.str ();
+}
+
+profile_writer & rsai::feature_profiles ()
+{
+    static profile_writer writer;
+    return writer;
+}
@@ -0,0 +1,487 @@
+#include "rsai/review_store.h"
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace rsai;
+using namespace rsai::building_models;
+
+namespace
+{
+    const uint32_t review_item_magic = 0x56455252; // "RREV"
+
+    class record_writer
+    {
+    public:
+        explicit record_writer ( std::string &record ) : m_record ( record ) {}
+
+        template < class T >
+        void put ( const T &value )
+        {
+            m_record.append ( reinterpret_cast < const char * > ( &value ), sizeof ( T ) );
+        }
+
+        void put ( const double * values, const size_t count )
+        {
+            m_record.append ( reinterpret_cast < const char * > ( values ), count * sizeof ( double ) );
+        }
+
+        void put_bytes ( const void * data, const size_t size )
+        {
+            put ( uint64_t ( size ) );
+            m_record.append ( static_cast < const char * > ( data ), size );
+        }
+
+        // Lossless PNG with a fast compression level, the reviewer sees the same tile
+        bool put_image ( const cv::Mat &image )
+        {
+            std::vector < uchar > encoded;
+            if ( !image.empty () && !cv::imencode ( ".png", image, encoded, { cv::IMWRITE_PNG_COMPRESSION, 1 } ) )
+                return false;
+
+            put_bytes ( encoded.data (), encoded.size () );
+            return true;
+        }
+
+        void put_geometry ( const OGRGeometry * geometry )
+        {
+            if ( geometry == nullptr )
+            {
+                put ( uint64_t ( 0 ) );
+                return;
+            }
+
+            std::vector < unsigned char > wkb ( geometry->WkbSize () );
+            geometry->exportToWkb ( wkbNDR, wkb.data () );
+            put_bytes ( wkb.data (), wkb.size () );
+        }
+
+    private:
+        std::string & m_record;
+    };
+
+    class record_reader
+    {
+    public:
+        explicit record_reader ( std::string_view record ) : m_data ( record.data () ), m_end ( record.data () + record.size () ) {}
+
+        bool good () const { return m_good; }
+
+        template < class T >
+        T get ()
+        {
+            T value {};
+            if ( __take ( sizeof ( T ) ) )
+                std::memcpy ( &value, m_data - sizeof ( T ), sizeof ( T ) );
+            return value;
+        }
+
+        void get ( double * values, const size_t count )
+        {
+            if ( __take ( count * sizeof ( double ) ) )
+                std::memcpy ( values, m_data - count * sizeof ( double ), count * sizeof ( double ) );
+        }
+
+        std::string_view get_bytes ()
+        {
+            const auto size = get < uint64_t > ();
+            if ( !__take ( size ) )
+                return {};
+            return { m_data - size, size };
+        }
+
+        cv::Mat get_image ()
+        {
+            const auto bytes = get_bytes ();
+            if ( bytes.empty () )
+                return {};
+
+            std::vector < uchar > encoded ( bytes.begin (), bytes.end () );
+            return cv::imdecode ( encoded, cv::IMREAD_UNCHANGED );
+        }
+
+        gdal::geometry get_geometry ()
+        {
+            const auto bytes = get_bytes ();
+            if ( bytes.empty () )
+                return {};
+
+            OGRGeometry * geometry = nullptr;
+            if ( OGRGeometryFactory::createFromWkb ( bytes.data (), nullptr, &geometry, bytes.size () ) != OGRERR_NONE )
+            {
+                m_good = false;
+                return {};
+            }
+
+            return gdal::geometry ( geometry );
+        }
+
+    private:
+        const char *    m_data;
+        const char *    m_end;
+        bool            m_good = true;
+
+        bool __take ( const size_t size )
+        {
+            if ( !m_good || size_t ( m_end - m_data ) < size )
+            {
+                m_good = false;
+                return false;
+            }
+
+            m_data += size;
+            return true;
+        }
+    };
+
+    gdal::polygon as_polygon ( gdal::geometry geometry )
+    {
+        if ( !geometry || wkbFlatten ( geometry->getGeometryType () ) != wkbPolygon )
+            return {};
+        return std::dynamic_pointer_cast < OGRPolygon > ( geometry );
+    }
+
+    bool encode_tile_info ( record_writer &writer, const tile_info &info )
+    {
+        writer.put ( review_item_magic );
+        writer.put_bytes ( info.index.data (), info.index.size () );
+        writer.put ( info.top_left.data (), 2 );
+        writer.put_geometry ( info.original_object.get () );
+
+        // Marked tile is frequently the same image
+        const bool same_marked = info.tile_marked.data == info.tile.data;
+        writer.put ( uint8_t ( same_marked ) );
+
+        return writer.put_image ( info.tile ) && ( same_marked || writer.put_image ( info.tile_marked ) );
+    }
+
+    bool decode_tile_info ( record_reader &reader, tile_info &info )
+    {
+        if ( reader.get < uint32_t > () != review_item_magic )
+            return false;
+
+        info.index = std::string ( reader.get_bytes () );
+        reader.get ( info.top_left.data (), 2 );
+        info.original_object = as_polygon ( reader.get_geometry () );
+
+        const bool same_marked = reader.get < uint8_t > () != 0;
+        info.tile = reader.get_image ();
+        info.tile_marked = same_marked ? info.tile : reader.get_image ();
+
+        return reader.good ();
+    }
+
+    template < class Frame >
+    std::vector < const Frame * > frames_table ( const std::vector < const Frame * > &used )
+    {
+        std::vector < const Frame * > frames;
+        for ( const auto * frame : used )
+            if ( std::find ( frames.begin (), frames.end (), frame ) == frames.end () )
+                frames.push_back ( frame );
+        return frames;
+    }
+
+    template < class Frame >
+    int32_t frame_number ( const std::vector < const Frame * > &frames, const Frame * frame )
+    {
+        return static_cast < int32_t > ( std::find ( frames.begin (), frames.end (), frame ) - frames.begin () );
+    }
+
+    void encode_roof_frame ( record_writer &writer, const roof_frame * frame )
+    {
+        writer.put_geometry ( frame->roof.get () );
+        writer.put ( frame->world_2_raster.data (), 9 );
+        writer.put ( frame->tile_offset.data (), 2 );
+    }
+
+    std::shared_ptr < const roof_frame > decode_roof_frame ( record_reader &reader )
+    {
+        auto frame = std::make_shared < roof_frame > ();
+        frame->roof = as_polygon ( reader.get_geometry () );
+        reader.get ( frame->world_2_raster.data (), 9 );
+        reader.get ( frame->tile_offset.data (), 2 );
+        return frame;
+    }
+
+    void encode_roof_responses ( record_writer &writer, const roof_responses &candidates )
+    {
+        std::vector < const roof_frame * > used;
+        for ( const auto &candidate : candidates )
+            if ( candidate.frame )
+                used.push_back ( candidate.frame.get () );
+
+        const auto frames = frames_table ( used );
+        writer.put ( uint32_t ( frames.size () ) );
+        for ( const auto * frame : frames )
+            encode_roof_frame ( writer, frame );
+
+        writer.put ( uint32_t ( candidates.size () ) );
+        for ( const auto &candidate : candidates )
+        {
+            writer.put ( candidate.shift_world.data (), 2 );
+            writer.put ( candidate.shift_on_tile.data (), 2 );
+            writer.put ( candidate.value );
+            writer.put ( candidate.deviation );
+            writer.put ( candidate.frame ? frame_number ( frames, candidate.frame.get () ) : int32_t ( -1 ) );
+        }
+    }
+
+    void decode_roof_responses ( record_reader &reader, roof_responses &candidates )
+    {
+        std::vector < std::shared_ptr < const roof_frame > > frames ( reader.get < uint32_t > () );
+        for ( auto &frame : frames )
+            frame = decode_roof_frame ( reader );
+
+        candidates.resize ( reader.get < uint32_t > () );
+        for ( auto &candidate : candidates )
+        {
+            reader.get ( candidate.shift_world.data (), 2 );
+            reader.get ( candidate.shift_on_tile.data (), 2 );
+            candidate.value = reader.get < double > ();
+            candidate.deviation = reader.get < double > ();
+
+            const auto frame = reader.get < int32_t > ();
+            if ( frame >= 0 && frame < frames.size () )
+                candidate.frame = frames [frame];
+        }
+    }
+}
+
+rsai::review_file::review_file ( const std::string &file_name )
+    : m_file_name ( file_name )
+{
+    m_out.open ( m_file_name, std::ios::binary | std::ios::trunc );
+    if ( !m_out.is_open () )
+    {
+        std::cerr << "Stop: Unable to create review file " << m_file_name << std::endl;
+        m_failed = true;
+    }
+}
+
+rsai::review_file::~review_file ()
+{
+    __unmap ();
+
+    if ( m_out.is_open () )
+        m_out.close ();
+
+    std::remove ( m_file_name.c_str () );
+}
+
+bool rsai::review_file::is_open () const
+{
+    std::scoped_lock lock ( m_lock );
+    return !m_failed;
+}
+
+bool rsai::review_file::append ( const std::string &record )
+{
+    std::scoped_lock lock ( m_lock );
+
+    if ( m_failed || !m_out.is_open () )
+        return false;
+
+    m_out.write ( record.data (), record.size () );
+    if ( !m_out.good () )
+    {
+        std::cerr << "Stop: Failed to write review file " << m_file_name << std::endl;
+        m_failed = true;
+        return false;
+    }
+
+    m_entries.push_back ( { m_size, record.size () } );
+    m_size += record.size ();
+
+    return true;
+}
+
+bool rsai::review_file::seal ()
+{
+    std::scoped_lock lock ( m_lock );
+
+    if ( m_failed )
+        return false;
+
+    m_out.close ();
+
+    // Nothing to map for an empty layer
+    if ( m_size == 0 )
+        return true;
+
+    const int descriptor = open ( m_file_name.c_str (), O_RDONLY );
+    if ( descriptor < 0 )
+    {
+        std::cerr << "Stop: Unable to open review file " << m_file_name << std::endl;
+        m_failed = true;
+        return false;
+    }
+
+    m_data_size = m_size;
+    m_data = mmap ( nullptr, m_data_size, PROT_READ, MAP_PRIVATE, descriptor, 0 );
+    close ( descriptor );
+
+    if ( m_data == MAP_FAILED )
+    {
+        m_data = nullptr;
+        m_data_size = 0;
+        std::cerr << "Stop: Unable to map review file " << m_file_name << std::endl;
+        m_failed = true;
+        return false;
+    }
+
+    // Items are visited mostly sequentially
+    madvise ( m_data, m_data_size, MADV_SEQUENTIAL );
+
+    return true;
+}
+
+size_t rsai::review_file::size () const
+{
+    std::scoped_lock lock ( m_lock );
+    return m_entries.size ();
+}
+
+std::string_view rsai::review_file::record ( const size_t index ) const
+{
+    std::scoped_lock lock ( m_lock );
+
+    if ( m_data == nullptr || index >= m_entries.size () )
+        return {};
+
+    const auto &an_entry = m_entries [index];
+    return { static_cast < const char * > ( m_data ) + an_entry.offset, an_entry.size };
+}
+
+void rsai::review_file::__unmap ()
+{
+    if ( m_data )
+        munmap ( m_data, m_data_size );
+
+    m_data = nullptr;
+    m_data_size = 0;
+}
+
+bool rsai::encode_review_item ( std::string &record, const tile_info &info, const roof_responses &candidates )
+{
+    record_writer writer ( record );
+    if ( !encode_tile_info ( writer, info ) )
+        return false;
+
+    encode_roof_responses ( writer, candidates );
+    return true;
+}
+
+bool rsai::encode_review_item ( std::string &record, const tile_info &info, const structures &candidates )
+{
+    record_writer writer ( record );
+    if ( !encode_tile_info ( writer, info ) )
+        return false;
+
+    // Structures are roof candidates with their own shade candidates
+    roof_responses roofs ( candidates.begin (), candidates.end () );
+    encode_roof_responses ( writer, roofs );
+
+    std::vector < const model_frame * > used;
+    for ( const auto &candidate : candidates )
+        for ( const auto &shade : candidate.shades )
+            if ( shade.frame )
+                used.push_back ( shade.frame.get () );
+
+    const auto frames = frames_table ( used );
+    writer.put ( uint32_t ( frames.size () ) );
+    for ( const auto * frame : frames )
+    {
+        const auto projection_step = frame->model.projection_step (),
+                   shade_step = frame->model.shade_step ();
+
+        writer.put_geometry ( frame->model.object ().get () );
+        writer.put ( projection_step.data (), 2 );
+        writer.put ( shade_step.data (), 2 );
+        writer.put ( frame->world_2_raster.data (), 9 );
+        writer.put ( frame->tile_tl_corner.data (), 2 );
+    }
+
+    for ( const auto &candidate : candidates )
+    {
+        writer.put ( uint32_t ( candidate.shades.size () ) );
+        for ( const auto &shade : candidate.shades )
+        {
+            writer.put ( int32_t ( shade.length ) );
+            writer.put ( shade.response );
+            writer.put ( shade.shift.data (), 2 );
+            writer.put ( shade.frame ? frame_number ( frames, shade.frame.get () ) : int32_t ( -1 ) );
+        }
+    }
+
+    return true;
+}
+
+bool rsai::decode_review_item ( std::string_view record, tile_info &info, roof_responses &candidates )
+{
+    record_reader reader ( record );
+    if ( !decode_tile_info ( reader, info ) )
+        return false;
+
+    decode_roof_responses ( reader, candidates );
+    return reader.good ();
+}
+
+bool rsai::decode_review_item ( std::string_view record, tile_info &info, structures &candidates )
+{
+    record_reader reader ( record );
+    if ( !decode_tile_info ( reader, info ) )
+        return false;
+
+    roof_responses roofs;
+    decode_roof_responses ( reader, roofs );
+
+    std::vector < std::shared_ptr < const model_frame > > frames ( reader.get < uint32_t > () );
+    for ( auto &frame : frames )
+    {
+        auto object = as_polygon ( reader.get_geometry () );
+
+        Eigen::Vector2d projection_step, shade_step;
+        reader.get ( projection_step.data (), 2 );
+        reader.get ( shade_step.data (), 2 );
+
+        auto a_frame = std::make_shared < model_frame > ();
+        if ( object )
+            a_frame->model = prismatic ( object, projection_step, shade_step );
+        reader.get ( a_frame->world_2_raster.data (), 9 );
+        reader.get ( a_frame->tile_tl_corner.data (), 2 );
+
+        frame = a_frame;
+    }
+
+    candidates.clear ();
+    candidates.reserve ( roofs.size () );
+    for ( auto &roof : roofs )
+    {
+        structure candidate;
+        static_cast < roof_response & > ( candidate ) = std::move ( roof );
+
+        const auto shades_count = reader.get < uint32_t > ();
+        candidate.shades.reserve ( shades_count );
+        for ( uint32_t i = 0; i < shades_count && reader.good (); ++i )
+        {
+            const auto length = reader.get < int32_t > ();
+            const auto response = reader.get < double > ();
+
+            Eigen::Vector2d shift;
+            reader.get ( shift.data (), 2 );
+
+            const auto frame = reader.get < int32_t > ();
+            candidate.shades.emplace_back ( length, response, shift, frame >= 0 && frame < frames.size () ? frames [frame] : nullptr );
+        }
+
+        candidates.push_back ( std::move ( candidate ) );
+    }
+
+    return reader.good ();
+}
@@ -0,0 +1,158 @@
+#include "rsai/sam_coverage_planner.h"
+
+#include <algorithm>
+#include <queue>
+#include <tuple>
+#include "gdal_utils/spatial_index.h"
+
+using namespace rsai;
+
+namespace
+{
+    OGREnvelope to_envelope ( const gdal::bbox &box )
+    {
+        OGREnvelope envelope;
+        envelope.MinX = box.top_left ().x ();
+        envelope.MinY = box.top_left ().y ();
+        envelope.MaxX = box.bottom_right ().x ();
+        envelope.MaxY = box.bottom_right ().y ();
+        return envelope;
+    }
+
+    bool contains ( const gdal::bbox &outer, const gdal::bbox &inner )
+    {
+        return outer.top_left ().x () <= inner.top_left ().x () && outer.top_left ().y () <= inner.top_left ().y ()
+            && outer.bottom_right ().x () >= inner.bottom_right ().x () && outer.bottom_right ().y () >= inner.bottom_right ().y ();
+    }
+
+    bool less ( const gdal::bbox &lh, const gdal::bbox &rh )
+    {
+        return std::make_tuple ( lh.top_left ().y (), lh.top_left ().x (), lh.bottom_right ().y (), lh.bottom_right ().x () )
+             < std::make_tuple ( rh.top_left ().y (), rh.top_left ().x (), rh.bottom_right ().y (), rh.bottom_right ().x () );
+    }
+}
+
+sam_coverage_planner::sam_coverage_planner ( const Eigen::Vector2d &raster_size, const Eigen::Vector2d &tile_size, const double margin )
+    : m_raster_size ( raster_size ), m_tile_size ( tile_size.cwiseMin ( raster_size ) ), m_margin ( margin )
+{
+}
+
+std::vector < gdal::bbox > sam_coverage_planner::operator () ( const std::vector < gdal::bbox > &objects ) const
+{
+    const Eigen::Vector2d zero ( 0.0, 0.0 );
+
+    // Objects' bboxes with margins clipped by the raster, sorted to get rid of the input order
+    std::vector < gdal::bbox > extended;
+    extended.reserve ( objects.size () );
+    for ( auto object : objects )
+    {
+        object.bufferize ( { m_margin, m_margin } );
+        const Eigen::Vector2d tl = object.top_left ().cwiseMax ( zero );
+        const Eigen::Vector2d br = object.bottom_right ().cwiseMin ( m_raster_size );
+        if ( ( br - tl ).minCoeff () > 0.0 )
+            extended.emplace_back ( tl, br );
+    }
+    std::sort ( extended.begin (), extended.end (), less );
+
+    OGREnvelope bounds;
+    bounds.MinX = 0.0;
+    bounds.MinY = 0.0;
+    bounds.MaxX = m_raster_size.x ();
+    bounds.MaxY = m_raster_size.y ();
+
+    gdal::spatial_index < int > index ( bounds );
+    for ( int i = 0; i < extended.size (); ++i )
+        index.insert ( to_envelope ( extended [i] ), i );
+
+    std::vector < bool > covered ( extended.size (), false );
+    std::vector < gdal::bbox > tiles;
+
+    // Tile covers the objects and returns their count, marking shrinks the tile to the covered objects
+    auto cover = [&] ( gdal::bbox &tile, const bool mark )
+    {
+        int count = 0;
+        Eigen::Vector2d tl = tile.bottom_right (), br = tile.top_left ();
+        for ( auto object_index : index.search ( to_envelope ( tile ) ) )
+        {
+            const int i = *object_index;
+            if ( !covered [i] && contains ( tile, extended [i] ) )
+            {
+                ++count;
+                if ( mark )
+                {
+                    covered [i] = true;
+                    tl = tl.cwiseMin ( extended [i].top_left () );
+                    br = br.cwiseMax ( extended [i].bottom_right () );
+                }
+            }
+        }
+
+        if ( mark && count > 0 )
+            tile.set ( tl, br );
+
+        return count;
+    };
+
+    // Oversized objects do not fit into a fixed tile
+    for ( int i = 0; i < extended.size (); ++i )
+    {
+        const Eigen::Vector2d size = extended [i].size ();
+        if ( !covered [i] && ( size.x () > m_tile_size.x () || size.y () > m_tile_size.y () ) )
+        {
+            gdal::bbox tile = extended [i];
+            cover ( tile, true );
+            tiles.push_back ( tile );
+        }
+    }
+
+    // Candidates are tiles aligned to each corner of every object, all of them fully contain their object
+    std::vector < gdal::bbox > candidates;
+    candidates.reserve ( extended.size () * 4 );
+    for ( int i = 0; i < extended.size (); ++i )
+    {
+        if ( covered [i] )
+            continue;
+
+        const auto &tl = extended [i].top_left ();
+        const auto &br = extended [i].bottom_right ();
+        candidates.push_back ( __fit ( tl ) );
+        candidates.push_back ( __fit ( Eigen::Vector2d ( br.x () - m_tile_size.x (), tl.y () ) ) );
+        candidates.push_back ( __fit ( Eigen::Vector2d ( tl.x (), br.y () - m_tile_size.y () ) ) );
+        candidates.push_back ( __fit ( br - m_tile_size ) );
+    }
+
+    // Lazy greedy: gains only decrease, so a candidate which keeps its gain after an update is the best one.
+    // Ties are resolved by the lowest candidate index.
+    using entry = std::pair < int, int >;
+    std::priority_queue < entry > queue;
+    for ( int i = 0; i < candidates.size (); ++i )
+        queue.emplace ( cover ( candidates [i], false ), -i );
+
+    while ( !queue.empty () )
+    {
+        const auto [gain, negative_index] = queue.top ();
+        queue.pop ();
+
+        if ( gain == 0 )
+            break;
+
+        gdal::bbox candidate = candidates [-negative_index];
+        const int current_gain = cover ( candidate, false );
+
+        if ( current_gain == gain )
+        {
+            cover ( candidate, true );
+            tiles.push_back ( candidate );
+        }
+        else if ( current_gain > 0 )
+            queue.emplace ( current_gain, negative_index );
+    }
+
+    return tiles;
+}
+
+gdal::bbox sam_coverage_planner::__fit ( const Eigen::Vector2d &top_left ) const
+{
+    const Eigen::Vector2d tl = top_left.cwiseMax ( Eigen::Vector2d ( 0.0, 0.0 ) ).cwiseMin ( m_raster_size - m_tile_size );
+    return { tl, tl + m_tile_size };
+}
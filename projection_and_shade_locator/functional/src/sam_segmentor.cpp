@@ -1,27 +1,106 @@
 #include "rsai/sam_segmentor.h"
 #include "opencv_utils/raster_roi.h"
 
+#include <cmath>
+#include <deque>
 #include <filesystem>
 
 using namespace rsai;
 
-sam_tile::sam_tile ( gdal::shared_dataset raster, const std::string &path, const int index, const Eigen::Vector2d &pos, const Eigen::Vector2d &size )
+namespace
+{
+    OGREnvelope to_envelope ( const gdal::bbox &box )
+    {
+        OGREnvelope envelope;
+        envelope.MinX = box.top_left ().x ();
+        envelope.MinY = box.top_left ().y ();
+        envelope.MaxX = box.bottom_right ().x ();
+        envelope.MaxY = box.bottom_right ().y ();
+        return envelope;
+    }
+
+    OGREnvelope raster_envelope ( const gdal::shared_dataset &raster )
+    {
+        return to_envelope ( gdal::bbox ( Eigen::Vector2d ( 0.0, 0.0 ), Eigen::Vector2d ( raster->GetRasterXSize (), raster->GetRasterYSize () ) ) );
+    }
+
+    // Worker rejects tiles over max_tile_side, so oversized objects' tiles are downscaled and their contours are scaled back
+    cv::Mat fit_to_worker ( const cv::Mat &image, Eigen::Vector2d &scale )
+    {
+        const int max_side = segmentation::max_tile_side;
+
+        scale = { 1.0, 1.0 };
+        if ( image.cols <= max_side && image.rows <= max_side )
+            return image;
+
+        const double factor = double ( max_side ) / std::max ( image.cols, image.rows );
+        const cv::Size size ( std::clamp ( int ( std::lround ( image.cols * factor ) ), 1, max_side )
+                            , std::clamp ( int ( std::lround ( image.rows * factor ) ), 1, max_side ) );
+
+        cv::Mat fitted;
+        cv::resize ( image, fitted, size, 0.0, 0.0, cv::INTER_AREA );
+
+        scale = { double ( image.cols ) / size.width, double ( image.rows ) / size.height };
+        return fitted;
+    }
+}
+
+sam_tile::sam_tile ( const opencv::dataset_roi_extractor &extractor, const std::string &path, const int index, const Eigen::Vector2d &pos, const Eigen::Vector2d &size )
     : m_index ( index ), m_pos ( pos ), m_size ( size ), m_center ( pos + size / 2 )
     , m_file_name ( path + std::to_string ( m_index ) + DEFAULT_SEGMENT_FILE_EXT )
     , m_segs_name ( path + std::to_string ( m_index ) + DEFAULT_SEGMENT_WKT_FILE_EXT )
+    , m_store_name ( path + std::to_string ( m_index ) + DEFAULT_SEGMENT_STORE_FILE_EXT )
 {
-    opencv::dataset_roi_extractor ds_tile_extractor ( raster );
-
     //std::cout << "Created tile index " << m_index << " filename " << m_file_name << " segs name " << m_segs_name << '\n';
 
+    // Raster is not read here, only the tile's bounds are fitted to it
     gdal::bbox raster_box ( pos, pos + size );
-    auto tile = ds_tile_extractor.roi ( raster_box );
+    extractor.clip ( raster_box );
 
     m_pos = raster_box.top_left();
     m_size = raster_box.size ();
     m_center = raster_box.center();
+}
+
+cv::Mat sam_tile::image ( const opencv::dataset_roi_extractor &extractor ) const
+{
+    gdal::bbox raster_box = bbox ();
+    return extractor.roi ( raster_box );
+}
+
+bool sam_tile::save ( const opencv::dataset_roi_extractor &extractor ) const
+{
+    return cv::imwrite ( m_file_name, image ( extractor ) );
+}
+
+void sam_tile::set_segments ( const segmentation::contours &contours )
+{
+    CPLPushErrorHandler ( CPLQuietErrorHandler );
+
+    m_segments.clear ();
+    for ( const auto &contour : contours )
+    {
+        if ( contour.size () < 3 )
+            continue;
+
+        auto ring = new OGRLinearRing;
+        for ( const auto &pt : contour )
+            ring->addPoint ( pt.x, pt.y );
+
+        gdal::geometry segment ( new OGRPolygon );
+        segment->toPolygon ()->addRingDirectly ( ring );
+        segment->toPolygon ()->closeRings ();
+
+        if ( !segment->IsValid () )
+            segment = gdal::geometry ( segment->MakeValid () );
+
+        if ( segment != nullptr && !segment->IsEmpty () )
+            m_segments.push_back ( segment );
+    }
+
+    CPLPopErrorHandler ();
 
-    cv::imwrite ( m_file_name, tile );
+    m_segmented = true;
 }
 
 gdal::bbox sam_tile::bbox () const
@@ -29,6 +108,11 @@ gdal::bbox sam_tile::bbox () const
     return { m_pos, m_pos + m_size };
 }
 
+int sam_tile::index () const
+{
+    return m_index;
+}
+
 bool sam_tile::verify ( const gdal::bbox &tile_bbox ) const
 {
     const Eigen::Vector2d tile_tl = tile_bbox.top_left(),
@@ -48,12 +132,56 @@ gdal::polygons sam_tile::segments ( const gdal::bbox &tile_bbox )
     //std::cout << "Getting segments tile " << tile_bbox << " from " << m_pos << " and local bbox " << local_bbox << '\n';
     //std::cout.flush ();
 
-    auto segs = to_polygon ( gdal::from_wkt_file ( m_segs_name, local_bbox.to_polygon() ) );
+    gdal::polygons segs;
+    if ( m_segmented )
+    {
+        // Segments received from the worker are filtered like the stored ones
+        const auto spatial_filter = local_bbox.to_polygon();
+
+        OGREnvelope region;
+        spatial_filter->getEnvelope ( &region );
+
+        CPLPushErrorHandler ( CPLQuietErrorHandler );
+
+        gdal::geometries filtered;
+        for ( const auto &segment : m_segments )
+        {
+            OGREnvelope envelope;
+            segment->getEnvelope ( &envelope );
+            if ( !envelope.Intersects ( region ) )
+                continue;
+
+            gdal::geometry clipped ( segment->Intersection ( spatial_filter.get () ) );
+            if ( clipped != nullptr && !clipped->IsEmpty () )
+                filtered.push_back ( clipped );
+        }
+
+        CPLPopErrorHandler ();
+
+        segs = to_polygon ( filtered );
+    }
+    else if ( m_store )
+        segs = to_polygon ( m_store->read ( local_bbox.to_polygon() ) );
+    else
+        segs = to_polygon ( gdal::from_wkt_file ( m_segs_name, local_bbox.to_polygon() ) );
+
     segs += -local_bbox.top_left();
 
     return segs;
 }
 
+bool sam_tile::load ()
+{
+    if ( m_segmented )
+        return true;
+
+    if ( !gdal::wkt_to_segments_file ( m_segs_name, m_store_name ) )
+        return false;
+
+    m_store = std::make_unique < gdal::segments_file > ( m_store_name );
+    return m_store->is_open ();
+}
+
 /*cv::Mat sam_tile::segments ( const gdal::bbox &tile_bbox )
 {
     if ( m_segs.empty() )
@@ -79,12 +207,12 @@ double sam_tile::distance ( const gdal::bbox &tile_bbox ) const
 }
 
 sam_tiles::sam_tiles ( gdal::shared_dataset raster, const std::string &path )
-    : m_raster ( raster ), m_path ( path ), m_index ( 0 )
+    : m_raster ( raster ), m_extractor ( raster ), m_path ( path ), m_index ( 0 ), m_tiles_index ( raster_envelope ( raster ) )
 {
 }
 
 sam_tiles::sam_tiles ( gdal::shared_dataset raster, const std::string &path, gdal::geometry coverage, const Eigen::Vector2d tile_size, const Eigen::Vector2d tile_step )
-    : m_raster ( raster ), m_path ( path ), m_index ( 0 )
+    : m_raster ( raster ), m_extractor ( raster ), m_path ( path ), m_index ( 0 ), m_tiles_index ( raster_envelope ( raster ) )
 {
     OGREnvelope envelope;
     coverage->getEnvelope(&envelope);
@@ -108,34 +236,19 @@ sam_tiles::sam_tiles ( gdal::shared_dataset raster, const std::string &path, gda
             rectangle.closeRings();
 
             if (rectangle.Intersects(coverage.get()))
-            {
-                std::scoped_lock lock_guard ( m_lock );
-                m_tiles.emplace_back ( raster, path, m_index++, Eigen::Vector2d ( x, y ), tile_size );
-            }
+                __add ( sam_tile ( m_extractor, path, m_index++, Eigen::Vector2d ( x, y ), tile_size ) );
         }
     }
 }
 
 gdal::polygons sam_tiles::segments ( const gdal::bbox &tile_bbox )
 {
-    std::pair < int, double > best_distance ( -1, 1e+30 );
-    for ( int i = 0; i < m_tiles.size(); ++i )
-    {
-        const auto & tile = m_tiles [i];
-
-        if ( !tile.verify( tile_bbox ) )
-            continue;
+    sam_tile * best_tile = __find ( tile_bbox );
 
-        const auto curr_distance = tile.distance ( tile_bbox );
-        if ( best_distance.second > curr_distance )
-            best_distance = { i, curr_distance };
-    }
-
-    if ( best_distance.first >= 0 )
+    if ( best_tile )
     {
-        auto & best_tile = m_tiles [best_distance.first];
-        //std::cout << "best seg for tile " << tile_bbox << " is no " << best_distance.first << " " << best_tile.bbox() << " with dist = " << best_distance.second << '\n';
-        return best_tile.segments ( tile_bbox );
+        //std::cout << "best seg for tile " << tile_bbox << " is no " << best_tile->index () << " " << best_tile->bbox() << '\n';
+        return best_tile->segments ( tile_bbox );
     }
     else
         return {};
@@ -161,39 +274,112 @@ gdal::polygons sam_tiles::segments ( const gdal::bbox &tile_bbox )
         return {};
 }*/
 
-bool sam_tiles::verify_or_add ( const gdal::bbox &tile_bbox )
+void sam_tiles::add ( const gdal::bbox &tile_bbox )
 {
-    std::scoped_lock lock_guard ( m_lock );
+    __add ( sam_tile ( m_extractor, m_path, m_index++, tile_bbox.top_left (), tile_bbox.size () ) );
+}
 
-    std::pair < int, double > best_distance ( -1, 1e+30 );
-    for ( int i = 0; i < m_tiles.size(); ++i )
+// Covering tile with the closest center, the earliest one on a tie
+sam_tile * sam_tiles::__find ( const gdal::bbox &tile_bbox ) const
+{
+    sam_tile * best_tile = nullptr;
+    double best_distance = 1e+30;
+
+    for ( auto candidate : m_tiles_index.search ( to_envelope ( tile_bbox ) ) )
     {
-        const auto & tile = m_tiles [i];
+        sam_tile * tile = *candidate;
 
-        if ( !tile.verify( tile_bbox ) )
+        if ( !tile->verify( tile_bbox ) )
             continue;
 
-        const auto curr_distance = tile.distance ( tile_bbox );
-        if ( best_distance.second > curr_distance )
-            best_distance = { i, curr_distance };
+        const auto curr_distance = tile->distance ( tile_bbox );
+        if ( best_distance > curr_distance
+             || ( best_distance == curr_distance && best_tile && tile->index () < best_tile->index () ) )
+        {
+            best_distance = curr_distance;
+            best_tile = tile;
+        }
     }
 
-    bool found_tile = best_distance.first >= 0;
+    return best_tile;
+}
 
-    if ( !found_tile )
+void sam_tiles::__add ( sam_tile &&tile )
+{
+    m_tiles.push_back ( std::move ( tile ) );
+    auto &added = m_tiles.back ();
+    m_tiles_index.insert ( to_envelope ( added.bbox () ), &added );
+}
+
+bool sam_tiles::save ()
+{
+    for ( const auto &tile : m_tiles )
+    {
+        if ( !tile.save ( m_extractor ) )
+            return false;
+    }
+
+    return true;
+}
+
+bool sam_tiles::load ()
+{
+    for ( auto &tile : m_tiles )
+    {
+        if ( !tile.load () )
+            return false;
+    }
+
+    return true;
+}
+
+bool sam_tiles::segment ( segmentation::client &client, const int in_flight )
+{
+    struct request
     {
-        const Eigen::Vector2d tile_tl = tile_bbox.top_left() - Eigen::Vector2d { 100, 100 },
-                              tile_br = tile_bbox.bottom_right() + Eigen::Vector2d { 100, 100 },
-                              tile_size = tile_br - tile_tl;
+        sam_tile *                              tile;
+        Eigen::Vector2d                         scale;
+        std::future < segmentation::contours >  contours;
+    };
+
+    std::deque < request > requests;
 
-        m_tiles.emplace_back ( m_raster, m_path, m_index++, tile_tl, tile_size );
+    auto complete = [&] ()
+    {
+        auto &a_request = requests.front ();
+
+        auto contours = a_request.contours.get ();
+        for ( auto &contour : contours )
+            for ( auto &pt : contour )
+            {
+                pt.x *= a_request.scale.x ();
+                pt.y *= a_request.scale.y ();
+            }
+
+        a_request.tile->set_segments ( contours );
+        requests.pop_front ();
+    };
+
+    // Next tiles are read while the worker segments the previous ones
+    for ( auto &tile : m_tiles )
+    {
+        Eigen::Vector2d scale;
+        const auto image = fit_to_worker ( tile.image ( m_extractor ), scale );
+        requests.push_back ( { &tile, scale, client.submit ( image ) } );
+
+        while ( int ( requests.size () ) > in_flight )
+            complete ();
     }
 
-    return !found_tile;
+    while ( !requests.empty () )
+        complete ();
+
+    return client.connected ();
 }
 
-rsai::sam_segmentor::sam_segmentor ( gdal::shared_dataset raster, gdal::shared_dataset objects_vector, const std::string &store_dir )
-    : m_raster ( raster ), m_objects_vector ( objects_vector ), m_store_dir ( store_dir )
+rsai::sam_segmentor::sam_segmentor ( gdal::shared_dataset raster, gdal::shared_dataset objects_vector, const std::string &store_dir
+                                     , const segmentation_service &service )
+    : m_raster ( raster ), m_objects_vector ( objects_vector ), m_store_dir ( store_dir ), m_service ( service )
 {
 }
 
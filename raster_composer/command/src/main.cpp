@@ -0,0 +1,129 @@
+#include <iostream>
+#include <string>
+
+#include <args-parser/all.hpp>
+
+#include "common/definitions.h"
+#include "common/arguments.h"
+#include "common/string_utils.h"
+#include "common/progress_functions.hpp"
+#include "gdal_utils/all_helpers.h"
+#include "rsai/raster_composer.h"
+
+using namespace std;
+
+int main ( int argc, char * argv[] )
+{
+    try
+    {
+        Args::CmdLine cmd( argc, argv );
+
+        Args::Arg & input_raster_param = arguments::get_input_raster ();
+        input_raster_param.setDescription( input_raster_param.description() + SL( "Its band is highlighted by the output color channel, its pixels define the output grid." ) );
+
+        Args::Arg & second_raster_param = arguments::get_second_raster ();
+        second_raster_param.setDescription( second_raster_param.description() + SL( "Its band fills the rest of the output color channels." ) );
+
+        Args::Arg & output_param = arguments::get_output ();
+        output_param.setDescription( SL( "Output GeoTIFF raster file. " ) );
+
+        Args::Arg & projwin_param = arguments::get_projection_window ();
+
+        Args::Arg & band_param = arguments::get_source_band ();
+
+        Args::Arg & color_param = arguments::get_composite_color ();
+
+        Args::Help help;
+        help.setAppDescription(
+            std::string ( "Utility to compose a multidate RGB raster from two rasters of the same region. "
+                          "The band of the first raster is put into the '" ) + color_param.name() + "' channel and the band of the second one - into the others. "
+                          "The output is a tiled compressed GeoTIFF written in one pass without intermediate files. "
+                          "World coordinate systems of the rasters should match (no reprojection is performed)." );
+        help.setExecutable( argv[0] );
+
+        cmd.addArg ( input_raster_param );
+        cmd.addArg ( second_raster_param );
+        cmd.addArg ( output_param );
+        cmd.addArg ( projwin_param );
+        cmd.addArg ( band_param );
+        cmd.addArg ( color_param );
+        cmd.addArg ( help );
+
+        cmd.parse();
+
+        gdal::open_raster_ro_helper first_helper ( input_raster_param.value(), std::cerr );
+        auto ds_first = first_helper.validate ( true );
+
+        gdal::open_raster_ro_helper second_helper ( second_raster_param.value(), std::cerr );
+        auto ds_second = second_helper.validate ( true );
+
+        if ( ds_first == nullptr || ds_second == nullptr )
+        {
+            std::cerr << "STOP: Input parameters verification failed" << std::endl;
+            return 1;
+        }
+
+        auto first_srs = first_helper.srs (),
+             second_srs = second_helper.srs ();
+
+        if ( !first_srs.verify ( std::cerr ) || !second_srs.verify ( std::cerr ) )
+        {
+            std::cerr << "STOP: Input datasets' SRS are not valid" << std::endl;
+            return 1;
+        }
+
+        if ( !first_srs->IsSame ( second_srs.get() ) )
+        {
+            std::cerr << "STOP: input rasters' SRSs are not same." << std::endl << std::endl;
+            std::cout << "First SRS: " << first_srs.export_to_pretty_wkt() << std::endl << std::endl;
+            std::cout << "Second SRS: " << second_srs.export_to_pretty_wkt() << std::endl;
+            return 1;
+        }
+
+        array_helper < double > projwin_helper ( projwin_param.value(), ", " );
+        if ( !projwin_helper.verify ( std::cerr, "STOP: Projection window is incorrect" ) || projwin_helper.value().size () != 4 )
+        {
+            std::cerr << "STOP: Projection window should be set as 'ulx,uly,lrx,lry'" << std::endl;
+            return 1;
+        }
+
+        value_helper < int > band_helper ( band_param.value() );
+        if ( !band_helper.verify ( std::cerr, "STOP: Source band is incorrect" ) )
+            return 1;
+
+        const auto band_sources = rsai::raster_composer::color_sources ( color_param.value() );
+        if ( band_sources.empty () )
+        {
+            std::cerr << "STOP: Invalid color '" << color_param.value() << "'. Please specify blue, green, or red." << std::endl;
+            return 1;
+        }
+
+        const auto projwin = projwin_helper.value();
+        const auto grid = gdal::raster_grid::from_projwin ( ds_first, projwin [0], projwin [1], projwin [2], projwin [3] );
+        if ( !grid.valid () )
+        {
+            std::cerr << "STOP: Projection window does not define a region of the first raster" << std::endl;
+            return 1;
+        }
+
+        rsai::raster_composer composer ( { input_raster_param.value(), second_raster_param.value() }
+                                         , band_helper.value()
+                                         , band_sources
+                                         , grid
+                                         , output_param.value()
+                                       );
+
+        if ( !composer ( console_progress ) )
+            return 1;
+    }
+    catch( const Args::HelpHasBeenPrintedException & )
+    {
+    }
+    catch( const Args::BaseException & x )
+    {
+        Args::outStream() << x.desc() << SL( "\n" );
+    }
+
+
+    return 0;
+}
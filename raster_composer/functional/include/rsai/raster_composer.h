@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <thread>
+
+#include "common/progress_functions.hpp"
+
+#include "gdal_utils/shared_dataset.h"
+#include "gdal_utils/raster_window.h"
+
+namespace rsai
+{
+    // Composes a multidate raster by taking a band of each source into the output color channels.
+    // Rows are processed by block height strips in parallel and written in order into a tiled compressed GeoTIFF,
+    // no intermediate files are created.
+    class raster_composer
+    {
+    public:
+        // Output band i is read from sources [band_sources [i]], the grid is set in the first source's pixels
+        raster_composer ( const std::vector < std::string > &sources
+                          , const int source_band
+                          , const std::vector < int > &band_sources
+                          , const gdal::raster_grid &grid
+                          , const std::string &output
+                          , const int threads = std::max ( 1u, std::thread::hardware_concurrency () )
+                        );
+
+        template < class ProgressFunc >
+        bool operator () ( const ProgressFunc &progress_func = console_progress );
+
+        // Output bands' sources to highlight the first source in the color channel, empty for an unknown color
+        static std::vector < int > color_sources ( const std::string &color );
+
+    private:
+        const std::vector < std::string >   m_sources;
+        const int                           m_source_band;
+        const std::vector < int >           m_band_sources;
+        const gdal::raster_grid             m_grid;
+        const std::string                   m_output;
+        const int                           m_threads;
+    }; // class raster_composer
+
+}; // namespace rsai
+
+#include "rsai/raster_composer.hpp"
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "rsai/raster_composer.h"
+
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include "threading_utils/ordered_sink.h"
+
+template < class ProgressFunc >
+bool rsai::raster_composer::operator () ( const ProgressFunc &progress_func )
+{
+    auto ds_first = gdal::open_dataset ( m_sources.front (), GDAL_OF_RASTER | GDAL_OF_READONLY );
+    if ( !ds_first || m_source_band < 1 || m_source_band > ds_first->GetRasterCount () )
+    {
+        std::cerr << "Stop: Source band " << m_source_band << " is not found in " << m_sources.front () << std::endl;
+        return false;
+    }
+
+    const GDALDataType type = ds_first->GetRasterBand ( m_source_band )->GetRasterDataType ();
+    const int bands = m_band_sources.size ();
+
+    gdal::tiled_raster_writer writer ( m_output, m_grid, bands, type, "RGB", ds_first.raster_srs ().get () );
+    if ( !writer.valid () )
+    {
+        std::cerr << "Stop: Failed to create output raster " << m_output << std::endl;
+        return false;
+    }
+
+    const int strip_height = writer.block_height ();
+    const int strips = ( m_grid.height () + strip_height - 1 ) / strip_height;
+    const size_t pixel_size = GDALGetDataTypeSizeBytes ( type );
+
+    std::atomic_bool failed = false;
+    std::atomic_int next_strip = 0;
+    int written = 0;
+
+    threading::ordered_sink < std::vector < GByte > > sink ( [&] ( const int strip, std::vector < GByte > &buffer )
+    {
+        const int row_from = strip * strip_height;
+        const int row_to = std::min ( m_grid.height (), row_from + strip_height );
+
+        if ( !writer.write ( row_from, row_to, buffer.data () ) )
+            failed = true;
+
+        ++written;
+        progress_func ( float ( written ) / strips, written == strips );
+    }
+    , 0, 2 * m_threads );
+
+    auto worker = [&] ()
+    {
+        // Datasets are not thread safe, every worker reads by own handles
+        gdal::shared_datasets sources;
+        for ( const auto &source : m_sources )
+            sources.push_back ( gdal::open_dataset ( source, GDAL_OF_RASTER | GDAL_OF_READONLY ) );
+
+        if ( !sources )
+            failed = true;
+
+        std::vector < std::vector < GByte > > source_strips ( sources.size () );
+
+        for ( int strip = next_strip++; strip < strips; strip = next_strip++ )
+        {
+            if ( failed )
+            {
+                sink.skip ( strip );
+                continue;
+            }
+
+            const int row_from = strip * strip_height;
+            const int row_to = std::min ( m_grid.height (), row_from + strip_height );
+            const auto strip_grid = m_grid.rows ( row_from, row_to );
+            const size_t band_size = size_t ( strip_grid.width () ) * strip_grid.height () * pixel_size;
+
+            // Every source is read once even if it fills several output bands
+            for ( int i = 0; i < sources.size (); ++i )
+            {
+                source_strips [i].assign ( band_size, 0 );
+
+                auto * band = sources [i]->GetRasterBand ( m_source_band );
+                if ( band == nullptr || !strip_grid.read ( band, type, source_strips [i].data () ) )
+                    failed = true;
+            }
+
+            std::vector < GByte > buffer ( band_size * bands );
+            for ( int i = 0; i < bands; ++i )
+                std::memcpy ( buffer.data () + i * band_size, source_strips [m_band_sources [i]].data (), band_size );
+
+            sink.push ( strip, std::move ( buffer ) );
+        }
+    };
+
+    std::vector < std::thread > workers;
+    for ( int i = 0; i < m_threads; ++i )
+        workers.emplace_back ( worker );
+
+    for ( auto &a_worker : workers )
+        a_worker.join ();
+
+    sink.finish ();
+
+    if ( failed )
+    {
+        std::cerr << "Stop: Failed to compose raster " << m_output << std::endl;
+        return false;
+    }
+
+    return writer.commit ();
+}
@@ -0,0 +1,24 @@
+#include "rsai/raster_composer.h"
+
+rsai::raster_composer::raster_composer ( const std::vector < std::string > &sources
+                                         , const int source_band
+                                         , const std::vector < int > &band_sources
+                                         , const gdal::raster_grid &grid
+                                         , const std::string &output
+                                         , const int threads
+                                       )
+    : m_sources ( sources ), m_source_band ( source_band ), m_band_sources ( band_sources ), m_grid ( grid ), m_output ( output )
+    , m_threads ( std::max ( 1, threads ) )
+{
+}
+
+std::vector < int > rsai::raster_composer::color_sources ( const std::string &color )
+{
+    if ( color == "red" )
+        return { 0, 1, 1 };
+    if ( color == "green" )
+        return { 1, 0, 1 };
+    if ( color == "blue" )
+        return { 1, 1, 0 };
+    return {};
+}
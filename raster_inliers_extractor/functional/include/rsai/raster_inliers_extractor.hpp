@@ -2,12 +2,16 @@
 
 #include "rsai/raster_inliers_extractor.h"
 
+#include <atomic>
 #include <ogrsf_frmts.h>
 
 #include <gdal_utils/all_helpers.h>
 #include <gdal_utils/shared_options.h>
 #include <gdal_utils/region_of_interest.h>
 #include "gdal_utils/shared_feature.h"
+#include "gdal_utils/operations.h"
+#include "threading_utils/gdal_iterators.h"
+#include "threading_utils/ordered_sink.h"
 
 #include "common/definitions.h"
 
@@ -41,7 +45,11 @@ rsai::raster_inliers_extractor::raster_inliers_extractor ( gdal::shared_dataset
     if ( roi != nullptr )
         final_roi = gdal::geometry ( raster_bounds->Intersection ( roi.get () ) );
 
+    // prepared roi to skip cropping of the objects lying inside, a copy per worker
+    const gdal::thread_prepared_geometry thread_prepared_roi ( final_roi.get () );
+
     const int layers = ds_vector->GetLayerCount ();
+    const int threads_count = std::max ( 1u, std::thread::hardware_concurrency () );
 
     for( int i = 0; i < layers; ++i )
     {
@@ -64,78 +72,82 @@ rsai::raster_inliers_extractor::raster_inliers_extractor ( gdal::shared_dataset
         for ( int i = 0; i < layer_defn->GetFieldCount (); ++i )
             out_layer->CreateField ( layer_defn->GetFieldDefn ( i ) );
 
-        const float features_count = layer->GetFeatureCount ();
-        float features_processed = 0.0f;
-
-        for ( const auto& feature: *layer )
+        // Features are cropped by workers and written in the source order behind them
+        std::atomic_bool written ( true );
+        threading::ordered_sink < gdal::shared_features > out_sink ( [&] ( const int, gdal::shared_features &new_features )
         {
-            progress_func ( i + 1, layers, ++features_processed / features_count );
+            for ( auto &new_feature : new_features )
+            {
+                if ( written && out_layer->CreateFeature( new_feature.get () ) != OGRERR_NONE )
+                {
+                    std::cerr << "Stop: Failed to create feature." << std::endl;
+                    written = false;
+                }
+            }
+        }, 1, threads_count * 4 );
 
+        threading::layer_iterator a_layer_iterator ( layer );
+        a_layer_iterator ( [&] ( gdal::shared_feature feature, const int current_feature_id )
+        {
             const OGRGeometry *geometry = feature->GetGeometryRef ();
-            if ( geometry != nullptr
-                    && wkbFlatten ( geometry->getGeometryType()) == wkbPolygon )
+            if ( !written || geometry == nullptr
+                    || wkbFlatten ( geometry->getGeometryType()) != wkbPolygon )
             {
+                out_sink.skip ( current_feature_id );
+                return;
+            }
+
+            gdal::shared_features new_features;
 
-                auto polygon = geometry->toPolygon();
+            auto add_polygon = [&] ( const OGRGeometry * polygon )
+            {
+                if ( !__check_raster_size ( polygon, world_2_raster, min_raster_obj_size ) )
+                    return;
 
                 shared_feature new_feature ( feature->Clone () );
+                new_feature->SetGeometry ( polygon );
+                new_features.push_back ( new_feature );
+            };
 
-                // Crop geometry if required
-                if ( crop_geometry )
-                {
-                    auto cropped_geom = polygon->Intersection( final_roi.get() );
+            OGREnvelope envelope;
+            geometry->getEnvelope ( &envelope );
 
-                    OGRwkbGeometryType geom_type = cropped_geom->getGeometryType();
-                    if ( wkbFlatten(geom_type) == wkbPolygon )      // Crop result is polygon
-                    {
-                        if ( !__check_raster_size ( cropped_geom, world_2_raster, min_raster_obj_size ) )
-                            continue;
+            const auto & prepared_roi = thread_prepared_roi.local ();
 
-                        new_feature->SetGeometry ( cropped_geom );
+            // Crop geometry if required, objects inside roi are kept as is
+            if ( crop_geometry && !( prepared_roi.envelope ().Contains ( envelope ) && prepared_roi.contains ( geometry ) ) )
+            {
+                gdal::geometry cropped_geom ( geometry->Intersection( final_roi.get() ) );
 
-                        if( out_layer->CreateFeature( new_feature.get () ) != OGRERR_NONE )
-                        {
-                            std::cerr << "Stop: Failed to create feature." << std::endl;
-                            return;
-                        }
-                    }
-                    else    // Crop result is multipolygon - add the output individually
+                if ( cropped_geom != nullptr )
+                {
+                    OGRwkbGeometryType geom_type = wkbFlatten ( cropped_geom->getGeometryType() );
+                    if ( geom_type == wkbPolygon )      // Crop result is polygon
+                        add_polygon ( cropped_geom.get () );
+                    else if ( geom_type == wkbMultiPolygon || geom_type == wkbGeometryCollection )   // Crop result is multipolygon - add the output individually
                     {
-                        gdal::multipolygon cropped_multi_polygon ( cropped_geom->toMultiPolygon() );
+                        auto cropped_collection = cropped_geom->toGeometryCollection();
 
-                        for(int i = 0; i < cropped_multi_polygon->getNumGeometries(); ++i)
+                        for(int i = 0; i < cropped_collection->getNumGeometries(); ++i)
                         {
-                            auto polygon = cropped_multi_polygon->getGeometryRef(i);
-
-                            if ( !__check_raster_size ( polygon, world_2_raster, min_raster_obj_size ) )
-                                continue;
-
-                            new_feature->SetGeometry ( polygon );
-
-                            if( out_layer->CreateFeature( new_feature.get () ) != OGRERR_NONE )
-                            {
-                                std::cerr << "Stop: Failed to create feature." << std::endl;
-                                return;
-                            }
+                            auto polygon = cropped_collection->getGeometryRef(i);
+                            if ( wkbFlatten ( polygon->getGeometryType() ) == wkbPolygon )
+                                add_polygon ( polygon );
                         }
                     }
                 }
-                else // No crop - simply add polygon to the output map
-                {
-                    if ( !__check_raster_size ( polygon, world_2_raster, min_raster_obj_size ) )
-                        continue;
+            }
+            else // No crop - simply add polygon to the output map
+                add_polygon ( geometry );
 
-                    new_feature->SetGeometry ( polygon );
+            out_sink.push ( current_feature_id, std::move ( new_features ) );
 
-                    if( out_layer->CreateFeature( new_feature.get () ) != OGRERR_NONE )
-                    {
-                        std::cerr << "Stop: Failed to create feature." << std::endl;
-                        return;
-                    }
-                }
-            }
-        }
-        progress_func ( i + 1, layers, 1.0f, true );
+        }, i, layers, progress_func, threads_count );
+
+        out_sink.finish ();
+
+        if ( !written )
+            return;
     }
 }
 
@@ -1,9 +1,15 @@
 #include <iostream>
 #include <string>
+#include <limits>
 
 #include <args-parser/all.hpp>
 
 #include "rsai/roof_locator.h"
+#include "rsai/markup/shards.h"
+#include "rsai/feature_profile.h"
+#include "rsai/building_models/estimator_capture.h"
+#include "opencv_utils/artifact_writer.h"
+#include "threading_utils/trace.h"
 
 #include "common/definitions.h"
 #include "common/arguments.h"
@@ -47,6 +53,24 @@ int main ( int argc, char * argv[] )
 
         Args::Arg & use_sam_param = arguments::get_use_sam ();
 
+        Args::Arg & segmentation_socket_param = arguments::get_segmentation_socket ();
+        segmentation_socket_param.setDescription( std::string( "Unix socket path of the persistent segmentation worker objects are segmented by. "
+                                                               "The default is " ) + DEFAULT_SEGMENTATION_SOCKET + ". " );
+
+        Args::Arg & segmentation_batch_param = arguments::get_segmentation_batch ();
+        segmentation_batch_param.setDescription( std::string( "Segmentation worker's batch, twice as many tiles are sent ahead. "
+                                                              "The default is " ) + DEFAULT_SEGMENTATION_BATCH_VALUE + ". " );
+
+        Args::Arg & artifacts_param = arguments::get_artifacts ();
+
+        Args::Arg & artifacts_archive_param = arguments::get_artifacts_archive ();
+
+        Args::Arg & trace_param = arguments::get_trace ();
+
+        Args::Arg & profile_param = arguments::get_profile ();
+
+        Args::Arg & capture_param = arguments::get_capture ();
+
         Args::Arg & min_first_pos_weight_param = arguments::get_min_first_pos_weight ();
 
         Args::Arg & max_first_pos_deviation_param = arguments::get_max_first_pos_deviation ();
@@ -71,6 +95,13 @@ int main ( int argc, char * argv[] )
         cmd.addArg ( roof_position_walk_param );
         cmd.addArg ( roof_variants_param );
         cmd.addArg ( use_sam_param );
+        cmd.addArg ( segmentation_socket_param );
+        cmd.addArg ( segmentation_batch_param );
+        cmd.addArg ( artifacts_param );
+        cmd.addArg ( artifacts_archive_param );
+        cmd.addArg ( trace_param );
+        cmd.addArg ( profile_param );
+        cmd.addArg ( capture_param );
         cmd.addArg ( min_first_pos_weight_param );
         cmd.addArg ( max_first_pos_deviation_param );
         cmd.addArg ( help );
@@ -133,6 +164,14 @@ int main ( int argc, char * argv[] )
         if ( !roof_variants_helper.verify ( std::cerr,      "STOP: Building model roof variants value is incorrect." ) )
             return 1;
 
+        value_helper < int > segmentation_batch_helper      ( segmentation_batch_param.value() );
+        if ( !segmentation_batch_helper.verify ( std::cerr, "STOP: Segmentation batch value is incorrect." ) )
+            return 1;
+
+        rsai::segmentation_service segmentation;
+        segmentation.socket = segmentation_socket_param.value();
+        segmentation.batch = segmentation_batch_helper.value();
+
         value_helper < double > min_first_pos_weight_helper ( min_first_pos_weight_param.value() );
         if ( !min_first_pos_weight_helper.verify ( std::cerr, "STOP: First position minimum weight value is incorrect." ) )
             return 1;
@@ -164,6 +203,37 @@ int main ( int argc, char * argv[] )
             return 1;
         }
 
+        opencv::artifact_level artifacts_level;
+        if ( !opencv::artifact_level_from_string ( artifacts_param.value(), artifacts_level ) )
+        {
+            std::cerr << "STOP: Debug images level '" << artifacts_param.value() << "' is invalid. Use --help param for correct values." << std::endl;
+            return 1;
+        }
+
+        // Debug images go to a single tar archive of the run if asked
+        std::shared_ptr < rsai::markup::shard_writer > artifacts_archive;
+        opencv::artifact_writer::archive_sink artifacts_sink;
+        if ( artifacts_archive_param.isDefined () && artifacts_level != opencv::artifact_level::off )
+        {
+            artifacts_archive.reset ( new rsai::markup::shard_writer ( ds_out->GetDescription(), DEFAULT_ARTIFACTS_ARCHIVE_PREFIX
+                                                                     , std::numeric_limits < size_t >::max () ) );
+            artifacts_sink = [artifacts_archive] ( const std::string &file_name, const std::vector < uchar > &data )
+            {
+                return artifacts_archive->write_file ( file_name, data );
+            };
+        }
+
+        opencv::artifacts ().configure ( artifacts_level, artifacts_sink );
+
+        if ( trace_param.isDefined () )
+            threading::tracer::instance ().enable ( true );
+
+        if ( profile_param.isDefined () && !rsai::feature_profiles ().open ( profile_param.value() ) )
+            return 1;
+
+        if ( capture_param.isDefined () && !rsai::building_models::estimator_captures ().open ( capture_param.value() ) )
+            return 1;
+
         rsai::roof_locator finder (
                                         ds_vector
                                       , ds_raster
@@ -176,11 +246,23 @@ int main ( int argc, char * argv[] )
                                       , max_first_pos_deviation
                                       , force_rewtire_param.isDefined ()
                                       , use_sam_param.isDefined()
+                                      , segmentation
                                       , run_mode
                                       , interaction_mode
                                       , rewrite_layer_promt_func
                                       , console_progress_layers
                                    );
+
+        // Waiting for queued debug images and completing the archive
+        opencv::artifacts ().configure ( opencv::artifact_level::off );
+        if ( artifacts_archive )
+            artifacts_archive->close ();
+
+        if ( trace_param.isDefined () )
+            threading::tracer::instance ().write_chrome_trace ( trace_param.value() );
+
+        rsai::feature_profiles ().close ();
+        rsai::building_models::estimator_captures ().close ();
     }
     catch( const Args::HelpHasBeenPrintedException & )
     {
@@ -25,6 +25,7 @@ namespace rsai
                         , const double max_first_pos_deviation
                         , const bool force_rewrite
                         , const bool use_sam = false
+                        , const segmentation_service &segmentation = {}
                         , run_mode mode = run_mode::automatic
                         , interaction_mode interaction = interaction_mode::internal
                         , const PromtFunc &promt_func = rewrite_layer_promt_dummy
@@ -14,17 +14,25 @@
 #include "gdal_utils/shared_options.h"
 #include "gdal_utils/shared_feature.h"
 #include "gdal_utils/region_of_interest.h"
+#include "gdal_utils/segment_store.h"
 #include "opencv_utils/raster_roi.h"
 #include "opencv_utils/gdal_bridges.h"
 #include "opencv_utils/geometry_renderer.h"
+#include "opencv_utils/artifact_writer.h"
 #include "threading_utils/gdal_iterators.h"
+#include "threading_utils/ordered_sink.h"
+#include "threading_utils/trace.h"
 #include "rsai/building_models/prismatic.h"
 #include "rsai/building_models/roof_estimator.h"
 #include "rsai/building_models/structure_estimator.h"
+#include "rsai/building_models/estimator_capture.h"
 #include "differentiation/convolution_mask.h"
 #include "differentiation/gauss_directed_derivative.h"
 #include "differentiation/edge_detection.h"
 #include "rsai/building_variants_saver.h"
+#include "rsai/review_store.h"
+#include "rsai/feature_profile.h"
+#include "rsai/frame_cache.h"
 #include "rsai/building_models/building_renderer.h"
 #include "rsai/sam_segmentor.h"
 
@@ -43,6 +51,7 @@ rsai::roof_locator::roof_locator (
                                    , const double max_first_pos_deviation
                                    , const bool force_rewrite
                                    , const bool use_sam
+                                   , const segmentation_service &segmentation
                                    , run_mode a_run_mode
                                    , interaction_mode an_interaction_mode
                                    , const PromtFunc &promt_func
@@ -56,11 +65,22 @@ rsai::roof_locator::roof_locator (
     Eigen::Matrix3d raster_2_world = raster_eigen.transform ();
     Eigen::Matrix3d world_2_raster = raster_2_world.inverse ();
 
-    gdal::open_vector_ro_helper iv_helper ( ds_vector->GetDescription(), std::cerr );
-    auto ds_vector_4_render = iv_helper.validate ( true );
+    gdal::shared_dataset ds_vector_4_render;
+    if ( ds_vector->GetDriver () != nullptr && std::string ( ds_vector->GetDriver ()->GetDescription () ) == "Memory" )
+    {
+        // An in-memory input can't be reopened, so the renderer reads its copy
+        ds_vector_4_render = gdal::create_dataset ( "Memory", ds_vector->GetDescription () );
+        for ( int i = 0; ds_vector_4_render && i < ds_vector->GetLayerCount (); ++i )
+            ds_vector_4_render->CopyLayer ( ds_vector->GetLayer ( i ), ds_vector->GetLayer ( i )->GetName () );
+    }
+    else
+    {
+        gdal::open_vector_ro_helper iv_helper ( ds_vector->GetDescription(), std::cerr );
+        ds_vector_4_render = iv_helper.validate ( true );
+    }
 
     const std::string dst_dir = std::string ( ds_out->GetDescription() ) + "/" + DEFAULT_SEGMENTS_DIRECTORY + "/";
-    sam_segmentor segmentor ( ds_raster, ds_vector, dst_dir );
+    sam_segmentor segmentor ( ds_raster, ds_vector, dst_dir, segmentation );
     if ( use_sam )
     {
         std::cout << "Creating Segment anything objects' boundaries...\n";
@@ -91,10 +111,53 @@ rsai::roof_locator::roof_locator (
         gdal::layer_simple_reader reader_4_render ( layer_4_render );
         rsai::building_variants_saver saver ( std::string ( ds_out->GetDescription() )
                                               + "/" + DEFAULT_VARIANTS_DIRECTORY + "/" + DEFAULT_ROOFS_SUBDIRECTORY );
-        std::vector < std::pair < tile_info, rsai::building_models::roof_responses > > positions_list;
 
-        threading::layer_iterator a_layer_iterator ( layer );
-        layers_result &= a_layer_iterator ( [&] ( gdal::shared_feature feature, const int current_feature_id )
+        // Candidates for internal review are spilled to a memory mapped file instead of being kept in RAM
+        std::unique_ptr < rsai::review_store < rsai::building_models::roof_responses > > positions_store;
+
+        // Automatic mode streams the first positions straight to the output layer in the source order,
+        // tiles and responses are dropped by workers
+        const bool streaming = an_interaction_mode == interaction_mode::internal && a_run_mode == run_mode::automatic;
+        std::unique_ptr < threading::ordered_sink < gdal::shared_feature > > out_sink;
+        OGRFeatureDefn * roof_defn = nullptr;
+        std::atomic_int done_streamed ( 0 );
+        // Same statistics files as the automatic review writes, the sink consumer times the output
+        std::ofstream streamed_hist, streamed_time;
+        double streamed_total_time = 0.0;
+        if ( streaming )
+        {
+            const std::string out_dir = ds_out->GetDescription();
+            streamed_hist.open ( out_dir + "roof_stats.txt" );
+            streamed_time.open ( out_dir + "timings.txt" );
+            streamed_time << "ID" << '\t' << "index" << '\t' << "actions"
+                          << '\t' << "time, s" << "\t" << "size" << "\t" << "response"
+                          << "\t" << "best response" << '\t' << "deviation" << '\t' << "best deviation" << '\n';
+
+            gdal::create_vector_helper layers_helper ( ds_out, std::cerr );
+            auto roof_layer = layers_helper.create_layer ( DEFAULT_ROOF_LAYER_NAME, wkbMultiPolygon, layer->GetSpatialRef(), force_rewrite, promt_func );
+            if ( !roof_layer )
+                continue;
+
+            roof_layer << gdal::field_definition ( DEFAULT_OBJECT_ID_FIELD_NAME, OFTInteger );
+            roof_defn = roof_layer->GetLayerDefn();
+
+            out_sink.reset ( new threading::ordered_sink < gdal::shared_feature > ( [roof_layer, &streamed_total_time] ( const int, gdal::shared_feature &new_feature )
+            {
+                RSAI_TRACE_FEATURE_SPAN ( "write", new_feature->GetFieldAsInteger ( DEFAULT_OBJECT_ID_FIELD_NAME ) );
+                auto start = std::chrono::high_resolution_clock::now();
+
+                if ( roof_layer->CreateFeature( new_feature.get () ) != OGRERR_NONE )
+                    std::cerr << "Stop: Failed to create feature in layer " << roof_layer->GetName () << std::endl;
+
+                std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+                streamed_total_time += elapsed.count();
+            }, 1, std::max ( 1u, std::thread::hardware_concurrency () ) * 4 ) );
+        }
+        else if ( an_interaction_mode == interaction_mode::internal )
+            positions_store.reset ( new rsai::review_store < rsai::building_models::roof_responses > (
+                                        std::string ( ds_out->GetDescription() ) + "/" + layer->GetName () + DEFAULT_REVIEW_STORE_FILE_EXT ) );
+
+        auto locate = [&] ( gdal::shared_feature feature, const int current_feature_id ) -> gdal::shared_feature
         {
             const OGRGeometry *geometry = feature->GetGeometryRef ();
             if ( geometry != nullptr
@@ -103,30 +166,39 @@ rsai::roof_locator::roof_locator (
                 const int object_index = feature->GetFieldAsInteger ( id_field_name.c_str() );
                 const std::string object_index_str = std::to_string ( object_index );
 
+                RSAI_TRACE_FEATURE ( object_index );
+                RSAI_TRACE_SPAN ( "locate" );
+                rsai::feature_profile profile ( object_index );
+
                 auto polygon = geometry->toPolygon();
 
                 if ( polygon == nullptr )
-                    return;
+                    return {};
 
                 // Getting bbox and polygon
                 auto bounds_ring = polygon->getExteriorRing ();
                 auto object = polygon->getInteriorRing ( 0 );
 
                 if ( bounds_ring == nullptr || object == nullptr )
-                    return;
+                    return {};
 
                 // Extracting a desired object's tile from source raster
                 auto tile_bounds = instance < gdal::polygon > ();
                 tile_bounds->addRingDirectly ( bounds_ring->clone () );
+                RSAI_TRACE_BEGIN ( tile_span, "tile read" );
                 auto tile_bbox  = ds_tile_extractor.raster_bbox ( tile_bounds );
                 auto tile       = ds_tile_extractor.roi ( tile_bbox );
+                RSAI_TRACE_END ( tile_span );
+                profile.lap ( "tile_read" );
 
                 auto geometry_inliers = gdal::to_polygon ( reader_4_render ( tile_bounds ) );
                 geometry_inliers *= world_2_raster;
                 geometry_inliers += -tile_bbox.top_left();
 
                 cv::Mat tile_marked;
+                if ( !streaming || use_sam )
                 {
+                    RSAI_TRACE_SPAN ( "rendering" );
                     building_renderer renderer ( tile, 1 );
                     for ( auto inlier : geometry_inliers )
                         renderer.render_position( inlier, cv::Scalar ( 0x00, 0xFF, 0x00 ), false );
@@ -142,15 +214,18 @@ rsai::roof_locator::roof_locator (
                 {
                     //edges = cv::imread ( dst_dir + object_index_str + "_edges.jpg" );
 
-                    cv::imwrite ( dst_dir + object_index_str + "_tile.jpg", tile_marked );
+                    opencv::artifacts ().write ( opencv::artifact_level::summary, dst_dir + object_index_str + "_tile.jpg", tile_marked );
 
-                    segments = to_polygon ( gdal::from_wkt_file ( dst_dir + DEFAULT_OBJECT_WKT_FILE_PREFIX + object_index_str + ".wkt" ) );
+                    RSAI_TRACE_SPAN ( "sam load" );
+                    segments = to_polygon ( gdal::from_segments_file ( dst_dir + DEFAULT_OBJECT_WKT_FILE_PREFIX + object_index_str + DEFAULT_SEGMENT_STORE_FILE_EXT ) );
 
 //                    if ( tile.size () != edges.size () )
 //                        std::cerr << "Stop: Image tile and edges size missmatch! "
 //                                  << "Tile: " << tile.size () << " edges: " << edges.size () << '\n';
                 }
 
+                profile.lap ( "prepare" );
+
                 // Projecting and shading vectors
                 cv::Mat tile_gray;
                 cv::cvtColor ( tile, tile_gray, cv::COLOR_BGR2GRAY );
@@ -178,31 +253,103 @@ rsai::roof_locator::roof_locator (
                 auto roof = instance < gdal::polygon > ();
                 roof->addRingDirectly ( object->clone() );
 
+                if ( building_models::estimator_captures ().enabled () )
+                {
+                    building_models::estimator_input input;
+                    input.object_index = object_index;
+                    input.tile_gray = tile_gray;
+                    input.world_2_raster = world_2_raster;
+                    input.tile_top_left = tile_bbox.top_left ();
+                    input.proj_world = proj_world;
+                    input.shade_world = shade_world;
+                    input.max_length = max_length;
+                    input.roof = roof;
+                    input.segments = segments;
+                    input.use_sam = use_sam;
+                    input.roof_position_walk = roof_position_walk;
+                    input.roof_variants = roof_variants;
+                    building_models::estimator_captures ().write ( input );
+                }
+
                 // Estimating roof position
                 rsai::building_models::roof_estimator roof_estimator ( roof_position_walk, world_2_raster, proj_world, shade_world, max_length, tile_gray );
 
                 auto responses = ( use_sam ) ? roof_estimator ( roof, -tile_bbox.top_left(), segments, roof_variants, dst_dir + object_index_str + "_" )
                                              : roof_estimator ( roof, -tile_bbox.top_left(), roof_variants );
+                profile.lap ( "roof_estimation" );
 
-                cv::imwrite ( dst_dir + object_index_str + "_heat.jpg", roof_estimator.heatmap() );
+                opencv::artifacts ().write ( opencv::artifact_level::summary, dst_dir + object_index_str + "_heat.jpg", roof_estimator.heatmap() );
+
+                if ( rsai::feature_profiles ().enabled () )
+                {
+                    const auto & estimator_stats = roof_estimator.stats ();
+                    profile.tile_width = tile.cols;
+                    profile.tile_height = tile.rows;
+                    profile.contour_length = object->get_Length ();
+                    profile.search_area = estimator_stats.search_area;
+                    profile.segments = segments.size ();
+                    profile.candidates = estimator_stats.candidates;
+                    profile.variants = responses.size ();
+                    profile.scratch_bytes = estimator_stats.scratch_bytes;
+                    rsai::feature_profiles ().write ( profile );
+                }
 
                 if ( an_interaction_mode == interaction_mode::external )
                     saver.write ( object_index_str, roof, responses, tile, tile_bbox.top_left(), raster_2_world );
-                else
+                else if ( streaming )
                 {
-                    static std::mutex mutex;
-                    std::lock_guard < std::mutex > lock ( mutex );
+                    if ( responses.size() == 0 )
+                    {
+                        std::cout << "Skipped feature " << object_index_str << " with no positions\n";
+                        return {};
+                    }
+
+                    auto roof_poly = instance < multipolygon > ();
+                    roof_poly->addGeometryDirectly ( responses [0].aligned_roof ()->clone () );
 
-                    positions_list.push_back ( { { tile, tile_marked, tile_bbox.top_left(), object_index_str, roof }, std::move ( responses ) } );
+                    gdal::shared_feature new_feature ( roof_defn );
+                    new_feature->SetGeometry ( roof_poly.get () );
+                    new_feature->SetField ( DEFAULT_OBJECT_ID_FIELD_NAME, object_index );
+
+                    ++done_streamed;
+                    return new_feature;
                 }
+                else
+                    positions_store->push ( { tile, tile_marked, tile_bbox.top_left(), object_index_str, roof }, responses );
             }
+
+            return {};
+        };
+
+        threading::layer_iterator a_layer_iterator ( layer );
+        layers_result &= a_layer_iterator ( [&] ( gdal::shared_feature feature, const int current_feature_id )
+        {
+            auto roof_feature = locate ( feature, current_feature_id );
+
+            // Every feature id has to reach the bounded sink
+            if ( out_sink && roof_feature )
+                out_sink->push ( current_feature_id, roof_feature );
+            else if ( out_sink )
+                out_sink->skip ( current_feature_id );
         } , i, layers, progress_func );
 
-        if ( an_interaction_mode == interaction_mode::internal )
+        if ( streaming )
+        {
+            out_sink->finish ();
+
+            // Automatic choices are not counted in the roof index histogram, it stays empty as before
+            streamed_time << "Overall time is " << streamed_total_time << "s";
+
+            std::cout << "Roofs aligned automatically " << done_streamed << "\n";
+        }
+        else if ( an_interaction_mode == interaction_mode::internal )
         {
 
             std::cout << "Result reviewing...\n";
 
+            if ( !positions_store->seal () )
+                continue;
+
             const std::string out_dir = ds_out->GetDescription();
             std::ofstream choice_hist ( out_dir + "roof_stats.txt" );
             std::ofstream choice_time ( out_dir + "timings.txt" );
@@ -232,12 +379,14 @@ rsai::roof_locator::roof_locator (
             int done_automatically = 0;
             int done_manually = 0;
 
-            std::vector < map_item > map_items ( positions_list.size () );
+            std::vector < map_item > map_items ( positions_store->size () );
+            rsai::frame_cache < rsai::frame_key > frames;
 
             int key = 0;
-            for ( int j = 0; j < positions_list.size (); )
+            for ( int j = 0; j < positions_store->size (); )
             {
-                auto &positions_data = positions_list [j];
+                auto positions_item = positions_store->get ( j );
+                auto &positions_data = *positions_item;
                 const auto &tile_tl = positions_data.first.top_left;
                 auto &positions = positions_data.second;
                 auto obj_id = positions_data.first.index;
@@ -259,7 +408,7 @@ rsai::roof_locator::roof_locator (
                     auto start = std::chrono::high_resolution_clock::now();
                     int actions_count = 0;
 
-                    const int linear_size = static_cast < int > ( std::sqrt ( positions[0].aligned_roof->get_Area() ) );
+                    const int linear_size = static_cast < int > ( std::sqrt ( positions[0].aligned_roof ()->get_Area() ) );
                     const auto first_position_deviation = positions[0].deviation;
                     const auto first_position_weight = ( positions[0].value - positions[1].value ) / linear_size * raster_2_world ( 0, 0 )
                                                        / ( first_position_deviation > 1.0 ? first_position_deviation : 1.0 );
@@ -272,17 +421,13 @@ rsai::roof_locator::roof_locator (
                     done_automatically  += use_manual ? 0 : 1;
                     done_manually       += use_manual ? 1 : 0;
 
-                    while ( true && use_manual )
+                    frames.reset ( [positions_item, original_on_tile] ( const rsai::frame_key &view )
                     {
+                        auto tile = ( view.markup ) ? positions_item->first.tile_marked : positions_item->first.tile;
 
-                        //std::cout << "Reveiwing " << obj_id << " with positions count " << positions.size();
-                        //std::cout.flush();
-
-                        auto tile = ( show_markup ) ? positions_data.first.tile_marked : positions_data.first.tile;
-
-                        if ( draw_model )
+                        if ( view.model )
                         {
-                            auto current_roof = positions[current_roof_index].aligned_roof_in_tile;
+                            auto current_roof = positions_item->second [view.roof].aligned_roof_in_tile ();
                             building_renderer renderer ( tile );
 
                             renderer.render_position ( original_on_tile, cv::Scalar ( 0xFF, 0x00, 0x00 ) );
@@ -290,6 +435,27 @@ rsai::roof_locator::roof_locator (
                             tile = renderer.get ();
                         }
 
+                        return tile;
+                    } );
+
+                    while ( true && use_manual )
+                    {
+
+                        //std::cout << "Reveiwing " << obj_id << " with positions count " << positions.size();
+                        //std::cout.flush();
+
+                        auto tile = frames.get ( { current_roof_index, 0, show_markup, draw_model } );
+
+                        // Frames reachable by the next keypress are rendered while the operator looks at this one
+                        std::vector < rsai::frame_key > next_views;
+                        if ( current_roof_index + 1 < positions.size () )
+                            next_views.push_back ( { current_roof_index + 1, 0, show_markup, draw_model } );
+                        if ( current_roof_index > 0 )
+                            next_views.push_back ( { current_roof_index - 1, 0, show_markup, draw_model } );
+                        next_views.push_back ( { current_roof_index, 0, !show_markup, draw_model } );
+                        next_views.push_back ( { current_roof_index, 0, show_markup, !draw_model } );
+                        frames.prefetch ( next_views );
+
                         cv::imshow("Roof variant", tile);
                         key = cv::waitKey(0);
 
@@ -329,7 +495,7 @@ rsai::roof_locator::roof_locator (
                             current_roof_index = 0;
                         }
 
-                        auto current_roof = positions[current_roof_index].aligned_roof;
+                        auto current_roof = positions[current_roof_index].aligned_roof ();
 
                         auto & item = map_items [j];
                         auto roof_poly = instance < multipolygon > ();
@@ -356,7 +522,7 @@ rsai::roof_locator::roof_locator (
 
                     if ( !save && a_run_mode != run_mode::automatic )
                     {
-                        auto current_roof = positions[current_roof_index].aligned_roof;
+                        auto current_roof = positions[current_roof_index].aligned_roof ();
                         const int linear_size = static_cast < int > ( std::sqrt ( current_roof->get_Area() ) );
 
                         choice_time << obj_id << '\t' << -1 /*<< '\t' << actions_count
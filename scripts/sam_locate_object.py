@@ -23,18 +23,28 @@ predictor = SamPredictor(sam)
 
 directory_name = sys.argv [2]
 
-jpg_files = su.get_jpg_filenames_without_extension(directory_name)
-print(f"Number of jpg files: {len(jpg_files)}")
 
-mean_iou = 0
 
-for file in tqdm(jpg_files):
-    image = cv2.imread(f"{directory_name}/{file}.jpg")
-    image = cv2.cvtColor(image, cv2.COLOR_BGR2RGB)
+def read_samples(directory):
+    # Yields (name, image, bbox, positives, reference contour) from shards or per-object files
+    if su.get_shard_indices(directory):
+        for key, members in su.read_shard_samples(directory):
+            image = cv2.imdecode(np.frombuffer(members['.jpg'], np.uint8), cv2.IMREAD_COLOR)
+            yield key, image, su.parse_coordinates(members['.bbox'].decode()), \
+                su.wkt_text_to_np_array(members['.points'].decode()), su.wkt_text_to_ogr(members['.object'].decode())
+    else:
+        for file in su.get_jpg_filenames_without_extension(directory):
+            image = cv2.imread(f"{directory}/{file}.jpg")
+            yield file, image, su.read_coordinates(f"{directory}/{file}.bbox"), \
+                su.wkt_to_np_array(f"{directory}/{file}.points"), su.wkt_to_ogr(f"{directory}/{file}.object")
 
-    bbox = su.read_coordinates(f"{directory_name}/{file}.bbox")
 
-    positives = su.wkt_to_np_array(f"{directory_name}/{file}.points")
+samples = 0
+mean_iou = 0
+
+for file, image, bbox, positives, ref_contour in tqdm(read_samples(directory_name)):
+    samples += 1
+    image = cv2.cvtColor(image, cv2.COLOR_BGR2RGB)
     #negatives = wkt_to_np_array(f"{directory_name}/{file}.negative")
 
     positive_labels = np.full(positives.shape[0], 1)
@@ -64,7 +74,6 @@ for file in tqdm(jpg_files):
         #cv2.imwrite(f"{directory_name}/{file}_{i}_pred.jpg", opencv_image)
 
         major_contour = su.opencv2ogr(su.get_largest_contour(opencv_image))
-        ref_contour = su.wkt_to_ogr(f"{directory_name}/{file}.object")
 
         iou = su.compute_iou(major_contour, ref_contour)
 
@@ -86,4 +95,5 @@ for file in tqdm(jpg_files):
         iou_file.write(str(max_iou))
         iou_file.close()
 
-print("mean iou = ", mean_iou / len(jpg_files))
+print(f"Number of samples: {samples}")
+print("mean iou = ", mean_iou / max(samples, 1))
@@ -0,0 +1,149 @@
+import sam_utility as su
+import sys
+import os
+import socket
+import select
+import struct
+import numpy as np
+import cv2
+from segment_anything import sam_model_registry, SamAutomaticMaskGenerator
+
+# Persistent segmentation worker, see segmentation/include/rsai/segmentation/protocol.h
+HEADER = struct.Struct('<IHHIIIIQ')
+MAGIC = 0x49415352
+VERSION = 1
+MSG_SEGMENT = 1
+MSG_CONTOURS = 2
+MSG_ERROR = 3
+MSG_SHUTDOWN = 4
+# Mirrors max_tile_side and max_tile_channels, larger sizes are treated as a corrupt header
+MAX_TILE_SIDE = 512 + 2 * 100
+MAX_TILE_CHANNELS = 4
+
+
+def read_exact(connection, size):
+    data = bytearray()
+    while len(data) < size:
+        chunk = connection.recv(size - len(data))
+        if not chunk:
+            return None
+        data.extend(chunk)
+    return bytes(data)
+
+
+# The size comes from the peer, so it's checked before anything is read
+def payload_size_valid(msg_type, width, height, channels, payload_size):
+    if msg_type == MSG_SEGMENT:
+        return (width <= MAX_TILE_SIDE and height <= MAX_TILE_SIDE and 0 < channels <= MAX_TILE_CHANNELS
+                and payload_size == width * height * channels)
+    return payload_size == 0
+
+
+# None closes the connection: the peer is gone or its header is invalid
+def read_message(connection):
+    header = read_exact(connection, HEADER.size)
+    if header is None:
+        return None
+    magic, version, msg_type, request_id, width, height, channels, payload_size = HEADER.unpack(header)
+    if magic != MAGIC or version != VERSION:
+        return None
+    if not payload_size_valid(msg_type, width, height, channels, payload_size):
+        print(f"Rejected payload of {payload_size} bytes, closing the connection")
+        return None
+    payload = read_exact(connection, payload_size) if payload_size > 0 else b''
+    if payload is None:
+        return None
+    return msg_type, request_id, width, height, channels, payload
+
+
+def send_contours(connection, request_id, contours):
+    payload = bytearray()
+    for contour in contours:
+        points = np.asarray(contour, dtype='<f8').reshape(-1, 2)
+        payload.extend(struct.pack('<I', points.shape[0]))
+        payload.extend(points.tobytes())
+    connection.sendall(HEADER.pack(MAGIC, VERSION, MSG_CONTOURS, request_id, len(contours), 0, 0, len(payload)) + payload)
+
+
+def send_error(connection, request_id):
+    connection.sendall(HEADER.pack(MAGIC, VERSION, MSG_ERROR, request_id, 0, 0, 0, 0))
+
+
+def segment(mask_generator, tile):
+    image = cv2.cvtColor(tile, cv2.COLOR_BGR2RGB) if tile.shape[2] == 3 else tile
+    contours = []
+    for mask in mask_generator.generate(image):
+        m = mask['segmentation'].astype(np.uint8)
+        _, m = cv2.threshold(m, 0.5, 255, cv2.THRESH_BINARY)
+        if np.any(m):
+            major_contour = su.get_largest_contour(m)
+            if major_contour is not None and len(major_contour) >= 3:
+                contours.append(major_contour.reshape(-1, 2).astype(np.float64))
+    return contours
+
+
+def serve(connection, mask_generator, batch_size):
+    while True:
+        batch = []
+        shutdown = False
+        # Blocking for the first request, then collecting the already pipelined ones
+        while len(batch) < batch_size:
+            message = read_message(connection)
+            if message is None:
+                return True
+            msg_type, request_id, width, height, channels, payload = message
+            if msg_type == MSG_SHUTDOWN:
+                shutdown = True
+                break
+            if msg_type == MSG_SEGMENT:
+                batch.append((request_id, np.frombuffer(payload, dtype=np.uint8).reshape(height, width, channels)))
+            readable, _, _ = select.select([connection], [], [], 0)
+            if not readable:
+                break
+
+        for request_id, tile in batch:
+            try:
+                send_contours(connection, request_id, segment(mask_generator, tile))
+            except Exception:
+                send_error(connection, request_id)
+
+        if shutdown:
+            return False
+
+
+if len(sys.argv) < 3:
+    print("Please provide SAM model path and socket path, optionally batch size")
+    exit()
+
+sam_checkpoint = sys.argv[1]
+socket_path = sys.argv[2]
+batch_size = int(sys.argv[3]) if len(sys.argv) > 3 else 8
+model_type = "vit_h"
+
+device = "cuda"
+
+sam = sam_model_registry[model_type](checkpoint=sam_checkpoint)
+sam.to(device=device)
+
+mask_generator = SamAutomaticMaskGenerator(
+    model=sam,
+    stability_score_thresh=0.9
+)
+
+if os.path.exists(socket_path):
+    os.unlink(socket_path)
+
+server = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+server.bind(socket_path)
+server.listen(4)
+print(f"Segmentation worker is listening {socket_path}")
+
+try:
+    while True:
+        connection, _ = server.accept()
+        with connection:
+            if not serve(connection, mask_generator, batch_size):
+                break
+finally:
+    server.close()
+    os.unlink(socket_path)
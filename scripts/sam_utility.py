@@ -3,6 +3,7 @@ import cv2
 import os
 from osgeo import ogr
 import fnmatch
+import glob
 
 
 def cv_show_box(box, image):
@@ -25,52 +26,87 @@ def get_jpg_filenames_without_extension(directory, exceptions=None):
 
 def wkt_to_np_array(filename):
     with open(filename, 'r') as file:
-        data = file.read().replace('\n', '')
+        return wkt_text_to_np_array(file.read())
 
-        # Create a geometry from the WKT string
-        geom = ogr.CreateGeometryFromWkt(data)
 
-        # Get the points from the MultiPoint geometry
-        points = [(point.GetX(), point.GetY()) for point in geom]
+def wkt_text_to_np_array(text):
+    data = text.replace('\n', '')
 
-        # Convert the points into a numpy array
-        coordinates = np.array(points)
+    # Create a geometry from the WKT string
+    geom = ogr.CreateGeometryFromWkt(data)
 
-        return coordinates
+    # Get the points from the MultiPoint geometry
+    points = [(point.GetX(), point.GetY()) for point in geom]
+
+    # Convert the points into a numpy array
+    coordinates = np.array(points)
+
+    return coordinates
 
 
 def wkt_to_ogr(filename):
     with open(filename, 'r') as file:
-        data = file.read().replace('\n', '')
+        return wkt_text_to_ogr(file.read())
+
 
-        # Create a geometry from the WKT string
-        geom = ogr.CreateGeometryFromWkt(data)
+def wkt_text_to_ogr(text):
+    data = text.replace('\n', '')
 
-        return geom
+    # Create a geometry from the WKT string
+    geom = ogr.CreateGeometryFromWkt(data)
+
+    return geom
 
 
 def read_coordinates(file_name):
+    # Open the file
+    with open(file_name, 'r') as file:
+        return parse_coordinates(file.read())
+
+
+def parse_coordinates(text):
     # Initialize an empty list to store the coordinates
     coordinates_list = []
 
-    # Open the file
-    with open(file_name, 'r') as file:
-        # Read each line in the file
-        for line in file:
-            # Remove the brackets and split the line into parts by comma
-            parts = line.replace('[', '').replace(']', '').split(',')
+    # Read each line
+    for line in text.splitlines():
+        # Remove the brackets and split the line into parts by comma
+        parts = line.replace('[', '').replace(']', '').split(',')
 
-            for part in parts:
-                # Split the part into x and y coordinates
-                x, y = part.split()
+        for part in parts:
+            # Split the part into x and y coordinates
+            x, y = part.split()
 
-                # Convert the parts to float and add them to the list
-                coordinates_list.append((float(x), float(y)))
+            # Convert the parts to float and add them to the list
+            coordinates_list.append((float(x), float(y)))
 
     # Convert the list to a numpy array and return it
     return np.array(coordinates_list)
 
 
+def get_shard_indices(directory):
+    return sorted(glob.glob(os.path.join(directory, '*-[0-9][0-9][0-9][0-9][0-9].idx')))
+
+
+def read_shard_samples(directory):
+    # Yields (key, {extension: bytes}) samples of tar shards written by rsai::markup::shard_writer,
+    # index lines are "key<TAB>extension<TAB>offset<TAB>size" and sample members are contiguous
+    for index_name in get_shard_indices(directory):
+        shard_name = os.path.splitext(index_name)[0] + '.tar'
+        key, members = None, {}
+        with open(index_name, 'r') as index, open(shard_name, 'rb') as shard:
+            for line in index:
+                sample_key, extension, offset, size = line.rstrip('\n').split('\t')
+                if key is not None and sample_key != key:
+                    yield key, members
+                    members = {}
+                key = sample_key
+                shard.seek(int(offset))
+                members[extension] = shard.read(int(size))
+        if key is not None:
+            yield key, members
+
+
 def get_largest_contour(image):
     # Find contours - cv2.RETR_EXTERNAL is for outer contours
     contours, _ = cv2.findContours(image, cv2.RETR_EXTERNAL, cv2.CHAIN_APPROX_SIMPLE)
@@ -39,6 +39,8 @@ int main ( int argc, char * argv[] )
 
         Args::Arg & force_rewtire_param = arguments::get_force_rewtire ();
 
+        Args::Arg & shard_size_param = arguments::get_shard_size ();
+
         Args::Help help;
         help.setAppDescription(
             SL( "Utility to create a Segment Anything markup using roofs vector layer and start a script to collect best IoU-based predicitions."
@@ -51,6 +53,7 @@ int main ( int argc, char * argv[] )
         cmd.addArg ( output_map_param );
         cmd.addArg ( tile_buffer_size_param );
         cmd.addArg ( force_rewtire_param );
+        cmd.addArg ( shard_size_param );
         cmd.addArg ( help );
 
         cmd.parse();
@@ -103,6 +106,23 @@ int main ( int argc, char * argv[] )
 
         const int tile_buffer_size = tile_buffer_size_helper.value();
 
+        size_t shard_size = 0;
+        if ( shard_size_param.isDefined () )
+        {
+            value_helper < int > shard_size_helper  ( shard_size_param.value() );
+
+            if ( !shard_size_helper.verify ( std::cerr, "STOP: Shard size is incorrect." ) )
+                return 1;
+
+            if ( shard_size_helper.value() <= 0 )
+            {
+                std::cerr << "STOP: Shard size has to be positive." << std::endl;
+                return 1;
+            }
+
+            shard_size = size_t ( shard_size_helper.value() ) << 20;
+        }
+
         rsai::segany_markup_by_objects markupper (
                                                       ds_vector
                                                     , ds_raster
@@ -110,6 +130,7 @@ int main ( int argc, char * argv[] )
                                                     , output_param.value ()
                                                     , tile_buffer_size
                                                     , force_rewtire_param.isDefined ()
+                                                    , shard_size
                                                     , rewrite_directory_promt_func
                                                     , rewrite_layer_promt_func
                                                     , console_progress_layers
@@ -19,6 +19,7 @@ namespace rsai
                                     , const std::string &markup_directory
                                     , int tile_buffer_size
                                     , const bool force_rewrite
+                                    , const size_t shard_size = 0
                                     , const PromtFunc &promt_func = rewrite_directory_promt_dummy
                                     , const LayerPromtFunc &layer_promt_func = rewrite_layer_promt_dummy
                                     , const ProgressFunc &progress_func = progress_dummy
@@ -5,6 +5,8 @@
 #include <ogrsf_frmts.h>
 #include <cstdint>
 #include <fstream>
+#include <sstream>
+#include <memory>
 #include <filesystem>
 #include <cstdlib>
 
@@ -21,6 +23,7 @@
 #include "threading_utils/gdal_iterators.h"
 #include "geometry_utils/points_fill.h"
 #include "rsai/markup/tile_saver.h"
+#include "rsai/markup/shards.h"
 
 using namespace rsai;
 
@@ -55,6 +58,14 @@ rsai::segany_markup_by_objects::segany_markup_by_objects (
 
     bool layers_result = true;
 
+    // Optionally objects are packed into tar shards instead of a set of files per object
+    std::unique_ptr < markup::shard_writer > shards;
+    if ( shard_size > 0 )
+        shards.reset ( new markup::shard_writer ( markup_directory, DEFAULT_MARKUP_LAYER_NAME, shard_size ) );
+
+    // A failed shard stops storing, the markup is incomplete and not segmented
+    std::atomic_bool shards_failed ( false );
+
     for( int i = 0; i < layers; ++i )
     {
         auto layer = roof_vector->GetLayer ( i );
@@ -100,16 +111,19 @@ rsai::segany_markup_by_objects::segany_markup_by_objects (
 
                 auto polygon = geometry->toPolygon();
 
-                if ( polygon == nullptr )
+                if ( polygon == nullptr || shards_failed )
                     return;
 
                 const int object_index = feature->GetFieldAsInteger ( id_field_name.c_str () );
                 const std::string object_index_str = std::to_string ( object_index );
 
                 auto object_raster_bbox = a_tile_saver.get_bbox ( feature );
-                auto bufferized_raster_box = a_tile_saver ( feature, tile_buffer_size );
 
-                geometry::point_fill markup_creator ( polygon );
+                std::vector < uchar > encoded_tile;
+                auto bufferized_raster_box = ( shards ) ? a_tile_saver ( feature, encoded_tile, tile_buffer_size )
+                                                        : a_tile_saver ( feature, tile_buffer_size );
+
+                geometry::point_fill markup_creator ( polygon, object_index );
                 auto object_markup = markup_creator ();
 
                 if ( markup_feature )
@@ -124,17 +138,39 @@ rsai::segany_markup_by_objects::segany_markup_by_objects (
                 /*auto negative_local = gdal::transform ( object_markup.negative, world_2_raster );
                 auto negative_tile = gdal::shift ( negative_local, -raster_box.top_left() );*/
 
+                object_raster_bbox += -bufferized_raster_box.top_left();
+                std::ostringstream bbox_stream;
+                bbox_stream << object_raster_bbox;
+
+                auto raster_object = gdal::operator * ( polygon, world_2_raster );
+                raster_object = gdal::operator + ( raster_object, -bufferized_raster_box.top_left() );
+
+                std::ostringstream shift_stream;
+                shift_stream << bufferized_raster_box.top_left() [0] << " " << bufferized_raster_box.top_left() [1];
+
+                if ( shards )
+                {
+                    markup::shard_sample sample { object_index_str,
+                                                  {
+                                                      { DEFAULT_SEGMENT_FILE_EXT, std::string ( encoded_tile.begin (), encoded_tile.end () ) }
+                                                    , { ".points", positive_tile->exportToWkt() }
+                                                    , { ".bbox", bbox_stream.str () }
+                                                    , { ".object", raster_object->exportToWkt() }
+                                                    , { ".shift", shift_stream.str () }
+                                                  } };
+                    if ( !shards->write ( sample ) && !shards_failed.exchange ( true ) )
+                        std::cerr << "Unable to store object " << object_index_str << " into markup shards" << std::endl;
+                    return;
+                }
+
                 std::ofstream positive_writer ( markup_directory + "/" + object_index_str + ".points" );
                 positive_writer << positive_tile->exportToWkt();
                 positive_writer.close ();
 
-                object_raster_bbox += -bufferized_raster_box.top_left();
                 std::ofstream bbox_writer ( markup_directory + "/" + object_index_str + ".bbox" );
-                bbox_writer << object_raster_bbox;
+                bbox_writer << bbox_stream.str ();
                 bbox_writer.close ();
 
-                auto raster_object = gdal::operator * ( polygon, world_2_raster );
-                raster_object = gdal::operator + ( raster_object, -bufferized_raster_box.top_left() );
                 std::ofstream object_writer ( markup_directory + "/" + object_index_str + ".object" );
                 object_writer << raster_object->exportToWkt();
                 object_writer.close ();
@@ -144,7 +180,7 @@ rsai::segany_markup_by_objects::segany_markup_by_objects (
                 negative_writer.close ();*/
 
                 std::ofstream shift_writer ( markup_directory + "/" + object_index_str + ".shift" );
-                shift_writer << bufferized_raster_box.top_left() [0] << " " << bufferized_raster_box.top_left() [1];
+                shift_writer << shift_stream.str ();
                 shift_writer.close ();
             }
         } , i, layers, progress_func );
@@ -152,6 +188,12 @@ rsai::segany_markup_by_objects::segany_markup_by_objects (
         progress_func ( i + 1, layers, 1.0f, true );
     }
 
+    if ( shards && ( !shards->close () || shards_failed ) )
+    {
+        std::cerr << "STOP: Markup shards are incomplete in " << markup_directory << std::endl;
+        return;
+    }
+
     const std::string segment_script = "python3 ./scripts/sam_locate_object.py";
     const std::string weights_file = "/home/miron/projects/Segment\\ Anything/segment-anything/checkpoints/sam_vit_h_4b8939.pth";
     const std::string command = segment_script + " " + weights_file + " " + markup_directory;
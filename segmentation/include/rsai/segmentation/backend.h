@@ -0,0 +1,19 @@
+#pragma once
+
+#include "rsai/segmentation/protocol.h"
+
+namespace rsai
+{
+namespace segmentation
+{
+    // Segmentation model interface, tiles are processed by batches
+    class backend
+    {
+    public:
+        virtual ~backend () = default;
+
+        virtual std::vector < contours > segment ( const std::vector < cv::Mat > &tiles ) = 0;
+    }; // class backend
+
+}; // namespace segmentation
+}; // namespace rsai
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <future>
+#include <thread>
+#include <condition_variable>
+
+#include "rsai/segmentation/protocol.h"
+
+namespace rsai
+{
+namespace segmentation
+{
+    // Pipelined worker client: tiles are sent without waiting for the previous results,
+    // at most max_in_flight requests are pending. Results arrive via futures,
+    // empty contours are returned if the worker fails or disconnects.
+    class client
+    {
+    public:
+        client ( const std::string &socket_path, const int max_in_flight = 32 );
+        ~client ();
+
+        bool                        connected () const;
+
+        std::future < contours >    submit ( const cv::Mat &tile );
+        void                        shutdown_server ();
+
+    private:
+        int                         m_socket = -1;
+        const int                   m_max_in_flight;
+        std::atomic_bool            m_connected { false };
+
+        std::mutex                  m_send_lock;
+        std::mutex                  m_lock;
+        std::condition_variable     m_slots;
+        std::map < uint32_t, std::promise < contours > > m_pending;
+        uint32_t                    m_next_id = 0;
+
+        std::thread                 m_receiver;
+
+        void                        __receive ();
+        void                        __disconnect ();
+    }; // class client
+
+}; // namespace segmentation
+}; // namespace rsai
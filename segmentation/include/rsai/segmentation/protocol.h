@@ -0,0 +1,79 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <opencv2/core.hpp>
+
+#include "common/definitions.h"
+
+// Binary protocol of the local segmentation worker. Every message is a fixed header followed by a payload:
+//  - segment:  8-bit interleaved tile pixels, rows are tightly packed ( width * channels bytes )
+//  - contours: for each of 'count' contours - uint32 points number and float64 x, y pairs in tile pixels
+//  - error, shutdown: no payload
+// Values are in the host byte order, the socket is local.
+namespace rsai
+{
+namespace segmentation
+{
+    using contour   = std::vector < cv::Point2d >;
+    using contours  = std::vector < contour >;
+
+    constexpr uint32_t protocol_magic   = 0x49415352; // "RSAI"
+    constexpr uint16_t protocol_version = 1;
+
+    // Planned tiles never exceed the segmentation tile with its margins, larger sizes are treated as a corrupt header
+    constexpr uint32_t max_tile_side        = DEFAULT_SEGMENTATION_TILE_SIZE + 2 * DEFAULT_SEGMENTATION_TILE_MARGIN;
+    constexpr uint32_t max_tile_channels    = 4;
+    // Overlapping masks' contours may pass a pixel corner a few times, but never more than max_contour_passes
+    constexpr uint64_t max_contour_passes   = 4;
+    constexpr uint64_t max_contours_payload = uint64_t ( max_tile_side + 1 ) * ( max_tile_side + 1 ) * max_contour_passes
+                                              * ( sizeof ( uint32_t ) + 2 * sizeof ( double ) );
+
+    enum class message_type : uint16_t
+    {
+        segment     = 1,
+        contours    = 2,
+        error       = 3,
+        shutdown    = 4
+    };
+
+#pragma pack(push, 1)
+    struct message_header
+    {
+        uint32_t magic          = protocol_magic;
+        uint16_t version        = protocol_version;
+        uint16_t type           = 0;
+        uint32_t request_id     = 0;
+        uint32_t width          = 0;    // tile width or contours count
+        uint32_t height         = 0;
+        uint32_t channels       = 0;
+        uint64_t payload_size   = 0;
+    };
+#pragma pack(pop)
+
+    static_assert ( sizeof ( message_header ) == 32, "Segmentation protocol header size mismatch" );
+
+    bool    is_valid        ( const message_header &header );
+
+    // Blocking socket io, partial transfers and interrupts are handled
+    bool    write_all       ( const int socket, const void * data, const size_t size );
+    bool    read_all        ( const int socket, void * data, const size_t size );
+
+    bool    write_message   ( const int socket, const message_header &header, const void * payload = nullptr );
+    bool    read_header     ( const int socket, message_header &header );
+    // Fails without reading if the header's payload size exceeds its type's limit
+    bool    read_payload    ( const int socket, const message_header &header, std::vector < uint8_t > &payload );
+
+    bool    send_tile       ( const int socket, const uint32_t request_id, const cv::Mat &tile );
+    cv::Mat decode_tile     ( const message_header &header, std::vector < uint8_t > &payload );
+
+    bool    send_contours   ( const int socket, const uint32_t request_id, const contours &result );
+    bool    decode_contours ( const message_header &header, const std::vector < uint8_t > &payload, contours &result );
+
+    // Unix domain socket helpers, return -1 on failure
+    int     connect_socket  ( const std::string &path );
+    int     listen_socket   ( const std::string &path );
+
+}; // namespace segmentation
+}; // namespace rsai
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include "rsai/segmentation/backend.h"
+
+namespace rsai
+{
+namespace segmentation
+{
+    // Persistent worker serving clients one by one. Pipelined requests already received
+    // are segmented together by batches up to batch_size tiles.
+    class server
+    {
+    public:
+        server ( const std::string &socket_path, backend &a_backend, const int batch_size );
+        ~server ();
+
+        bool    listening () const;
+
+        // Serves until a shutdown message is received
+        bool    run ();
+
+    private:
+        const std::string   m_socket_path;
+        backend &           m_backend;
+        const int           m_batch_size;
+        int                 m_socket = -1;
+
+        // Returns false on shutdown request
+        bool    __serve ( const int connection );
+    }; // class server
+
+}; // namespace segmentation
+}; // namespace rsai
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "rsai/segmentation/backend.h"
+
+namespace rsai
+{
+namespace segmentation
+{
+    // Deterministic model-free backend for testing: Otsu-binarized tile's external contours
+    class stub_backend : public backend
+    {
+    public:
+        stub_backend ( const double min_area = 16.0 );
+
+        std::vector < contours > segment ( const std::vector < cv::Mat > &tiles ) override;
+
+    private:
+        const double m_min_area;
+
+        contours __segment ( const cv::Mat &tile ) const;
+    }; // class stub_backend
+
+}; // namespace segmentation
+}; // namespace rsai
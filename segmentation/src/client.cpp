@@ -0,0 +1,125 @@
+#include "rsai/segmentation/client.h"
+
+#include <unistd.h>
+#include <sys/socket.h>
+
+using namespace rsai::segmentation;
+
+rsai::segmentation::client::client ( const std::string &socket_path, const int max_in_flight )
+    : m_max_in_flight ( std::max ( 1, max_in_flight ) )
+{
+    m_socket = connect_socket ( socket_path );
+    m_connected = m_socket >= 0;
+
+    if ( m_connected )
+        m_receiver = std::thread ( [this] () { __receive (); } );
+}
+
+rsai::segmentation::client::~client ()
+{
+    if ( m_socket >= 0 )
+        ::shutdown ( m_socket, SHUT_RDWR );
+
+    if ( m_receiver.joinable () )
+        m_receiver.join ();
+
+    if ( m_socket >= 0 )
+        ::close ( m_socket );
+}
+
+bool rsai::segmentation::client::connected () const
+{
+    return m_connected;
+}
+
+std::future < contours > rsai::segmentation::client::submit ( const cv::Mat &tile )
+{
+    std::promise < contours > promise;
+    auto result = promise.get_future ();
+
+    uint32_t request_id = 0;
+    {
+        std::unique_lock lock ( m_lock );
+        m_slots.wait ( lock, [&] () { return !m_connected || int ( m_pending.size () ) < m_max_in_flight; } );
+
+        if ( !m_connected )
+        {
+            promise.set_value ( {} );
+            return result;
+        }
+
+        request_id = m_next_id++;
+        m_pending.emplace ( request_id, std::move ( promise ) );
+    }
+
+    bool sent = false;
+    {
+        std::scoped_lock lock ( m_send_lock );
+        sent = send_tile ( m_socket, request_id, tile );
+    }
+
+    if ( !sent )
+    {
+        std::scoped_lock lock ( m_lock );
+        auto pending = m_pending.find ( request_id );
+        if ( pending != m_pending.end () )
+        {
+            pending->second.set_value ( {} );
+            m_pending.erase ( pending );
+        }
+        m_slots.notify_all ();
+    }
+
+    return result;
+}
+
+void rsai::segmentation::client::shutdown_server ()
+{
+    if ( !m_connected )
+        return;
+
+    message_header header;
+    header.type = static_cast < uint16_t > ( message_type::shutdown );
+
+    std::scoped_lock lock ( m_send_lock );
+    write_message ( m_socket, header );
+}
+
+void rsai::segmentation::client::__receive ()
+{
+    std::vector < uint8_t > payload;
+
+    while ( true )
+    {
+        message_header header;
+        if ( !read_header ( m_socket, header ) || !read_payload ( m_socket, header, payload ) )
+            break;
+
+        contours result;
+        if ( static_cast < message_type > ( header.type ) == message_type::contours )
+            decode_contours ( header, payload, result );
+
+        std::scoped_lock lock ( m_lock );
+        auto pending = m_pending.find ( header.request_id );
+        if ( pending != m_pending.end () )
+        {
+            pending->second.set_value ( std::move ( result ) );
+            m_pending.erase ( pending );
+        }
+        m_slots.notify_all ();
+    }
+
+    __disconnect ();
+}
+
+void rsai::segmentation::client::__disconnect ()
+{
+    std::scoped_lock lock ( m_lock );
+    m_connected = false;
+
+    for ( auto &pending : m_pending )
+        pending.second.set_value ( {} );
+    m_pending.clear ();
+
+    m_slots.notify_all ();
+}
@@ -0,0 +1,244 @@
+#include "rsai/segmentation/protocol.h"
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+using namespace rsai::segmentation;
+
+bool rsai::segmentation::is_valid ( const message_header &header )
+{
+    return header.magic == protocol_magic && header.version == protocol_version;
+}
+
+bool rsai::segmentation::write_all ( const int socket, const void * data, const size_t size )
+{
+    auto bytes = static_cast < const uint8_t * > ( data );
+    size_t written = 0;
+
+    while ( written < size )
+    {
+        const ssize_t result = ::send ( socket, bytes + written, size - written, MSG_NOSIGNAL );
+        if ( result < 0 && errno == EINTR )
+            continue;
+        if ( result <= 0 )
+            return false;
+
+        written += result;
+    }
+
+    return true;
+}
+
+bool rsai::segmentation::read_all ( const int socket, void * data, const size_t size )
+{
+    auto bytes = static_cast < uint8_t * > ( data );
+    size_t received = 0;
+
+    while ( received < size )
+    {
+        const ssize_t result = ::recv ( socket, bytes + received, size - received, 0 );
+        if ( result < 0 && errno == EINTR )
+            continue;
+        if ( result <= 0 )
+            return false;
+
+        received += result;
+    }
+
+    return true;
+}
+
+bool rsai::segmentation::write_message ( const int socket, const message_header &header, const void * payload )
+{
+    if ( !write_all ( socket, &header, sizeof ( header ) ) )
+        return false;
+
+    return header.payload_size == 0 || write_all ( socket, payload, header.payload_size );
+}
+
+bool rsai::segmentation::read_header ( const int socket, message_header &header )
+{
+    return read_all ( socket, &header, sizeof ( header ) ) && is_valid ( header );
+}
+
+namespace
+{
+    // The size comes from the peer, so it's checked before anything is allocated
+    bool payload_size_valid ( const message_header &header )
+    {
+        switch ( static_cast < message_type > ( header.type ) )
+        {
+        case message_type::segment:
+            return header.width <= max_tile_side && header.height <= max_tile_side
+                    && header.channels > 0 && header.channels <= max_tile_channels
+                    && header.payload_size == uint64_t ( header.width ) * header.height * header.channels;
+        case message_type::contours:
+            return header.payload_size <= max_contours_payload;
+        default:
+            return header.payload_size == 0;
+        }
+    }
+}; // namespace
+
+bool rsai::segmentation::read_payload ( const int socket, const message_header &header, std::vector < uint8_t > &payload )
+{
+    if ( !payload_size_valid ( header ) )
+    {
+        std::cerr << "Segmentation protocol: rejected payload of " << header.payload_size << " bytes" << std::endl;
+        return false;
+    }
+
+    payload.resize ( header.payload_size );
+    return payload.empty () || read_all ( socket, payload.data (), payload.size () );
+}
+
+bool rsai::segmentation::send_tile ( const int socket, const uint32_t request_id, const cv::Mat &tile )
+{
+    if ( tile.depth () != CV_8U || tile.cols > int ( max_tile_side ) || tile.rows > int ( max_tile_side )
+         || tile.channels () > int ( max_tile_channels ) )
+        return false;
+
+    // Payload rows have to be tightly packed
+    const cv::Mat continuous = tile.isContinuous () ? tile : tile.clone ();
+
+    message_header header;
+    header.type         = static_cast < uint16_t > ( message_type::segment );
+    header.request_id   = request_id;
+    header.width        = continuous.cols;
+    header.height       = continuous.rows;
+    header.channels     = continuous.channels ();
+    header.payload_size = continuous.total () * continuous.elemSize ();
+
+    return write_message ( socket, header, continuous.data );
+}
+
+cv::Mat rsai::segmentation::decode_tile ( const message_header &header, std::vector < uint8_t > &payload )
+{
+    if ( header.channels == 0 || header.channels > 4
+         || payload.size () != size_t ( header.width ) * header.height * header.channels )
+        return {};
+
+    const cv::Mat wrapper ( header.height, header.width, CV_8UC ( header.channels ), payload.data () );
+    return wrapper.clone ();
+}
+
+bool rsai::segmentation::send_contours ( const int socket, const uint32_t request_id, const contours &result )
+{
+    std::vector < uint8_t > payload;
+    for ( const auto &a_contour : result )
+    {
+        const uint32_t points = a_contour.size ();
+        const size_t offset = payload.size ();
+
+        payload.resize ( offset + sizeof ( points ) + points * 2 * sizeof ( double ) );
+        std::memcpy ( payload.data () + offset, &points, sizeof ( points ) );
+
+        auto coords = payload.data () + offset + sizeof ( points );
+        for ( const auto &pt : a_contour )
+        {
+            std::memcpy ( coords, &pt.x, sizeof ( double ) );
+            std::memcpy ( coords + sizeof ( double ), &pt.y, sizeof ( double ) );
+            coords += 2 * sizeof ( double );
+        }
+    }
+
+    message_header header;
+    header.type         = static_cast < uint16_t > ( message_type::contours );
+    header.request_id   = request_id;
+    header.width        = result.size ();
+    header.payload_size = payload.size ();
+
+    return write_message ( socket, header, payload.data () );
+}
+
+bool rsai::segmentation::decode_contours ( const message_header &header, const std::vector < uint8_t > &payload, contours &result )
+{
+    result.clear ();
+    result.reserve ( header.width );
+
+    size_t offset = 0;
+    for ( uint32_t i = 0; i < header.width; ++i )
+    {
+        uint32_t points = 0;
+        if ( offset + sizeof ( points ) > payload.size () )
+            return false;
+
+        std::memcpy ( &points, payload.data () + offset, sizeof ( points ) );
+        offset += sizeof ( points );
+
+        if ( offset + points * 2 * sizeof ( double ) > payload.size () )
+            return false;
+
+        contour a_contour ( points );
+        for ( auto &pt : a_contour )
+        {
+            std::memcpy ( &pt.x, payload.data () + offset, sizeof ( double ) );
+            std::memcpy ( &pt.y, payload.data () + offset + sizeof ( double ), sizeof ( double ) );
+            offset += 2 * sizeof ( double );
+        }
+
+        result.push_back ( std::move ( a_contour ) );
+    }
+
+    return offset == payload.size ();
+}
+
+namespace
+{
+    bool make_address ( const std::string &path, sockaddr_un &address )
+    {
+        if ( path.empty () || path.size () >= sizeof ( address.sun_path ) )
+            return false;
+
+        std::memset ( &address, 0, sizeof ( address ) );
+        address.sun_family = AF_UNIX;
+        std::strncpy ( address.sun_path, path.c_str (), sizeof ( address.sun_path ) - 1 );
+        return true;
+    }
+}
+
+int rsai::segmentation::connect_socket ( const std::string &path )
+{
+    sockaddr_un address;
+    if ( !make_address ( path, address ) )
+        return -1;
+
+    const int socket = ::socket ( AF_UNIX, SOCK_STREAM, 0 );
+    if ( socket < 0 )
+        return -1;
+
+    if ( ::connect ( socket, reinterpret_cast < sockaddr * > ( &address ), sizeof ( address ) ) != 0 )
+    {
+        ::close ( socket );
+        return -1;
+    }
+
+    return socket;
+}
+
+int rsai::segmentation::listen_socket ( const std::string &path )
+{
+    sockaddr_un address;
+    if ( !make_address ( path, address ) )
+        return -1;
+
+    const int socket = ::socket ( AF_UNIX, SOCK_STREAM, 0 );
+    if ( socket < 0 )
+        return -1;
+
+    // Stale socket file of a previous worker
+    ::unlink ( path.c_str () );
+
+    if ( ::bind ( socket, reinterpret_cast < sockaddr * > ( &address ), sizeof ( address ) ) != 0
+         || ::listen ( socket, 4 ) != 0 )
+    {
+        ::close ( socket );
+        return -1;
+    }
+
+    return socket;
+}
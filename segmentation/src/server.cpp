@@ -0,0 +1,126 @@
+#include "rsai/segmentation/server.h"
+
+#include <iostream>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+using namespace rsai::segmentation;
+
+rsai::segmentation::server::server ( const std::string &socket_path, backend &a_backend, const int batch_size )
+    : m_socket_path ( socket_path ), m_backend ( a_backend ), m_batch_size ( std::max ( 1, batch_size ) )
+{
+    m_socket = listen_socket ( m_socket_path );
+}
+
+rsai::segmentation::server::~server ()
+{
+    if ( m_socket >= 0 )
+    {
+        ::close ( m_socket );
+        ::unlink ( m_socket_path.c_str () );
+    }
+}
+
+bool rsai::segmentation::server::listening () const
+{
+    return m_socket >= 0;
+}
+
+bool rsai::segmentation::server::run ()
+{
+    if ( !listening () )
+        return false;
+
+    while ( true )
+    {
+        const int connection = ::accept ( m_socket, nullptr, nullptr );
+        if ( connection < 0 )
+        {
+            if ( errno == EINTR )
+                continue;
+            return false;
+        }
+
+        const bool proceed = __serve ( connection );
+        ::close ( connection );
+
+        if ( !proceed )
+            return true;
+    }
+}
+
+bool rsai::segmentation::server::__serve ( const int connection )
+{
+    std::vector < uint32_t > request_ids;
+    std::vector < cv::Mat > tiles;
+    std::vector < uint8_t > payload;
+
+    bool shutdown = false;
+    bool connected = true;
+
+    while ( connected && !shutdown )
+    {
+        request_ids.clear ();
+        tiles.clear ();
+
+        // Blocking for the first request, then collecting the already pipelined ones
+        do
+        {
+            message_header header;
+            if ( !read_header ( connection, header ) || !read_payload ( connection, header, payload ) )
+            {
+                connected = false;
+                break;
+            }
+
+            const auto type = static_cast < message_type > ( header.type );
+            if ( type == message_type::shutdown )
+            {
+                shutdown = true;
+                break;
+            }
+
+            if ( type != message_type::segment )
+                continue;
+
+            auto tile = decode_tile ( header, payload );
+            if ( tile.empty () )
+            {
+                message_header error;
+                error.type = static_cast < uint16_t > ( message_type::error );
+                error.request_id = header.request_id;
+                connected = write_message ( connection, error );
+                continue;
+            }
+
+            request_ids.push_back ( header.request_id );
+            tiles.push_back ( std::move ( tile ) );
+
+            pollfd pending { connection, POLLIN, 0 };
+            if ( ::poll ( &pending, 1, 0 ) <= 0 || !( pending.revents & POLLIN ) )
+                break;
+        }
+        while ( connected && int ( tiles.size () ) < m_batch_size );
+
+        if ( tiles.empty () )
+            continue;
+
+        const auto results = m_backend.segment ( tiles );
+
+        for ( size_t i = 0; i < request_ids.size () && connected; ++i )
+        {
+            if ( i < results.size () )
+                connected = send_contours ( connection, request_ids [i], results [i] );
+            else
+            {
+                message_header error;
+                error.type = static_cast < uint16_t > ( message_type::error );
+                error.request_id = request_ids [i];
+                connected = write_message ( connection, error );
+            }
+        }
+    }
+
+    return !shutdown;
+}
@@ -0,0 +1,62 @@
+#include "rsai/segmentation/stub_backend.h"
+
+#include <algorithm>
+#include <opencv2/imgproc.hpp>
+
+using namespace rsai::segmentation;
+
+rsai::segmentation::stub_backend::stub_backend ( const double min_area )
+    : m_min_area ( min_area )
+{
+}
+
+std::vector < contours > rsai::segmentation::stub_backend::segment ( const std::vector < cv::Mat > &tiles )
+{
+    std::vector < contours > result;
+    result.reserve ( tiles.size () );
+
+    for ( const auto &tile : tiles )
+        result.push_back ( __segment ( tile ) );
+
+    return result;
+}
+
+contours rsai::segmentation::stub_backend::__segment ( const cv::Mat &tile ) const
+{
+    if ( tile.empty () )
+        return {};
+
+    cv::Mat gray;
+    if ( tile.channels () == 3 )
+        cv::cvtColor ( tile, gray, cv::COLOR_BGR2GRAY );
+    else if ( tile.channels () == 4 )
+        cv::cvtColor ( tile, gray, cv::COLOR_BGRA2GRAY );
+    else
+        gray = tile;
+
+    cv::Mat binary;
+    cv::threshold ( gray, binary, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU );
+
+    std::vector < std::vector < cv::Point > > found;
+    cv::findContours ( binary, found, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE );
+
+    contours result;
+    for ( const auto &item : found )
+    {
+        if ( item.size () < 3 || cv::contourArea ( item ) < m_min_area )
+            continue;
+
+        result.emplace_back ( item.begin (), item.end () );
+    }
+
+    // Larger segments first, ties are resolved by position to keep the output stable
+    std::sort ( result.begin (), result.end (), [] ( const contour &lh, const contour &rh )
+    {
+        const double lh_area = cv::contourArea ( lh ), rh_area = cv::contourArea ( rh );
+        if ( lh_area != rh_area )
+            return lh_area > rh_area;
+        return std::make_pair ( lh.front ().y, lh.front ().x ) < std::make_pair ( rh.front ().y, rh.front ().x );
+    } );
+
+    return result;
+}
@@ -0,0 +1,67 @@
+#include <iostream>
+#include <string>
+
+#include <args-parser/all.hpp>
+
+#include "common/definitions.h"
+#include "common/arguments.h"
+#include "common/string_utils.h"
+#include "rsai/segmentation/server.h"
+#include "rsai/segmentation/stub_backend.h"
+
+using namespace std;
+
+int main ( int argc, char * argv[] )
+{
+    try
+    {
+        Args::CmdLine cmd( argc, argv );
+
+        Args::Arg & segmentation_socket_param = arguments::get_segmentation_socket ();
+
+        Args::Arg & segmentation_batch_param = arguments::get_segmentation_batch ();
+
+        Args::Help help;
+        help.setAppDescription(
+            std::string ( "Persistent segmentation worker with a deterministic stub backend. "
+                          "Serves tiles segmentation requests over a Unix socket until a shutdown request. " ) );
+        help.setExecutable( argv[0] );
+
+        cmd.addArg ( segmentation_socket_param );
+        cmd.addArg ( segmentation_batch_param );
+        cmd.addArg ( help );
+
+        cmd.parse();
+
+        value_helper < int > batch_helper ( segmentation_batch_param.value() );
+        if ( !batch_helper.verify ( std::cerr, "STOP: Segmentation batch size is incorrect." ) )
+            return 1;
+
+        rsai::segmentation::stub_backend backend;
+        rsai::segmentation::server worker ( segmentation_socket_param.value(), backend, batch_helper.value() );
+
+        if ( !worker.listening () )
+        {
+            std::cerr << "STOP: Failed to listen socket " << segmentation_socket_param.value() << std::endl;
+            return 1;
+        }
+
+        std::cout << "Segmentation worker is listening " << segmentation_socket_param.value() << '\n';
+
+        if ( !worker.run () )
+        {
+            std::cerr << "STOP: Segmentation worker failed" << std::endl;
+            return 1;
+        }
+    }
+    catch( const Args::HelpHasBeenPrintedException & )
+    {
+    }
+    catch( const Args::BaseException & x )
+    {
+        Args::outStream() << x.desc() << SL( "\n" );
+    }
+
+
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include <iostream>
+#include <string>
+#include <filesystem>
+
+#include <args-parser/all.hpp>
+
+#include "common/definitions.h"
+#include "common/arguments.h"
+#include "common/string_utils.h"
+#include "gdal_utils/segment_store.h"
+
+using namespace std;
+
+int main ( int argc, char * argv[] )
+{
+    try
+    {
+        Args::CmdLine cmd( argc, argv );
+
+        Args::Arg & segments_directory_param = arguments::get_segments_directory ();
+
+        Args::Help help;
+        help.setAppDescription(
+            std::string ( "Converts WKT segments files of a directory into binary segments files (" ) + DEFAULT_SEGMENT_STORE_FILE_EXT + "). "
+                          "Each WKT file is replaced by a file with the same name and the binary extension. " );
+        help.setExecutable( argv[0] );
+
+        cmd.addArg ( segments_directory_param );
+        cmd.addArg ( help );
+
+        cmd.parse();
+
+        const std::filesystem::path segments_directory = segments_directory_param.value();
+
+        std::error_code error;
+        if ( !std::filesystem::is_directory ( segments_directory, error ) )
+        {
+            std::cerr << "STOP: Segments directory " << segments_directory << " is not found." << std::endl;
+            return 1;
+        }
+
+        int converted = 0, failed = 0;
+        for ( const auto &entry : std::filesystem::directory_iterator ( segments_directory ) )
+        {
+            if ( !entry.is_regular_file () || entry.path ().extension () != DEFAULT_SEGMENT_WKT_FILE_EXT )
+                continue;
+
+            auto segments_file_name = entry.path ();
+            segments_file_name.replace_extension ( DEFAULT_SEGMENT_STORE_FILE_EXT );
+
+            if ( gdal::wkt_to_segments_file ( entry.path ().string (), segments_file_name.string () ) )
+                ++converted;
+            else
+            {
+                std::cerr << "Failed to convert " << entry.path () << std::endl;
+                ++failed;
+            }
+        }
+
+        std::cout << "Converted " << converted << " files, failed " << failed << '\n';
+
+        if ( failed > 0 )
+            return 1;
+    }
+    catch( const Args::HelpHasBeenPrintedException & )
+    {
+    }
+    catch( const Args::BaseException & x )
+    {
+        Args::outStream() << x.desc() << SL( "\n" );
+    }
+
+
+    return 0;
+}
@@ -0,0 +1,160 @@
+#include <iostream>
+#include <string>
+#include <algorithm>
+#include <filesystem>
+
+#include <args-parser/all.hpp>
+
+#include "common/definitions.h"
+#include "common/promt_functions.hpp"
+#include "common/arguments.h"
+#include "common/string_utils.h"
+#include "gdal_utils/all_helpers.h"
+#include "rsai/shard_planner.h"
+#include "rsai/shard_launcher.h"
+
+using namespace std;
+
+int main ( int argc, char * argv[] )
+{
+    try
+    {
+        Args::CmdLine cmd( argc, argv );
+
+        Args::Arg &input_vector_param = arguments::get_input_vector ();
+        input_vector_param.setDescription( SL( "Input vector map in GDAL-supported format split into spatial shards, e.g. objects' bounds. " ) );
+
+        Args::Arg & output_param = arguments::get_output ();
+
+        Args::Arg & driver_param = arguments::get_driver ();
+
+        Args::Arg & force_rewtire_param = arguments::get_force_rewtire ();
+
+        Args::Arg & shards_count_param = arguments::get_shards_count ();
+
+        Args::Arg & shard_processes_param = arguments::get_shard_processes ();
+
+        Args::Arg & shard_halo_param = arguments::get_shard_halo ();
+
+        Args::Arg & shard_command_param = arguments::get_shard_command ();
+
+        Args::Arg & shard_updating_param = arguments::get_shard_updating ();
+
+        Args::Help help;
+        help.setAppDescription(
+            std::string ( "Utility to run a locator over a large scene by local processes. The input vector map is split into spatial "
+                          "shards with halo margins, the command is run for every shard and shards' outputs are merged into "
+                          "the output vector map, an object from a halo is taken from the shard owning it. Finished shards "
+                          "are skipped on a restart. An updating map is clipped by the same shards, so map_updater "
+                          "compares the shards' parts of both maps. " ) );
+        help.setExecutable( argv[0] );
+
+        cmd.addArg ( input_vector_param );
+        cmd.addArg ( output_param );
+        cmd.addArg ( driver_param );
+        cmd.addArg ( force_rewtire_param );
+        cmd.addArg ( shards_count_param );
+        cmd.addArg ( shard_processes_param );
+        cmd.addArg ( shard_halo_param );
+        cmd.addArg ( shard_command_param );
+        cmd.addArg ( shard_updating_param );
+        cmd.addArg ( help );
+
+        cmd.parse();
+
+        gdal::open_vector_ro_helper iv_helper ( input_vector_param.value(), std::cerr );
+        auto ds_vector = iv_helper.validate ( true );
+
+        gdal::create_vector_helper out_helper ( output_param.value(), driver_param.value(), std::cerr );
+        auto ds_out = out_helper.validate ( true );
+
+        gdal::shared_dataset ds_updating;
+        if ( shard_updating_param.isDefined () )
+        {
+            gdal::open_vector_ro_helper iu_helper ( shard_updating_param.value(), std::cerr );
+            ds_updating = iu_helper.validate ( true );
+            if ( ds_updating == nullptr )
+            {
+                std::cerr << "STOP: Updating map verification failed" << std::endl;
+                return 1;
+            }
+        }
+
+        if ( ds_vector == nullptr || ds_out == nullptr )
+        {
+            std::cerr << "STOP: Input parameters verification failed" << std::endl;
+            return 1;
+        }
+
+        value_helper < int > shards_count_helper        ( shards_count_param.value() );
+        if ( !shards_count_helper.verify ( std::cerr,   "STOP: Shards count value is incorrect." ) )
+            return 1;
+
+        value_helper < int > shard_processes_helper     ( shard_processes_param.value() );
+        if ( !shard_processes_helper.verify ( std::cerr, "STOP: Shard processes value is incorrect." ) )
+            return 1;
+
+        value_helper < double > shard_halo_helper       ( shard_halo_param.value() );
+        if ( !shard_halo_helper.verify ( std::cerr,     "STOP: Shard halo value is incorrect." ) )
+            return 1;
+
+        const auto command = rsai::split_command ( shard_command_param.value() );
+        if ( command.empty () )
+        {
+            std::cerr << "STOP: Shard command is empty" << std::endl;
+            return 1;
+        }
+
+        // Both maps have to be sharded, a whole updating map would mark other shards' objects as outdated
+        const bool passes_updating = std::any_of ( command.begin (), command.end (), [] ( const std::string &argument )
+                                                   { return argument.find ( "{updating}" ) != std::string::npos; } );
+
+        if ( std::filesystem::path ( command.front () ).filename () == "map_updater" && ( ds_updating == nullptr || !passes_updating ) )
+        {
+            std::cerr << "STOP: map_updater shards need the updating map (-u) passed to the command as {updating}" << std::endl;
+            return 1;
+        }
+
+        if ( ds_updating != nullptr && !passes_updating )
+        {
+            std::cerr << "STOP: Updating map is set, but the command does not pass {updating}" << std::endl;
+            return 1;
+        }
+
+        const std::string work_directory = std::string ( ds_out->GetDescription() ) + "/" + DEFAULT_SHARDS_DIRECTORY;
+
+        std::cout << "Planning shards...\n";
+        auto shards = rsai::plan_shards ( ds_vector, shards_count_helper.value(), shard_halo_helper.value(), work_directory );
+        if ( !rsai::write_shard_inputs ( ds_vector, ds_updating, shards, driver_param.value() ) )
+        {
+            std::cerr << "STOP: Failed to write shards' inputs" << std::endl;
+            return 1;
+        }
+
+        for ( const auto &shard : shards )
+            std::cout << "Shard " << shard.index << ": " << shard.features << " features\n";
+
+        std::cout << "Running shards...\n";
+        if ( !rsai::run_shards ( command, shards, shard_processes_helper.value() ) )
+        {
+            std::cerr << "STOP: Some shards failed, finished ones are skipped on a restart" << std::endl;
+            return 1;
+        }
+
+        std::cout << "Merging shards...\n";
+        if ( !rsai::merge_shard_outputs ( shards, ds_out, force_rewtire_param.isDefined(), rewrite_layer_promt_func ) )
+            return 1;
+
+        std::cout << "done\n";
+    }
+    catch( const Args::HelpHasBeenPrintedException & )
+    {
+    }
+    catch( const Args::BaseException & x )
+    {
+        Args::outStream() << x.desc() << SL( "\n" );
+    }
+
+
+    return 0;
+}
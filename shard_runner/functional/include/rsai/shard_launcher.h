@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "rsai/shard_planner.h"
+
+namespace rsai
+{
+    // Splits a command line into arguments, quotes group words
+    std::vector < std::string > split_command ( const std::string &command );
+
+    // Command's arguments for the shard, {input}, {updating}, {output} and {shard} are replaced by the shard's values
+    std::vector < std::string > shard_command ( const std::vector < std::string > &command, const shard &a_shard );
+
+    // Runs the command for every non-empty and not yet done shard by up to the given number of local processes.
+    // A shard is done for the input fingerprint and the command its done marker holds, otherwise its output is removed.
+    // A process's stdout and stderr go to its shard's log, stdin is closed, so prompts have to be disabled by the command.
+    bool run_shards ( const std::vector < std::string > &command, const shards &a_shards, const int processes );
+
+}; // namespace rsai
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <unordered_set>
+#include <ogrsf_frmts.h>
+
+#include "gdal_utils/shared_dataset.h"
+
+namespace rsai
+{
+    // Spatial part of a scene. Cores tile the whole plane without overlaps, an input feature goes to every shard
+    // which extent (the core grown by a halo) it touches and is owned by the shard which core holds its center.
+    // An output feature is kept by the shard owning the input feature of the same object id within the input layer
+    // of the same name or the only input layer. Features of other layers are kept by the core holding their center.
+    struct shard
+    {
+        int             index = 0;
+        OGREnvelope     core;
+        OGREnvelope     extent;
+        size_t          features = 0;
+        std::string     directory;
+        // Object ids of the owned input features by input layers, layers number their ids independently
+        std::map < std::string, std::unordered_set < GIntBig > > owned;
+        // Hash of the written input, a done shard of another input is run again
+        uint64_t        fingerprint = 0;
+
+        std::string     input () const;
+        std::string     output () const;
+        // Shard's part of the updating map, clipped like the input
+        std::string     updating () const;
+        std::string     log () const;
+        // Marks a successfully completed shard, a restarted run of the same input and command skips it
+        std::string     done () const;
+
+        // Half-open core bounds, so a point is owned by exactly one shard
+        bool            owns ( const double x, const double y ) const;
+    };
+
+    using shards = std::vector < shard >;
+
+    // Recursive bisection of the bounds layers' features by their centers into shards of nearly equal counts
+    shards  plan_shards ( gdal::shared_dataset ds_vector, const int count, const double halo, const std::string &work_directory );
+
+    // Writes each shard's features of every layer into its input dataset and records owned object ids,
+    // input layers have to carry DEFAULT_OBJECT_ID_FIELD_NAME. An updating map, e.g. map_updater's one, is clipped
+    // by the same extents into the shards' updating datasets without recording owners.
+    bool    write_shard_inputs ( gdal::shared_dataset ds_vector, gdal::shared_dataset ds_updating, shards &a_shards, const std::string &driver );
+
+    // Collects every layer of the shards' outputs into the output dataset. Features are taken in shards' and then
+    // features' order, a feature of an object from the halo of a shard is dropped in favour of its owner's copy.
+    template < class PromtFunc >
+    bool    merge_shard_outputs ( const shards &a_shards, gdal::shared_dataset ds_out, const bool force_rewrite, const PromtFunc &promt_func );
+
+}; // namespace rsai
+
+#include "rsai/shard_planner.hpp"
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "rsai/shard_planner.h"
+
+#include <map>
+#include <set>
+#include <iostream>
+
+#include "common/definitions.h"
+#include "gdal_utils/all_helpers.h"
+
+template < class PromtFunc >
+bool rsai::merge_shard_outputs ( const shards &a_shards, gdal::shared_dataset ds_out, const bool force_rewrite, const PromtFunc &promt_func )
+{
+    gdal::create_vector_helper out_helper ( ds_out, std::cerr );
+    std::map < std::string, OGRLayer * > out_layers;
+    std::set < std::string > center_merged;
+
+    for ( const auto &a_shard : a_shards )
+    {
+        if ( a_shard.features == 0 )
+            continue;
+
+        gdal::open_vector_ro_helper shard_helper ( a_shard.output (), std::cerr );
+        auto ds_shard = shard_helper.validate ( true );
+        if ( ds_shard == nullptr )
+        {
+            std::cerr << "STOP: Shard " << a_shard.index << " output is missing" << std::endl;
+            return false;
+        }
+
+        size_t kept = 0;
+        for ( int i = 0; i < ds_shard->GetLayerCount (); ++i )
+        {
+            auto shard_layer = ds_shard->GetLayer ( i );
+            auto defn = shard_layer->GetLayerDefn ();
+
+            // Output layers follow the first shard having them
+            auto & out_layer = out_layers [shard_layer->GetName ()];
+            if ( out_layer == nullptr )
+            {
+                out_layer = out_helper.create_layer ( shard_layer->GetName (), defn->GetGeomType (), shard_layer->GetSpatialRef ()
+                                                    , force_rewrite, promt_func );
+                if ( out_layer == nullptr )
+                    return false;
+
+                for ( int j = 0; j < defn->GetFieldCount (); ++j )
+                    out_layer->CreateField ( defn->GetFieldDefn ( j ) );
+            }
+
+            // Ids are owned within the input layer of the same name or the only input layer
+            const std::unordered_set < GIntBig > * owned_ids = nullptr;
+            const int id_index = defn->GetFieldIndex ( DEFAULT_OBJECT_ID_FIELD_NAME );
+            if ( id_index >= 0 )
+            {
+                auto owned_layer = a_shard.owned.find ( shard_layer->GetName () );
+                if ( owned_layer == a_shard.owned.end () && a_shard.owned.size () == 1 )
+                    owned_layer = a_shard.owned.begin ();
+
+                if ( owned_layer != a_shard.owned.end () )
+                    owned_ids = &owned_layer->second;
+            }
+
+            if ( owned_ids == nullptr && center_merged.insert ( shard_layer->GetName () ).second )
+                std::cout << "Layer " << shard_layer->GetName () << " has no input layer's " << DEFAULT_OBJECT_ID_FIELD_NAME
+                          << " values, its features are merged by their centers\n";
+
+            shard_layer->ResetReading ();
+            while ( gdal::shared_feature feature = shard_layer->GetNextFeature () )
+            {
+                const OGRGeometry * geometry = feature->GetGeometryRef ();
+                if ( geometry == nullptr || geometry->IsEmpty () )
+                    continue;
+
+                // Overlapping objects are resolved by the owner assigned at planning
+                if ( owned_ids != nullptr )
+                {
+                    if ( owned_ids->count ( feature->GetFieldAsInteger64 ( id_index ) ) == 0 )
+                        continue;
+                }
+                else
+                {
+                    OGREnvelope envelope;
+                    geometry->getEnvelope ( &envelope );
+                    if ( !a_shard.owns ( ( envelope.MinX + envelope.MaxX ) / 2.0, ( envelope.MinY + envelope.MaxY ) / 2.0 ) )
+                        continue;
+                }
+
+                gdal::shared_feature out_feature ( out_layer->GetLayerDefn () );
+                out_feature->SetFrom ( feature.get (), TRUE );
+                if ( out_layer->CreateFeature ( out_feature.get () ) != OGRERR_NONE )
+                {
+                    std::cerr << "STOP: Failed to create feature in layer " << out_layer->GetName () << std::endl;
+                    return false;
+                }
+
+                ++kept;
+            }
+        }
+
+        std::cout << "Merged shard " << a_shard.index << ": " << kept << " features\n";
+    }
+
+    return true;
+}
@@ -0,0 +1,205 @@
+#include "rsai/shard_launcher.h"
+
+#include <map>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iterator>
+#include <filesystem>
+#include <fcntl.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+extern char **environ;
+
+using namespace rsai;
+
+namespace
+{
+    void replace_all ( std::string &text, const std::string &from, const std::string &to )
+    {
+        for ( auto pos = text.find ( from ); pos != std::string::npos; pos = text.find ( from, pos + to.size () ) )
+            text.replace ( pos, from.size (), to );
+    }
+
+    pid_t spawn ( const std::vector < std::string > &arguments, const std::string &log_file )
+    {
+        std::vector < char * > argv;
+        for ( const auto &argument : arguments )
+            argv.push_back ( const_cast < char * > ( argument.c_str () ) );
+        argv.push_back ( nullptr );
+
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init ( &actions );
+        posix_spawn_file_actions_addopen ( &actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0 );
+        posix_spawn_file_actions_addopen ( &actions, STDOUT_FILENO, log_file.c_str (), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+        posix_spawn_file_actions_adddup2 ( &actions, STDOUT_FILENO, STDERR_FILENO );
+
+        pid_t pid = 0;
+        const int result = posix_spawnp ( &pid, argv [0], &actions, nullptr, argv.data (), environ );
+        posix_spawn_file_actions_destroy ( &actions );
+
+        return result == 0 ? pid : -1;
+    }
+
+    // A done shard is skipped only for the same input and command
+    std::string done_marker ( const std::vector < std::string > &arguments, const shard &a_shard )
+    {
+        std::ostringstream marker;
+        marker << std::hex << a_shard.fingerprint << std::dec << '\n';
+        for ( const auto &argument : arguments )
+            marker << argument << '\n';
+        return marker.str ();
+    }
+
+    bool is_done ( const std::string &marker, const shard &a_shard )
+    {
+        std::ifstream in ( a_shard.done () );
+        if ( !in )
+            return false;
+
+        const std::string stored ( ( std::istreambuf_iterator < char > ( in ) ), std::istreambuf_iterator < char > () );
+        return stored == marker;
+    }
+}
+
+std::vector < std::string > rsai::split_command ( const std::string &command )
+{
+    std::vector < std::string > arguments;
+    std::string current;
+    bool in_word = false;
+    char quote = 0;
+
+    for ( const char c : command )
+    {
+        if ( quote != 0 )
+        {
+            if ( c == quote )
+                quote = 0;
+            else
+                current += c;
+        }
+        else if ( c == '"' || c == '\'' )
+        {
+            quote = c;
+            in_word = true;
+        }
+        else if ( std::isspace ( static_cast < unsigned char > ( c ) ) )
+        {
+            if ( in_word )
+                arguments.push_back ( current );
+            current.clear ();
+            in_word = false;
+        }
+        else
+        {
+            current += c;
+            in_word = true;
+        }
+    }
+
+    if ( in_word )
+        arguments.push_back ( current );
+
+    return arguments;
+}
+
+std::vector < std::string > rsai::shard_command ( const std::vector < std::string > &command, const shard &a_shard )
+{
+    auto arguments = command;
+    for ( auto &argument : arguments )
+    {
+        replace_all ( argument, "{input}", a_shard.input () );
+        replace_all ( argument, "{updating}", a_shard.updating () );
+        replace_all ( argument, "{output}", a_shard.output () );
+        replace_all ( argument, "{shard}", std::to_string ( a_shard.index ) );
+    }
+    return arguments;
+}
+
+bool rsai::run_shards ( const std::vector < std::string > &command, const shards &a_shards, const int processes )
+{
+    if ( command.empty () )
+    {
+        std::cerr << "STOP: Shard command is empty" << std::endl;
+        return false;
+    }
+
+    std::vector < const shard * > pending;
+    for ( const auto &a_shard : a_shards )
+    {
+        if ( a_shard.features == 0 )
+            continue;
+
+        if ( is_done ( done_marker ( shard_command ( command, a_shard ), a_shard ), a_shard ) )
+        {
+            std::cout << "Shard " << a_shard.index << " is already done\n";
+            continue;
+        }
+
+        // Outputs of another input or command are stale
+        std::error_code error;
+        std::filesystem::remove ( a_shard.done (), error );
+        std::filesystem::remove_all ( a_shard.output (), error );
+
+        pending.push_back ( &a_shard );
+    }
+
+    std::map < pid_t, const shard * > running;
+    bool result = true;
+
+    auto next = pending.begin ();
+    while ( next != pending.end () || !running.empty () )
+    {
+        // Keeping the pool full, failed shards don't stop the others
+        while ( next != pending.end () && running.size () < size_t ( std::max ( 1, processes ) ) )
+        {
+            const shard &a_shard = **next++;
+            std::filesystem::create_directories ( a_shard.output () );
+
+            const pid_t pid = spawn ( shard_command ( command, a_shard ), a_shard.log () );
+            if ( pid < 0 )
+            {
+                std::cerr << "Failed to start " << command.front () << " for shard " << a_shard.index << std::endl;
+                result = false;
+                continue;
+            }
+
+            std::cout << "Started shard " << a_shard.index << " with " << a_shard.features << " features, pid " << pid << '\n';
+            running [pid] = &a_shard;
+        }
+
+        if ( running.empty () )
+            break;
+
+        int status = 0;
+        const pid_t pid = waitpid ( -1, &status, 0 );
+        if ( pid < 0 )
+        {
+            std::cerr << "STOP: Failed to wait for shard processes" << std::endl;
+            return false;
+        }
+
+        auto found = running.find ( pid );
+        if ( found == running.end () )
+            continue;
+
+        const shard &a_shard = *found->second;
+        running.erase ( found );
+
+        if ( WIFEXITED ( status ) && WEXITSTATUS ( status ) == 0 )
+        {
+            std::ofstream ( a_shard.done () ) << done_marker ( shard_command ( command, a_shard ), a_shard );
+            std::cout << "Shard " << a_shard.index << " is done\n";
+        }
+        else
+        {
+            std::cerr << "Shard " << a_shard.index << " failed, see " << a_shard.log () << std::endl;
+            result = false;
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,272 @@
+#include "rsai/shard_planner.h"
+
+#include <limits>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <Eigen/Dense>
+
+#include "common/definitions.h"
+#include "gdal_utils/all_helpers.h"
+
+using namespace rsai;
+
+namespace
+{
+    const double infinity = std::numeric_limits < double >::infinity ();
+
+    using centers = std::vector < Eigen::Vector2d >;
+
+    // Splits the points across the longer side of their bbox proportionally to the shards' counts on each side
+    void bisect ( centers::iterator begin, centers::iterator end, const OGREnvelope &core, const int count, std::vector < OGREnvelope > &cores )
+    {
+        if ( count <= 1 )
+        {
+            cores.push_back ( core );
+            return;
+        }
+
+        OGREnvelope bbox;
+        for ( auto it = begin; it != end; ++it )
+            bbox.Merge ( ( *it ) [0], ( *it ) [1] );
+
+        const int axis = ( begin == end || bbox.MaxX - bbox.MinX >= bbox.MaxY - bbox.MinY ) ? 0 : 1;
+
+        const int left_count = count / 2;
+        const auto left_size = std::distance ( begin, end ) * left_count / count;
+
+        std::sort ( begin, end, [axis] ( const Eigen::Vector2d &lh, const Eigen::Vector2d &rh ) { return lh [axis] < rh [axis]; } );
+
+        double split = 0.0;
+        if ( begin != end )
+            split = ( left_size == 0 ) ? ( *begin ) [axis] : ( ( *( begin + left_size - 1 ) ) [axis] + ( *( begin + left_size ) ) [axis] ) / 2.0;
+
+        auto left_core = core, right_core = core;
+        if ( axis == 0 )
+            left_core.MaxX = right_core.MinX = split;
+        else
+            left_core.MaxY = right_core.MinY = split;
+
+        // Points on the split line belong to the right half as the cores are half-open
+        auto middle = std::partition_point ( begin, end, [axis, split] ( const Eigen::Vector2d &p ) { return p [axis] < split; } );
+
+        bisect ( begin, middle, left_core, left_count, cores );
+        bisect ( middle, end, right_core, count - left_count, cores );
+    }
+
+    bool intersects ( const OGREnvelope &lh, const OGREnvelope &rh )
+    {
+        return !( rh.MaxX < lh.MinX || rh.MinX > lh.MaxX || rh.MaxY < lh.MinY || rh.MinY > lh.MaxY );
+    }
+
+    // FNV-1a of the written features
+    void hash_bytes ( uint64_t &hash, const void * data, const size_t size )
+    {
+        auto bytes = static_cast < const unsigned char * > ( data );
+        for ( size_t i = 0; i < size; ++i )
+        {
+            hash ^= bytes [i];
+            hash *= 1099511628211ull;
+        }
+    }
+
+    void hash_feature ( uint64_t &hash, const std::string &layer_name, const OGRFeature * feature )
+    {
+        hash_bytes ( hash, layer_name.data (), layer_name.size () );
+
+        const OGRGeometry * geometry = feature->GetGeometryRef ();
+        std::vector < unsigned char > wkb ( geometry->WkbSize () );
+        geometry->exportToWkb ( wkbNDR, wkb.data () );
+        hash_bytes ( hash, wkb.data (), wkb.size () );
+
+        for ( int i = 0; i < feature->GetFieldCount (); ++i )
+        {
+            const std::string value = feature->GetFieldAsString ( i );
+            hash_bytes ( hash, value.c_str (), value.size () + 1 );
+        }
+    }
+
+    // Clips every layer of the source into the shards' datasets given by the path, owners are recorded for the input map
+    bool write_shards ( gdal::shared_dataset ds_source, shards &a_shards, std::string ( shard::*path ) () const
+                      , const std::string &driver, const bool owners )
+    {
+        std::vector < gdal::shared_dataset > ds_targets;
+        for ( auto &a_shard : a_shards )
+        {
+            const std::string target = ( a_shard.*path ) ();
+
+            std::error_code error;
+            std::filesystem::remove_all ( target, error );
+
+            gdal::create_vector_helper target_helper ( target, driver, std::cerr );
+            auto ds_target = target_helper.validate ( true );
+            if ( ds_target == nullptr )
+                return false;
+
+            ds_targets.push_back ( ds_target );
+        }
+
+        for ( int i = 0; i < ds_source->GetLayerCount (); ++i )
+        {
+            auto layer = ds_source->GetLayer ( i );
+            auto defn = layer->GetLayerDefn ();
+
+            // Maps are told apart in the fingerprint, so swapping them reruns the shards
+            const std::string hashed_name = ( owners ) ? layer->GetName () : std::string ( "updating/" ) + layer->GetName ();
+
+            const int id_index = defn->GetFieldIndex ( DEFAULT_OBJECT_ID_FIELD_NAME );
+            if ( owners && id_index < 0 )
+            {
+                std::cerr << "STOP: Layer " << layer->GetName () << " has no " << DEFAULT_OBJECT_ID_FIELD_NAME
+                          << " field to assign objects to shards" << std::endl;
+                return false;
+            }
+
+            // Shards' layers repeat the source one, every shard lists the layer even owning none of its objects
+            std::vector < OGRLayer * > shard_layers;
+            for ( int k = 0; k < a_shards.size (); ++k )
+            {
+                if ( owners )
+                    a_shards [k].owned [layer->GetName ()];
+
+                gdal::create_vector_helper target_helper ( ds_targets [k], std::cerr );
+                auto shard_layer = target_helper.create_layer ( layer->GetName (), defn->GetGeomType (), layer->GetSpatialRef (), true, rewrite_layer_promt_dummy );
+                if ( shard_layer == nullptr )
+                    return false;
+
+                for ( int j = 0; j < defn->GetFieldCount (); ++j )
+                    shard_layer->CreateField ( defn->GetFieldDefn ( j ) );
+
+                shard_layers.push_back ( shard_layer );
+            }
+
+            layer->ResetReading ();
+            while ( gdal::shared_feature feature = layer->GetNextFeature () )
+            {
+                const OGRGeometry * geometry = feature->GetGeometryRef ();
+                if ( geometry == nullptr || geometry->IsEmpty () )
+                    continue;
+
+                OGREnvelope envelope;
+                geometry->getEnvelope ( &envelope );
+
+                const double center_x = ( envelope.MinX + envelope.MaxX ) / 2.0,
+                             center_y = ( envelope.MinY + envelope.MaxY ) / 2.0;
+
+                for ( int k = 0; k < a_shards.size (); ++k )
+                {
+                    if ( !intersects ( a_shards [k].extent, envelope ) )
+                        continue;
+
+                    // Same centers the cores are planned by
+                    if ( owners && a_shards [k].owns ( center_x, center_y ) )
+                        a_shards [k].owned [layer->GetName ()].insert ( feature->GetFieldAsInteger64 ( id_index ) );
+
+                    gdal::shared_feature shard_feature ( shard_layers [k]->GetLayerDefn () );
+                    shard_feature->SetFrom ( feature.get (), TRUE );
+                    if ( shard_layers [k]->CreateFeature ( shard_feature.get () ) != OGRERR_NONE )
+                    {
+                        std::cerr << "STOP: Failed to create feature in shard " << k << " layer " << layer->GetName () << std::endl;
+                        return false;
+                    }
+
+                    hash_feature ( a_shards [k].fingerprint, hashed_name, feature.get () );
+                    ++a_shards [k].features;
+                }
+            }
+        }
+
+        return true;
+    }
+}
+
+std::string shard::input () const
+{
+    return directory + "/input";
+}
+
+std::string shard::output () const
+{
+    return directory + "/output";
+}
+
+std::string shard::updating () const
+{
+    return directory + "/updating";
+}
+
+std::string shard::log () const
+{
+    return directory + "/log.txt";
+}
+
+std::string shard::done () const
+{
+    return directory + "/done";
+}
+
+bool shard::owns ( const double x, const double y ) const
+{
+    return x >= core.MinX && x < core.MaxX && y >= core.MinY && y < core.MaxY;
+}
+
+shards rsai::plan_shards ( gdal::shared_dataset ds_vector, const int count, const double halo, const std::string &work_directory )
+{
+    centers points;
+    for ( int i = 0; i < ds_vector->GetLayerCount (); ++i )
+    {
+        auto layer = ds_vector->GetLayer ( i );
+        layer->ResetReading ();
+        while ( gdal::shared_feature feature = layer->GetNextFeature () )
+        {
+            const OGRGeometry * geometry = feature->GetGeometryRef ();
+            if ( geometry == nullptr || geometry->IsEmpty () )
+                continue;
+
+            OGREnvelope envelope;
+            geometry->getEnvelope ( &envelope );
+            points.emplace_back ( ( envelope.MinX + envelope.MaxX ) / 2.0, ( envelope.MinY + envelope.MaxY ) / 2.0 );
+        }
+    }
+
+    // Outer cores are unbounded, so the cores cover any output
+    OGREnvelope plane;
+    plane.MinX = plane.MinY = -infinity;
+    plane.MaxX = plane.MaxY = infinity;
+
+    std::vector < OGREnvelope > cores;
+    bisect ( points.begin (), points.end (), plane, std::max ( 1, count ), cores );
+
+    shards result;
+    for ( int i = 0; i < cores.size (); ++i )
+    {
+        shard a_shard;
+        a_shard.index = i;
+        a_shard.core = cores [i];
+        a_shard.extent = cores [i];
+        a_shard.extent.MinX -= halo;
+        a_shard.extent.MinY -= halo;
+        a_shard.extent.MaxX += halo;
+        a_shard.extent.MaxY += halo;
+        a_shard.directory = work_directory + "/" + DEFAULT_SHARD_DIRECTORY_PREFIX + std::to_string ( i );
+
+        result.push_back ( a_shard );
+    }
+
+    return result;
+}
+
+bool rsai::write_shard_inputs ( gdal::shared_dataset ds_vector, gdal::shared_dataset ds_updating, shards &a_shards, const std::string &driver )
+{
+    for ( auto &a_shard : a_shards )
+    {
+        a_shard.features = 0;
+        a_shard.owned.clear ();
+        a_shard.fingerprint = 14695981039346656037ull;
+    }
+
+    if ( !write_shards ( ds_vector, a_shards, &shard::input, driver, true ) )
+        return false;
+
+    return ds_updating == nullptr || write_shards ( ds_updating, a_shards, &shard::updating, driver, false );
+}
@@ -1,3 +1,3 @@
-sh ./scripts/raster_composer.sh "./raster/Kursk/Mapbox_19_3395.tif" "./raster/Kursk/Bing_19_3395.tif" "./composite/" "4020549.6 6718068.8 4023724.3 6715727.0" "raster_composite" blue
-sh ./scripts/raster_composer.sh "./raster/Kursk/Mapbox_19_3395.tif" "./raster/Kursk/Bing_19_3395.tif" "./composite/" "4020549.6 6718068.8 4023724.3 6715727.0" "raster_composite" green
-sh ./scripts/raster_composer.sh "./raster/Kursk/Mapbox_19_3395.tif" "./raster/Kursk/Bing_19_3395.tif" "./composite/" "4020549.6 6718068.8 4023724.3 6715727.0" "raster_composite" red
+./raster_composer -r "./raster/Kursk/Mapbox_19_3395.tif" --second_raster "./raster/Kursk/Bing_19_3395.tif" -o "./composite/raster_composite_blue.tif" --projwin "4020549.6 6718068.8 4023724.3 6715727.0" --color blue
+./raster_composer -r "./raster/Kursk/Mapbox_19_3395.tif" --second_raster "./raster/Kursk/Bing_19_3395.tif" -o "./composite/raster_composite_green.tif" --projwin "4020549.6 6718068.8 4023724.3 6715727.0" --color green
+./raster_composer -r "./raster/Kursk/Mapbox_19_3395.tif" --second_raster "./raster/Kursk/Bing_19_3395.tif" -o "./composite/raster_composite_red.tif" --projwin "4020549.6 6718068.8 4023724.3 6715727.0" --color red
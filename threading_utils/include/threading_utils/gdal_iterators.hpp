@@ -37,10 +37,10 @@ bool threading::layer_iterator::operator () ( WorkerFunc worker, const int layer
     {
         threading::worker_pool workers ( [&] ()
         {
-            while ( auto feature = source_layer_iter.next_feature () )
+            int current_feature_id = 0;
+            while ( auto feature = source_layer_iter.next_feature ( current_feature_id ) )
             {
-                const int current_feature_id = ++features_processed;
-                progress_func ( layer_index + 1, layers_count, current_feature_id / features_count );
+                progress_func ( layer_index + 1, layers_count, ++features_processed / features_count );
 
                 worker ( feature, current_feature_id );
             }
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <thread>
+#include <optional>
+#include <functional>
+#include <condition_variable>
+
+namespace threading
+{
+    // Write-behind sink: workers push indexed items in any order, a dedicated writer thread
+    // consumes them strictly by index. Pending items are bounded by max_pending ( 0 - unbounded ),
+    // the item with the next expected index is always accepted to avoid stalls.
+    template < class Item >
+    class ordered_sink
+    {
+    public:
+        using consumer_func = std::function < void ( const int index, Item &item ) >;
+
+        ordered_sink ( consumer_func consumer, const int first_index = 0, const size_t max_pending = 0 );
+        ~ordered_sink ();
+
+        void    push    ( const int index, Item item );
+        void    skip    ( const int index );
+        void    finish  ();
+
+    private:
+        consumer_func   m_consumer;
+        const size_t    m_max_pending;
+
+        std::map < int, std::optional < Item > > m_pending;
+        int             m_next_index;
+        bool            m_finished = false;
+
+        std::mutex      m_mutex;
+        std::condition_variable m_ready;
+        std::condition_variable m_space;
+        std::thread     m_writer;
+
+        void            __put ( const int index, std::optional < Item > item );
+        void            __write ();
+    }; // class ordered_sink
+
+}; // namespace threading
+
+#include "threading_utils/ordered_sink.hpp"
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "threading_utils/ordered_sink.h"
+
+template < class Item >
+threading::ordered_sink < Item >::ordered_sink ( consumer_func consumer, const int first_index, const size_t max_pending )
+    : m_consumer ( std::move ( consumer ) )
+    , m_max_pending ( max_pending )
+    , m_next_index ( first_index )
+{
+    m_writer = std::thread ( [this] () { __write (); } );
+}
+
+template < class Item >
+threading::ordered_sink < Item >::~ordered_sink ()
+{
+    finish ();
+}
+
+template < class Item >
+void threading::ordered_sink < Item >::push ( const int index, Item item )
+{
+    __put ( index, std::optional < Item > ( std::move ( item ) ) );
+}
+
+template < class Item >
+void threading::ordered_sink < Item >::skip ( const int index )
+{
+    __put ( index, std::nullopt );
+}
+
+template < class Item >
+void threading::ordered_sink < Item >::finish ()
+{
+    {
+        std::scoped_lock lock ( m_mutex );
+        m_finished = true;
+    }
+    m_ready.notify_all ();
+
+    if ( m_writer.joinable () )
+        m_writer.join ();
+}
+
+template < class Item >
+void threading::ordered_sink < Item >::__put ( const int index, std::optional < Item > item )
+{
+    std::unique_lock lock ( m_mutex );
+
+    if ( m_max_pending > 0 )
+        m_space.wait ( lock, [&] () { return index == m_next_index || m_pending.size () < m_max_pending; } );
+
+    m_pending.emplace ( index, std::move ( item ) );
+
+    if ( index == m_next_index )
+        m_ready.notify_one ();
+}
+
+template < class Item >
+void threading::ordered_sink < Item >::__write ()
+{
+    std::unique_lock lock ( m_mutex );
+
+    while ( true )
+    {
+        m_ready.wait ( lock, [&] () { return m_finished || ( !m_pending.empty () && m_pending.begin ()->first == m_next_index ); } );
+
+        // On finish the remaining items are written in order even if some indices were never pushed
+        if ( m_pending.empty () )
+        {
+            if ( m_finished )
+                return;
+            continue;
+        }
+
+        if ( !m_finished && m_pending.begin ()->first != m_next_index )
+            continue;
+
+        auto pending = m_pending.extract ( m_pending.begin () );
+        m_next_index = pending.key () + 1;
+
+        lock.unlock ();
+        m_space.notify_all ();
+
+        if ( pending.mapped () )
+            m_consumer ( pending.key (), *pending.mapped () );
+
+        lock.lock ();
+    }
+}
@@ -11,6 +11,7 @@ namespace threading
         shared_layer_iterator (OGRLayer* layer);
         shared_layer_iterator ( const shared_layer_iterator &src );
         gdal::shared_feature    next_feature();
+        gdal::shared_feature    next_feature( int &feature_index );
         void                    set_feature ( gdal::shared_feature new_feature );
         void                    reset ();
         OGRLayer*               layer ();
@@ -18,5 +19,6 @@ namespace threading
     private:
         OGRLayer* m_layer;
         std::mutex m_mutex;
+        int m_features_read = 0;
     };
 }; // namespace threading
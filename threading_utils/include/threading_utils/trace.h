@@ -0,0 +1,119 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <optional>
+
+#include "common/definitions.h"
+
+// RSAI_TRACING is defined by the CMake option of the same name ( -DRSAI_TRACING=ON ) and builds the hot path
+// spans in, without it the RSAI_TRACE_* macros expand to nothing
+
+namespace threading
+{
+    struct trace_event
+    {
+        const char *    name        = nullptr;
+        int             feature     = -1;
+        // Nanoseconds since the tracer's start
+        uint64_t        begin       = 0;
+        uint64_t        end         = 0;
+    };
+
+    // Single writer ring of the latest events of a thread, the oldest ones are overwritten
+    class trace_buffer
+    {
+    public:
+        trace_buffer ( const int thread_index, const size_t capacity );
+
+        void            push    ( const trace_event &event );
+
+        int             thread_index () const;
+        // Retained events, oldest first
+        std::vector < trace_event > events () const;
+
+    private:
+        const int       m_thread_index;
+        std::vector < trace_event > m_events;
+        std::atomic < uint64_t > m_head { 0 };
+    }; // class trace_buffer
+
+    // Process wide spans collector. Every thread records to its own buffer without locking,
+    // the buffers outlive their threads and are exported once the run is over.
+    class tracer
+    {
+    public:
+        static tracer & instance ();
+
+        void            enable  ( const bool enabled );
+        bool            enabled () const;
+
+        uint64_t        now     () const;
+        void            record  ( const char * name, const int feature, const uint64_t begin, const uint64_t end );
+
+        // Chrome trace event format, opened by chrome://tracing and Perfetto
+        bool            write_chrome_trace ( const std::string &file_name ) const;
+
+    private:
+        tracer ();
+
+        const std::chrono::steady_clock::time_point m_start;
+        std::atomic_bool m_enabled { false };
+
+        // Guards buffers' registration only
+        mutable std::mutex m_lock;
+        std::vector < std::unique_ptr < trace_buffer > > m_buffers;
+
+        trace_buffer &  __local ();
+    }; // class tracer
+
+    // Feature the spans of the current thread belong to
+    int & current_trace_feature ();
+
+    class trace_feature
+    {
+    public:
+        trace_feature ( const int feature );
+        ~trace_feature ();
+
+    private:
+        const int       m_previous;
+    }; // class trace_feature
+
+    class trace_span
+    {
+    public:
+        trace_span ( const char * name, const int feature = current_trace_feature () );
+        ~trace_span ();
+
+    private:
+        const char *    m_name;
+        const int       m_feature;
+        uint64_t        m_begin = 0;
+        bool            m_active = false;
+    }; // class trace_span
+
+}; // namespace threading
+
+#define RSAI_TRACE_JOIN_IMPL( a, b )    a##b
+#define RSAI_TRACE_JOIN( a, b )         RSAI_TRACE_JOIN_IMPL ( a, b )
+
+#if defined ( RSAI_TRACING )
+#   define RSAI_TRACE_SPAN( name )                  threading::trace_span RSAI_TRACE_JOIN ( __trace_span_, __COUNTER__ ) ( name )
+#   define RSAI_TRACE_FEATURE_SPAN( name, feature ) threading::trace_span RSAI_TRACE_JOIN ( __trace_span_, __COUNTER__ ) ( name, feature )
+#   define RSAI_TRACE_FEATURE( feature )            threading::trace_feature RSAI_TRACE_JOIN ( __trace_feature_, __COUNTER__ ) ( feature )
+    // Span of a function's part, ended explicitly
+#   define RSAI_TRACE_BEGIN( span, name )           std::optional < threading::trace_span > span; span.emplace ( name )
+#   define RSAI_TRACE_END( span )                   span.reset ()
+#else
+#   define RSAI_TRACE_SPAN( name )
+#   define RSAI_TRACE_FEATURE_SPAN( name, feature )
+#   define RSAI_TRACE_FEATURE( feature )
+#   define RSAI_TRACE_BEGIN( span, name )
+#   define RSAI_TRACE_END( span )
+#endif
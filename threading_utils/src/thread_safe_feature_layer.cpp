@@ -28,6 +28,21 @@ gdal::shared_feature shared_layer_iterator::next_feature()
         return gdal::shared_feature ();
 }
 
+// Feature index is assigned in the reading order - from 1 to features count
+gdal::shared_feature shared_layer_iterator::next_feature( int &feature_index )
+{
+    if ( m_layer )
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        gdal::shared_feature feature ( m_layer->GetNextFeature() );
+        if ( feature )
+            feature_index = ++m_features_read;
+        return feature;
+    }
+    else
+        return gdal::shared_feature ();
+}
+
 void shared_layer_iterator::set_feature ( gdal::shared_feature new_feature )
 {
     if ( m_layer )
@@ -46,6 +61,7 @@ void shared_layer_iterator::reset ()
     {
         std::lock_guard<std::mutex> lock(m_mutex);
         m_layer->ResetReading();
+        m_features_read = 0;
     }
 }
 
@@ -0,0 +1,170 @@
+#include "threading_utils/trace.h"
+
+#include <fstream>
+#include <algorithm>
+#include <iostream>
+
+using namespace threading;
+
+trace_buffer::trace_buffer ( const int thread_index, const size_t capacity )
+    : m_thread_index ( thread_index ), m_events ( std::max < size_t > ( 1, capacity ) )
+{
+}
+
+void trace_buffer::push ( const trace_event &event )
+{
+    const auto head = m_head.load ( std::memory_order_relaxed );
+    m_events [head % m_events.size ()] = event;
+    m_head.store ( head + 1, std::memory_order_release );
+}
+
+int trace_buffer::thread_index () const
+{
+    return m_thread_index;
+}
+
+std::vector < trace_event > trace_buffer::events () const
+{
+    const auto head = m_head.load ( std::memory_order_acquire );
+    const auto count = std::min < uint64_t > ( head, m_events.size () );
+
+    std::vector < trace_event > result;
+    result.reserve ( count );
+    for ( auto i = head - count; i < head; ++i )
+        result.push_back ( m_events [i % m_events.size ()] );
+
+    return result;
+}
+
+tracer & tracer::instance ()
+{
+    static tracer a_tracer;
+    return a_tracer;
+}
+
+tracer::tracer ()
+    : m_start ( std::chrono::steady_clock::now () )
+{
+}
+
+void tracer::enable ( const bool enabled )
+{
+#if !defined ( RSAI_TRACING )
+    if ( enabled )
+        std::cerr << "Tracing is not built in, configure with -DRSAI_TRACING=ON to get the spans" << std::endl;
+#endif
+    m_enabled = enabled;
+}
+
+bool tracer::enabled () const
+{
+    return m_enabled.load ( std::memory_order_relaxed );
+}
+
+uint64_t tracer::now () const
+{
+    return std::chrono::duration_cast < std::chrono::nanoseconds > ( std::chrono::steady_clock::now () - m_start ).count ();
+}
+
+void tracer::record ( const char * name, const int feature, const uint64_t begin, const uint64_t end )
+{
+    __local ().push ( { name, feature, begin, end } );
+}
+
+bool tracer::write_chrome_trace ( const std::string &file_name ) const
+{
+    std::ofstream out ( file_name );
+    if ( !out )
+    {
+        std::cerr << "Unable to write trace file: " << file_name << std::endl;
+        return false;
+    }
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    bool first = true;
+    auto separate = [&] ()
+    {
+        if ( !first )
+            out << ',';
+        out << '\n';
+        first = false;
+    };
+
+    std::scoped_lock lock ( m_lock );
+    size_t written = 0;
+    for ( const auto &buffer : m_buffers )
+    {
+        const int tid = buffer->thread_index ();
+
+        separate ();
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid
+            << ",\"args\":{\"name\":\"thread " << tid << "\"}}";
+
+        // Span names are literals of the instrumented code, so no escaping is needed
+        for ( const auto &event : buffer->events () )
+        {
+            separate ();
+            out << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+                << ",\"ts\":" << event.begin / 1000.0 << ",\"dur\":" << ( event.end - event.begin ) / 1000.0;
+            if ( event.feature >= 0 )
+                out << ",\"args\":{\"feature\":" << event.feature << '}';
+            out << '}';
+            ++written;
+        }
+    }
+
+    out << "\n]}\n";
+
+    std::cout << "Trace of " << written << " spans written to " << file_name << '\n';
+    return bool ( out );
+}
+
+trace_buffer & tracer::__local ()
+{
+    thread_local trace_buffer * buffer = nullptr;
+    if ( buffer == nullptr )
+    {
+        std::scoped_lock lock ( m_lock );
+        m_buffers.emplace_back ( new trace_buffer ( m_buffers.size (), DEFAULT_TRACE_BUFFER_EVENTS ) );
+        buffer = m_buffers.back ().get ();
+    }
+    return *buffer;
+}
+
+int & threading::current_trace_feature ()
+{
+    thread_local int feature = -1;
+    return feature;
+}
+
+trace_feature::trace_feature ( const int feature )
+    : m_previous ( current_trace_feature () )
+{
+    current_trace_feature () = feature;
+}
+
+trace_feature::~trace_feature ()
+{
+    current_trace_feature () = m_previous;
+}
+
+trace_span::trace_span ( const char * name, const int feature )
+    : m_name ( name ), m_feature ( feature )
+{
+    auto & a_tracer = tracer::instance ();
+    if ( a_tracer.enabled () )
+    {
+        m_active = true;
+        m_begin = a_tracer.now ();
+    }
+}
+
+trace_span::~trace_span ()
+{
+    if ( !m_active )
+        return;
+
+    auto & a_tracer = tracer::instance ();
+    a_tracer.record ( m_name, m_feature, m_begin, a_tracer.now () );
+}
@@ -0,0 +1,144 @@
+#include <iostream>
+#include <string>
+#include <algorithm>
+
+#include <args-parser/all.hpp>
+
+#include "common/definitions.h"
+#include "common/arguments.h"
+#include "common/string_utils.h"
+#include "common/progress_functions.hpp"
+#include "gdal_utils/all_helpers.h"
+#include "rsai/vector_composer.h"
+
+using namespace std;
+
+int main ( int argc, char * argv[] )
+{
+    try
+    {
+        Args::CmdLine cmd( argc, argv );
+
+        Args::Arg & input_vector_param = arguments::get_input_vector ();
+        input_vector_param.setDescription( input_vector_param.description() + SL( "Newer map rendered into the red channel." ) );
+
+        Args::Arg & input_updating_param = arguments::get_input_updating_map ();
+        input_updating_param.setDescription( SL( "Older vector map rendered into the blue channel. " ) );
+
+        Args::Arg & output_param = arguments::get_output ();
+        output_param.setDescription( SL( "Output GeoTIFF raster file. " ) );
+
+        Args::Arg & projwin_param = arguments::get_projection_window ();
+
+        Args::Arg & pixel_size_param = arguments::get_pixel_size ();
+
+        Args::Arg & background_param = arguments::get_background_raster ();
+        background_param.setDescription( background_param.description() + SL( "If is set the maps are rendered over its RGB bands." ) );
+
+        Args::Help help;
+        help.setAppDescription(
+            std::string ( "Utility to compose a multidate RGBA raster from two vector maps of the same region. "
+                          "Objects of the older map are blue, of the newer one - red, the rest is transparent or taken from the '" ) + background_param.name() + "' raster. "
+                          "The output is a tiled compressed GeoTIFF written in one pass without intermediate files. "
+                          "World coordinate systems of all the datasets should match (no reprojection is performed)." );
+        help.setExecutable( argv[0] );
+
+        cmd.addArg ( input_vector_param );
+        cmd.addArg ( input_updating_param );
+        cmd.addArg ( output_param );
+        cmd.addArg ( projwin_param );
+        cmd.addArg ( pixel_size_param );
+        cmd.addArg ( background_param );
+        cmd.addArg ( help );
+
+        cmd.parse();
+
+        gdal::open_vector_ro_helper newer_helper ( input_vector_param.value(), std::cerr );
+        auto ds_newer = newer_helper.validate ( true );
+
+        gdal::open_vector_ro_helper older_helper ( input_updating_param.value(), std::cerr );
+        auto ds_older = older_helper.validate ( true );
+
+        gdal::open_raster_ro_helper background_helper ( background_param.value(), std::cerr );
+        auto ds_background = background_helper.validate ( false );
+
+        if ( ds_newer == nullptr || ds_older == nullptr || ds_background == nullptr && !background_param.value().empty () )
+        {
+            std::cerr << "STOP: Input parameters verification failed" << std::endl;
+            return 1;
+        }
+
+        auto newer_srs = newer_helper.srs (),
+             older_srs = older_helper.srs ();
+
+        if ( !newer_srs.verify ( std::cerr ) || !older_srs.verify ( std::cerr ) )
+        {
+            std::cerr << "STOP: Input datasets' SRS are not valid" << std::endl;
+            return 1;
+        }
+
+        if ( !newer_srs->IsSame ( older_srs.get() ) )
+        {
+            std::cerr << "STOP: input maps' SRSs are not same." << std::endl << std::endl;
+            std::cout << "Newer map SRS: " << newer_srs.export_to_pretty_wkt() << std::endl << std::endl;
+            std::cout << "Older map SRS: " << older_srs.export_to_pretty_wkt() << std::endl;
+            return 1;
+        }
+
+        if ( ds_background != nullptr )
+        {
+            auto background_srs = background_helper.srs ();
+            if ( !background_srs.verify ( std::cerr ) || !newer_srs->IsSame ( background_srs.get() ) )
+            {
+                std::cerr << "STOP: background raster's SRS is not valid or does not match the maps' one." << std::endl;
+                return 1;
+            }
+        }
+
+        array_helper < double > projwin_helper ( projwin_param.value(), ", " );
+        if ( !projwin_helper.verify ( std::cerr, "STOP: Projection window is incorrect" ) || projwin_helper.value().size () != 4 )
+        {
+            std::cerr << "STOP: Projection window should be set as 'ulx,uly,lrx,lry'" << std::endl;
+            return 1;
+        }
+
+        value_helper < double > pixel_size_helper ( pixel_size_param.value() );
+        if ( !pixel_size_helper.verify ( std::cerr, "STOP: Pixel size is incorrect" ) )
+            return 1;
+
+        // Window corners can be set in any order
+        const auto projwin = projwin_helper.value();
+        OGREnvelope extent;
+        extent.MinX = std::min ( projwin [0], projwin [2] );
+        extent.MaxX = std::max ( projwin [0], projwin [2] );
+        extent.MinY = std::min ( projwin [1], projwin [3] );
+        extent.MaxY = std::max ( projwin [1], projwin [3] );
+
+        const auto grid = gdal::raster_grid::from_extent ( extent, pixel_size_helper.value(), pixel_size_helper.value() );
+        if ( !grid.valid () )
+        {
+            std::cerr << "STOP: Projection window or pixel size does not define an output raster" << std::endl;
+            return 1;
+        }
+
+        rsai::vector_composer composer ( ds_newer
+                                         , ds_older
+                                         , background_param.value()
+                                         , grid
+                                         , output_param.value()
+                                       );
+
+        if ( !composer ( console_progress ) )
+            return 1;
+    }
+    catch( const Args::HelpHasBeenPrintedException & )
+    {
+    }
+    catch( const Args::BaseException & x )
+    {
+        Args::outStream() << x.desc() << SL( "\n" );
+    }
+
+
+    return 0;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <thread>
+
+#include "common/progress_functions.hpp"
+
+#include "gdal_utils/shared_dataset.h"
+#include "gdal_utils/shared_geometry.h"
+#include "gdal_utils/raster_window.h"
+
+namespace rsai
+{
+    // Renders an older map into the blue channel and a newer one into the red channel with transparent background,
+    // optionally over a background raster. Both maps' layers are read once, rows are rasterized by block height strips
+    // in parallel and written in order into a tiled compressed RGBA GeoTIFF, no intermediate files are created.
+    class vector_composer
+    {
+    public:
+        vector_composer ( gdal::shared_dataset ds_newer
+                          , gdal::shared_dataset ds_older
+                          , const std::string &background
+                          , const gdal::raster_grid &grid
+                          , const std::string &output
+                          , const int threads = std::max ( 1u, std::thread::hardware_concurrency () )
+                        );
+
+        template < class ProgressFunc >
+        bool operator () ( const ProgressFunc &progress_func = console_progress );
+
+    private:
+        struct map_geometry
+        {
+            gdal::geometry  geometry;
+            bool            newer;
+        };
+
+        gdal::shared_dataset        m_newer;
+        gdal::shared_dataset        m_older;
+        const std::string           m_background;
+        const gdal::raster_grid     m_grid;
+        const std::string           m_output;
+        const int                   m_threads;
+
+        bool __load ( gdal::shared_dataset ds, const bool newer, std::vector < map_geometry > &geometries ) const;
+        bool __rasterize ( const gdal::raster_grid &strip_grid, const std::vector < const map_geometry * > &geometries, std::vector < GByte > &rgb ) const;
+    }; // class vector_composer
+
+}; // namespace rsai
+
+#include "rsai/vector_composer.hpp"
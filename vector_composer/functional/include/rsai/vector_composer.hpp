@@ -0,0 +1,153 @@
+#pragma once
+
+#include "rsai/vector_composer.h"
+
+#include <atomic>
+#include <iostream>
+#include "gdal_utils/spatial_index.h"
+#include "threading_utils/ordered_sink.h"
+
+template < class ProgressFunc >
+bool rsai::vector_composer::operator () ( const ProgressFunc &progress_func )
+{
+    std::vector < map_geometry > geometries;
+    if ( !__load ( m_older, false, geometries ) || !__load ( m_newer, true, geometries ) )
+    {
+        std::cerr << "Stop: Failed to read input maps" << std::endl;
+        return false;
+    }
+
+    // Index bounds cover the output region and all the loaded geometries
+    OGREnvelope bounds = m_grid.envelope ();
+    for ( const auto &a_geometry : geometries )
+    {
+        OGREnvelope envelope;
+        a_geometry.geometry->getEnvelope ( &envelope );
+        bounds.Merge ( envelope );
+    }
+
+    gdal::spatial_index < const map_geometry * > index ( bounds );
+    for ( const auto &a_geometry : geometries )
+    {
+        OGREnvelope envelope;
+        a_geometry.geometry->getEnvelope ( &envelope );
+        index.insert ( envelope, &a_geometry );
+    }
+
+    const auto srs = m_newer.vector_srs ( 0 );
+
+    gdal::tiled_raster_writer writer ( m_output, m_grid, 4, GDT_Byte, "RGB", srs.get () );
+    if ( !writer.valid () )
+    {
+        std::cerr << "Stop: Failed to create output raster " << m_output << std::endl;
+        return false;
+    }
+
+    const int strip_height = writer.block_height ();
+    const int strips = ( m_grid.height () + strip_height - 1 ) / strip_height;
+
+    std::atomic_bool failed = false;
+    std::atomic_int next_strip = 0;
+    int written = 0;
+
+    threading::ordered_sink < std::vector < GByte > > sink ( [&] ( const int strip, std::vector < GByte > &buffer )
+    {
+        const int row_from = strip * strip_height;
+        const int row_to = std::min ( m_grid.height (), row_from + strip_height );
+
+        if ( !writer.write ( row_from, row_to, buffer.data () ) )
+            failed = true;
+
+        ++written;
+        progress_func ( float ( written ) / strips, written == strips );
+    }
+    , 0, 2 * m_threads );
+
+    auto worker = [&] ()
+    {
+        // Datasets are not thread safe, every worker reads the background by own handle
+        gdal::shared_dataset ds_background;
+        if ( !m_background.empty () )
+        {
+            ds_background = gdal::open_dataset ( m_background, GDAL_OF_RASTER | GDAL_OF_READONLY );
+            if ( !ds_background || ds_background->GetRasterCount () < 3 )
+                failed = true;
+        }
+
+        std::vector < GByte > vector_rgb, background_rgb;
+
+        for ( int strip = next_strip++; strip < strips; strip = next_strip++ )
+        {
+            if ( failed )
+            {
+                sink.skip ( strip );
+                continue;
+            }
+
+            const int row_from = strip * strip_height;
+            const int row_to = std::min ( m_grid.height (), row_from + strip_height );
+            const auto strip_grid = m_grid.rows ( row_from, row_to );
+            const size_t band_size = size_t ( strip_grid.width () ) * strip_grid.height ();
+
+            const auto found = index.search ( strip_grid.envelope () );
+            std::vector < const map_geometry * > strip_geometries;
+            strip_geometries.reserve ( found.size () );
+            for ( auto a_geometry : found )
+                strip_geometries.push_back ( *a_geometry );
+
+            if ( !__rasterize ( strip_grid, strip_geometries, vector_rgb ) )
+            {
+                failed = true;
+                sink.skip ( strip );
+                continue;
+            }
+
+            if ( ds_background )
+            {
+                background_rgb.assign ( band_size * 3, 0 );
+                for ( int band = 0; band < 3; ++band )
+                {
+                    if ( !strip_grid.read ( ds_background->GetRasterBand ( band + 1 ), GDT_Byte, background_rgb.data () + band * band_size ) )
+                        failed = true;
+                }
+            }
+
+            // Black pixels are transparent, the maps are drawn over the background
+            std::vector < GByte > buffer ( band_size * 4, 0 );
+            for ( size_t i = 0; i < band_size; ++i )
+            {
+                const GByte * source = nullptr;
+                if ( vector_rgb [i] || vector_rgb [i + band_size] || vector_rgb [i + 2 * band_size] )
+                    source = vector_rgb.data ();
+                else if ( ds_background && ( background_rgb [i] || background_rgb [i + band_size] || background_rgb [i + 2 * band_size] ) )
+                    source = background_rgb.data ();
+
+                if ( source == nullptr )
+                    continue;
+
+                for ( int band = 0; band < 3; ++band )
+                    buffer [i + band * band_size] = source [i + band * band_size];
+                buffer [i + 3 * band_size] = 255;
+            }
+
+            sink.push ( strip, std::move ( buffer ) );
+        }
+    };
+
+    std::vector < std::thread > workers;
+    for ( int i = 0; i < m_threads; ++i )
+        workers.emplace_back ( worker );
+
+    for ( auto &a_worker : workers )
+        a_worker.join ();
+
+    sink.finish ();
+
+    if ( failed )
+    {
+        std::cerr << "Stop: Failed to compose maps into " << m_output << std::endl;
+        return false;
+    }
+
+    return writer.commit ();
+}
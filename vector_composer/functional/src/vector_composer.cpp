@@ -0,0 +1,89 @@
+#include "rsai/vector_composer.h"
+
+#include <gdal_alg.h>
+
+rsai::vector_composer::vector_composer ( gdal::shared_dataset ds_newer
+                                         , gdal::shared_dataset ds_older
+                                         , const std::string &background
+                                         , const gdal::raster_grid &grid
+                                         , const std::string &output
+                                         , const int threads
+                                       )
+    : m_newer ( ds_newer ), m_older ( ds_older ), m_background ( background ), m_grid ( grid ), m_output ( output )
+    , m_threads ( std::max ( 1, threads ) )
+{
+}
+
+bool rsai::vector_composer::__load ( gdal::shared_dataset ds, const bool newer, std::vector < map_geometry > &geometries ) const
+{
+    const OGREnvelope extent = m_grid.envelope ();
+
+    for ( int i = 0; i < ds->GetLayerCount (); ++i )
+    {
+        auto * layer = ds->GetLayer ( i );
+        if ( layer == nullptr )
+            return false;
+
+        layer->SetSpatialFilterRect ( extent.MinX, extent.MinY, extent.MaxX, extent.MaxY );
+        layer->ResetReading ();
+
+        OGRFeature * feature = nullptr;
+        while ( ( feature = layer->GetNextFeature () ) != nullptr )
+        {
+            const OGRGeometry * geometry = feature->GetGeometryRef ();
+            if ( geometry != nullptr && !geometry->IsEmpty () )
+                geometries.push_back ( { gdal::geometry ( geometry->clone () ), newer } );
+
+            OGRFeature::DestroyFeature ( feature );
+        }
+
+        layer->SetSpatialFilter ( nullptr );
+    }
+
+    return true;
+}
+
+bool rsai::vector_composer::__rasterize ( const gdal::raster_grid &strip_grid, const std::vector < const map_geometry * > &geometries
+                                          , std::vector < GByte > &rgb ) const
+{
+    auto ds_strip = gdal::create_dataset ( "MEM", "", strip_grid.width (), strip_grid.height (), 3, GDT_Byte );
+    if ( !ds_strip )
+        return false;
+
+    double transform [6];
+    strip_grid.geo_transform ( transform );
+    ds_strip->SetGeoTransform ( transform );
+
+    // Older map is burned as blue into all the bands, newer one as red over it
+    for ( const bool newer : { false, true } )
+    {
+        std::vector < OGRGeometryH > handles;
+        for ( const auto * a_geometry : geometries )
+        {
+            if ( a_geometry->newer == newer )
+                handles.push_back ( OGRGeometry::ToHandle ( a_geometry->geometry.get () ) );
+        }
+
+        if ( handles.empty () )
+            continue;
+
+        std::vector < int > bands = newer ? std::vector < int > { 1 } : std::vector < int > { 1, 2, 3 };
+        std::vector < double > burn_color = newer ? std::vector < double > { 255.0 } : std::vector < double > { 0.0, 0.0, 255.0 };
+
+        std::vector < double > burn_values;
+        burn_values.reserve ( handles.size () * bands.size () );
+        for ( size_t i = 0; i < handles.size (); ++i )
+            burn_values.insert ( burn_values.end (), burn_color.begin (), burn_color.end () );
+
+        if ( GDALRasterizeGeometries ( GDALDataset::ToHandle ( ds_strip.get () ), bands.size (), bands.data ()
+                                       , handles.size (), handles.data (), nullptr, nullptr, burn_values.data ()
+                                       , nullptr, nullptr, nullptr ) != CE_None )
+            return false;
+    }
+
+    const GSpacing band_size = GSpacing ( strip_grid.width () ) * strip_grid.height ();
+    rgb.resize ( band_size * 3 );
+
+    return ds_strip->RasterIO ( GF_Read, 0, 0, strip_grid.width (), strip_grid.height (), rgb.data (), strip_grid.width (), strip_grid.height ()
+                              , GDT_Byte, 3, nullptr, 1, strip_grid.width (), band_size, nullptr ) == CE_None;
+}
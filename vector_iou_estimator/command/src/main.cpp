@@ -30,6 +30,8 @@ int main ( int argc, char * argv[] )
 
         Args::Arg & force_rewtire_param = arguments::get_force_rewtire ();
 
+        Args::Arg & iou_thresholds_param = arguments::get_iou_thresholds ();
+
         Args::Help help;
         help.setAppDescription(
             std::string ( "Utility to calculate IoU via vector 2 ground true matching ( object against best ground true object ). " ) );
@@ -40,6 +42,7 @@ int main ( int argc, char * argv[] )
         cmd.addArg ( output_optional_param );
         cmd.addArg ( driver_param );
         cmd.addArg ( force_rewtire_param );
+        cmd.addArg ( iou_thresholds_param );
         cmd.addArg ( help );
 
         cmd.parse();
@@ -53,7 +56,10 @@ int main ( int argc, char * argv[] )
         array_helper < std::string > o_list_helper ( output_optional_param.value() );
         const bool output_valid = o_list_helper.verify ( std::cerr, "STOP: Output directories list is incorrect" );
 
-        if ( !input_vector_valid || !input_ground_true_valid || !output_valid )
+        array_helper < double > iou_thresholds_helper ( iou_thresholds_param.value() );
+        const bool iou_thresholds_valid = iou_thresholds_helper.verify ( std::cerr, "STOP: IoU thresholds list is incorrect" );
+
+        if ( !input_vector_valid || !input_ground_true_valid || !output_valid || !iou_thresholds_valid )
         {
             std::cerr << "STOP: Input parameters verification failed" << std::endl;
             return 1;
@@ -95,6 +101,7 @@ int main ( int argc, char * argv[] )
                                                               ds_vectors
                                                             , ds_ground_trues
                                                             , ds_outs
+                                                            , iou_thresholds_helper.value()
                                                             , rewrite_layer_promt_func
                                                             , console_progress_layers
         );
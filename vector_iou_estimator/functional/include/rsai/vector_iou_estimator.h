@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "common/promt_functions.hpp"
 #include "common/progress_functions.hpp"
@@ -19,6 +20,7 @@ namespace rsai
                                  gdal::shared_datasets &ds_vectors
                                , gdal::shared_datasets &ds_ground_trues
                                , gdal::shared_datasets &ds_outs
+                               , const std::vector < double > &iou_thresholds
                                , const PromtFunc &promt_func = rewrite_layer_promt_dummy
                                , const ProgressFunc &progress_func = console_progress
                              );
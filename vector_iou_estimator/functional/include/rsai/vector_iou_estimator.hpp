@@ -2,6 +2,8 @@
 
 #include "rsai/vector_iou_estimator.h"
 
+#include <algorithm>
+#include <atomic>
 #include <ogrsf_frmts.h>
 
 #include "gdal_utils/all_helpers.h"
@@ -11,14 +13,32 @@
 #include "gdal_utils/layers.h"
 #include "threading_utils/gdal_iterators.h"
 #include "gdal_utils/operations.h"
+#include "gdal_utils/spatial_index.h"
 
 #include "common/definitions.h"
 
+// Ground true object prepared once for all the prediction layers
+struct ground_true_object
+{
+    gdal::geometry      geometry;
+    gdal::iou_operand   operand;
+    int                 index = 0;
+};
+
+// Prediction to ground true collision used for one-to-one objects assignment
+struct iou_match
+{
+    int     prediction = 0;
+    int     ground_true = 0;
+    double  iou = 0.0;
+};
+
 template < class PromtFunc, class ProgressFunc >
 rsai::vector_iou_estimator::vector_iou_estimator (
                                                     gdal::shared_datasets &ds_vectors
                                                   , gdal::shared_datasets &ds_ground_trues
                                                   , gdal::shared_datasets &ds_outs
+                                                  , const std::vector < double > &iou_thresholds
                                                   , const PromtFunc &promt_func
                                                   , const ProgressFunc &progress_func
                                                  )
@@ -28,13 +48,43 @@ rsai::vector_iou_estimator::vector_iou_estimator (
 
     static const std::string id_field_name = DEFAULT_OBJECT_ID_FIELD_NAME;
 
-    gdal::ogr_layers gt_layers;
+    // Ground true objects are loaded once into a read-only index shared by all the workers
+    OGREnvelope gt_bounds;
+    for ( auto ds_ground_true : ds_ground_trues )
+    {
+        for( int i = 0; i < ds_ground_true->GetLayerCount (); ++i )
+        {
+            OGREnvelope layer_bounds;
+            if ( ds_ground_true->GetLayer ( i )->GetExtent ( &layer_bounds, TRUE ) == OGRERR_NONE )
+                gt_bounds.Merge ( layer_bounds );
+        }
+    }
+
+    gdal::spatial_index < ground_true_object > gt_index ( gt_bounds );
     for ( auto ds_ground_true : ds_ground_trues )
     {
         for( int i = 0; i < ds_ground_true->GetLayerCount (); ++i )
-            gt_layers.add ( ds_ground_true->GetLayer ( i ) );
+        {
+            auto gt_layer = ds_ground_true->GetLayer ( i );
+            gt_layer->ResetReading ();
+
+            while ( gdal::shared_feature gt_feature = gt_layer->GetNextFeature () )
+            {
+                gdal::geometry geometry ( gt_feature->StealGeometry () );
+                gdal::iou_operand operand ( geometry.get () );
+                if ( operand.empty () )
+                    continue;
+
+                const auto envelope = operand.envelope ();
+                const int index = gt_index.size ();
+                gt_index.insert ( envelope, { geometry, operand, index } );
+            }
+        }
     }
 
+    const double min_threshold = iou_thresholds.empty () ? 1.0 : *std::min_element ( iou_thresholds.begin (), iou_thresholds.end () );
+    const int threads_count = std::max ( 1u, std::thread::hardware_concurrency () );
+
     int total_layers = 0;
     for ( auto ds_vector : ds_vectors )
         total_layers += ds_vector->GetLayerCount ();
@@ -42,6 +92,8 @@ rsai::vector_iou_estimator::vector_iou_estimator (
 
     std::mutex locker;
     std::pair < double, int > ious ( 0.0, 0 );
+    std::vector < iou_match > matches;
+    std::atomic_int predictions_count ( 0 );
 
     std::string group_name;
     std::string base_name;
@@ -65,23 +117,30 @@ rsai::vector_iou_estimator::vector_iou_estimator (
             threading::layer_iterator a_layer_iterator ( layer );
             layers_result &= a_layer_iterator ( [&] ( gdal::shared_feature feature, const int current_feature_id )
             {
-                OGRGeometry *geometry = feature->GetGeometryRef ();
-
-                gt_layers.set_spatial_filter ( geometry );
-                auto gt_features = gt_layers.search();
+                const int prediction_index = predictions_count++;
+                const gdal::iou_operand prediction ( feature->GetGeometryRef (), true );
 
                 double best_iou = 0.0;
-                for ( auto gt_feature : gt_features )
+                std::vector < iou_match > prediction_matches;
+
+                if ( !prediction.empty () )
                 {
-                    auto iou_value = gdal::iou ( geometry, gt_feature->GetGeometryRef() );
-                    best_iou = std::max ( best_iou, iou_value );
+                    for ( auto gt_object : gt_index.search ( prediction.envelope () ) )
+                    {
+                        auto iou_value = gdal::iou ( prediction, gt_object->operand );
+                        best_iou = std::max ( best_iou, iou_value );
+
+                        if ( iou_value > 0.0 && iou_value >= min_threshold )
+                            prediction_matches.push_back ( { prediction_index, gt_object->index, iou_value } );
+                    }
                 }
 
                 std::scoped_lock lock ( locker );
                 layer_ious.first += best_iou;
                 ++layer_ious.second;
+                matches.insert ( matches.end (), prediction_matches.begin (), prediction_matches.end () );
 
-            }, total_layer++, total_layers, progress_layers_dummy, 1 );
+            }, total_layer++, total_layers, progress_layers_dummy, threads_count );
         }
 
         //std::cout << "Layer " << group_name << "/" << vector_file_name << ", objects " << layer_ious.second
@@ -92,4 +151,42 @@ rsai::vector_iou_estimator::vector_iou_estimator (
     }
 
     std::cout << base_name << "/" << group_name << ", objects " << ious.second << " IoU = " << ious.first / ious.second * 100. << "%" << '\n';
+
+    // Greedy one-to-one assignment by descending IoU. Matches above a threshold form a prefix
+    // of the sorted list, so a single assignment serves all the thresholds.
+    std::sort ( matches.begin (), matches.end (), [] ( const iou_match &lh, const iou_match &rh )
+    {
+        if ( lh.iou != rh.iou )
+            return lh.iou > rh.iou;
+        if ( lh.prediction != rh.prediction )
+            return lh.prediction < rh.prediction;
+        return lh.ground_true < rh.ground_true;
+    } );
+
+    std::vector < bool > prediction_assigned ( predictions_count, false );
+    std::vector < bool > ground_true_assigned ( gt_index.size (), false );
+    std::vector < double > assigned_ious;
+
+    for ( const auto &match : matches )
+    {
+        if ( prediction_assigned [match.prediction] || ground_true_assigned [match.ground_true] )
+            continue;
+
+        prediction_assigned [match.prediction] = true;
+        ground_true_assigned [match.ground_true] = true;
+        assigned_ious.push_back ( match.iou );
+    }
+
+    for ( const auto threshold : iou_thresholds )
+    {
+        const int true_positives = std::count_if ( assigned_ious.begin (), assigned_ious.end (), [threshold] ( const double iou ) { return iou >= threshold; } );
+
+        const double precision = ious.second > 0 ? double ( true_positives ) / ious.second : 0.0;
+        const double recall = gt_index.size () > 0 ? double ( true_positives ) / gt_index.size () : 0.0;
+        const double f1 = precision + recall > 0.0 ? 2.0 * precision * recall / ( precision + recall ) : 0.0;
+
+        std::cout << base_name << "/" << group_name << ", IoU >= " << threshold << " matched " << true_positives
+                  << " of " << gt_index.size () << " ground true objects, precision = " << precision * 100. << "%"
+                  << ", recall = " << recall * 100. << "%" << ", F1 = " << f1 * 100. << "%" << '\n';
+    }
 }